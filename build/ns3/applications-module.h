@@ -10,11 +10,13 @@
 #include "application-packet-probe.h"
 #include "bulk-send-application.h"
 #include "bulk-send-helper.h"
+#include "flow-completion-stats.h"
 #include "on-off-helper.h"
 #include "onoff-application.h"
 #include "packet-loss-counter.h"
 #include "packet-sink-helper.h"
 #include "packet-sink.h"
+#include "traffic-pattern-helper.h"
 #include "seq-ts-header.h"
 #include "udp-client-server-helper.h"
 #include "udp-client.h"
@@ -23,4 +25,5 @@
 #include "udp-echo-server.h"
 #include "udp-server.h"
 #include "udp-trace-client.h"
+#include "workload-application.h"
 #endif
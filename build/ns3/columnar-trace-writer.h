@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_WRITER_H
+#define COLUMNAR_TRACE_WRITER_H
+
+#include <stdint.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Buffered binary writer of per-flow time series
+ *
+ * Every record is a (time, flow, series, value) tuple. Flows and series
+ * are declared once, by name, and then referred to by a small integer.
+ * Records are buffered in blocks of BlockSize records, each block being
+ * written as four separate columns:
+ *
+ * - time: zigzag varint of the difference from the previous record (ns)
+ * - flow: zigzag varint of the difference from the previous record
+ * - series: varint
+ * - value: the bits of the double XORed with the previous value of the
+ *   same flow and series; a header byte gives the number of leading and
+ *   trailing zero bytes of the result, which are not written
+ *
+ * Slowly changing series compress to one or two bytes per value, and the
+ * state is reset at every block, so that blocks decode independently.
+ *
+ * File layout: the 8 bytes "NS3COLTR", a uint32_t version, then a
+ * sequence of records, each starting with a type byte:
+ * - 1, flow name: uint32_t id, uint16_t length, name
+ * - 2, series name: uint16_t id, uint16_t length, name
+ * - 3, block: uint32_t records, four uint32_t column sizes, four columns
+ *
+ * Integers are little endian. The script utils/columnar_trace.py loads a
+ * file into numpy arrays.
+ *
+ * TracedValue sources can be connected with ConnectDouble and
+ * ConnectUinteger: each object matching the path is a flow, named after
+ * the path of the object.
+ */
+class ColumnarTraceWriter : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  ColumnarTraceWriter ();
+  virtual ~ColumnarTraceWriter ();
+
+  /**
+   * \brief Open the output file and write the file header
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+
+  /// Write the pending records and close the file
+  void Close (void);
+
+  /**
+   * \brief Declare a flow
+   * \param name the name of the flow
+   * \return the flow identifier
+   */
+  uint32_t AddFlow (std::string name);
+
+  /**
+   * \brief Declare a series, or find a series declared before
+   * \param name the name of the series
+   * \return the series identifier
+   */
+  uint16_t AddSeries (std::string name);
+
+  /**
+   * \brief Add a record, stamped with the current simulation time
+   * \param flow the flow identifier
+   * \param series the series identifier
+   * \param value the value
+   */
+  void Write (uint32_t flow, uint16_t series, double value);
+
+  /**
+   * \brief Add a record
+   * \param time the time of the record
+   * \param flow the flow identifier
+   * \param series the series identifier
+   * \param value the value
+   */
+  void Write (Time time, uint32_t flow, uint16_t series, double value);
+
+  /**
+   * \brief Record every change of the double TracedValue sources matching a path
+   * \param path the Config path of the trace sources
+   * \param series the name of the series
+   */
+  void ConnectDouble (std::string path, std::string series);
+
+  /**
+   * \brief Record every change of the uint32_t TracedValue sources matching a path
+   * \param path the Config path of the trace sources
+   * \param series the name of the series
+   */
+  void ConnectUinteger (std::string path, std::string series);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Find the flow matching a trace context, declaring it if needed
+   * \param context the Config context of the trace source
+   * \return the flow identifier
+   */
+  uint32_t GetFlowFromContext (std::string context);
+
+  /**
+   * \brief Sink of double trace sources
+   * \param writer the writer
+   * \param series the series identifier
+   * \param context the Config context
+   * \param oldValue previous value
+   * \param newValue new value
+   */
+  static void DoubleSink (Ptr<ColumnarTraceWriter> writer, uint16_t series,
+                          std::string context, double oldValue, double newValue);
+
+  /**
+   * \brief Sink of uint32_t trace sources
+   * \param writer the writer
+   * \param series the series identifier
+   * \param context the Config context
+   * \param oldValue previous value
+   * \param newValue new value
+   */
+  static void UintegerSink (Ptr<ColumnarTraceWriter> writer, uint16_t series,
+                            std::string context, uint32_t oldValue, uint32_t newValue);
+
+  /// Write the buffered block, if any
+  void Flush (void);
+
+  std::ofstream m_out;                          //!< Output file
+  uint32_t m_blockSize;                         //!< Records per block
+  uint32_t m_records;                           //!< Records in the current block
+  int64_t m_lastTime;                           //!< Time of the previous record (ns)
+  uint32_t m_lastFlow;                          //!< Flow of the previous record
+  std::vector<uint8_t> m_columns[4];            //!< Time, flow, series and value columns
+  std::map<uint64_t, uint64_t> m_lastValue;     //!< Previous value bits, by flow and series
+  std::map<std::string, uint32_t> m_flows;      //!< Flows, by name
+  std::map<std::string, uint16_t> m_series;     //!< Series, by name
+};
+
+/**
+ * \ingroup stats
+ *
+ * \brief Reader of the files written by ColumnarTraceWriter
+ */
+class ColumnarTraceReader
+{
+public:
+  /// A decoded record
+  struct Record
+  {
+    int64_t time;     //!< Time (ns)
+    uint32_t flow;    //!< Flow identifier
+    uint16_t series;  //!< Series identifier
+    double value;     //!< Value
+  };
+
+  /**
+   * \brief Decode a whole file
+   * \param filename the name of the file
+   * \param records the records, in the order they were written
+   * \param flows the flow names, by identifier
+   * \param series the series names, by identifier
+   * \return false if the file could not be read or is malformed
+   */
+  static bool Read (std::string filename, std::vector<Record> &records,
+                    std::map<uint32_t, std::string> &flows,
+                    std::map<uint16_t, std::string> &series);
+};
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_WRITER_H */
@@ -42,6 +42,7 @@
 #include "int64x64-double.h"
 #include "int64x64.h"
 #include "integer.h"
+#include "ladder-scheduler.h"
 #include "list-scheduler.h"
 #include "log-macros-disabled.h"
 #include "log-macros-enabled.h"
@@ -49,6 +50,7 @@
 #include "make-event.h"
 #include "map-scheduler.h"
 #include "math.h"
+#include "mpsc-queue.h"
 #include "names.h"
 #include "non-copyable.h"
 #include "nstime.h"
@@ -25,11 +25,14 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
+#include "mpsc-queue.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <ostream>
+#include <typeindex>
+#include <unordered_map>
 
 /**
  * \file
@@ -43,6 +46,17 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * With the ProfilePeriod attribute, it also profiles the events it
+ * runs: one event in ProfilePeriod, on average, is timed with the wall
+ * clock, and its time is added to the statistics of its type, the
+ * class of the EventImpl. For the events made by MakeEvent(), as the
+ * Simulator::Schedule functions do, the type names the signature of the
+ * function, or the class and the signature of the method, and the
+ * types of the arguments bound. The gaps between the sampled events are
+ * random, so that the sampling does not follow periodic patterns of the
+ * events. A report, the types sorted by their share of the time, is
+ * printed to std::clog by Destroy(), or with PrintProfile().
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -78,6 +92,13 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * Print the profile of the events, the types sorted by their share of
+   * the time.
+   * \param [in] os The output stream.
+   */
+  void PrintProfile (std::ostream &os) const;
+
 private:
   virtual void DoDispose (void);
 
@@ -85,6 +106,22 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /**
+   * Invoke an event, and time it if it is sampled.
+   * \param [in] event The event.
+   */
+  void InvokeProfiled (EventImpl *event);
+  /**
+   * Set the mean number of events per sampled event, and restart the
+   * profile.
+   * \param [in] period The period, 0 to stop profiling.
+   */
+  void SetProfilePeriod (uint32_t period);
+  /**
+   * Get the mean number of events per sampled event.
+   * \returns The period, 0 if not profiling.
+   */
+  uint32_t GetProfilePeriod (void) const;
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -95,17 +132,8 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
-  /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
-   */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  /** The events scheduled from the other threads, with relative timestamps. */
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -132,6 +160,21 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The statistics of the sampled events of a type. */
+  struct EventProfile
+  {
+    uint64_t samples;  //!< Number of events sampled
+    uint64_t time;     //!< Their wall clock time, in nanoseconds
+  };
+  /** Container type of the statistics, by type of event. */
+  typedef std::unordered_map<std::type_index, struct EventProfile> EventProfiles;
+
+  uint32_t m_profilePeriod;     //!< Mean events per sampled event, 0 if off
+  uint32_t m_profileCountdown;  //!< Number of events until the next sampled one
+  uint64_t m_profileRandom;     //!< State of the generator of the gaps between samples
+  uint64_t m_profileEvents;     //!< Number of events run since profiling started
+  EventProfiles m_profile;      //!< The statistics of the sampled events
 };
 
 } // namespace ns3
@@ -23,6 +23,8 @@
 #include "ip-l4-protocol.h"
 #include "ipv4-address-generator.h"
 #include "ipv4-address-helper.h"
+#include "ipv4-end-point-demux.h"
+#include "ipv4-end-point.h"
 #include "ipv4-global-routing-helper.h"
 #include "ipv4-global-routing.h"
 #include "ipv4-header.h"
@@ -47,6 +49,8 @@
 #include "ipv4.h"
 #include "ipv6-address-generator.h"
 #include "ipv6-address-helper.h"
+#include "ipv6-end-point-demux.h"
+#include "ipv6-end-point.h"
 #include "ipv6-extension-demux.h"
 #include "ipv6-extension-header.h"
 #include "ipv6-extension.h"
@@ -80,13 +84,19 @@
 #include "ripng-helper.h"
 #include "ripng.h"
 #include "rtt-estimator.h"
+#include "tcp-ack-policy.h"
 #include "tcp-bic.h"
 #include "tcp-congestion-ops.h"
+#include "tcp-dcqcn.h"
 #include "tcp-header.h"
 #include "tcp-highspeed.h"
+#include "tcp-hpcc.h"
 #include "tcp-hybla.h"
 #include "tcp-l4-protocol.h"
 #include "tcp-option.h"
+#include "tcp-option-sack-permitted.h"
+#include "tcp-option-sack.h"
+#include "tcp-rate-congestion-ops.h"
 #include "tcp-rx-buffer.h"
 #include "tcp-scalable.h"
 #include "tcp-socket-base.h"
@@ -94,6 +104,7 @@
 #include "tcp-socket.h"
 #include "tcp-timely.h"
 #include "tcp-tx-buffer.h"
+#include "tcp-tx-timestamp-ring.h"
 #include "tcp-vegas.h"
 #include "tcp-veno.h"
 #include "tcp-westwood.h"
@@ -232,8 +232,14 @@ protected:
 private:
   /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
   bool m_randomEcmpRouting;
+  /// Set to true if flows are routed among ECMP by a hash of their 5-tuple
+  bool m_flowEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
+  /// Per-node salt of the flow hash
+  uint32_t m_ecmpSalt;
+  /// True if m_ecmpSalt has been initialized
+  bool m_ecmpSaltSet;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
@@ -262,9 +268,22 @@ private:
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
    * \param oif output interface if any (put 0 otherwise)
+   * \param flowHash hash of the flow, used to select among ECMP if FlowEcmpRouting is set
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0, uint32_t flowHash = 0);
+
+  /**
+   * \brief Hash the 5-tuple of a packet
+   *
+   * The ports are read from the transport header for TCP and UDP. The hash
+   * is salted with the node id.
+   *
+   * \param p the packet, starting with the transport header (can be 0)
+   * \param header the IPv4 header of the packet
+   * \return the hash of the flow
+   */
+  uint32_t GetFlowHash (Ptr<const Packet> p, const Ipv4Header &header);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This is the ladder queue of W. T. Tang, R. S. M. Goh and I. L.-J. Thng
+ * ("Ladder queue: An O(1) priority queue structure for large-scale
+ * discrete event simulation", ACM TOMACS 15(3), 2005), which has an O(1)
+ * amortized cost per event for the event populations of large
+ * simulations, where the cost of the HeapScheduler grows with the
+ * logarithm of the population, mostly in cache misses.
+ *
+ * The events are kept in three tiers, every event of a tier being
+ * earlier than the events of the tiers above:
+ *  - Top, an unsorted vector of the far future events, beyond
+ *    m_topStart. Inserting there is a push_back.
+ *  - The rungs, up to MAX_RUNGS of them, each an array of buckets of
+ *    equal width in time. The first rung is created from Top, with as
+ *    many buckets as events; when a bucket about to be dequeued holds
+ *    more than THRESHOLD events, it is spread over a new rung, finer
+ *    than the one above. The buckets are unsorted vectors too, and are
+ *    dequeued in order.
+ *  - Bottom, a sorted vector of the events of the last dequeued bucket,
+ *    from which RemoveNext takes the events.
+ *
+ * Every event is thus copied a few times, from Top to the rungs and to
+ * Bottom, but only sorted in small batches. The vectors keep their
+ * capacity from one use to the next, so that once the simulation is
+ * running the scheduler seldom allocates memory, and its events are
+ * stored contiguously.
+ *
+ * Bottom is never empty while the scheduler is not: it is refilled
+ * at once, so that PeekNext has nothing to do.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Event list type: a vector of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;                 //!< Timestamp of the first bucket
+    uint64_t width;                 //!< Width of the buckets
+    uint32_t current;               //!< Index of the first bucket not dequeued
+    uint32_t count;                 //!< Events in the rung
+    std::vector<Bucket> buckets;    //!< The buckets
+  };
+
+  /**
+   * \param [in] r A rung.
+   * \param [in] ts A timestamp, not earlier than the current bucket.
+   * \returns The index of the bucket of \p ts in \p r.  The last
+   * bucket also holds the events after the end of the rung.
+   */
+  static uint32_t BucketIndex (const Rung &r, uint64_t ts);
+  /**
+   * Spread events over a new rung, below the others.
+   *
+   * \param [in,out] events The events, left empty.
+   * \param [in] min The earliest timestamp of \p events.
+   * \param [in] max The latest timestamp of \p events.
+   */
+  void NewRung (Bucket &events, uint64_t min, uint64_t max);
+  /**
+   * Insert an event in Bottom, and spread Bottom over a new rung if it
+   * grew too large.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /** Refill the empty Bottom from the rungs or, if none is left, Top. */
+  void Refill (void);
+
+  /** Number of rungs at most. */
+  static const uint32_t MAX_RUNGS = 8;
+  /** Number of events above which a bucket, or Bottom, becomes a rung. */
+  static const uint32_t THRESHOLD = 50;
+
+  Bucket m_top;               //!< Top, the unsorted far future events
+  uint64_t m_topStart;        //!< Timestamp of the first event going to Top
+  uint64_t m_topMin;          //!< Earliest timestamp in Top
+  uint64_t m_topMax;          //!< Latest timestamp in Top
+  std::vector<Rung> m_rungs;  //!< The rungs, the ones past m_nRungs unused
+  uint32_t m_nRungs;          //!< Number of rungs in use
+  Bucket m_bottom;            //!< Bottom, sorted, from m_bottomHead on
+  uint32_t m_bottomHead;      //!< Index of the next event in Bottom
+  Bucket m_scratch;           //!< The bucket being dequeued
+  uint32_t m_size;            //!< Number of events
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -9,5 +9,6 @@
 // Module headers:
 #include "mpi-interface.h"
 #include "mpi-receiver.h"
+#include "multithreaded-simulator-impl.h"
 #include "parallel-communication-interface.h"
 #endif
@@ -0,0 +1,242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator implementation for shared-memory
+ * machines
+ *
+ * The nodes are split into partitions, each with its own event list,
+ * which worker threads of the same process run in parallel. The
+ * partitions advance in time windows: at every window, the threads agree
+ * on the earliest pending event, at time t, and each one runs the events
+ * of its partition before t + LookAhead. The lookahead is the smallest
+ * propagation delay of the point-to-point links between partitions, so
+ * that no packet sent in a window may arrive in the same window; the
+ * events a partition schedules for another one are queued, and handed
+ * over at the barrier that ends the window.
+ *
+ * The events without a node context (the ones scheduled from the main
+ * program with Simulator::Schedule, Simulator::Stop...) belong to no
+ * partition: they run one at a time, on the main thread, while the
+ * workers wait. They may touch every node, but everything they schedule
+ * keeps running serially, so the traffic should be started from
+ * applications (or with Simulator::ScheduleWithContext).
+ *
+ * The nodes go to the partitions by blocks of consecutive identifiers,
+ * unless some of them have a system identifier (the one given to the
+ * distributed simulators), in which case the partition is the system
+ * identifier modulo the number of partitions. All the links between the
+ * partitions must be point-to-point links with a propagation delay;
+ * the nodes must be created before Simulator::Run.
+ *
+ * The simulation is repeatable for a given number of threads, but the
+ * events of different nodes at the same time may run in another order
+ * than with the DefaultSimulatorImpl. The code run by the events must
+ * not share state between the nodes of different partitions: trace
+ * sinks writing to a common file or object, the FlowMonitor and packet
+ * metadata (Packet::EnablePrinting) are not supported, and the
+ * TxRxPointToPoint trace of the links between partitions does not fire.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \brief Whether the events of a node run in the calling thread
+   *
+   * The models whose objects are reached from two nodes, like the
+   * channels, use it to avoid sharing reference counts between threads.
+   *
+   * \param context the node identifier
+   * \returns false if a MultithreadedSimulatorImpl is running and the
+   * node belongs to another partition than the current event, true
+   * otherwise
+   */
+  static bool IsLocal (uint32_t context);
+
+  /**
+   * \returns the number of node partitions of the last Run, 0 before
+   */
+  uint32_t GetPartitions (void) const;
+
+  /**
+   * \returns the lookahead of the last Run
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  /** Wrap an event with its execution context. */
+  struct EventWithContext
+  {
+    uint32_t context;   //!< The event context
+    uint64_t timestamp; //!< Event timestamp, absolute or relative to the receiver
+    EventImpl *event;   //!< The event implementation
+  };
+
+  /** The events of a group of nodes, run by one thread. */
+  struct Partition
+  {
+    uint32_t index;                //!< Index, 0 for the context-less events
+    MultithreadedSimulatorImpl *impl; //!< The simulator
+    Ptr<Scheduler> events;         //!< The event priority queue
+    uint32_t uid;                  //!< Next event unique id
+    uint32_t currentUid;           //!< Unique id of the current event
+    uint64_t currentTs;            //!< Timestamp of the current event
+    uint32_t currentContext;       //!< Execution context of the current event
+    int unscheduledEvents;         //!< Events inserted but not yet run
+    uint64_t next;                 //!< Timestamp of the next event, published at the barrier
+    uint64_t windowEnd;            //!< End of the current time window
+    /** Events scheduled for the other partitions in this window, by partition. */
+    std::vector<std::vector<EventWithContext> > outbox;
+    /** Events scheduled from foreign threads, with relative timestamps. */
+    MpscQueue<EventWithContext> foreign;
+  };
+
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Create the node partitions, map the nodes to them and compute
+   * the lookahead, before a Run
+   */
+  void CreatePartitions (void);
+  /**
+   * \brief Map the nodes created since the last Run to the partitions
+   */
+  void MapNodes (void);
+  /** Compute the lookahead from the links between the partitions. */
+  void CalculateLookAhead (void);
+  /**
+   * \param context an event context
+   * \returns the partition running the events of the context
+   */
+  Partition *GetPartition (uint32_t context) const;
+  /**
+   * \brief Insert an event in a partition
+   * \param p the partition
+   * \param ts absolute timestamp
+   * \param context the event context
+   * \param event the event
+   * \returns the unique id of the event
+   */
+  uint32_t Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * \brief Move the events handed over by the other partitions and by the
+   * foreign threads into a partition
+   * \param p the partition
+   */
+  void Merge (Partition *p);
+  /**
+   * \brief Run the events of a partition, until a time
+   * \param p the partition
+   * \param end the events before this time are run
+   */
+  void ProcessEvents (Partition *p, uint64_t end);
+  /**
+   * \brief The time window loop of a partition
+   * \param p the partition
+   */
+  void Work (Partition *p);
+  /**
+   * \brief Entry point of the worker threads
+   * \param p the partition of the thread
+   */
+  static void WorkThread (Partition *p);
+  /** Wait for all the threads at the end of a step. */
+  void Barrier (void);
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex of the Destroy events. */
+  SystemMutex m_destroyMutex;
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The scheduler factory, for the partitions. */
+  ObjectFactory m_schedulerFactory;
+  /** The partitions, the context-less one first. */
+  std::vector<Partition *> m_partitions;
+  /** The partition of every node, by node identifier. */
+  std::vector<uint32_t> m_nodePartition;
+  /** Whether the main thread runs context-less events alone. */
+  bool m_serial;
+  /** System identifier of the first partition of the current Run. */
+  uint32_t m_systemIdBase;
+
+  uint32_t m_maxThreads;             //!< Maximum number of threads
+  Time m_lookAheadAttribute;         //!< Lookahead set by the user
+  uint64_t m_lookAhead;              //!< Lookahead of the current Run
+
+  std::atomic<uint32_t> m_barrierCount;      //!< Threads arrived at the barrier
+  std::atomic<uint32_t> m_barrierGeneration; //!< Barriers completed
+
+  /** The partition of the calling thread, 0 for a foreign thread. */
+  static thread_local Partition *m_current;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
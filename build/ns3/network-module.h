@@ -26,6 +26,9 @@
 #include "ethernet-header.h"
 #include "ethernet-trailer.h"
 #include "flow-id-tag.h"
+#include "int-telemetry-tag.h"
+#include "tsq-tag.h"
+#include "tso-tag.h"
 #include "generic-phy.h"
 #include "header.h"
 #include "inet-socket-address.h"
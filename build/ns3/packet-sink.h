@@ -21,9 +21,11 @@
 #ifndef PACKET_SINK_H
 #define PACKET_SINK_H
 
+#include <map>
 #include "ns3/application.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
+#include "ns3/nstime.h"
 #include "ns3/traced-callback.h"
 #include "ns3/address.h"
 
@@ -32,6 +34,7 @@ namespace ns3 {
 class Address;
 class Socket;
 class Packet;
+class FlowCompletionStats;
 
 /**
  * \ingroup applications 
@@ -64,6 +67,13 @@ class Packet;
  * as a callback on the receiving socket.  By default, when logging is
  * enabled, it prints out the size of packets and their address.
  * A tracing source to Receive() is also available.
+ *
+ * Each accepted connection is accounted for as a flow, from its
+ * acceptance to the last byte received before the peer closes it. The
+ * flow is then reported by the "FlowCompleted" trace and recorded in the
+ * FlowCompletionStats of the "FlowStats" attribute, if any, which
+ * accounts for the half RTT missed at each end so that the FCT is the
+ * one BulkSendApplication measures at the sender.
  */
 class PacketSink : public Application 
 {
@@ -91,6 +101,17 @@ public:
    * \return list of pointers to accepted sockets
    */
   std::list<Ptr<Socket> > GetAcceptedSockets (void) const;
+
+  /**
+   * TracedCallback signature for completed connections.
+   *
+   * \param [in] from address of the peer
+   * \param [in] bytes bytes received
+   * \param [in] start time the connection was accepted
+   * \param [in] finish time the last byte was received
+   */
+  typedef void (* FlowCompletedTracedCallback)(const Address &from, uint64_t bytes,
+                                               Time start, Time finish);
  
 protected:
   virtual void DoDispose (void);
@@ -121,6 +142,15 @@ private:
    */
   void HandlePeerError (Ptr<Socket> socket);
 
+  /// A connection being received
+  struct Flow
+  {
+    Address from;       //!< Address of the peer
+    Time start;         //!< Acceptance of the connection
+    Time last;          //!< Reception of the last byte
+    uint64_t bytes;     //!< Bytes received
+  };
+
   // In the case of TCP, each socket accept returns a new socket, so the 
   // listening socket is stored separately from the accepted sockets
   Ptr<Socket>     m_socket;       //!< Listening socket
@@ -129,10 +159,15 @@ private:
   Address         m_local;        //!< Local address to bind to
   uint32_t        m_totalRx;      //!< Total bytes received
   TypeId          m_tid;          //!< Protocol TypeId
+  std::map<Ptr<Socket>, Flow> m_flows; //!< Connections not closed yet by their peer
+  Ptr<FlowCompletionStats> m_flowStats; //!< FCT statistics the connections are recorded in
 
   /// Traced Callback: received packets, source address.
   TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
 
+  /// Traced Callback: connections closed by their peer
+  TracedCallback<const Address &, uint64_t, Time, Time> m_flowCompletedTrace;
+
 };
 
 } // namespace ns3
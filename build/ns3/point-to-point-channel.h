@@ -159,6 +159,12 @@ private:
    * net device, receiving net device, transmission time and 
    * packet receipt time.
    *
+   * With a MultithreadedSimulatorImpl, it is fired in the thread of the
+   * transmitting device, also when the receiving device belongs to
+   * another partition. The reference count of that device is then
+   * updated by two threads: the sinks must not keep it, and a run which
+   * must be free of data races leaves the trace source unconnected.
+   *
    * \see class CallBackTraceSource
    * \deprecated The non-const \c Ptr<NetDevice> argument is deprecated
    * and will be changed to \c Ptr<const NetDevice> in a future release.
@@ -194,13 +200,28 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNode (NO_NODE) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    uint32_t                   m_dstNode; //!< Node id of the second NetDevice
   };
 
+  /// Node id of a link whose destination has no node yet
+  static const uint32_t NO_NODE = 0xffffffff;
+
+  /**
+   * \brief Get the node id of the destination of a link
+   *
+   * The id is cached, so that the Node, which may be run by another
+   * thread, is not referenced by every packet.
+   *
+   * \param wire the link
+   * \returns the node id
+   */
+  uint32_t GetDestinationNode (uint32_t wire);
+
   Link    m_link[N_DEVICES]; //!< Link model
 };
 
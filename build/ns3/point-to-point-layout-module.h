@@ -8,6 +8,8 @@
 
 // Module headers:
 #include "point-to-point-dumbbell.h"
+#include "point-to-point-fat-tree.h"
 #include "point-to-point-grid.h"
+#include "point-to-point-leaf-spine.h"
 #include "point-to-point-star.h"
 #endif
@@ -85,6 +85,18 @@ public:
    */
   virtual void AddHeader (void) = 0;
 
+  /**
+   * \brief Mark the packet as having experienced congestion
+   *
+   * Subclasses storing a header with an ECN field set the Congestion
+   * Experienced codepoint, if the sender declared the packet ECN capable.
+   *
+   * \return true if the packet has been marked, false if it cannot be marked
+   *         and has to be dropped instead. The default implementation
+   *         returns false.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
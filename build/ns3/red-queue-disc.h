@@ -106,6 +106,7 @@ public:
   typedef struct
   {   
     uint32_t unforcedDrop;  //!< Early probability drops
+    uint32_t unforcedMark;  //!< Early probability ECN marks, instead of drops
     uint32_t forcedDrop;    //!< Forced drops, qavg > max threshold
     uint32_t qLimDrop;      //!< Drops due to queue limits
   } Stats;
@@ -283,6 +284,7 @@ private:
   bool m_isGentle;          //!< True to increases dropping prob. slowly when ave queue exceeds maxthresh
   bool m_isARED;            //!< True to enable Adaptive RED
   bool m_isAdaptMaxP;       //!< True to adapt m_curMaxP
+  bool m_useEcn;            //!< True to mark ECN capable packets instead of early dropping them
   double m_minTh;           //!< Min avg length threshold (bytes)
   double m_maxTh;           //!< Max avg length threshold (bytes), should be >= 2*minTh
   uint32_t m_queueLimit;    //!< Queue limit in bytes / packets
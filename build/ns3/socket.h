@@ -936,6 +936,14 @@ protected:
   // inherited function, no doc necessary
   virtual void DoDispose (void);
 
+  /**
+   * \brief Bring the socket back to the state of a new one
+   *
+   * Nulls the callbacks, unbinds the socket from its device and forgets
+   * the IP options set, for sockets recycled instead of reconstructed.
+   */
+  void ResetSocket (void);
+
   /**
    * \brief Checks if the socket has a specific IPv4 ToS set
    *
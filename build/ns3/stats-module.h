@@ -10,6 +10,7 @@
 #include "average.h"
 #include "basic-data-calculators.h"
 #include "boolean-probe.h"
+#include "columnar-trace-writer.h"
 #include "data-calculator.h"
 #include "data-collection-object.h"
 #include "data-collector.h"
@@ -23,6 +24,7 @@
 #include "gnuplot.h"
 #include "omnet-data-output.h"
 #include "probe.h"
+#include "quantile-sketch.h"
 #include "sqlite-data-output.h"
 #include "time-data-calculators.h"
 #include "time-probe.h"
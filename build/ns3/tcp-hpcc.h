@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCPHPCC_H
+#define TCPHPCC_H
+
+#include "ns3/tcp-rate-congestion-ops.h"
+#include "ns3/sequence-number.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A rate-based implementation of HPCC
+ *
+ * HPCC drives the sending rate from the in-band telemetry of the most
+ * loaded link of the path. Every ACK echoes the queueing delay and the
+ * transmit utilization of the links traversed (see IntTelemetryTag and the
+ * "LinkRate" attribute of Queue), from which the normalized inflight is
+ *
+ *              U = qDelay / BaseRtt + txUtilization
+ *
+ * Against a reference rate Rc, updated once per RTT:
+ *
+ *              U >= Eta or stage >= MaxStage : R = Rc * Eta / U + RateAI
+ *              otherwise                     : R = Rc + RateAI
+ *
+ * The additive stage counts the RTTs spent below the target; it is reset by
+ * a multiplicative update.
+ *
+ * The switches keep the maximum queueing delay and the maximum utilization
+ * separately, so U may combine two different hops; with a single
+ * bottleneck they are the same link.
+ *
+ * The rate is handled by TcpRateCongestionOps, like Timely's.
+ *
+ * More information: http://dx.doi.org/10.1145/3341302.3342085
+ */
+class TcpHpcc : public TcpRateCongestionOps
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpHpcc (void);
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpHpcc (const TcpHpcc& sock);
+  virtual ~TcpHpcc (void);
+
+  virtual std::string GetName () const;
+
+  /**
+   * \return the capabilities of TcpRateCongestionOps, plus CAP_TELEMETRY
+   */
+  virtual uint32_t GetCapabilities () const;
+
+  /**
+   * \brief Compute the rate from the telemetry echoed by the ACK
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments ACKed
+   * \param rtt last RTT
+   */
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+
+  /**
+   * \brief Start from MaxRate when a connection enters the open state
+   *
+   * \param tcb internal congestion state
+   * \param newState new congestion state to which the TCP is going to switch
+   */
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+private:
+  double m_eta;                      //!< Target utilization
+  uint32_t m_maxStage;               //!< Additive increase stages before a multiplicative update
+  DataRate m_rateAi;                 //!< Additive increase step
+  Time m_baseRtt;                    //!< Base RTT of the network, normalizing the queueing delay
+  double m_refRate;                  //!< Reference rate Rc (bps)
+  uint32_t m_incStage;               //!< Additive increase stages since the last multiplicative update
+  SequenceNumber32 m_lastUpdateSeq;  //!< Sent when Rc was last updated; its ACK closes the RTT
+  TracedValue<double> m_utilization; //!< Normalized inflight U of the last ACK
+};
+
+} // namespace ns3
+
+#endif // TCPHPCC_H
@@ -22,10 +22,13 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <list>
+#include <map>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/sequence-number.h"
+#include "ns3/nstime.h"
 #include "ip-l4-protocol.h"
 
 
@@ -38,6 +41,7 @@ class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
 class TcpSocketBase;
+class TcpCongestionOps;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 
@@ -58,6 +62,21 @@ class Ipv6EndPoint;
  * and SHOULD checksum packets its receives from the socket layer going down
  * the stack, but currently checksumming is disabled.
  *
+ * Socket pool
+ * ---------------------------
+ *
+ * Building a socket initializes the attributes of the socket, its buffers,
+ * its RTT estimator, congestion control and ACK policy. With many short
+ * flows this setup dominates, so when the attribute "SocketPoolSize" is not
+ * zero the sockets are instead copied from prototypes built once (at the
+ * first creation, so attribute defaults changed later are ignored), and the
+ * closed sockets are kept to be recycled (TcpSocketBase::Recycle) by the
+ * following creations. A closed socket is only recycled once nothing but
+ * the pool refers to it, i.e. once the application dropped it, and not
+ * before the simulation time advanced. Trace sinks connected to a socket
+ * stay connected when it is recycled: do not enable the pool when tracing
+ * sockets individually.
+ *
  * \see CreateSocket
  * \see NotifyNewAggregate
  * \see SendPacket
@@ -101,6 +120,12 @@ public:
    */
   Ptr<Socket> CreateSocket (TypeId congestionTypeId);
 
+  /**
+   * \brief Get the number of sockets recycled from the pool
+   * \return the number of sockets created by recycling a closed one
+   */
+  uint64_t GetRecycledSockets (void) const;
+
   /**
    * \brief Allocate an IPv4 Endpoint
    * \return the Endpoint
@@ -278,13 +303,34 @@ protected:
   void NoEndPointsFound (const TcpHeader &incomingHeader, const Address &incomingSAddr,
                          const Address &incomingDAddr);
 
+  /**
+   * \brief Create a socket from the prototypes, recycling a closed one if possible
+   * \param congestionTypeId the congestion control algorithm TypeId
+   * \return the socket
+   */
+  Ptr<TcpSocketBase> CreatePooledSocket (TypeId congestionTypeId);
+
 private:
   Ptr<Node> m_node;                //!< the node this stack is associated with
   Ipv4EndPointDemux *m_endPoints;  //!< A list of IPv4 end points.
   Ipv6EndPointDemux *m_endPoints6; //!< A list of IPv6 end points.
   TypeId m_rttTypeId;              //!< The RTT Estimator TypeId
   TypeId m_congestionTypeId;       //!< The socket TypeId
+  TypeId m_ackPolicyTypeId;        //!< The ACK policy TypeId
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
+
+  /// A closed socket waiting to be recycled
+  struct PooledSocket
+  {
+    Ptr<TcpSocketBase> socket; //!< The socket
+    Time released;             //!< When it was closed
+  };
+
+  uint32_t m_socketPoolSize;                       //!< Closed sockets kept, 0 to disable the pool
+  std::list<PooledSocket> m_socketPool;            //!< Closed sockets, oldest first
+  Ptr<TcpSocketBase> m_socketPrototype;            //!< Pristine socket the pooled ones are copied from
+  std::map<TypeId, Ptr<TcpCongestionOps> > m_congestionPrototypes; //!< Congestion controls forked by type
+  uint64_t m_recycledSockets;                      //!< Sockets recycled from the pool
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 
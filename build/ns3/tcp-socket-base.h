@@ -33,8 +33,11 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-interface.h"
 #include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/int-telemetry-tag.h"
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
+#include "tcp-tx-timestamp-ring.h"
 #include "rtt-estimator.h"
 
 namespace ns3 {
@@ -46,6 +49,7 @@ class Packet;
 class TcpL4Protocol;
 class TcpHeader;
 class TcpCongestionOps;
+class TcpAckPolicy;
 
 /**
  * \ingroup tcp
@@ -164,6 +168,15 @@ public:
   TracedValue<SequenceNumber32> m_highTxMark; //!< Highest seqno ever sent, regardless of ReTx
   TracedValue<SequenceNumber32> m_nextTxSequence; //!< Next seqnum to be sent (SND.NXT), ReTx pushes it back
 
+  // Pacing
+  DataRate               m_pacingRate;      //!< Pacing rate set by the congestion control (0 means no pacing)
+
+  // In-band telemetry
+  uint32_t               m_pathQueuePackets; //!< Max per-hop queue occupancy (packets) echoed by the last ACK
+  uint32_t               m_pathQueueBytes;   //!< Max per-hop queue occupancy (bytes) echoed by the last ACK
+  Time                   m_pathQueueDelay;   //!< Max per-hop queueing delay echoed by the last ACK
+  double                 m_pathUtilization;  //!< Max per-hop link utilization echoed by the last ACK
+
   /**
    * \brief Get cwnd in segments rather than bytes
    *
@@ -226,10 +239,133 @@ public:
  * congestion window, slow start threshold, segment size and the state of the
  * Congestion state machine.
  *
+ * Algorithms that need a different treatment from the socket (e.g. rate-based
+ * ones that own cWnd during recovery) advertise it through
+ * TcpCongestionOps::GetCapabilities. The socket caches the capabilities when
+ * the algorithm is installed or forked, so no per-ACK lookup is needed.
+ *
  * To track the trace inside the TcpSocketState class, a "forward" technique is
  * used, which consists in chaining callbacks from TcpSocketState to TcpSocketBase
  * (see for example cWnd trace source).
  *
+ * Pacing
+ * ---------------------------
+ *
+ * A congestion control can publish a sending rate in TcpSocketState::m_pacingRate.
+ * When the rate is not zero, SendPendingData releases one segment at a time
+ * and waits for the transmission time of that segment at the pacing rate
+ * before sending the next one. The congestion window is still enforced.
+ *
+ * Per-segment RTT samples
+ * ---------------------------
+ *
+ * By default one RTT sample is taken per ACK, from the oldest segment it
+ * covers, and passed to PktsAcked. Algorithms advertising
+ * TcpCongestionOps::CAP_SEGMENT_RTT get instead one sample for every segment
+ * completed by the ACK: the send time of each segment is kept in a
+ * TcpTxTimestampRing and subtracted from the arrival time of the ACK, as a
+ * NIC with hardware timestamps would do. The attribute "AckCoalescing"
+ * selects whether all the segments covered by a delayed or stretch ACK
+ * are sampled, or only the newest one.
+ *
+ * In-band telemetry
+ * ---------------------------
+ *
+ * Algorithms advertising TcpCongestionOps::CAP_TELEMETRY get an
+ * IntTelemetryTag added to every data segment; queues with the
+ * "StampTelemetry" attribute record their occupancy in it. Any socket
+ * receiving such a tag echoes the maximum seen since its last ACK in an
+ * IntTelemetryEchoTag, and the sender stores the echoed values in
+ * TcpSocketState::m_pathQueuePackets and m_pathQueueBytes (and, from
+ * queues which know their link rate, m_pathQueueDelay and
+ * m_pathUtilization) before the ACK is processed. No global state is
+ * involved, so every flow sees the occupancy of its own path.
+ *
+ * ECN
+ * ---------------------------
+ *
+ * Algorithms advertising TcpCongestionOps::CAP_ECN send their data
+ * segments with the ECT(0) codepoint, so that AQMs such as RedQueueDisc
+ * (attribute "UseEcn") can mark them instead of dropping them. A receiver
+ * echoes every Congestion Experienced mark with the ECE flag on its next
+ * ACK, and the sender reports it with TcpCongestionOps::EcnEchoReceived.
+ * There is no CWR handshake: the ECE flags follow the marks, as in DCTCP
+ * and DCQCN.
+ *
+ * SACK and RACK
+ * ---------------------------
+ *
+ * With the attribute "Sack" set on both ends, the SACK-permitted option is
+ * exchanged on the SYNs and the receiver reports the out-of-order blocks of
+ * its TcpRxBuffer in a SACK option (RFC 2018), the most recent first. The
+ * sender keeps a scoreboard of the segments sent in its TcpTxBuffer, and
+ * loss recovery follows RFC 6675: the bytes in flight are the "pipe" of the
+ * scoreboard, and the segments marked lost are retransmitted before any
+ * new data, as the window allows.
+ *
+ * Segments are marked lost by RACK (RFC 8985, attribute "Rack") when a
+ * segment sent at least one reordering window later has been delivered; the
+ * window is a quarter of the minimum RTT. A timer marks the remaining ones
+ * when the window elapses. Without RACK, a segment is lost once
+ * ReTxThreshold segments above it have been SACKed. Tail loss probes and
+ * D-SACK are not implemented; a tail loss is repaired by the RTO, which
+ * marks the whole scoreboard lost.
+ *
+ * TCP Small Queues
+ * ---------------------------
+ *
+ * With the attribute "TsqLimit" set, a socket keeps at most that many bytes
+ * of data in the queues of its host (queue discs and device queues), as
+ * Linux does: every data segment carries a TsqTag, and SendPendingData
+ * stops once the limit is reached, even if the window allows more. The
+ * bytes are given back when the device starts transmitting the segment, or
+ * when a queue drops it, and the socket then resumes sending. The host
+ * queues stay a few segments long, instead of holding a whole window.
+ *
+ * Only PointToPointNetDevice and QueueDisc give the bytes back; the limit
+ * must not be used with other devices. An RTO forgets the bytes still
+ * accounted for, so that a segment which was never given back cannot stall
+ * the socket forever.
+ *
+ * Segmentation offload
+ * ---------------------------
+ *
+ * With the attribute "TsoMaxSize" set, SendPendingData hands down segments
+ * of up to that many bytes, a whole number of MSS, instead of one MSS at a
+ * time, as with TSO/GSO. Each of them carries a TsoTag; the IP layer does
+ * not fragment it, and PointToPointNetDevice and CsmaNetDevice transmit it
+ * for the time its MSS-sized wire frames would take. The receiver gets the
+ * super-segment at once when its last frame arrives, as with GRO, and
+ * acknowledges it immediately, since it holds more than one segment.
+ *
+ * The wire timing is preserved on the first link, but not the interleaving
+ * of frames of different flows on a link, nor per-frame losses and marks:
+ * queues, error models and traces see one packet. Queues counted in
+ * packets hold more bytes. When pacing, a super-segment holds at most one
+ * millisecond at the pacing rate, as in Linux.
+ *
+ * The super-segment is not split after the first link either: every
+ * switch or router receives it whole before forwarding it, so each hop
+ * adds the serialization time of the whole super-segment, not of one
+ * frame, and a packet-counting queue takes it as a single packet. On
+ * multi-hop paths the latency and the queue occupancy grow with
+ * TsoMaxSize; keep it to a few MSS, or disabled, when they matter.
+ *
+ * ACK policy
+ * ---------------------------
+ *
+ * When the receiver acknowledges in-order data is decided by a TcpAckPolicy,
+ * selected with the attribute "AckPolicyType" of TcpL4Protocol: the delayed
+ * ACK of RFC 1122 (TcpDelayedAckPolicy, the default, driven by
+ * "DelAckCount" and "DelAckTimeout"), one ACK per segment
+ * (TcpPerSegmentAckPolicy), or a NIC-like coalescing window
+ * (TcpCoalescingAckPolicy). Out-of-order data, holes being filled, FIN and
+ * the handshake are always acknowledged at once, and so, with the policy
+ * attribute "QuickAckOnCe", is CE-marked data. The "AckedSegments" trace of
+ * the policy gives the segments each ACK covers; together with
+ * "AckCoalescing" it shows how coalescing inflates the RTT samples of
+ * delay-based algorithms.
+ *
  * Fast retransmit
  * ---------------------------
  *
@@ -344,6 +480,16 @@ public:
    */
   Ptr<TcpRxBuffer> GetRxBuffer (void) const;
 
+  /**
+   * \brief Get a pointer to the congestion control algorithm
+   *
+   * Exported as the "CongestionOps" attribute, so that the trace sources of
+   * the algorithm can be reached with a Config path.
+   *
+   * \return a pointer to the congestion control algorithm
+   */
+  Ptr<TcpCongestionOps> GetCongestionControlAlgorithm (void) const;
+
   /**
    * \brief Callback pointer for cWnd trace chaining
    */
@@ -412,6 +558,40 @@ public:
    */
   void SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo);
 
+  /**
+   * \brief Install an ACK policy on this socket
+   *
+   * \param policy the policy to be installed
+   */
+  void SetAckPolicy (Ptr<TcpAckPolicy> policy);
+
+  /**
+   * \brief Get the ACK policy
+   *
+   * Exported as the "AckPolicy" attribute.
+   *
+   * \return a pointer to the ACK policy
+   */
+  Ptr<TcpAckPolicy> GetAckPolicy (void) const;
+
+  /**
+   * \brief Bring a closed socket back to the state of a new one
+   *
+   * Used by the socket pool of TcpL4Protocol: the configuration and the
+   * initial state are copied from the pristine socket proto, as the copy
+   * constructor does, while the socket object, its RTT estimator (when of
+   * the same type) and its attribute-free members are reused. The Socket
+   * callbacks are nulled, and the sinks connected to the trace sources of
+   * the socket are disconnected, so that they do not get the events of an
+   * unrelated connection. The congestion control is the one of proto, if
+   * any.
+   *
+   * The socket must be closed, with no endpoint and no timer pending.
+   *
+   * \param proto a socket as built by CreateSocket, never connected
+   */
+  void Recycle (Ptr<TcpSocketBase> proto);
+
   // Necessary implementations of null functions from ns3::Socket
   virtual enum SocketErrno GetErrno (void) const;    // returns m_errno
   virtual enum SocketType GetSocketType (void) const; // returns socket type
@@ -684,6 +864,18 @@ protected:
    */
   void CancelAllTimers (void);
 
+  /**
+   * \brief Copy the configuration and the initial state of a socket
+   *
+   * Shared by the copy constructor and Recycle: the buffers, the control
+   * block, the congestion control and the ACK policy are copied or forked
+   * from those of sock, and the members holding the state of a connection
+   * are reset.
+   *
+   * \param sock the socket to copy
+   */
+  void CopyState (const TcpSocketBase& sock);
+
   /**
    * \brief Move from CLOSING or FIN_WAIT_2 to TIME_WAIT state
    */
@@ -843,6 +1035,50 @@ protected:
   virtual void UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
                                  bool isRetransmission);
 
+  /**
+   * \brief Pass the timing information of the last ACK to the congestion control
+   *
+   * If the congestion control asked for per-segment RTT samples, all the
+   * samples collected by EstimateRtt are passed in one call to
+   * PktsAckedBatch. Otherwise, PktsAcked is called with the last RTT.
+   *
+   * \param segmentsAcked count of segments ACKed
+   */
+  void CongestionPktsAcked (uint32_t segmentsAcked);
+
+  /**
+   * \brief Add the in-band telemetry tags to an outgoing segment
+   *
+   * Data segments get an empty IntTelemetryTag if the congestion control
+   * asked for telemetry; ACKs get the echo of the tags received since the
+   * last ACK, if any.
+   *
+   * \param p the packet
+   * \param flags the TCP flags of the segment
+   */
+  void AddTelemetryTags (Ptr<Packet> p, uint8_t flags);
+
+  /**
+   * \brief Strip the in-band telemetry tags from an incoming segment
+   *
+   * A telemetry tag is kept to be echoed; an echo updates the path
+   * occupancy in the TcpSocketState.
+   *
+   * \param p the packet
+   */
+  void ProcessTelemetryTags (Ptr<Packet> p);
+
+  /**
+   * \brief Get the ECE flag to add to an outgoing segment
+   *
+   * A Congestion Experienced mark received is echoed once, on the next
+   * segment carrying an ACK.
+   *
+   * \param flags the TCP flags of the segment
+   * \return TcpHeader::ECE if a mark has to be echoed, 0 otherwise
+   */
+  uint8_t EcnEchoFlag (uint8_t flags);
+
   /**
    * \brief Update buffers w.r.t. ACK
    * \param seq the sequence number
@@ -939,6 +1175,76 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \brief Register with TsqTag, forgetting the bytes accounted for so far
+   */
+  void TsqRegister (void);
+
+  /**
+   * \brief Bytes of the socket left the host: resume sending if throttled
+   * \param bytes the bytes released
+   */
+  void TsqRelease (uint32_t bytes);
+
+  /**
+   * \brief Largest segment SendPendingData may hand down at once
+   *
+   * With segmentation offload, a whole number of MSS up to TsoMaxSize; when
+   * pacing, no more than what the pacing rate sends in a millisecond, and
+   * at least two MSS.
+   *
+   * \return the largest segment size
+   */
+  uint32_t GetSendQuantum (void) const;
+
+  /**
+   * \brief Add the SACK-permitted option to the header
+   *
+   * \param header TcpHeader (a SYN) to which add the option to
+   */
+  void AddOptionSackPermitted (TcpHeader& header);
+
+  /**
+   * \brief Add the SACK option to the header
+   *
+   * Report as many blocks of the receive buffer as the option space left
+   * allows, the block holding the last segment received first.
+   *
+   * \param header TcpHeader to which add the option to
+   */
+  void AddOptionSack (TcpHeader& header);
+
+  /**
+   * \brief Process an ACK in SACK mode
+   *
+   * Update the scoreboard from the SACK option, move the congestion
+   * state and detect the losses (RFC 6675).
+   *
+   * \param packet the packet
+   * \param tcpHeader the header of the ACK
+   * \param bytesAcked bytes newly acknowledged by the cumulative ACK
+   * \param segsAcked segments newly acknowledged by the cumulative ACK
+   */
+  void ProcessSackAck (Ptr<Packet> packet, const TcpHeader& tcpHeader,
+                       uint32_t bytesAcked, uint32_t segsAcked);
+
+  /**
+   * \brief Mark the lost segments of the scoreboard, entering recovery if any
+   *
+   * Use RACK when enabled, the duplicate threshold otherwise.
+   */
+  void DetectLosses (void);
+
+  /**
+   * \brief Take the RTT sample and the send time of the last delivered segment
+   */
+  void RackUpdate (void);
+
+  /**
+   * \brief Reordering window elapsed: detect the losses and retransmit
+   */
+  void RackTimeout (void);
+
   /**
    * \brief Performs a safe subtraction between a and b (a-b)
    *
@@ -958,7 +1264,7 @@ protected:
   EventId           m_persistEvent;    //!< Persist event: Send 1 byte to probe for a non-zero Rx window
   EventId           m_timewaitEvent;   //!< TIME_WAIT expiration event: Move this socket to CLOSED state
   uint32_t          m_dupAckCount;     //!< Dupack counter
-  uint32_t          m_delAckCount;     //!< Delayed ACK counter
+  Ptr<TcpAckPolicy> m_ackPolicy;       //!< When to acknowledge the data received
   uint32_t          m_delAckMaxCount;  //!< Number of packet to fire an ACK before delay timeout
   bool              m_noDelay;         //!< Set to true to disable Nagle's algorithm
   uint32_t          m_synCount;        //!< Count of remaining connection retries
@@ -973,6 +1279,9 @@ protected:
   Time              m_persistTimeout;  //!< Time between sending 1-byte probes
   Time              m_cnTimeout;       //!< Timeout for connection retry
   RttHistory_t      m_history;         //!< List of sent packet
+  TcpTxTimestampRing m_txTimestamps;   //!< Per-segment send times (CAP_SEGMENT_RTT)
+  std::vector<TcpRttSample> m_rttSamples; //!< Per-segment RTT samples of the last ACK
+  TcpTxTimestampRing::SampleMode_t m_ackCoalescing; //!< How ACKs covering many segments are sampled
 
   // Connections to other layers of TCP/IP
   Ipv4EndPoint*       m_endPoint;   //!< the IPv4 endpoint
@@ -1015,7 +1324,24 @@ protected:
   bool     m_timestampEnabled;    //!< Timestamp option enabled
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
 
+  bool     m_sackEnabled;         //!< SACK option enabled (RFC 2018)
+  bool     m_rackEnabled;         //!< RACK loss detection (RFC 8985), in SACK mode
+
+  // RACK state
+  Time             m_rackXmitTs;  //!< Send time of the most recently sent segment delivered
+  SequenceNumber32 m_rackEndSeq;  //!< End of that segment
+  Time             m_rackRtt;     //!< RTT of that segment
+  Time             m_rackMinRtt;  //!< Minimum RTT seen, sizing the reordering window
+  EventId          m_rackEvent;   //!< Reordering window timer
+  bool             m_recoveryRetx; //!< First retransmission of the recovery, not held by the window
+
   EventId m_sendPendingDataEvent; //!< micro-delay event to send pending data
+  EventId m_pacingEvent;          //!< Pacing event: next segment can be sent when it expires
+
+  IntTelemetryTag m_telemetryToEcho; //!< Telemetry received since the last ACK sent
+  bool     m_telemetryEchoPending;   //!< m_telemetryToEcho has to be echoed
+  bool     m_ecnEchoPending;         //!< A CE mark has been received and not echoed yet
+  bool     m_ceReceived;             //!< The last segment received carried a CE mark
 
   // Fast Retransmit and Recovery
   SequenceNumber32       m_recover;      //!< Previous highest Tx seqnum for fast recovery
@@ -1023,9 +1349,19 @@ protected:
   bool                   m_limitedTx;    //!< perform limited transmit
   uint32_t               m_retransOut;   //!< Number of retransmission in this window
 
+  // TCP Small Queues
+  uint32_t               m_tsqLimit;     //!< Maximum bytes queued in the host, 0 to disable
+  uint32_t               m_tsqOwner;     //!< TsqTag owner identifier, 0 if not registered
+  TracedValue<uint32_t>  m_tsqBytes;     //!< Bytes queued in the host
+  bool                   m_tsqThrottled; //!< Sending stopped on the limit
+
+  // Segmentation offload
+  uint32_t               m_tsoMaxSize;   //!< Largest super-segment, 0 to disable
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control informations
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
+  uint32_t               m_congCaps;          //!< Cached congestion control capabilities
 
   // Guesses over the other connection end
   bool m_isFirstPartialAck; //!< First partial ACK during RECOVERY
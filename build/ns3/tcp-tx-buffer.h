@@ -21,12 +21,15 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <deque>
 #include <list>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +39,30 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * By default the packets given by the application are kept in a list, and
+ * each segment is cut from it with CreateFragment and AddAtEnd, which is
+ * linear in the number of packets in the buffer.
+ *
+ * With the attribute VirtualPayload set, only the byte range
+ * [HeadSequence, TailSequence) is kept: Add counts the bytes and drops the
+ * packet, and CopyFromSequence creates a zero-filled packet of the right
+ * size. Every operation is then O(1), whatever the amount of data buffered.
+ * The content, the tags and the headers of the packets given by the
+ * application are lost, which suits applications sending dummy data, like
+ * BulkSendApplication.
+ *
+ * When SACK is in use, the buffer also keeps the scoreboard of the data
+ * sent and not acknowledged yet: one record per segment sent, with the time
+ * of its last transmission and whether it has been SACKed, marked lost or
+ * retransmitted. With TCP segmentation offload a record holds a whole
+ * super-segment; it is split when only part of it is retransmitted or
+ * SACKed, so that the flags always apply to all the bytes of a record. The socket reports every transmission with SegmentSent,
+ * the SACK blocks received with UpdateScoreboard, and chooses how the
+ * losses are detected: by duplicate threshold (\RFC{6675}), by the time
+ * based RACK (\RFC{8985}), or all at once on a retransmission timeout.
+ * The bytes in flight (the "pipe") are then the bytes sent, minus the
+ * bytes SACKed and the bytes lost and not retransmitted since.
  */
 class TcpTxBuffer : public Object
 {
@@ -127,7 +154,143 @@ public:
    */
   void DiscardUpTo (const SequenceNumber32& seq);
 
+  /**
+   * \brief Keep only the byte range of the data, not its content
+   *
+   * Can only be changed while the buffer is empty.
+   *
+   * \param virtualPayload true to synthesize the segments
+   */
+  void SetVirtualPayload (bool virtualPayload);
+
+  /**
+   * \returns true if the segments are synthesized from the byte range
+   */
+  bool GetVirtualPayload (void) const;
+
+  // Scoreboard
+
+  /**
+   * \brief Record the transmission of a segment
+   *
+   * New data gets a record; the records covered by a retransmission, split
+   * at its bounds, are no longer lost, and remember they have been
+   * retransmitted.
+   *
+   * \param seq first sequence number of the segment
+   * \param size size of the segment
+   * \param now time of the transmission
+   */
+  void SegmentSent (const SequenceNumber32 &seq, uint32_t size, const Time &now);
+
+  /**
+   * \brief Mark the records covered by SACK blocks
+   * \param list the SACK blocks received
+   * \returns the number of bytes newly SACKed
+   */
+  uint32_t UpdateScoreboard (const TcpOptionSack::SackList &list);
+
+  /**
+   * \brief Mark lost the records with more than (dupThresh - 1) segments
+   *        SACKed above them (\RFC{6675} IsLost)
+   * \param dupThresh the duplicate threshold
+   * \param segmentSize the segment size
+   * \returns the number of bytes newly marked lost
+   */
+  uint32_t MarkLostByDupThresh (uint32_t dupThresh, uint32_t segmentSize);
+
+  /**
+   * \brief Mark lost the records sent before the most recently sent
+   *        delivered segment, and not delivered within a window (RACK)
+   *
+   * \param xmitTs transmission time of the most recently sent segment delivered
+   * \param endSeq end sequence number of that segment
+   * \param window RTT plus reordering window
+   * \param now current time
+   * \param timeout set to the time left before the next record would be
+   *        marked lost, or zero if there is none
+   * \returns the number of bytes newly marked lost
+   */
+  uint32_t MarkLostByRack (const Time &xmitTs, const SequenceNumber32 &endSeq,
+                           const Time &window, const Time &now, Time &timeout);
+
+  /**
+   * \brief Mark lost every record not SACKed, after a retransmission timeout
+   * \returns the number of bytes newly marked lost
+   */
+  uint32_t MarkAllLost (void);
+
+  /**
+   * \brief Get the first segment marked lost and not retransmitted since
+   * \param seq set to its first sequence number
+   * \param size set to its size
+   * \returns false if there is none
+   */
+  bool NextLostSegment (SequenceNumber32 &seq, uint32_t &size) const;
+
+  /**
+   * \brief Get the most recently sent segment delivered, by SACK or cumulative
+   *        ACK, since the last call
+   * \param xmitTs set to the time of its last transmission
+   * \param endSeq set to its end sequence number
+   * \param retrans set to true if it has been retransmitted
+   * \returns false if nothing has been delivered since the last call
+   */
+  bool GetLastDelivered (Time &xmitTs, SequenceNumber32 &endSeq, bool &retrans);
+
+  /**
+   * \returns the bytes sent, not acknowledged and SACKed
+   */
+  uint32_t GetSackedBytes (void) const;
+
+  /**
+   * \returns the bytes marked lost and not retransmitted since
+   */
+  uint32_t GetLostBytes (void) const;
+
+  /**
+   * \returns the bytes in flight according to the scoreboard (\RFC{6675} pipe)
+   */
+  uint32_t BytesInFlight (void) const;
+
 private:
+  /// Scoreboard record of a segment sent and not acknowledged
+  struct SentSegment
+  {
+    SequenceNumber32 seq;   //!< First sequence number
+    uint32_t size;          //!< Size
+    Time lastSent;          //!< Time of the last transmission
+    bool sacked;            //!< Covered by a SACK block
+    bool lost;              //!< Marked lost, and not retransmitted since
+    bool retrans;           //!< Retransmitted at least once
+  };
+
+  /**
+   * \brief Find the first record ending after a sequence number
+   * \param seq the sequence number
+   * \returns the index of the record, or the number of records
+   */
+  uint32_t FindSegment (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Split the record holding a sequence number, so that a record
+   *        starts at it
+   * \param seq the sequence number
+   */
+  void SplitSegment (const SequenceNumber32 &seq);
+
+  /**
+   * \brief Remember a delivered record for GetLastDelivered
+   * \param segment the record
+   */
+  void Delivered (const SentSegment &segment);
+
+  /**
+   * \brief Remove the records acknowledged
+   * \param seq the sequence number acknowledged
+   */
+  void DiscardSentUpTo (const SequenceNumber32& seq);
+
   /// container for data stored in the buffer
   typedef std::list<Ptr<Packet> >::iterator BufIterator;
 
@@ -135,6 +298,15 @@ private:
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
   std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  bool m_virtualPayload;                        //!< Keep only the byte range, not the data
+
+  std::deque<SentSegment> m_sent;               //!< Scoreboard, in sequence order
+  uint32_t m_sackedBytes;                       //!< Bytes SACKed
+  uint32_t m_lostBytes;                         //!< Bytes lost, not retransmitted since
+  bool m_delivered;                             //!< Some data delivered since GetLastDelivered
+  Time m_deliveredXmitTs;                       //!< Last transmission of the most recent segment delivered
+  SequenceNumber32 m_deliveredEndSeq;           //!< End of the most recent segment delivered
+  bool m_deliveredRetrans;                      //!< The most recent segment delivered was retransmitted
 };
 
 } // namepsace ns3
@@ -93,6 +93,17 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Remove all the Callbacks from the chain, e.g. when the object
+   * holding the trace source is reused for something else.
+   */
+  void DisconnectAll (void);
+  /**
+   * Check whether the chain of Callbacks is empty.
+   *
+   * \return \c true if no Callback is connected.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -319,6 +330,24 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectAll (void)
+{
+  m_callbackList.clear ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_callbackList.empty ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
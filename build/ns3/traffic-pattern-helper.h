@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRAFFIC_PATTERN_HELPER_H
+#define TRAFFIC_PATTERN_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup bulksend
+ * \brief A helper to install the classic datacenter traffic patterns
+ * (incast, all-to-all, permutation) made of BulkSendApplication flows
+ * between the hosts of a fabric.
+ *
+ * Every receiving host gets a single PacketSink listening on the
+ * configured port, which accepts all the flows directed to it; the sinks
+ * are created on demand and can be retrieved with GetSinks. The remote
+ * address of a flow is the first address of the first non-loopback
+ * interface of the receiver, which is the host address in the fabric
+ * helpers of the point-to-point-layout module.
+ *
+ * InstallWorkload installs instead a WorkloadApplication on every host,
+ * opening flows of random sizes to random other hosts.
+ */
+class TrafficPatternHelper
+{
+public:
+  /**
+   * Create a TrafficPatternHelper
+   *
+   * \param protocol the socket factory type used by senders and sinks,
+   *        e.g. ns3::TcpSocketFactory
+   * \param port the port the sinks listen on
+   */
+  TrafficPatternHelper (std::string protocol, uint16_t port);
+
+  /**
+   * Helper function used to set the attributes of the BulkSendApplication
+   * senders, _not_ the socket attributes.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Helper function used to set the attributes of the WorkloadApplication
+   * generators, _not_ the socket attributes.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetWorkloadAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install one flow from every sender to the receiver
+   *
+   * \param senders the hosts sending at the same time
+   * \param receiver the host all flows converge on
+   * \returns the senders installed
+   */
+  ApplicationContainer InstallIncast (NodeContainer senders, Ptr<Node> receiver);
+
+  /**
+   * Install one flow between every ordered pair of distinct hosts
+   *
+   * \param hosts the hosts exchanging traffic
+   * \returns the senders installed
+   */
+  ApplicationContainer InstallAllToAll (NodeContainer hosts);
+
+  /**
+   * Install one flow from every host to another host, chosen with a
+   * random permutation without fixed points: each host sends exactly one
+   * flow and receives exactly one flow.
+   *
+   * \param hosts the hosts exchanging traffic (at least two)
+   * \returns the senders installed
+   */
+  ApplicationContainer InstallPermutation (NodeContainer hosts);
+
+  /**
+   * Install on every host a WorkloadApplication sending flows, at Poisson
+   * arrivals, to all the other hosts.
+   *
+   * \param hosts the hosts exchanging traffic (at least two)
+   * \returns the generators installed
+   */
+  ApplicationContainer InstallWorkload (NodeContainer hosts);
+
+  /**
+   * \returns the sinks installed so far, one per receiving host
+   */
+  ApplicationContainer GetSinks (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this helper: the first stream to the one drawing the
+   * permutations, the following ones to the WorkloadApplications installed
+   * so far, in the order they were installed. Call it after InstallWorkload;
+   * the permutations drawn before use the stream only from the next one.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  /**
+   * Install a flow from src to dst, creating the sink on dst if needed
+   *
+   * \param src the sending node
+   * \param dst the receiving node
+   * \returns the sender application
+   */
+  Ptr<Application> InstallFlow (Ptr<Node> src, Ptr<Node> dst);
+
+  /**
+   * Create the sink on dst if needed
+   *
+   * \param dst the receiving node
+   * \returns the address of the sink
+   */
+  Address InstallSink (Ptr<Node> dst);
+
+  ObjectFactory m_factory;                  //!< Sender factory
+  ObjectFactory m_workloadFactory;          //!< Workload generator factory
+  std::string m_protocol;                   //!< Socket factory type name
+  uint16_t m_port;                          //!< Sink port
+  std::map<uint32_t, Ptr<Application> > m_sinks; //!< Sinks, by node id
+  Ptr<UniformRandomVariable> m_rng;         //!< Draws the permutations
+  ApplicationContainer m_workloads;         //!< Workload generators installed
+};
+
+} // namespace ns3
+
+#endif /* TRAFFIC_PATTERN_HELPER_H */
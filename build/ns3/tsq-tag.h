@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TSQ_TAG_H
+#define TSQ_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Bytes of a socket queued below the transport (TCP Small Queues)
+ *
+ * A socket limiting the data it keeps in the queues of its host registers
+ * a release callback, then tags every packet it sends with its owner
+ * identifier and the number of bytes accounted for. When the packet leaves
+ * the host, because the device starts transmitting it or because a queue
+ * drops it, the device or the queue disc calls Release: the tag is removed,
+ * so that the next hops do not release it again, and the bytes are given
+ * back to the owner, which can send more.
+ *
+ * PointToPointNetDevice and QueueDisc release the packets; other devices
+ * do not, and must not be used with a limit.
+ */
+class TsqTag : public Tag
+{
+public:
+  /// Callback invoked with the bytes released
+  typedef Callback<void, uint32_t> ReleaseCallback;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  TsqTag ();
+
+  /**
+   * \brief Constructor
+   * \param owner the owner identifier, as returned by Register
+   * \param bytes the bytes accounted for by the owner
+   */
+  TsqTag (uint32_t owner, uint32_t bytes);
+
+  /**
+   * \return the owner identifier
+   */
+  uint32_t GetOwner (void) const;
+
+  /**
+   * \return the bytes accounted for by the owner
+   */
+  uint32_t GetBytes (void) const;
+
+  /**
+   * \brief Register an owner
+   * \param cb the callback invoked when bytes of the owner are released
+   * \return the owner identifier, never 0
+   */
+  static uint32_t Register (ReleaseCallback cb);
+
+  /**
+   * \brief Unregister an owner; its packets still queued are then ignored
+   * \param owner the owner identifier
+   */
+  static void Unregister (uint32_t owner);
+
+  /**
+   * \brief Release the bytes of a packet leaving the host
+   *
+   * Packets without a TsqTag are untouched.
+   *
+   * \param p the packet
+   */
+  static void Release (Ptr<Packet> p);
+
+private:
+  uint32_t m_owner; //!< Owner identifier
+  uint32_t m_bytes; //!< Bytes accounted for by the owner
+};
+
+} // namespace ns3
+
+#endif /* TSQ_TAG_H */
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Datacenter fabric example: a k-ary fat-tree or a leaf-spine fabric of
+// point-to-point links, routed with per-flow ECMP, loaded with an incast,
+// all-to-all or permutation pattern of bulk TCP flows, or with an open-loop
+// workload of flows drawn from a flow size CDF at Poisson arrivals.
+//
+// The rate-based datacenter algorithms can be compared on the same fabric:
+// Timely (RTT), Dcqcn (ECN marks of RED queue discs on the switches) and
+// Hpcc (in-band telemetry stamped by the switch queues).
+//
+// ./waf --run "fabric --topology=fattree --k=8 --pattern=permutation --cc=Timely"
+// ./waf --run "fabric --topology=leafspine --pattern=incast --cc=Dcqcn"
+// ./waf --run "fabric --pattern=workload --cdf=examples/tcp/websearch-cdf.txt --load=0.5 --cc=Timely"
+// ./waf --run "fabric --topology=fattree --k=16 --pattern=workload --threads=0"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("FabricExample");
+
+int
+main (int argc, char *argv[])
+{
+  std::string topology = "fattree";
+  std::string pattern = "permutation";
+  std::string cc = "";
+  uint32_t k = 4;
+  double oversub = 1.0;
+  uint32_t leaves = 4, spines = 2, hostsPerLeaf = 8;
+  std::string hostBw = "10Gbps", fabricBw = "40Gbps";
+  std::string pd = "1us";
+  uint32_t queueSize = 1000;
+  uint32_t maxBytes = 1000000;
+  uint32_t incastDegree = 16;
+  double simTime = 1.0;
+  bool useOracle = false;
+  uint32_t deviceQueueSize = 10;
+  double redMinTh = 20, redMaxTh = 80;
+  std::string baseRtt = "20us";
+  std::string timelyUpdate = "PerRtt";
+  bool virtualPayload = true;
+  bool sack = false;
+  uint32_t tsqLimit = 4 * 1448;
+  uint32_t tsoMaxSize = 0;
+  std::string ackPolicy = "Delayed";
+  std::string cdf = "examples/tcp/websearch-cdf.txt";
+  double sizeScale = 1;
+  double load = 0.5;
+  uint32_t maxFlows = 0;
+  uint32_t threads = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("topology", "Fabric to build: fattree, leafspine", topology);
+  cmd.AddValue ("pattern", "Traffic pattern: incast, alltoall, permutation, workload", pattern);
+  cmd.AddValue ("cc", "Congestion control protocol to use", cc);
+  cmd.AddValue ("k", "Fat-tree switch radix", k);
+  cmd.AddValue ("oversub", "Fat-tree edge oversubscription", oversub);
+  cmd.AddValue ("leaves", "Leaf-spine: number of leaves", leaves);
+  cmd.AddValue ("spines", "Leaf-spine: number of spines", spines);
+  cmd.AddValue ("hostsPerLeaf", "Leaf-spine: hosts under each leaf", hostsPerLeaf);
+  cmd.AddValue ("hostBw", "Bandwidth of host links, with units", hostBw);
+  cmd.AddValue ("fabricBw", "Bandwidth of switch links, with units", fabricBw);
+  cmd.AddValue ("pd", "Propagation delay of links, with units", pd);
+  cmd.AddValue ("queueSize", "Size of the buffer queue, in packets", queueSize);
+  cmd.AddValue ("maxBytes", "Bytes sent by each flow (0 for unlimited)", maxBytes);
+  cmd.AddValue ("incastDegree", "Number of senders of the incast", incastDegree);
+  cmd.AddValue ("simTime", "Simulated time, in seconds", simTime);
+  cmd.AddValue ("oracle", "Use the queue occupancy echoed by in-band telemetry for cc", useOracle);
+  cmd.AddValue ("deviceQueueSize", "Dcqcn: size of the device queues behind RED, in packets", deviceQueueSize);
+  cmd.AddValue ("redMinTh", "Dcqcn: RED marking threshold, in packets", redMinTh);
+  cmd.AddValue ("redMaxTh", "Dcqcn: RED full marking threshold, in packets", redMaxTh);
+  cmd.AddValue ("baseRtt", "Hpcc and FCT slowdowns: base RTT of the fabric, with units", baseRtt);
+  cmd.AddValue ("timelyUpdate", "Timely: rate update gating, PerAck, PerRtt or PerBytes", timelyUpdate);
+  cmd.AddValue ("virtualPayload", "Keep only the byte ranges of the data in the TCP send buffers", virtualPayload);
+  cmd.AddValue ("sack", "Use SACK and RACK loss recovery", sack);
+  cmd.AddValue ("tsqLimit", "Bytes of each flow queued in its host (0 for unlimited)", tsqLimit);
+  cmd.AddValue ("tsoMaxSize", "Largest TCP super-segment, segmented by the devices (0 to disable); "
+                "the switches forward it whole, adding its serialization time at each hop", tsoMaxSize);
+  cmd.AddValue ("ackPolicy", "Receiver ACK policy: Delayed, PerSegment or Coalescing", ackPolicy);
+  cmd.AddValue ("cdf", "Workload: flow size CDF file", cdf);
+  cmd.AddValue ("sizeScale", "Workload: multiplier of the sizes of the CDF file", sizeScale);
+  cmd.AddValue ("load", "Workload: load of the host links", load);
+  cmd.AddValue ("maxFlows", "Workload: flows started by each host (0 for no limit)", maxFlows);
+  cmd.AddValue ("threads", "Threads of the multithreaded simulator (1 for the default one, 0 for one per core)", threads);
+  cmd.Parse (argc, argv);
+
+  if (threads != 1)
+    {
+      // The nodes are split among the threads, which synchronize every
+      // link propagation delay
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::MultithreadedSimulatorImpl"));
+      Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (threads));
+    }
+
+  Time::SetResolution (Time::NS);
+  Config::SetDefault ("ns3::Queue::MaxPackets", UintegerValue (queueSize));
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::FlowEcmpRouting", BooleanValue (true));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpTxBuffer::VirtualPayload", BooleanValue (virtualPayload));
+  Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (sack));
+  Config::SetDefault ("ns3::TcpSocketBase::TsqLimit", UintegerValue (tsqLimit));
+  Config::SetDefault ("ns3::TcpSocketBase::TsoMaxSize", UintegerValue (tsoMaxSize));
+  Config::SetDefault ("ns3::TcpL4Protocol::AckPolicyType",
+                      TypeIdValue (TypeId::LookupByName ("ns3::Tcp" + ackPolicy + "AckPolicy")));
+
+  bool rateBased = cc.compare ("Timely") == 0 || cc.compare ("Dcqcn") == 0
+    || cc.compare ("Hpcc") == 0;
+  if (rateBased)
+    {
+      Config::SetDefault ("ns3::TcpRateCongestionOps::MaxRate", DataRateValue (DataRate (hostBw)));
+      Config::SetDefault ("ns3::TcpOptionTS::UseNS", BooleanValue (true));
+      Config::SetDefault ("ns3::TcpSocketBase::ClockGranularity", TimeValue (Time ("1ns")));
+    }
+
+  if (cc.compare ("Timely") == 0)
+    {
+      Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpTimely::GetTypeId ()));
+      Config::SetDefault ("ns3::TcpTimely::UseOracle", BooleanValue (useOracle));
+      Config::SetDefault ("ns3::TcpTimely::UpdateMode", StringValue (timelyUpdate));
+      Config::SetDefault ("ns3::Queue::StampTelemetry", BooleanValue (useOracle));
+    }
+  else if (cc.compare ("Dcqcn") == 0)
+    {
+      Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpDcqcn::GetTypeId ()));
+      // Mark on the instantaneous queue, as datacenter switches do
+      Config::SetDefault ("ns3::RedQueueDisc::UseEcn", BooleanValue (true));
+      Config::SetDefault ("ns3::RedQueueDisc::QW", DoubleValue (1));
+      Config::SetDefault ("ns3::RedQueueDisc::MinTh", DoubleValue (redMinTh));
+      Config::SetDefault ("ns3::RedQueueDisc::MaxTh", DoubleValue (redMaxTh));
+      Config::SetDefault ("ns3::RedQueueDisc::QueueLimit", UintegerValue (queueSize));
+    }
+  else if (cc.compare ("Hpcc") == 0)
+    {
+      Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpHpcc::GetTypeId ()));
+      Config::SetDefault ("ns3::TcpHpcc::BaseRtt", TimeValue (Time (baseRtt)));
+      Config::SetDefault ("ns3::Queue::StampTelemetry", BooleanValue (true));
+    }
+  else if (cc.compare ("NewReno") == 0)
+    {
+      Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+    }
+  else if (cc.compare ("Vegas") == 0)
+    {
+      Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpVegas::GetTypeId ()));
+    }
+
+  PointToPointHelper hostLink;
+  hostLink.SetDeviceAttribute ("DataRate", StringValue (hostBw));
+  hostLink.SetChannelAttribute ("Delay", StringValue (pd));
+  PointToPointHelper fabricLink;
+  fabricLink.SetDeviceAttribute ("DataRate", StringValue (fabricBw));
+  fabricLink.SetChannelAttribute ("Delay", StringValue (pd));
+  if (cc.compare ("Dcqcn") == 0)
+    {
+      // Short device queues, so that the backlog builds up in RED
+      hostLink.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (deviceQueueSize));
+      fabricLink.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (deviceQueueSize));
+    }
+
+  InternetStackHelper stack;
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  NodeContainer hosts;
+
+  NS_LOG_INFO ("Build " << topology << " fabric.");
+  PointToPointFatTreeHelper *fatTree = 0;
+  PointToPointLeafSpineHelper *leafSpine = 0;
+  if (topology.compare ("leafspine") == 0)
+    {
+      leafSpine = new PointToPointLeafSpineHelper (leaves, spines, hostsPerLeaf,
+                                                   hostLink, fabricLink);
+      leafSpine->InstallStack (stack);
+      leafSpine->AssignIpv4Addresses (address);
+      hosts = leafSpine->GetHosts ();
+    }
+  else
+    {
+      fatTree = new PointToPointFatTreeHelper (k, hostLink, fabricLink, oversub);
+      fatTree->InstallStack (stack);
+      fatTree->AssignIpv4Addresses (address);
+      hosts = fatTree->GetHosts ();
+    }
+  NS_LOG_INFO (hosts.GetN () << " hosts.");
+
+  if (cc.compare ("Dcqcn") == 0)
+    {
+      NS_LOG_INFO ("Install ECN marking RED queue discs on the switches.");
+      NodeContainer switches = fatTree ? fatTree->GetSwitches () : leafSpine->GetSwitches ();
+      NetDeviceContainer switchDevices;
+      for (uint32_t i = 0; i < switches.GetN (); ++i)
+        {
+          // Device 0 is the loopback
+          for (uint32_t d = 1; d < switches.Get (i)->GetNDevices (); ++d)
+            {
+              switchDevices.Add (switches.Get (i)->GetDevice (d));
+            }
+        }
+      TrafficControlHelper red;
+      red.SetRootQueueDisc ("ns3::RedQueueDisc");
+      red.Uninstall (switchDevices);
+      red.Install (switchDevices);
+    }
+
+  NS_LOG_INFO ("Populate routing tables.");
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  NS_LOG_INFO ("Create " << pattern << " traffic.");
+  TrafficPatternHelper traffic ("ns3::TcpSocketFactory", 50000);
+  traffic.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
+  Ptr<FlowCompletionStats> fct = CreateObjectWithAttributes<FlowCompletionStats> (
+      "LineRate", DataRateValue (DataRate (hostBw)),
+      "BaseRtt", TimeValue (Time (baseRtt)));
+  traffic.SetAttribute ("FlowStats", PointerValue (fct));
+  traffic.SetWorkloadAttribute ("FlowSizeCdfFile", StringValue (cdf));
+  traffic.SetWorkloadAttribute ("SizeScale", DoubleValue (sizeScale));
+  traffic.SetWorkloadAttribute ("Load", DoubleValue (load));
+  traffic.SetWorkloadAttribute ("LineRate", DataRateValue (DataRate (hostBw)));
+  traffic.SetWorkloadAttribute ("MaxFlows", UintegerValue (maxFlows));
+  traffic.SetWorkloadAttribute ("FlowStats", PointerValue (fct));
+
+  ApplicationContainer senders;
+  if (pattern.compare ("incast") == 0)
+    {
+      NodeContainer incastSenders;
+      for (uint32_t i = 1; i <= incastDegree && i < hosts.GetN (); ++i)
+        {
+          incastSenders.Add (hosts.Get (i));
+        }
+      senders = traffic.InstallIncast (incastSenders, hosts.Get (0));
+    }
+  else if (pattern.compare ("workload") == 0)
+    {
+      senders = traffic.InstallWorkload (hosts);
+    }
+  else if (pattern.compare ("alltoall") == 0)
+    {
+      senders = traffic.InstallAllToAll (hosts);
+    }
+  else
+    {
+      // The permutation is drawn at once, from the first stream
+      traffic.AssignStreams (1);
+      senders = traffic.InstallPermutation (hosts);
+    }
+  // The workload generators draw their flows from the following streams
+  traffic.AssignStreams (1);
+
+  ApplicationContainer sinks = traffic.GetSinks ();
+  sinks.Start (Seconds (0.0));
+  senders.Start (Seconds (0.1));
+  senders.Stop (Seconds (simTime));
+
+  NS_LOG_INFO ("Run Simulation.");
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+  uint64_t totalRx = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); ++i)
+    {
+      totalRx += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  uint32_t flows = senders.GetN ();
+  if (pattern.compare ("workload") == 0)
+    {
+      flows = 0;
+      for (uint32_t i = 0; i < senders.GetN (); ++i)
+        {
+          flows += DynamicCast<WorkloadApplication> (senders.Get (i))->GetFlowsStarted ();
+        }
+    }
+  std::cout << flows << " flows, " << totalRx << " bytes received, "
+            << totalRx * 8 / ((simTime - 0.1) * 1e9) << " Gbit/s aggregate" << std::endl;
+  if (maxBytes > 0 || pattern.compare ("workload") == 0)
+    {
+      fct->Print (std::cout);
+    }
+
+  Simulator::Destroy ();
+  delete fatTree;
+  delete leafSpine;
+  return 0;
+}
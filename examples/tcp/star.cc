@@ -22,29 +22,48 @@
 #include "ns3/applications-module.h"
 #include "ns3/bridge-module.h"
 #include "ns3/csma-module.h"
-#include "ns3/internet-module.h"
-#include <vector>
+#include "ns3/quantile-sketch.h"
+#include "ns3/columnar-trace-writer.h"
+#include <map>
 using namespace ns3;
-uint32_t qsize = 0;
 bool printRTT = false;
 bool printQueue = false;
 
-std::vector<int64_t> rtt_records;
+// Constant-memory RTT distributions, in microseconds
+QuantileSketch rtt_aggregate;
+std::map<uint32_t, QuantileSketch> rtt_per_flow;
 void queue_callback(uint32_t oldValue, uint32_t newValue) {
    if (printQueue) {
      std::cout << "Packets in queue:" << newValue << ":at time:" << ns3::Simulator::Now().GetMicroSeconds() << std::endl; 
    }
-   qsize = newValue;
 }
 
-void trace_rtt(int64_t rtt) {
+void trace_rtt(uint32_t flow, int64_t rtt) {
   if (printRTT) {
    std::cout << "RTT:" << rtt << ":at time:" << ns3::Simulator::Now().GetMicroSeconds() << std::endl; 
   }
-   rtt_records.push_back(rtt);
-} 
+   rtt_aggregate.Update(rtt);
+   rtt_per_flow[flow].Update(rtt);
+}
+
+void print_percentiles(std::ostream &os, const QuantileSketch &sketch) {
+  os << "samples " << sketch.Count()
+     << " p50 " << sketch.Quantile(0.5)
+     << " p95 " << sketch.Quantile(0.95)
+     << " p99 " << sketch.Quantile(0.99)
+     << " p99.9 " << sketch.Quantile(0.999) << " us" << std::endl;
+}
 
-uint32_t getQSize() { return qsize; }
+// The sockets, and their congestion control, only exist once the
+// applications have started
+void trace_timely_state(Ptr<ColumnarTraceWriter> writer) {
+  std::string path = "/NodeList/*/$ns3::TcpL4Protocol/SocketList/*/CongestionOps/$ns3::TcpTimely/";
+  writer->ConnectDouble(path + "Rate", "Rate");
+  writer->ConnectDouble(path + "RttDiff", "RttDiff");
+  writer->ConnectDouble(path + "NormalizedGradient", "NormalizedGradient");
+  writer->ConnectUinteger(path + "CompletionEvents", "CompletionEvents");
+  writer->ConnectUinteger(path + "HaiEntries", "HaiEntries");
+}
 
 NS_LOG_COMPONENT_DEFINE ("CsmaBridgeExample");
 
@@ -63,10 +82,12 @@ main (int argc, char *argv[])
   std::string socketType;
   std::string cc = "";
   uint32_t queueSize = 500000;
-  double emwa = 0.1, addstep = 4.0, beta = 0.01, thigh = 500, tlow = 50;
+  double emwa = 0.1, addstep = 10.0, beta = 0.01, thigh = 500, tlow = 50;
   std::string bw = "50Mbps";
   std::string pd = "10us";
   bool useOracle = false, traceRTT = true;
+  std::string stateTrace = "";
+  std::string timelyUpdate = "PerAck";
   CommandLine cmd;
   cmd.AddValue ("transportProt", "Transport protocol to use: Tcp, Udp", transportProt);
   cmd.AddValue ("cc", "Congestion control protocol to use", cc);
@@ -74,14 +95,16 @@ main (int argc, char *argv[])
   cmd.AddValue("bw", "Bandwidth of links, with units", bw);
   cmd.AddValue("pd", "Propogation Delay of links, with units", pd);
   cmd.AddValue("emwa", "Timely EMWA weight", emwa);
-  cmd.AddValue("addstep", "Timely Additive Increase", addstep);
+  cmd.AddValue("addstep", "Timely Additive Increase (Mbps)", addstep);
   cmd.AddValue("beta", "Timely Multiplicative Decrease", beta);
   cmd.AddValue("thigh", "RTT High threshold", thigh);
   cmd.AddValue("tlow", "RTT Low threshold", tlow);
-  cmd.AddValue("oracle", "Use queue occupancy for cc", useOracle);
+  cmd.AddValue("timelyUpdate", "Timely rate update gating: PerAck, PerRtt, PerBytes", timelyUpdate);
+  cmd.AddValue("oracle", "Use the queue occupancy echoed by in-band telemetry for cc", useOracle);
   cmd.AddValue("trace-rtt", "Trace RTT", traceRTT);
   cmd.AddValue("printRTT", "Print RTT", printRTT);
   cmd.AddValue("printQueue", "Print Queue Occupancy", printQueue);
+  cmd.AddValue("stateTrace", "File receiving the Timely state of every flow (binary, see utils/columnar_trace.py)", stateTrace);
   cmd.Parse (argc, argv);
   
   Config::SetDefault ("ns3::Queue::MaxPackets", UintegerValue(queueSize));
@@ -91,12 +114,14 @@ main (int argc, char *argv[])
   if (cc.compare ("Timely") == 0) {
     Config::SetDefault("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpTimely::GetTypeId ()));
     Config::SetDefault("ns3::TcpTimely::UseOracle", BooleanValue(useOracle));
-    Config::SetDefault("ns3::TcpTimely::QSizeCallback", CallbackValue(MakeCallback(&getQSize)));
+    Config::SetDefault("ns3::Queue::StampTelemetry", BooleanValue(useOracle));
     Config::SetDefault("ns3::TcpTimely::EMWA", DoubleValue(emwa));
     Config::SetDefault("ns3::TcpTimely::Addstep", DoubleValue(addstep));
     Config::SetDefault("ns3::TcpTimely::Beta", DoubleValue(beta));
     Config::SetDefault("ns3::TcpTimely::THigh", DoubleValue(thigh));
     Config::SetDefault("ns3::TcpTimely::TLow", DoubleValue(tlow));
+    Config::SetDefault("ns3::TcpTimely::UpdateMode", StringValue(timelyUpdate));
+    Config::SetDefault("ns3::TcpRateCongestionOps::MaxRate", DataRateValue(DataRate(bw)));
     Config::SetDefault("ns3::TcpOptionTS::UseNS", BooleanValue(true));
     Config::SetDefault("ns3::TcpSocketBase::ClockGranularity", TimeValue(Time("1ns")));
  
@@ -120,7 +145,7 @@ main (int argc, char *argv[])
   }
   
   if (traceRTT) {
-    Config::SetDefault("ns3::TcpCongestionOps::TraceRTTCallback", CallbackValue(MakeCallback(&trace_rtt)));
+    Config::SetDefault("ns3::TcpCongestionOps::TraceFlowRTTCallback", CallbackValue(MakeCallback(&trace_rtt)));
   }
 
   // Allow the user to override any of the defaults and the above Bind() at
@@ -234,12 +259,24 @@ main (int argc, char *argv[])
   //
   csma.EnablePcapAll ("csma-bridge", false);
 
+  // Before scheduling: the events already scheduled are not rescaled
+  Time::SetResolution(Time::FS);
+
+  Ptr<ColumnarTraceWriter> stateWriter;
+  if (!stateTrace.empty() && cc.compare ("Timely") == 0) {
+    stateWriter = CreateObject<ColumnarTraceWriter> ();
+    stateWriter->Open(stateTrace);
+    Simulator::Schedule(Seconds (1.1) + NanoSeconds (1), &trace_timely_state, stateWriter);
+  }
+
   //
   // Now, do the actual simulation.
   //
   NS_LOG_INFO ("Run Simulation.");
-  Time::SetResolution(Time::FS);
   Simulator::Run ();
+  if (stateWriter) {
+    stateWriter->Close();
+  }
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
   
@@ -250,9 +287,12 @@ main (int argc, char *argv[])
   std::stringstream ss;
   ss << "Average throughput: " << thr << " Mbit/s" << std::endl;
   if (traceRTT) {
-    ss << "95th percentile RTT: ";
-    std::sort(rtt_records.begin(), rtt_records.end());
-    ss << rtt_records.at((int)(rtt_records.size() * 0.95)) << std::endl;
+    ss << "RTT: ";
+    print_percentiles(ss, rtt_aggregate);
+    for (std::map<uint32_t, QuantileSketch>::const_iterator it = rtt_per_flow.begin(); it != rtt_per_flow.end(); ++it) {
+      ss << "RTT of flow " << it->first << ": ";
+      print_percentiles(ss, it->second);
+    }
   }
   NS_LOG_INFO(ss.str().c_str());
 }
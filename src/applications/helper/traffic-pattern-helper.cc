@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <vector>
+#include "traffic-pattern-helper.h"
+#include "ns3/workload-application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TrafficPatternHelper");
+
+TrafficPatternHelper::TrafficPatternHelper (std::string protocol, uint16_t port)
+  : m_protocol (protocol),
+    m_port (port)
+{
+  m_factory.SetTypeId ("ns3::BulkSendApplication");
+  m_factory.Set ("Protocol", StringValue (protocol));
+  m_workloadFactory.SetTypeId ("ns3::WorkloadApplication");
+  m_workloadFactory.Set ("Protocol", StringValue (protocol));
+  m_rng = CreateObject<UniformRandomVariable> ();
+}
+
+void
+TrafficPatternHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+void
+TrafficPatternHelper::SetWorkloadAttribute (std::string name, const AttributeValue &value)
+{
+  m_workloadFactory.Set (name, value);
+}
+
+ApplicationContainer
+TrafficPatternHelper::InstallIncast (NodeContainer senders, Ptr<Node> receiver)
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = senders.Begin (); i != senders.End (); ++i)
+    {
+      if (*i != receiver)
+        {
+          apps.Add (InstallFlow (*i, receiver));
+        }
+    }
+  return apps;
+}
+
+ApplicationContainer
+TrafficPatternHelper::InstallAllToAll (NodeContainer hosts)
+{
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < hosts.GetN (); ++i)
+    {
+      for (uint32_t j = 0; j < hosts.GetN (); ++j)
+        {
+          if (i != j)
+            {
+              apps.Add (InstallFlow (hosts.Get (i), hosts.Get (j)));
+            }
+        }
+    }
+  return apps;
+}
+
+ApplicationContainer
+TrafficPatternHelper::InstallPermutation (NodeContainer hosts)
+{
+  uint32_t n = hosts.GetN ();
+  NS_ABORT_MSG_IF (n < 2, "A permutation needs at least two hosts");
+
+  // Sattolo's algorithm: a uniformly random single cycle, hence a
+  // permutation where nobody sends to itself.
+  std::vector<uint32_t> dst (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      dst[i] = i;
+    }
+  for (uint32_t i = n - 1; i > 0; --i)
+    {
+      uint32_t j = m_rng->GetInteger (0, i - 1);
+      std::swap (dst[i], dst[j]);
+    }
+
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      apps.Add (InstallFlow (hosts.Get (i), hosts.Get (dst[i])));
+    }
+  return apps;
+}
+
+ApplicationContainer
+TrafficPatternHelper::InstallWorkload (NodeContainer hosts)
+{
+  uint32_t n = hosts.GetN ();
+  NS_ABORT_MSG_IF (n < 2, "A workload needs at least two hosts");
+
+  std::vector<Address> sinks;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      sinks.push_back (InstallSink (hosts.Get (i)));
+    }
+
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      std::vector<Address> peers;
+      for (uint32_t j = 0; j < n; ++j)
+        {
+          if (j != i)
+            {
+              peers.push_back (sinks[j]);
+            }
+        }
+      Ptr<WorkloadApplication> app = m_workloadFactory.Create<WorkloadApplication> ();
+      app->SetPeers (peers);
+      hosts.Get (i)->AddApplication (app);
+      apps.Add (app);
+      m_workloads.Add (app);
+    }
+  return apps;
+}
+
+ApplicationContainer
+TrafficPatternHelper::GetSinks (void) const
+{
+  ApplicationContainer sinks;
+  for (std::map<uint32_t, Ptr<Application> >::const_iterator it = m_sinks.begin ();
+       it != m_sinks.end (); ++it)
+    {
+      sinks.Add (it->second);
+    }
+  return sinks;
+}
+
+int64_t
+TrafficPatternHelper::AssignStreams (int64_t stream)
+{
+  int64_t currentStream = stream;
+  m_rng->SetStream (currentStream++);
+  for (uint32_t i = 0; i < m_workloads.GetN (); ++i)
+    {
+      Ptr<WorkloadApplication> app = DynamicCast<WorkloadApplication> (m_workloads.Get (i));
+      currentStream += app->AssignStreams (currentStream);
+    }
+  return (currentStream - stream);
+}
+
+Address
+TrafficPatternHelper::InstallSink (Ptr<Node> dst)
+{
+  Ptr<Ipv4> ipv4 = dst->GetObject<Ipv4> ();
+  NS_ABORT_MSG_IF (ipv4 == 0 || ipv4->GetNInterfaces () < 2,
+                   "Receiver node " << dst->GetId () << " has no IPv4 address");
+
+  if (m_sinks.find (dst->GetId ()) == m_sinks.end ())
+    {
+      ObjectFactory sinkFactory;
+      sinkFactory.SetTypeId ("ns3::PacketSink");
+      sinkFactory.Set ("Protocol", StringValue (m_protocol));
+      sinkFactory.Set ("Local", AddressValue (InetSocketAddress (Ipv4Address::GetAny (), m_port)));
+      Ptr<Application> sink = sinkFactory.Create<Application> ();
+      dst->AddApplication (sink);
+      m_sinks[dst->GetId ()] = sink;
+    }
+
+  return InetSocketAddress (ipv4->GetAddress (1, 0).GetLocal (), m_port);
+}
+
+Ptr<Application>
+TrafficPatternHelper::InstallFlow (Ptr<Node> src, Ptr<Node> dst)
+{
+  Address remote = InstallSink (dst);
+  NS_LOG_INFO ("Flow " << src->GetId () << " -> " << dst->GetId () << " (" <<
+               InetSocketAddress::ConvertFrom (remote).GetIpv4 () << ")");
+
+  m_factory.Set ("Remote", AddressValue (remote));
+  Ptr<Application> app = m_factory.Create<Application> ();
+  src->AddApplication (app);
+  return app;
+}
+
+} // namespace ns3
@@ -27,9 +27,11 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/tcp-socket-factory.h"
 #include "bulk-send-application.h"
+#include "flow-completion-stats.h"
 
 namespace ns3 {
 
@@ -64,9 +66,18 @@ BulkSendApplication::GetTypeId (void)
                    TypeIdValue (TcpSocketFactory::GetTypeId ()),
                    MakeTypeIdAccessor (&BulkSendApplication::m_tid),
                    MakeTypeIdChecker ())
+    .AddAttribute ("FlowStats",
+                   "The FCT statistics the flow is recorded in once completed",
+                   PointerValue (),
+                   MakePointerAccessor (&BulkSendApplication::m_flowStats),
+                   MakePointerChecker<FlowCompletionStats> ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&BulkSendApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("FlowCompleted",
+                     "All the MaxBytes have been acknowledged",
+                     MakeTraceSourceAccessor (&BulkSendApplication::m_flowCompletedTrace),
+                     "ns3::BulkSendApplication::FlowCompletedTracedCallback")
   ;
   return tid;
 }
@@ -75,7 +86,9 @@ BulkSendApplication::GetTypeId (void)
 BulkSendApplication::BulkSendApplication ()
   : m_socket (0),
     m_connected (false),
-    m_totBytes (0)
+    m_totBytes (0),
+    m_txCapacity (0),
+    m_completed (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -99,12 +112,31 @@ BulkSendApplication::GetSocket (void) const
   return m_socket;
 }
 
+Time
+BulkSendApplication::GetStartTime (void) const
+{
+  return m_startTime;
+}
+
+Time
+BulkSendApplication::GetFinishTime (void) const
+{
+  return m_finishTime;
+}
+
+bool
+BulkSendApplication::IsCompleted (void) const
+{
+  return m_completed;
+}
+
 void
 BulkSendApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
   m_socket = 0;
+  m_flowStats = 0;
   // chain up
   Application::DoDispose ();
 }
@@ -210,6 +242,8 @@ void BulkSendApplication::ConnectionSucceeded (Ptr<Socket> socket)
   NS_LOG_FUNCTION (this << socket);
   NS_LOG_LOGIC ("BulkSendApplication Connection succeeded");
   m_connected = true;
+  m_startTime = Simulator::Now ();
+  m_txCapacity = socket->GetTxAvailable ();
   SendData ();
 }
 
@@ -219,16 +253,34 @@ void BulkSendApplication::ConnectionFailed (Ptr<Socket> socket)
   NS_LOG_LOGIC ("BulkSendApplication, Connection Failed");
 }
 
-void BulkSendApplication::DataSend (Ptr<Socket>, uint32_t)
+void BulkSendApplication::DataSend (Ptr<Socket>, uint32_t available)
 {
   NS_LOG_FUNCTION (this);
 
+  CheckCompleted (available);
   if (m_connected)
     { // Only send new data if the connection has completed
       SendData ();
     }
 }
 
-
+void BulkSendApplication::CheckCompleted (uint32_t available)
+{
+  // The buffer is empty again once the last byte handed to it is acknowledged
+  if (m_completed || m_maxBytes == 0 || m_totBytes < m_maxBytes
+      || available < m_txCapacity)
+    {
+      return;
+    }
+  m_completed = true;
+  m_finishTime = Simulator::Now ();
+  NS_LOG_INFO ("Flow of " << m_totBytes << " bytes completed in " <<
+               (m_finishTime - m_startTime).GetSeconds () << "s");
+  m_flowCompletedTrace (m_totBytes, m_startTime, m_finishTime);
+  if (m_flowStats)
+    {
+      m_flowStats->Record (m_totBytes, m_finishTime - m_startTime);
+    }
+}
 
 } // Namespace ns3
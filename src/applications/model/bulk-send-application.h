@@ -25,12 +25,14 @@
 #include "ns3/application.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
+#include "ns3/nstime.h"
 #include "ns3/traced-callback.h"
 
 namespace ns3 {
 
 class Address;
 class Socket;
+class FlowCompletionStats;
 
 /**
  * \ingroup applications
@@ -64,6 +66,11 @@ class Socket;
  * For example, TCP sockets can be used, but
  * UDP sockets can not be used.
  *
+ * With MaxBytes set, the application also measures the flow completion
+ * time (FCT) of its connection: from the end of the handshake until all
+ * the bytes have been acknowledged, as FlowCompletionStats defines it.
+ * The flow is then reported by the "FlowCompleted" trace and recorded
+ * in the FlowCompletionStats of the "FlowStats" attribute, if any.
  */
 class BulkSendApplication : public Application
 {
@@ -99,6 +106,30 @@ public:
    */
   Ptr<Socket> GetSocket (void) const;
 
+  /**
+   * \returns the time the connection was established
+   */
+  Time GetStartTime (void) const;
+
+  /**
+   * \returns the time all the MaxBytes were acknowledged, if IsCompleted
+   */
+  Time GetFinishTime (void) const;
+
+  /**
+   * \returns true if MaxBytes is set and all of them have been acknowledged
+   */
+  bool IsCompleted (void) const;
+
+  /**
+   * TracedCallback signature for the completion of the flow.
+   *
+   * \param [in] bytes bytes sent
+   * \param [in] start time the connection was established
+   * \param [in] finish time the last byte was acknowledged
+   */
+  typedef void (* FlowCompletedTracedCallback)(uint32_t bytes, Time start, Time finish);
+
 protected:
   virtual void DoDispose (void);
 private:
@@ -111,6 +142,12 @@ private:
    */
   void SendData ();
 
+  /**
+   * \brief Record the flow once all of its bytes have been acknowledged
+   * \param available bytes free in the transmission buffer
+   */
+  void CheckCompleted (uint32_t available);
+
   Ptr<Socket>     m_socket;       //!< Associated socket
   Address         m_peer;         //!< Peer address
   bool            m_connected;    //!< True if connected
@@ -118,10 +155,18 @@ private:
   uint32_t        m_maxBytes;     //!< Limit total number of bytes sent
   uint32_t        m_totBytes;     //!< Total bytes sent so far
   TypeId          m_tid;          //!< The type of protocol to use.
+  uint32_t        m_txCapacity;   //!< Bytes free in the empty transmission buffer
+  bool            m_completed;    //!< True once all MaxBytes are acknowledged
+  Time            m_startTime;    //!< Establishment of the connection
+  Time            m_finishTime;   //!< Acknowledgment of the last byte
+  Ptr<FlowCompletionStats> m_flowStats; //!< FCT statistics the flow is recorded in
 
   /// Traced Callback: sent packets
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
+  /// Traced Callback: flow completed
+  TracedCallback<uint32_t, Time, Time> m_flowCompletedTrace;
+
 private:
   /**
    * \brief Connection Succeeded (called by Socket through a callback)
@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "flow-completion-stats.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowCompletionStats");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowCompletionStats);
+
+/// The slowdowns are sketched as integers, in thousandths
+static const double SLOWDOWN_SCALE = 1000;
+
+TypeId
+FlowCompletionStats::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowCompletionStats")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FlowCompletionStats> ()
+    .AddAttribute ("LineRate", "Rate of the host links, for the ideal FCT",
+                   DataRateValue (DataRate ("10Gbps")),
+                   MakeDataRateAccessor (&FlowCompletionStats::m_lineRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("BaseRtt", "Round trip time without queueing, for the ideal FCT",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&FlowCompletionStats::m_baseRtt),
+                   MakeTimeChecker ())
+    .AddAttribute ("SegmentSize", "Payload of a full segment, for the ideal FCT",
+                   UintegerValue (1448),
+                   MakeUintegerAccessor (&FlowCompletionStats::m_segmentSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HeaderSize", "Headers on the wire of every segment, for the ideal FCT",
+                   UintegerValue (54),
+                   MakeUintegerAccessor (&FlowCompletionStats::m_headerSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Precision",
+                   "Significant bits kept by the quantile sketches; only "
+                   "taken into account at construction and by SetSizeBuckets",
+                   UintegerValue (7),
+                   MakeUintegerAccessor (&FlowCompletionStats::m_precision),
+                   MakeUintegerChecker<uint32_t> (1, 16))
+    .AddTraceSource ("Flow", "A completed flow has been recorded",
+                     MakeTraceSourceAccessor (&FlowCompletionStats::m_flowTrace),
+                     "ns3::FlowCompletionStats::FlowTracedCallback")
+  ;
+  return tid;
+}
+
+FlowCompletionStats::FlowCompletionStats ()
+  : m_precision (7)
+{
+  NS_LOG_FUNCTION (this);
+  // Short, medium and long flows of the datacenter workloads
+  m_bounds.push_back (10000);
+  m_bounds.push_back (100000);
+  m_bounds.push_back (1000000);
+  m_bounds.push_back (10000000);
+}
+
+FlowCompletionStats::~FlowCompletionStats ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FlowCompletionStats::NotifyConstructionCompleted (void)
+{
+  Object::NotifyConstructionCompleted ();
+  Reset ();
+}
+
+void
+FlowCompletionStats::SetSizeBuckets (const std::vector<uint64_t> &bounds)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 1; i < bounds.size (); ++i)
+    {
+      NS_ABORT_MSG_UNLESS (bounds[i - 1] < bounds[i], "Bucket bounds must increase");
+    }
+  m_bounds = bounds;
+  Reset ();
+}
+
+void
+FlowCompletionStats::Reset (void)
+{
+  m_buckets.assign (m_bounds.size () + 2, Bucket (m_precision));
+}
+
+Time
+FlowCompletionStats::GetIdealFct (uint64_t bytes) const
+{
+  uint64_t segments = (bytes + m_segmentSize - 1) / m_segmentSize;
+  uint64_t wireBytes = segments * (m_segmentSize + m_headerSize);
+  return m_baseRtt + m_lineRate.CalculateBytesTxTime (wireBytes);
+}
+
+void
+FlowCompletionStats::Record (uint64_t bytes, Time fct)
+{
+  NS_LOG_FUNCTION (this << bytes << fct);
+
+  double slowdown = fct.GetSeconds () / GetIdealFct (bytes).GetSeconds ();
+
+  CriticalSection cs (m_mutex);
+  uint32_t bucket = 0;
+  while (bucket < m_bounds.size () && bytes > m_bounds[bucket])
+    {
+      bucket++;
+    }
+
+  uint32_t all = GetNBuckets ();
+  uint32_t indexes[2] = { bucket, all };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Bucket &b = m_buckets[indexes[i]];
+      b.slowdownSum += slowdown;
+      b.fct.Update (fct.GetNanoSeconds ());
+      b.slowdown.Update (static_cast<int64_t> (std::floor (slowdown * SLOWDOWN_SCALE + 0.5)));
+    }
+
+  m_flowTrace (bytes, fct, slowdown);
+}
+
+void
+FlowCompletionStats::RecordReceived (uint64_t bytes, Time accepted, Time last)
+{
+  NS_LOG_FUNCTION (this << bytes << accepted << last);
+  Record (bytes, last - accepted + m_baseRtt);
+}
+
+uint32_t
+FlowCompletionStats::GetNBuckets (void) const
+{
+  return m_bounds.size () + 1;
+}
+
+uint64_t
+FlowCompletionStats::GetBucketBound (uint32_t bucket) const
+{
+  NS_ASSERT (bucket < GetNBuckets ());
+  return bucket < m_bounds.size () ? m_bounds[bucket] : 0;
+}
+
+const FlowCompletionStats::Bucket &
+FlowCompletionStats::GetBucket (uint32_t bucket) const
+{
+  NS_ASSERT (bucket <= GetNBuckets ());
+  return m_buckets[bucket];
+}
+
+uint64_t
+FlowCompletionStats::GetFlows (uint32_t bucket) const
+{
+  return GetBucket (bucket).fct.Count ();
+}
+
+Time
+FlowCompletionStats::GetMeanFct (uint32_t bucket) const
+{
+  return NanoSeconds (std::floor (GetBucket (bucket).fct.Mean () + 0.5));
+}
+
+Time
+FlowCompletionStats::GetFctPercentile (uint32_t bucket, double p) const
+{
+  return NanoSeconds (GetBucket (bucket).fct.Quantile (p / 100));
+}
+
+double
+FlowCompletionStats::GetMeanSlowdown (uint32_t bucket) const
+{
+  const Bucket &b = GetBucket (bucket);
+  uint64_t flows = b.fct.Count ();
+  return flows > 0 ? b.slowdownSum / flows : 0;
+}
+
+double
+FlowCompletionStats::GetSlowdownPercentile (uint32_t bucket, double p) const
+{
+  return GetBucket (bucket).slowdown.Quantile (p / 100) / SLOWDOWN_SCALE;
+}
+
+void
+FlowCompletionStats::Print (std::ostream &os) const
+{
+  os << "size\tflows\tfct_mean\tfct_p50\tfct_p95\tfct_p99"
+     << "\tslowdown_mean\tslowdown_p50\tslowdown_p95\tslowdown_p99" << std::endl;
+  for (uint32_t i = 0; i <= GetNBuckets (); ++i)
+    {
+      if (i < m_bounds.size ())
+        {
+          os << "<=" << m_bounds[i];
+        }
+      else if (i < GetNBuckets ())
+        {
+          os << ">" << (m_bounds.empty () ? 0 : m_bounds.back ());
+        }
+      else
+        {
+          os << "all";
+        }
+      os << "\t" << GetFlows (i)
+         << "\t" << GetMeanFct (i).GetSeconds ()
+         << "\t" << GetFctPercentile (i, 50).GetSeconds ()
+         << "\t" << GetFctPercentile (i, 95).GetSeconds ()
+         << "\t" << GetFctPercentile (i, 99).GetSeconds ()
+         << "\t" << GetMeanSlowdown (i)
+         << "\t" << GetSlowdownPercentile (i, 50)
+         << "\t" << GetSlowdownPercentile (i, 95)
+         << "\t" << GetSlowdownPercentile (i, 99)
+         << std::endl;
+    }
+}
+
+void
+FlowCompletionStats::PrintSlowdownCdf (uint32_t bucket, std::ostream &os) const
+{
+  const Bucket &b = GetBucket (bucket);
+  if (b.slowdown.Count () == 0)
+    {
+      return;
+    }
+  for (uint32_t p = 1; p <= 100; ++p)
+    {
+      os << b.slowdown.Quantile (p / 100.0) / SLOWDOWN_SCALE << " " << p / 100.0 << std::endl;
+    }
+}
+
+FlowCompletionStats::Bucket::Bucket (uint32_t precision)
+  : slowdownSum (0),
+    fct (precision),
+    slowdown (precision)
+{
+}
+
+} // namespace ns3
@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef FLOW_COMPLETION_STATS_H
+#define FLOW_COMPLETION_STATS_H
+
+#include <ostream>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-callback.h"
+#include "ns3/system-mutex.h"
+#include "ns3/quantile-sketch.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Flow completion times, aggregated by flow size
+ *
+ * Every completed flow is recorded with its size and its flow completion
+ * time (FCT), from the time the sender has the connection established,
+ * or gets the flow on an established one, to the acknowledgment of its
+ * last byte; the handshake is not counted. The slowdown of the flow is
+ * its FCT divided by the FCT it would have alone in the network,
+ *
+ *              ideal = BaseRtt + ceil (bytes / SegmentSize)
+ *                      * (SegmentSize + HeaderSize) * 8 / LineRate
+ *
+ * (the last segment is counted as a full one). The flows are counted in
+ * size buckets, set with SetSizeBuckets, plus one bucket holding all of
+ * them; each bucket keeps a QuantileSketch of the FCT, in nanoseconds,
+ * and one of the slowdown, in thousandths. The memory used does not
+ * depend on the number of flows, and the percentiles are within
+ * 2^-Precision of the exact ones (below 1% with the default).
+ *
+ * A single object can be shared by all the BulkSendApplication (or
+ * PacketSink) of a simulation through their "FlowStats" attribute, and
+ * printed at the end of it with Print. Record may be called from the
+ * threads of a MultithreadedSimulatorImpl.
+ */
+class FlowCompletionStats : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FlowCompletionStats ();
+  virtual ~FlowCompletionStats ();
+
+  /**
+   * \brief Set the size buckets, clearing the flows recorded so far
+   *
+   * A flow goes to the first bucket whose bound is not below its size;
+   * the flows larger than all the bounds go to a last, unbounded bucket.
+   *
+   * \param bounds upper bounds of the buckets, in bytes, increasing
+   */
+  void SetSizeBuckets (const std::vector<uint64_t> &bounds);
+
+  /**
+   * \brief Record a completed flow
+   * \param bytes flow size
+   * \param fct flow completion time
+   */
+  void Record (uint64_t bytes, Time fct);
+
+  /**
+   * \brief Record a completed flow, as seen by its receiver
+   *
+   * The receiver accepts the connection half a RTT after the sender has it
+   * established, and gets the last byte half a RTT before the sender gets
+   * its acknowledgment: the FCT is the time between them plus BaseRtt.
+   *
+   * \param bytes flow size
+   * \param accepted time the connection was accepted
+   * \param last time the last byte was received
+   */
+  void RecordReceived (uint64_t bytes, Time accepted, Time last);
+
+  /**
+   * \brief The FCT of a flow alone in the network
+   * \param bytes flow size
+   * \returns the ideal FCT
+   */
+  Time GetIdealFct (uint64_t bytes) const;
+
+  /**
+   * \returns the number of size buckets, including the unbounded one
+   */
+  uint32_t GetNBuckets (void) const;
+
+  /**
+   * \param bucket index of the size bucket
+   * \returns the upper bound of the bucket, or 0 for the unbounded one
+   */
+  uint64_t GetBucketBound (uint32_t bucket) const;
+
+  /**
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \returns the number of flows recorded in the bucket
+   */
+  uint64_t GetFlows (uint32_t bucket) const;
+
+  /**
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \returns the mean FCT of the bucket
+   */
+  Time GetMeanFct (uint32_t bucket) const;
+
+  /**
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \param p percentile, between 0 and 100
+   * \returns the approximate percentile of the FCT of the bucket
+   */
+  Time GetFctPercentile (uint32_t bucket, double p) const;
+
+  /**
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \returns the mean slowdown of the bucket
+   */
+  double GetMeanSlowdown (uint32_t bucket) const;
+
+  /**
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \param p percentile, between 0 and 100
+   * \returns the approximate percentile of the slowdown of the bucket
+   */
+  double GetSlowdownPercentile (uint32_t bucket, double p) const;
+
+  /**
+   * \brief Print one line per size bucket, and one for all the flows, with
+   * the mean, median, 95th and 99th percentiles of FCT and slowdown
+   * \param os the output stream
+   */
+  void Print (std::ostream &os) const;
+
+  /**
+   * \brief Print the CDF of the slowdown of a bucket, one "value fraction"
+   * line per percentile
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \param os the output stream
+   */
+  void PrintSlowdownCdf (uint32_t bucket, std::ostream &os) const;
+
+  /**
+   * TracedCallback signature for completed flows.
+   *
+   * \param [in] bytes flow size
+   * \param [in] fct flow completion time
+   * \param [in] slowdown FCT over the ideal FCT
+   */
+  typedef void (* FlowTracedCallback)(uint64_t bytes, Time fct, double slowdown);
+
+protected:
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  /// Flows of one size bucket
+  struct Bucket
+  {
+    /**
+     * \param precision significant bits kept by the sketches
+     */
+    Bucket (uint32_t precision);
+    double slowdownSum;         //!< Sum of the slowdowns, not rounded
+    QuantileSketch fct;         //!< FCTs, in nanoseconds
+    QuantileSketch slowdown;    //!< Slowdowns, in thousandths
+  };
+
+  /**
+   * \param bucket index of the size bucket, or GetNBuckets () for all flows
+   * \returns the bucket
+   */
+  const Bucket & GetBucket (uint32_t bucket) const;
+
+  /**
+   * \brief Drop the flows recorded and rebuild the buckets
+   */
+  void Reset (void);
+
+  DataRate m_lineRate;              //!< Rate of the host links
+  Time m_baseRtt;                   //!< Round trip time without queueing
+  uint32_t m_segmentSize;           //!< Payload of a full segment
+  uint32_t m_headerSize;            //!< Headers on the wire of every segment
+  uint32_t m_precision;             //!< Significant bits kept by the sketches
+  std::vector<uint64_t> m_bounds;   //!< Upper bounds of the size buckets
+  std::vector<Bucket> m_buckets;    //!< Size buckets, then all the flows
+
+  /// Traced Callback: completed flows
+  TracedCallback<uint64_t, Time, double> m_flowTrace;
+  /// Serializes the flows recorded by several threads
+  SystemMutex m_mutex;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_COMPLETION_STATS_H */
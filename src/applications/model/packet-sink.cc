@@ -29,8 +29,10 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/pointer.h"
 #include "ns3/udp-socket-factory.h"
 #include "packet-sink.h"
+#include "flow-completion-stats.h"
 
 namespace ns3 {
 
@@ -55,10 +57,19 @@ PacketSink::GetTypeId (void)
                    TypeIdValue (UdpSocketFactory::GetTypeId ()),
                    MakeTypeIdAccessor (&PacketSink::m_tid),
                    MakeTypeIdChecker ())
+    .AddAttribute ("FlowStats",
+                   "The FCT statistics the connections are recorded in once closed by their peer",
+                   PointerValue (),
+                   MakePointerAccessor (&PacketSink::m_flowStats),
+                   MakePointerChecker<FlowCompletionStats> ())
     .AddTraceSource ("Rx",
                      "A packet has been received",
                      MakeTraceSourceAccessor (&PacketSink::m_rxTrace),
                      "ns3::Packet::AddressTracedCallback")
+    .AddTraceSource ("FlowCompleted",
+                     "An accepted connection has been closed by its peer",
+                     MakeTraceSourceAccessor (&PacketSink::m_flowCompletedTrace),
+                     "ns3::PacketSink::FlowCompletedTracedCallback")
   ;
   return tid;
 }
@@ -100,6 +111,8 @@ void PacketSink::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_socket = 0;
   m_socketList.clear ();
+  m_flows.clear ();
+  m_flowStats = 0;
 
   // chain up
   Application::DoDispose ();
@@ -169,6 +182,12 @@ void PacketSink::HandleRead (Ptr<Socket> socket)
           break;
         }
       m_totalRx += packet->GetSize ();
+      std::map<Ptr<Socket>, Flow>::iterator flow = m_flows.find (socket);
+      if (flow != m_flows.end ())
+        {
+          flow->second.bytes += packet->GetSize ();
+          flow->second.last = Simulator::Now ();
+        }
       if (InetSocketAddress::IsMatchingType (from))
         {
           NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
@@ -195,11 +214,25 @@ void PacketSink::HandleRead (Ptr<Socket> socket)
 void PacketSink::HandlePeerClose (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  HandleRead (socket);
+  std::map<Ptr<Socket>, Flow>::iterator it = m_flows.find (socket);
+  if (it == m_flows.end ())
+    {
+      return;
+    }
+  Flow flow = it->second;
+  m_flows.erase (it);
+  m_flowCompletedTrace (flow.from, flow.bytes, flow.start, flow.last);
+  if (m_flowStats && flow.bytes > 0)
+    {
+      m_flowStats->RecordReceived (flow.bytes, flow.start, flow.last);
+    }
 }
  
 void PacketSink::HandlePeerError (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  m_flows.erase (socket);
 }
  
 
@@ -208,6 +241,12 @@ void PacketSink::HandleAccept (Ptr<Socket> s, const Address& from)
   NS_LOG_FUNCTION (this << s << from);
   s->SetRecvCallback (MakeCallback (&PacketSink::HandleRead, this));
   m_socketList.push_back (s);
+  Flow flow;
+  flow.from = from;
+  flow.start = Simulator::Now ();
+  flow.last = flow.start;
+  flow.bytes = 0;
+  m_flows[s] = flow;
 }
 
 } // Namespace ns3
@@ -0,0 +1,430 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <fstream>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/tcp-socket-factory.h"
+#include "workload-application.h"
+#include "flow-completion-stats.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WorkloadApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (WorkloadApplication);
+
+TypeId
+WorkloadApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WorkloadApplication")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<WorkloadApplication> ()
+    .AddAttribute ("FlowSizeCdfFile", "The file of the flow size CDF",
+                   StringValue (""),
+                   MakeStringAccessor (&WorkloadApplication::m_cdfFile),
+                   MakeStringChecker ())
+    .AddAttribute ("SizeScale", "Multiplier of the flow sizes of the CDF file, "
+                   "e.g. the segment size for a CDF in packets",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&WorkloadApplication::m_sizeScale),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Load", "Target load of the host link, between 0 and 1",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&WorkloadApplication::m_load),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("LineRate", "Rate of the host link",
+                   DataRateValue (DataRate ("10Gbps")),
+                   MakeDataRateAccessor (&WorkloadApplication::m_lineRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("MaxFlows", "The number of flows to start. The value zero "
+                   "means that there is no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&WorkloadApplication::m_maxFlows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Protocol", "The type of protocol to use.",
+                   TypeIdValue (TcpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&WorkloadApplication::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("FlowStats",
+                   "The FCT statistics the flows are recorded in once completed",
+                   PointerValue (),
+                   MakePointerAccessor (&WorkloadApplication::m_flowStats),
+                   MakePointerChecker<FlowCompletionStats> ())
+    .AddTraceSource ("FlowCompleted",
+                     "All the bytes of a flow have been acknowledged",
+                     MakeTraceSourceAccessor (&WorkloadApplication::m_flowCompletedTrace),
+                     "ns3::WorkloadApplication::FlowCompletedTracedCallback")
+  ;
+  return tid;
+}
+
+WorkloadApplication::WorkloadApplication ()
+  : m_loaded (false),
+    m_meanSize (0),
+    m_started (0),
+    m_completed (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowSize = CreateObject<EmpiricalRandomVariable> ();
+  m_interArrival = CreateObject<ExponentialRandomVariable> ();
+  m_peerRng = CreateObject<UniformRandomVariable> ();
+}
+
+WorkloadApplication::~WorkloadApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+WorkloadApplication::SetPeers (const std::vector<Address> &peers)
+{
+  NS_LOG_FUNCTION (this);
+  m_peers = peers;
+  m_idle.assign (peers.size (), std::list<Ptr<Socket> > ());
+}
+
+int64_t
+WorkloadApplication::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_flowSize->SetStream (stream);
+  m_interArrival->SetStream (stream + 1);
+  m_peerRng->SetStream (stream + 2);
+  return 3;
+}
+
+uint32_t
+WorkloadApplication::GetFlowsStarted (void) const
+{
+  return m_started;
+}
+
+uint32_t
+WorkloadApplication::GetFlowsCompleted (void) const
+{
+  return m_completed;
+}
+
+uint32_t
+WorkloadApplication::GetConnections (void) const
+{
+  return m_connections.size ();
+}
+
+double
+WorkloadApplication::GetMeanFlowSize (void)
+{
+  LoadCdf ();
+  return m_meanSize;
+}
+
+Time
+WorkloadApplication::GetMeanInterArrival (void)
+{
+  LoadCdf ();
+  return m_meanInterArrival;
+}
+
+void
+WorkloadApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_connections.clear ();
+  m_idle.clear ();
+  m_flowStats = 0;
+  // chain up
+  Application::DoDispose ();
+}
+
+void
+WorkloadApplication::LoadCdf (void)
+{
+  if (m_loaded)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_cdfFile);
+
+  std::ifstream file (m_cdfFile.c_str ());
+  NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot open the flow size CDF " << m_cdfFile);
+
+  std::vector<std::pair<double, double> > points;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      std::istringstream fields (line);
+      double size;
+      if (line.empty () || line[0] == '#' || !(fields >> size))
+        {
+          continue;
+        }
+      double cdf = 0;
+      double field;
+      uint32_t n = 0;
+      while (fields >> field)
+        {
+          cdf = field;
+          n++;
+        }
+      NS_ABORT_MSG_IF (n == 0, "No fraction in the line \"" << line << "\" of " << m_cdfFile);
+      points.push_back (std::make_pair (size * m_sizeScale, cdf));
+    }
+  NS_ABORT_MSG_IF (points.empty (), "Empty flow size CDF " << m_cdfFile);
+
+  double scale = points.back ().second > 1 ? 100 : 1;
+  m_meanSize = 0;
+  double prevSize = 0;
+  double prevCdf = 0;
+  for (uint32_t i = 0; i < points.size (); ++i)
+    {
+      double size = points[i].first;
+      double cdf = points[i].second / scale;
+      m_flowSize->CDF (size, cdf);
+      // The sizes are interpolated linearly, and the first point holds
+      // the mass of the smaller ones
+      m_meanSize += (cdf - prevCdf) * (i == 0 ? size : (size + prevSize) / 2);
+      prevSize = size;
+      prevCdf = cdf;
+    }
+  NS_ABORT_MSG_IF (prevCdf < 0.999 || prevCdf > 1.001,
+                   "The flow size CDF " << m_cdfFile << " ends at " << prevCdf);
+
+  double rate = m_load * m_lineRate.GetBitRate ();
+  NS_ABORT_MSG_IF (rate <= 0, "The workload needs a load and a line rate");
+  m_meanInterArrival = Seconds (m_meanSize * 8 / rate);
+  m_interArrival->SetAttribute ("Mean", DoubleValue (m_meanInterArrival.GetSeconds ()));
+  m_loaded = true;
+  NS_LOG_INFO ("Mean flow size " << m_meanSize << " bytes, one flow every " <<
+               m_meanInterArrival.GetSeconds () << "s");
+}
+
+// Application Methods
+void WorkloadApplication::StartApplication (void) // Called at time specified by Start
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ABORT_MSG_IF (m_peers.empty (), "WorkloadApplication without peers");
+  LoadCdf ();
+  ScheduleNextFlow ();
+}
+
+void WorkloadApplication::StopApplication (void) // Called at time specified by Stop
+{
+  NS_LOG_FUNCTION (this);
+
+  Simulator::Cancel (m_nextFlow);
+  for (std::map<Ptr<Socket>, Connection>::iterator it = m_connections.begin ();
+       it != m_connections.end (); ++it)
+    {
+      it->first->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      it->first->Close ();
+    }
+  m_connections.clear ();
+  for (uint32_t i = 0; i < m_idle.size (); ++i)
+    {
+      m_idle[i].clear ();
+    }
+}
+
+void WorkloadApplication::ScheduleNextFlow (void)
+{
+  if (m_maxFlows > 0 && m_started >= m_maxFlows)
+    {
+      NS_LOG_LOGIC ("All the flows have been started");
+      return;
+    }
+  m_nextFlow = Simulator::Schedule (Seconds (m_interArrival->GetValue ()),
+                                    &WorkloadApplication::NewFlow, this);
+}
+
+void WorkloadApplication::NewFlow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t peer = m_peerRng->GetInteger (0, m_peers.size () - 1);
+  uint32_t size = std::max<double> (1, m_flowSize->GetValue () + 0.5);
+  m_started++;
+  NS_LOG_INFO ("Flow " << m_started << " of " << size << " bytes to peer " << peer);
+
+  Ptr<Socket> socket;
+  if (!m_idle[peer].empty ())
+    {
+      socket = m_idle[peer].front ();
+      m_idle[peer].pop_front ();
+    }
+  else
+    {
+      socket = Socket::CreateSocket (GetNode (), m_tid);
+      // Fatal error if socket type is not NS3_SOCK_STREAM or NS3_SOCK_SEQPACKET
+      if (socket->GetSocketType () != Socket::NS3_SOCK_STREAM &&
+          socket->GetSocketType () != Socket::NS3_SOCK_SEQPACKET)
+        {
+          NS_FATAL_ERROR ("Using WorkloadApplication with an incompatible socket type. "
+                          "WorkloadApplication requires SOCK_STREAM or SOCK_SEQPACKET. "
+                          "In other words, use TCP instead of UDP.");
+        }
+      if (Inet6SocketAddress::IsMatchingType (m_peers[peer]))
+        {
+          socket->Bind6 ();
+        }
+      else
+        {
+          socket->Bind ();
+        }
+      socket->Connect (m_peers[peer]);
+      socket->ShutdownRecv ();
+      socket->SetConnectCallback (
+        MakeCallback (&WorkloadApplication::ConnectionSucceeded, this),
+        MakeCallback (&WorkloadApplication::ConnectionFailed, this));
+      socket->SetSendCallback (
+        MakeCallback (&WorkloadApplication::DataSend, this));
+      socket->SetCloseCallbacks (
+        MakeCallback (&WorkloadApplication::HandleClose, this),
+        MakeCallback (&WorkloadApplication::HandleClose, this));
+      Connection c;
+      c.peer = peer;
+      c.connected = false;
+      c.capacity = 0;
+      m_connections[socket] = c;
+    }
+
+  Connection &c = m_connections[socket];
+  c.busy = true;
+  c.size = size;
+  c.toSend = size;
+  c.start = Simulator::Now ();
+  if (c.connected)
+    {
+      SendData (socket);
+    }
+
+  ScheduleNextFlow ();
+}
+
+void WorkloadApplication::SendData (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  Connection &c = m_connections[socket];
+  while (c.toSend > 0)
+    {
+      uint32_t toSend = std::min (c.toSend, socket->GetTxAvailable ());
+      if (toSend == 0)
+        {
+          // The "Send" callback will pop when some buffer space has freed up
+          break;
+        }
+      int actual = socket->Send (Create<Packet> (toSend));
+      if (actual <= 0)
+        {
+          break;
+        }
+      c.toSend -= actual;
+    }
+}
+
+void WorkloadApplication::ConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (socket);
+  if (it == m_connections.end ())
+    {
+      return;
+    }
+  it->second.connected = true;
+  it->second.capacity = socket->GetTxAvailable ();
+  // The FCT does not count the handshake
+  it->second.start = Simulator::Now ();
+  SendData (socket);
+}
+
+void WorkloadApplication::ConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  NS_LOG_WARN ("WorkloadApplication, Connection Failed; its flow is lost");
+  m_connections.erase (socket);
+}
+
+void WorkloadApplication::HandleClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (socket);
+  if (it == m_connections.end ())
+    {
+      return;
+    }
+  if (!it->second.busy)
+    {
+      m_idle[it->second.peer].remove (socket);
+    }
+  m_connections.erase (it);
+}
+
+void WorkloadApplication::DataSend (Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << socket << available);
+
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (socket);
+  if (it == m_connections.end () || !it->second.connected || !it->second.busy)
+    {
+      return;
+    }
+  Connection &c = it->second;
+  if (c.toSend > 0)
+    {
+      SendData (socket);
+      return;
+    }
+  // The buffer is empty again once the last byte of the flow is acknowledged
+  if (available < c.capacity)
+    {
+      return;
+    }
+
+  c.busy = false;
+  m_completed++;
+  Time finish = Simulator::Now ();
+  NS_LOG_INFO ("Flow of " << c.size << " bytes completed in " <<
+               (finish - c.start).GetSeconds () << "s");
+  m_flowCompletedTrace (m_peers[c.peer], c.size, c.start, finish);
+  if (m_flowStats)
+    {
+      m_flowStats->Record (c.size, finish - c.start);
+    }
+  m_idle[c.peer].push_back (socket);
+}
+
+} // Namespace ns3
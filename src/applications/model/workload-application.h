@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef WORKLOAD_APPLICATION_H
+#define WORKLOAD_APPLICATION_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class Socket;
+class EmpiricalRandomVariable;
+class ExponentialRandomVariable;
+class UniformRandomVariable;
+class FlowCompletionStats;
+
+/**
+ * \ingroup applications
+ * \defgroup workload WorkloadApplication
+ *
+ * This traffic generator opens flows with sizes drawn from an empirical
+ * distribution, at Poisson arrivals, to peers chosen at random.
+ */
+
+/**
+ * \ingroup workload
+ *
+ * \brief Generate an open-loop workload of flows from a flow size CDF
+ *
+ * The flow sizes follow the CDF read from FlowSizeCdfFile, interpolated
+ * linearly between its points, as done to evaluate datacenter transports
+ * with the web search, data mining or Hadoop workloads. Each line of the
+ * file holds a flow size and the fraction of flows up to that size; when
+ * a line has more columns, the first one is the size and the last one the
+ * fraction. Sizes are multiplied by SizeScale (e.g. 1460 for files in
+ * packets); fractions may be given in percent. Lines starting with '#'
+ * are skipped.
+ *
+ * The flows arrive as a Poisson process whose rate loads the host link
+ * of the application at Load: the mean inter-arrival time is
+ *
+ *              mean flow size * 8 / (Load * LineRate)
+ *
+ * Each flow goes to a peer drawn uniformly among those given with
+ * SetPeers. It is sent on an idle connection to that peer, if any, so
+ * that the connections are reused like those of an RPC pool; otherwise a
+ * new connection is opened and kept in the pool once the flow completes.
+ * A flow is complete when all of its bytes have been acknowledged: its
+ * flow completion time (FCT), from its arrival on an established
+ * connection or from the end of the handshake of a new one, as
+ * FlowCompletionStats defines it, is then reported by the
+ * "FlowCompleted" trace and recorded in the FlowCompletionStats of the
+ * "FlowStats" attribute, if any.
+ *
+ * Only SOCK_STREAM and SOCK_SEQPACKET sockets are supported.
+ */
+class WorkloadApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  WorkloadApplication ();
+
+  virtual ~WorkloadApplication ();
+
+  /**
+   * \brief Set the peers the flows are sent to
+   * \param peers the addresses of the peers, with their port
+   */
+  void SetPeers (const std::vector<Address> &peers);
+
+  /**
+   * \brief The mean of the flow size distribution, loading it if needed
+   * \returns the mean flow size, in bytes
+   */
+  double GetMeanFlowSize (void);
+
+  /**
+   * \brief The mean inter-arrival time of the flows, loading the flow
+   * size distribution if needed
+   * \returns the mean time between two flows
+   */
+  Time GetMeanInterArrival (void);
+
+  /**
+   * \returns the number of flows started so far
+   */
+  uint32_t GetFlowsStarted (void) const;
+
+  /**
+   * \returns the number of flows completed so far
+   */
+  uint32_t GetFlowsCompleted (void) const;
+
+  /**
+   * \returns the number of connections opened so far
+   */
+  uint32_t GetConnections (void) const;
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for completed flows.
+   *
+   * \param [in] peer address of the peer
+   * \param [in] bytes flow size
+   * \param [in] start arrival of the flow, or end of the handshake
+   * \param [in] finish acknowledgment of the last byte
+   */
+  typedef void (* FlowCompletedTracedCallback)(const Address &peer, uint32_t bytes,
+                                               Time start, Time finish);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);    // Called at time specified by Start
+  virtual void StopApplication (void);     // Called at time specified by Stop
+
+  /// A connection of the pool, and the flow it carries
+  struct Connection
+  {
+    uint32_t peer;        //!< Index of the peer
+    bool connected;       //!< True once the handshake is complete
+    bool busy;            //!< True while a flow is carried
+    uint32_t capacity;    //!< Bytes free in the empty transmission buffer
+    uint32_t size;        //!< Size of the flow
+    uint32_t toSend;      //!< Bytes of the flow not handed to the socket yet
+    Time start;           //!< Arrival of the flow, or end of the handshake
+  };
+
+  /**
+   * \brief Read the flow size CDF and set the mean inter-arrival time
+   */
+  void LoadCdf (void);
+
+  /**
+   * \brief Start a flow and schedule the arrival of the next one
+   */
+  void NewFlow (void);
+
+  /**
+   * \brief Schedule the arrival of the next flow
+   */
+  void ScheduleNextFlow (void);
+
+  /**
+   * \brief Hand the bytes of the flow of a connection to its socket
+   * \param socket the socket of the connection
+   */
+  void SendData (Ptr<Socket> socket);
+
+  /**
+   * \brief Connection Succeeded (called by Socket through a callback)
+   * \param socket the connected socket
+   */
+  void ConnectionSucceeded (Ptr<Socket> socket);
+
+  /**
+   * \brief Connection Failed (called by Socket through a callback)
+   * \param socket the connected socket
+   */
+  void ConnectionFailed (Ptr<Socket> socket);
+
+  /**
+   * \brief Send more data, and detect the completion of the flow, as soon
+   * as some has been acknowledged
+   * \param socket the socket
+   * \param available bytes free in the transmission buffer
+   */
+  void DataSend (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Drop a connection closed by the peer or in error
+   * \param socket the socket
+   */
+  void HandleClose (Ptr<Socket> socket);
+
+  std::string     m_cdfFile;      //!< File of the flow size CDF
+  double          m_sizeScale;    //!< Multiplier of the sizes of the file
+  double          m_load;         //!< Target load of the host link
+  DataRate        m_lineRate;     //!< Rate of the host link
+  uint32_t        m_maxFlows;     //!< Flows to start, 0 for no limit
+  TypeId          m_tid;          //!< The type of protocol to use.
+  std::vector<Address> m_peers;   //!< Peers the flows are sent to
+  Ptr<FlowCompletionStats> m_flowStats; //!< FCT statistics the flows are recorded in
+
+  Ptr<EmpiricalRandomVariable> m_flowSize;       //!< Flow sizes
+  Ptr<ExponentialRandomVariable> m_interArrival; //!< Time between two flows
+  Ptr<UniformRandomVariable> m_peerRng;          //!< Peer of each flow
+  bool            m_loaded;       //!< True once the CDF is loaded
+  double          m_meanSize;     //!< Mean flow size, in bytes
+  Time            m_meanInterArrival; //!< Mean time between two flows
+
+  EventId         m_nextFlow;     //!< Arrival of the next flow
+  uint32_t        m_started;      //!< Flows started
+  uint32_t        m_completed;    //!< Flows completed
+  std::map<Ptr<Socket>, Connection> m_connections; //!< The pool
+  std::vector<std::list<Ptr<Socket> > > m_idle;    //!< Idle connections, by peer
+
+  /// Traced Callback: completed flows
+  TracedCallback<const Address &, uint32_t, Time, Time> m_flowCompletedTrace;
+};
+
+} // namespace ns3
+
+#endif /* WORKLOAD_APPLICATION_H */
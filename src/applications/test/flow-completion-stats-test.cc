@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/flow-completion-stats.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("FlowCompletionStatsTestSuite");
+
+/**
+ * \ingroup applications
+ * \brief Testing the size buckets, slowdowns and percentiles of FlowCompletionStats
+ */
+class FlowCompletionStatsTestCase : public TestCase
+{
+public:
+  FlowCompletionStatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowCompletionStatsTestCase::FlowCompletionStatsTestCase ()
+  : TestCase ("FCT buckets, slowdowns and percentiles")
+{
+}
+
+void
+FlowCompletionStatsTestCase::DoRun (void)
+{
+  Ptr<FlowCompletionStats> stats = CreateObjectWithAttributes<FlowCompletionStats> (
+      "LineRate", DataRateValue (DataRate ("8Mbps")),
+      "BaseRtt", TimeValue (MicroSeconds (100)),
+      "SegmentSize", UintegerValue (1000),
+      "HeaderSize", UintegerValue (0));
+
+  // One microsecond per byte on the wire, the last segment counted full
+  NS_TEST_ASSERT_MSG_EQ (stats->GetIdealFct (1000), MicroSeconds (1100), "Wrong ideal FCT");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetIdealFct (1001), MicroSeconds (2100), "Wrong ideal FCT");
+
+  std::vector<uint64_t> bounds;
+  bounds.push_back (1000);
+  bounds.push_back (10000);
+  stats->SetSizeBuckets (bounds);
+  NS_TEST_ASSERT_MSG_EQ (stats->GetNBuckets (), 3, "Wrong number of buckets");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetBucketBound (2), 0, "Last bucket not unbounded");
+
+  // 100 short flows, slowdowns 1 to 100
+  for (uint32_t i = 1; i <= 100; ++i)
+    {
+      stats->Record (1000, MicroSeconds (1100 * i));
+    }
+  stats->Record (5000, MicroSeconds (5100));
+  stats->Record (20000, MicroSeconds (40200));
+
+  NS_TEST_ASSERT_MSG_EQ (stats->GetFlows (0), 100, "Wrong short flows");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetFlows (1), 1, "Wrong medium flows");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetFlows (2), 1, "Wrong long flows");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetFlows (3), 102, "Wrong flows in all buckets");
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetMeanSlowdown (0), 50.5, 1e-9, "Wrong mean slowdown");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetMeanSlowdown (1), 1, 1e-9, "Wrong medium slowdown");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetMeanSlowdown (2), 2, 1e-9, "Wrong long slowdown");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetMeanFct (1).GetSeconds (), 5100e-6, 1e-9, "Wrong mean FCT");
+
+  // Percentiles within a bucket of the sketches, 2^-7
+  double tol = 0.008;
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetSlowdownPercentile (0, 50), 50, 50 * tol, "Wrong median");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetSlowdownPercentile (0, 99), 99, 99 * tol, "Wrong 99th percentile");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetFctPercentile (0, 90).GetSeconds (), 0.099, 0.099 * tol,
+                             "Wrong FCT percentile");
+
+  // Resetting the buckets drops the flows
+  stats->SetSizeBuckets (bounds);
+  NS_TEST_ASSERT_MSG_EQ (stats->GetFlows (3), 0, "Flows not dropped");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetSlowdownPercentile (3, 50), 0, "Percentile of no flows");
+}
+
+/**
+ * \ingroup applications
+ * \brief Testing that the sender and the receiver of a flow measure the same FCT
+ *
+ * A flow of five segments, all in the initial window, crosses an idle
+ * link: the BulkSendApplication and the PacketSink record it in their own
+ * FlowCompletionStats, which must agree, without the handshake.
+ */
+class FlowCompletionStatsEndsTestCase : public TestCase
+{
+public:
+  FlowCompletionStatsEndsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowCompletionStatsEndsTestCase::FlowCompletionStatsEndsTestCase ()
+  : TestCase ("FCT of the sender and of the receiver")
+{
+}
+
+void
+FlowCompletionStatsEndsTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::InitialCwnd", UintegerValue (10));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+
+  NodeContainer hosts;
+  hosts.Create (2);
+  SimpleNetDeviceHelper link;
+  link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  link.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices = link.Install (hosts);
+  InternetStackHelper internet;
+  internet.Install (hosts);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  // IP and TCP headers, with the timestamp option
+  Ptr<FlowCompletionStats> sent = CreateObjectWithAttributes<FlowCompletionStats> (
+      "LineRate", DataRateValue (DataRate ("10Mbps")),
+      "BaseRtt", TimeValue (MilliSeconds (2)),
+      "HeaderSize", UintegerValue (52));
+  Ptr<FlowCompletionStats> received = CreateObjectWithAttributes<FlowCompletionStats> (
+      "LineRate", DataRateValue (DataRate ("10Mbps")),
+      "BaseRtt", TimeValue (MilliSeconds (2)),
+      "HeaderSize", UintegerValue (52));
+
+  BulkSendHelper bulk ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), 5000));
+  bulk.SetAttribute ("MaxBytes", UintegerValue (5 * 1448));
+  bulk.SetAttribute ("FlowStats", PointerValue (sent));
+  bulk.Install (hosts.Get (0)).Start (Seconds (0.1));
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  sink.SetAttribute ("FlowStats", PointerValue (received));
+  sink.Install (hosts.Get (1));
+
+  Simulator::Run ();
+
+  uint32_t all = sent->GetNBuckets ();
+  NS_TEST_ASSERT_MSG_EQ (sent->GetFlows (all), 1, "Flow not recorded by the sender");
+  NS_TEST_ASSERT_MSG_EQ (received->GetFlows (all), 1, "Flow not recorded by the receiver");
+  // Without queueing, the receiver misses exactly one BaseRtt
+  NS_TEST_ASSERT_MSG_EQ_TOL (received->GetMeanFct (all), sent->GetMeanFct (all), MicroSeconds (100),
+                             "The two ends disagree on the FCT");
+  // The device sends the frames as they start, the ideal FCT counts them
+  // until their end: the slowdown is a bit below 1
+  NS_TEST_ASSERT_MSG_EQ_TOL (sent->GetMeanSlowdown (all), 0.9, 0.1, "Wrong slowdown");
+
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+/**
+ * \ingroup applications
+ * \brief FlowCompletionStats TestSuite
+ */
+class FlowCompletionStatsTestSuite : public TestSuite
+{
+public:
+  FlowCompletionStatsTestSuite ();
+};
+
+FlowCompletionStatsTestSuite::FlowCompletionStatsTestSuite ()
+  : TestSuite ("flow-completion-stats", UNIT)
+{
+  AddTestCase (new FlowCompletionStatsTestCase, TestCase::QUICK);
+  AddTestCase (new FlowCompletionStatsEndsTestCase, TestCase::QUICK);
+}
+
+static FlowCompletionStatsTestSuite flowCompletionStatsTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-pattern-helper.h"
+#include "ns3/workload-application.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WorkloadApplicationTestSuite");
+
+/**
+ * \ingroup applications
+ * \brief Testing the flow size CDF and the arrival rate of WorkloadApplication
+ */
+class WorkloadApplicationCdfTestCase : public TestCase
+{
+public:
+  WorkloadApplicationCdfTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WorkloadApplicationCdfTestCase::WorkloadApplicationCdfTestCase ()
+  : TestCase ("Flow size CDF and arrival rate of the workload")
+{
+}
+
+void
+WorkloadApplicationCdfTestCase::DoRun (void)
+{
+  // Half of the flows of one packet, the others uniform from 1 to 9 packets,
+  // in percent and with a pFabric-like middle column
+  std::string file = CreateTempDirFilename ("workload-cdf.txt");
+  std::ofstream cdf (file.c_str ());
+  cdf << "# size count cdf" << std::endl;
+  cdf << "1 1 0" << std::endl;
+  cdf << "1 1 50" << std::endl;
+  cdf << std::endl;
+  cdf << "9 1 100" << std::endl;
+  cdf.close ();
+
+  Ptr<WorkloadApplication> app = CreateObject<WorkloadApplication> ();
+  app->SetAttribute ("FlowSizeCdfFile", StringValue (file));
+  app->SetAttribute ("SizeScale", DoubleValue (1000));
+  app->SetAttribute ("Load", DoubleValue (0.5));
+  app->SetAttribute ("LineRate", DataRateValue (DataRate ("8Mbps")));
+
+  // 0.5 * 1000 + 0.5 * 5000 bytes
+  NS_TEST_ASSERT_MSG_EQ_TOL (app->GetMeanFlowSize (), 3000, 1e-6, "Wrong mean flow size");
+  // 3000 bytes at half of one byte per microsecond
+  NS_TEST_ASSERT_MSG_EQ_TOL (app->GetMeanInterArrival ().GetSeconds (), 6e-3, 1e-9,
+                             "Wrong mean inter-arrival time");
+}
+
+/**
+ * \ingroup applications
+ * \brief Testing the flows of WorkloadApplication, installed by the
+ * TrafficPatternHelper: they all complete, on connections reused
+ */
+class WorkloadApplicationFlowTestCase : public TestCase
+{
+public:
+  WorkloadApplicationFlowTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Count a completed flow
+   * \param peer address of the peer
+   * \param bytes flow size
+   * \param start arrival of the flow
+   * \param finish acknowledgment of the last byte
+   */
+  void FlowCompleted (const Address &peer, uint32_t bytes, Time start, Time finish);
+
+  uint32_t m_completed;   //!< Flows completed
+  uint64_t m_bytes;       //!< Bytes of the flows completed
+};
+
+WorkloadApplicationFlowTestCase::WorkloadApplicationFlowTestCase ()
+  : TestCase ("Flow completion and connection reuse of the workload"),
+    m_completed (0),
+    m_bytes (0)
+{
+}
+
+void
+WorkloadApplicationFlowTestCase::FlowCompleted (const Address &peer, uint32_t bytes,
+                                                Time start, Time finish)
+{
+  m_completed++;
+  m_bytes += bytes;
+  NS_TEST_EXPECT_MSG_GT (finish, start, "Flow completed at its arrival");
+}
+
+void
+WorkloadApplicationFlowTestCase::DoRun (void)
+{
+  // All the flows of 10 kB
+  std::string file = CreateTempDirFilename ("workload-flow-cdf.txt");
+  std::ofstream cdf (file.c_str ());
+  cdf << "10000 1" << std::endl;
+  cdf.close ();
+
+  NodeContainer hosts;
+  hosts.Create (3);
+  SimpleNetDeviceHelper link;
+  link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  link.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices = link.Install (hosts);
+  InternetStackHelper internet;
+  internet.Install (hosts);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  // A flow every 80 ms on average, which takes about 10 ms: most flows
+  // find an idle connection to their peer
+  const uint32_t flows = 20;
+  TrafficPatternHelper traffic ("ns3::TcpSocketFactory", 5000);
+  traffic.SetWorkloadAttribute ("FlowSizeCdfFile", StringValue (file));
+  traffic.SetWorkloadAttribute ("Load", DoubleValue (0.1));
+  traffic.SetWorkloadAttribute ("LineRate", DataRateValue (DataRate ("10Mbps")));
+  traffic.SetWorkloadAttribute ("MaxFlows", UintegerValue (flows));
+  ApplicationContainer apps = traffic.InstallWorkload (hosts);
+  NS_TEST_ASSERT_MSG_EQ (traffic.AssignStreams (1), 1 + 3 * hosts.GetN (),
+                         "Wrong number of streams assigned");
+  for (uint32_t i = 0; i < apps.GetN (); ++i)
+    {
+      apps.Get (i)->TraceConnectWithoutContext (
+        "FlowCompleted", MakeCallback (&WorkloadApplicationFlowTestCase::FlowCompleted, this));
+    }
+
+  // The applications are not stopped, so that their pools are kept
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < apps.GetN (); ++i)
+    {
+      Ptr<WorkloadApplication> app = DynamicCast<WorkloadApplication> (apps.Get (i));
+      NS_TEST_ASSERT_MSG_EQ (app->GetFlowsStarted (), flows, "Flows not started");
+      NS_TEST_ASSERT_MSG_EQ (app->GetFlowsCompleted (), flows, "Flows not completed");
+      NS_TEST_ASSERT_MSG_LT (app->GetConnections (), flows, "Connections not reused");
+      NS_TEST_ASSERT_MSG_GT (app->GetConnections (), 0, "No connection kept");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_completed, flows * apps.GetN (), "Completions not traced");
+  NS_TEST_ASSERT_MSG_EQ (m_bytes, 10000ULL * flows * apps.GetN (), "Wrong flow sizes");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications
+ * \brief WorkloadApplication TestSuite
+ */
+class WorkloadApplicationTestSuite : public TestSuite
+{
+public:
+  WorkloadApplicationTestSuite ();
+};
+
+WorkloadApplicationTestSuite::WorkloadApplicationTestSuite ()
+  : TestSuite ("workload-application", UNIT)
+{
+  AddTestCase (new WorkloadApplicationCdfTestCase, TestCase::QUICK);
+  AddTestCase (new WorkloadApplicationFlowTestCase, TestCase::QUICK);
+}
+
+static WorkloadApplicationTestSuite workloadApplicationTestSuite; //!< Static variable for test initialization
@@ -25,10 +25,24 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "uinteger.h"
 #include "assert.h"
 #include "log.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
 
 
 /**
@@ -53,6 +67,13 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfilePeriod",
+                   "Profile the events, timing one event in ProfilePeriod on average; "
+                   "0 to not profile them.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::SetProfilePeriod,
+                                         &DefaultSimulatorImpl::GetProfilePeriod),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -71,8 +92,11 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profilePeriod = 0;
+  m_profileCountdown = 0;
+  m_profileRandom = 1;
+  m_profileEvents = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -108,6 +132,10 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (!m_profile.empty ())
+    {
+      PrintProfile (std::clog);
+    }
 }
 
 void
@@ -146,12 +174,152 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profilePeriod == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      InvokeProfiled (next.impl);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
 }
 
+void
+DefaultSimulatorImpl::InvokeProfiled (EventImpl *event)
+{
+  m_profileEvents++;
+  m_profileCountdown--;
+  if (m_profileCountdown != 0)
+    {
+      event->Invoke ();
+      return;
+    }
+  // the gaps between samples are uniform in [1, 2 * period - 1]
+  m_profileRandom = m_profileRandom * 6364136223846793005ULL + 1442695040888963407ULL;
+  m_profileCountdown = 1 + (m_profileRandom >> 32) % (2 * static_cast<uint64_t> (m_profilePeriod) - 1);
+  if (event->IsCancelled ())
+    {
+      // nothing to time: the next sample is the next event in the gap
+      event->Invoke ();
+      return;
+    }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  event->Invoke ();
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+
+  struct EventProfile &profile = m_profile[std::type_index (typeid (*event))];
+  profile.samples++;
+  profile.time += std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ();
+}
+
+void
+DefaultSimulatorImpl::SetProfilePeriod (uint32_t period)
+{
+  NS_LOG_FUNCTION (this << period);
+  m_profilePeriod = period;
+  m_profileCountdown = period;
+  m_profileEvents = 0;
+  m_profile.clear ();
+}
+
+uint32_t
+DefaultSimulatorImpl::GetProfilePeriod (void) const
+{
+  return m_profilePeriod;
+}
+
+/**
+ * \ingroup simulator
+ * \param [in] mangled The name of the type of an event.
+ * \returns The readable name of the type. For the events made by
+ * MakeEvent(), which are classes local to it, the name of the
+ * MakeEvent() specialization, which shows what the event calls.
+ */
+static std::string
+EventTypeName (const char *mangled)
+{
+  std::string name = mangled;
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  static const std::string makeEvent = "ns3::MakeEvent<";
+  if (name.compare (0, makeEvent.size (), makeEvent) != 0)
+    {
+      return name;
+    }
+  // keep the template arguments, up to their closing bracket
+  int depth = 0;
+  for (std::string::size_type i = makeEvent.size () - 1; i < name.size (); ++i)
+    {
+      if (name[i] == '<')
+        {
+          depth++;
+        }
+      else if (name[i] == '>' && --depth == 0)
+        {
+          return name.substr (5, i - 4);
+        }
+    }
+  return name;
+}
+
+/**
+ * \ingroup simulator
+ * \param [in] a The time of a type of event, and its statistics.
+ * \param [in] b The time of another type of event, and its statistics.
+ * \returns \c true if \p a took more time than \p b.
+ */
+template <typename T>
+static bool
+MoreTime (const std::pair<uint64_t, T> &a, const std::pair<uint64_t, T> &b)
+{
+  return a.first > b.first;
+}
+
+void
+DefaultSimulatorImpl::PrintProfile (std::ostream &os) const
+{
+  uint64_t samples = 0;
+  uint64_t time = 0;
+  std::vector<std::pair<uint64_t, EventProfiles::const_iterator> > sorted;
+  for (EventProfiles::const_iterator i = m_profile.begin (); i != m_profile.end (); ++i)
+    {
+      samples += i->second.samples;
+      time += i->second.time;
+      sorted.push_back (std::make_pair (i->second.time, i));
+    }
+  std::sort (sorted.begin (), sorted.end (), MoreTime<EventProfiles::const_iterator>);
+
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "Event profile: " << m_profileEvents << " events, "
+     << samples << " of them sampled and timed (" << time / 1e9 << " s)" << std::endl;
+  os << std::setw (8) << "time %" << std::setw (12) << "samples"
+     << std::setw (12) << "mean ns" << "  event type" << std::endl;
+  os << std::fixed << std::setprecision (2);
+  for (uint32_t i = 0; i < sorted.size (); ++i)
+    {
+      const struct EventProfile &profile = sorted[i].second->second;
+      os << std::setw (8) << (time > 0 ? 100.0 * profile.time / time : 0.0)
+         << std::setw (12) << profile.samples
+         << std::setw (12) << profile.time / profile.samples
+         << "  " << EventTypeName (sorted[i].second->first.name ())
+         << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
@@ -161,22 +329,14 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.IsEmpty ())
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  EventWithContext event;
+  while (m_eventsWithContext.Pop (event))
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
        Scheduler::Event ev;
        ev.impl = event.event;
        ev.key.m_ts = m_currentTs + event.timestamp;
@@ -269,11 +429,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      m_eventsWithContext.Push (ev);
     }
 }
 
@@ -19,7 +19,11 @@
  */
 
 #include "event-impl.h"
+#include "system-mutex.h"
 #include "log.h"
+#include <new>
+#include <utility>
+#include <vector>
 
 /**
  * \file
@@ -31,6 +35,187 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+#ifdef EVENT_IMPL_POOL
+namespace {
+
+/** Granularity of the size classes of the event pool, in bytes. */
+const std::size_t POOL_GRANULARITY = 16;
+/** Number of size classes: the events of up to 256 bytes are pooled. */
+const std::size_t POOL_CLASSES = 16;
+/** Size of the slabs the events are carved out of, in bytes. */
+const std::size_t POOL_SLAB_SIZE = 16384;
+/** Number of free events a thread hands over to the depot at once. */
+const uint32_t POOL_BATCH = 256;
+
+/** A free event, linked in a free list. */
+struct FreeEvent
+{
+  FreeEvent *next; //!< Next free event of the list
+};
+
+/** A list of free events. */
+typedef std::pair<FreeEvent *, uint32_t> FreeList;
+
+/**
+ * \ingroup events
+ * The free events shared by all the threads, by size class.
+ *
+ * The events scheduled by a thread for another one, like the events a
+ * reader thread of an FdNetDevice schedules for the simulation, are
+ * allocated in a thread and freed in another. The thread freeing them
+ * hands its surplus over to the depot, where the allocating thread takes
+ * them back, so that the memory does not pile up in the free lists of
+ * the consumers. The slabs are never freed: the events may be freed by
+ * any thread, at any time, even during the static destruction.
+ */
+class EventPoolDepot
+{
+public:
+  /**
+   * Give a free list to the depot.
+   * \param [in] sizeClass The size class of the events.
+   * \param [in] list The free list.
+   */
+  void Put (std::size_t sizeClass, FreeList list)
+  {
+    CriticalSection cs (m_mutex);
+    m_lists[sizeClass].push_back (list);
+  }
+  /**
+   * Take a free list from the depot, carving a new slab if it is empty.
+   * \param [in] sizeClass The size class of the events.
+   * \returns The free list.
+   */
+  FreeList Take (std::size_t sizeClass)
+  {
+    {
+      CriticalSection cs (m_mutex);
+      if (!m_lists[sizeClass].empty ())
+        {
+          FreeList list = m_lists[sizeClass].back ();
+          m_lists[sizeClass].pop_back ();
+          return list;
+        }
+    }
+    std::size_t size = (sizeClass + 1) * POOL_GRANULARITY;
+    char *slab = static_cast<char *> (::operator new (POOL_SLAB_SIZE));
+    FreeList list (0, 0);
+    for (char *p = slab; p + size <= slab + POOL_SLAB_SIZE; p += size)
+      {
+        FreeEvent *event = reinterpret_cast<FreeEvent *> (p);
+        event->next = list.first;
+        list.first = event;
+        list.second++;
+      }
+    return list;
+  }
+  /** \returns The depot, which is never destroyed. */
+  static EventPoolDepot *Get (void)
+  {
+    static EventPoolDepot *depot = new EventPoolDepot ();
+    return depot;
+  }
+private:
+  SystemMutex m_mutex;                          //!< Mutex of the lists
+  std::vector<FreeList> m_lists[POOL_CLASSES];  //!< The free lists, by size class
+};
+
+/**
+ * \ingroup events
+ * The free events of a thread, by size class.
+ */
+struct EventPoolCache
+{
+  FreeList lists[POOL_CLASSES];  //!< The free lists, by size class
+  /** Give the free events back to the depot when the thread exits. */
+  ~EventPoolCache ();
+};
+
+/** The free events of the thread. */
+thread_local EventPoolCache g_eventPoolCache;
+/** Whether the free events of the thread were given back to the depot. */
+thread_local bool g_eventPoolCacheDestroyed = false;
+
+EventPoolCache::~EventPoolCache ()
+{
+  for (std::size_t i = 0; i < POOL_CLASSES; ++i)
+    {
+      if (lists[i].first != 0)
+        {
+          EventPoolDepot::Get ()->Put (i, lists[i]);
+          lists[i] = FreeList (0, 0);
+        }
+    }
+  g_eventPoolCacheDestroyed = true;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  if (size > POOL_CLASSES * POOL_GRANULARITY)
+    {
+      return ::operator new (size);
+    }
+  std::size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (g_eventPoolCacheDestroyed)
+    {
+      // the thread is exiting: take a free list, and leave the rest of it
+      FreeList list = EventPoolDepot::Get ()->Take (sizeClass);
+      FreeEvent *event = list.first;
+      if (list.second > 1)
+        {
+          EventPoolDepot::Get ()->Put (sizeClass, FreeList (event->next, list.second - 1));
+        }
+      return event;
+    }
+  FreeList &list = g_eventPoolCache.lists[sizeClass];
+  if (list.first == 0)
+    {
+      list = EventPoolDepot::Get ()->Take (sizeClass);
+    }
+  FreeEvent *event = list.first;
+  list.first = event->next;
+  list.second--;
+  return event;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (size > POOL_CLASSES * POOL_GRANULARITY)
+    {
+      ::operator delete (p);
+      return;
+    }
+  std::size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  FreeEvent *event = static_cast<FreeEvent *> (p);
+  if (g_eventPoolCacheDestroyed)
+    {
+      event->next = 0;
+      EventPoolDepot::Get ()->Put (sizeClass, FreeList (event, 1));
+      return;
+    }
+  FreeList &list = g_eventPoolCache.lists[sizeClass];
+  event->next = list.first;
+  list.first = event;
+  list.second++;
+  if (list.second >= 2 * POOL_BATCH)
+    {
+      // keep a batch, and hand the other one over to the depot
+      FreeEvent *last = list.first;
+      for (uint32_t i = 1; i < POOL_BATCH; ++i)
+        {
+          last = last->next;
+        }
+      EventPoolDepot::Get ()->Put (sizeClass, FreeList (last->next, list.second - POOL_BATCH));
+      last->next = 0;
+      list.second = POOL_BATCH;
+    }
+}
+#endif /* EVENT_IMPL_POOL */
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,8 +21,17 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
+/**
+ * \ingroup events
+ * Allocate the events from per-thread pools, rather than with the
+ * global operator new. Undefine it to find the misuses of freed events
+ * with valgrind.
+ */
+#define EVENT_IMPL_POOL 1
+
 /**
  * \file
  * \ingroup events
@@ -66,6 +75,30 @@ public:
    */
   bool IsCancelled (void);
 
+#ifdef EVENT_IMPL_POOL
+  /**
+   * Allocate the memory of an event from the pool of the calling thread.
+   *
+   * The events of up to 256 bytes, which are all the events made by
+   * the MakeEvent() functions with the arguments they bind, are carved
+   * out of slabs, in size classes of 16 bytes, and recycled through a
+   * free list per class and per thread. The larger ones use the global
+   * operator new.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Give the memory of an event back to the pool of the calling thread,
+   * which may not be the thread which allocated it.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+#endif /* EVENT_IMPL_POOL */
+
 protected:
   /**
    * Implementation for Invoke().
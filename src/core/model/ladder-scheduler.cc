@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  // allocated once, so that the rungs never move
+  m_rungs.resize (MAX_RUNGS);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::BucketIndex (const Rung &r, uint64_t ts)
+{
+  uint64_t index = (ts - r.start) / r.width;
+  if (index >= r.buckets.size ())
+    {
+      index = r.buckets.size () - 1;
+    }
+  return index;
+}
+
+void
+LadderScheduler::NewRung (Bucket &events, uint64_t min, uint64_t max)
+{
+  NS_LOG_FUNCTION (this << events.size () << min << max);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && !events.empty ());
+  Rung &r = m_rungs[m_nRungs];
+  m_nRungs++;
+  uint32_t n = events.size ();
+  r.start = min;
+  r.width = (max - min) / n + 1;
+  r.current = 0;
+  r.count = n;
+  // the buckets of an unused rung are all empty, and keep their capacity
+  r.buckets.resize (n);
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      r.buckets[BucketIndex (r, i->key.m_ts)].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty () && m_bottomHead == 0);
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          m_scratch.swap (m_top);
+          NewRung (m_scratch, m_topMin, m_topMax);
+          const Rung &first = m_rungs[0];
+          m_topStart = first.start + first.width * first.buckets.size ();
+        }
+      Rung &r = m_rungs[m_nRungs - 1];
+      if (r.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (r.buckets[r.current].empty ())
+        {
+          r.current++;
+        }
+      m_scratch.swap (r.buckets[r.current]);
+      r.current++;
+      r.count -= m_scratch.size ();
+      if (r.current == r.buckets.size ())
+        {
+          NS_ASSERT (r.count == 0);
+          m_nRungs--;
+        }
+      if (m_scratch.size () > THRESHOLD && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t min = m_scratch[0].key.m_ts;
+          uint64_t max = min;
+          for (Bucket::const_iterator i = m_scratch.begin (); i != m_scratch.end (); ++i)
+            {
+              min = std::min (min, i->key.m_ts);
+              max = std::max (max, i->key.m_ts);
+            }
+          if (max > min)
+            {
+              NewRung (m_scratch, min, max);
+              continue;
+            }
+        }
+      m_bottom.swap (m_scratch);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+    }
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  m_bottom.insert (std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev), ev);
+  uint64_t min = m_bottom[m_bottomHead].key.m_ts;
+  uint64_t max = m_bottom.back ().key.m_ts;
+  if (m_bottom.size () - m_bottomHead > THRESHOLD && m_nRungs < MAX_RUNGS && max > min)
+    {
+      m_scratch.assign (m_bottom.begin () + m_bottomHead, m_bottom.end ());
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      NewRung (m_scratch, min, max);
+      Refill ();
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  m_size++;
+  if (m_size == 1)
+    {
+      // the scheduler was empty: start again, with the later events in Top
+      m_bottom.push_back (ev);
+      m_topStart = ts + 1;
+      return;
+    }
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      m_top.push_back (ev);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; ++i)
+    {
+      Rung &r = m_rungs[i];
+      if (ts >= r.start + r.current * r.width)
+        {
+          r.buckets[BucketIndex (r, ts)].push_back (ev);
+          r.count++;
+          return;
+        }
+    }
+  InsertBottom (ev);
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_size > 0);
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_size > 0);
+  Event next = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_size--;
+  if (m_bottomHead == m_bottom.size ())
+    {
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      if (m_size > 0)
+        {
+          Refill ();
+        }
+      else
+        {
+          m_nRungs = 0;
+        }
+    }
+  return next;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  uint32_t uid = ev.key.m_uid;
+  m_size--;
+  if (ts >= m_topStart)
+    {
+      for (Bucket::iterator i = m_top.begin (); i != m_top.end (); ++i)
+        {
+          if (i->key.m_uid == uid)
+            {
+              NS_ASSERT (i->impl == ev.impl);
+              *i = m_top.back ();
+              m_top.pop_back ();
+              return;
+            }
+        }
+      NS_ASSERT (false);
+    }
+  for (uint32_t j = 0; j < m_nRungs; ++j)
+    {
+      Rung &r = m_rungs[j];
+      if (ts >= r.start + r.current * r.width)
+        {
+          Bucket &bucket = r.buckets[BucketIndex (r, ts)];
+          for (Bucket::iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              if (i->key.m_uid == uid)
+                {
+                  NS_ASSERT (i->impl == ev.impl);
+                  *i = bucket.back ();
+                  bucket.pop_back ();
+                  r.count--;
+                  return;
+                }
+            }
+          NS_ASSERT (false);
+        }
+    }
+  Bucket::iterator i = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  NS_ASSERT (i != m_bottom.end () && i->key.m_uid == uid && i->impl == ev.impl);
+  m_bottom.erase (i);
+  if (m_bottomHead == m_bottom.size ())
+    {
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      if (m_size > 0)
+        {
+          Refill ();
+        }
+      else
+        {
+          m_nRungs = 0;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "system-mutex.h"
+#include "assert.h"
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief A queue with many producer threads and a single consumer thread
+ *
+ * The simulator implementations use it to take the events that other
+ * threads, like the reader threads of the FdNetDevice or the TapBridge,
+ * schedule with Simulator::ScheduleWithContext.
+ *
+ * The items go through a ring of fixed capacity, the bounded queue of
+ * D. Vyukov: a producer claims a cell by incrementing the enqueue
+ * position with a compare-and-swap, writes the item, and publishes it
+ * with the sequence number of the cell, which the consumer checks. The
+ * cells are reused, so that neither side allocates memory or takes a
+ * lock. When the ring is full, the producers fall back to an overflow
+ * vector, under a mutex, until the consumer has emptied it. The
+ * consumer takes the overflow only once every claimed cell of the ring
+ * has been read, so that the items of every producer are popped in the
+ * order they were pushed.
+ *
+ * The consumer must always be the same thread at a time, for instance
+ * the thread running the simulation.
+ *
+ * \tparam T \explicit The type of the items, default constructible and
+ * copyable.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] capacity The number of items in the ring, rounded up to
+   * a power of two.
+   */
+  MpscQueue (uint32_t capacity = 1024);
+  /** Destructor. */
+  ~MpscQueue ();
+
+  /**
+   * Add an item at the end of the queue; from any thread.
+   * \param [in] item The item.
+   */
+  void Push (const T &item);
+  /**
+   * Take the item at the front of the queue; from the consumer thread.
+   * \param [out] item The item.
+   * \returns \c true if there was an item, \c false if the queue was
+   * empty, or if the next item of the ring is still being written.
+   */
+  bool Pop (T &item);
+  /**
+   * Whether the queue is empty; from the consumer thread.  A cheap test
+   * for the common case, before Pop.
+   * \returns \c true if the queue is empty.
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /** A cell of the ring. */
+  struct Cell
+  {
+    std::atomic<uint64_t> sequence;  //!< Position at which the cell may be written, plus one once written
+    T item;                          //!< The item
+  };
+
+  /**
+   * Add an item to the ring.
+   * \param [in] item The item.
+   * \returns \c false if the ring is full.
+   */
+  bool PushRing (const T &item);
+
+  Cell *m_ring;                        //!< The ring
+  uint64_t m_mask;                     //!< Capacity of the ring, minus one
+  /** Padding, so that the producers and the consumer do not share a cache line. */
+  char m_padding0[64];
+  std::atomic<uint64_t> m_enqueuePos;  //!< Next position to claim, for the producers
+  /** Padding, so that the producers and the consumer do not share a cache line. */
+  char m_padding1[64];
+  uint64_t m_dequeuePos;               //!< Next position to read, for the consumer
+
+  std::atomic<bool> m_overflow;        //!< Whether the producers use the overflow
+  SystemMutex m_overflowMutex;         //!< Mutex of the overflow
+  std::vector<T> m_overflowItems;      //!< The items which did not fit in the ring
+  std::vector<T> m_drain;              //!< Overflow items taken by the consumer
+  uint32_t m_drainHead;                //!< Next item of m_drain to pop
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (uint32_t capacity)
+  : m_enqueuePos (0),
+    m_dequeuePos (0),
+    m_overflow (false),
+    m_drainHead (0)
+{
+  uint64_t size = 2;
+  while (size < capacity)
+    {
+      size *= 2;
+    }
+  m_mask = size - 1;
+  m_ring = new Cell [size];
+  for (uint64_t i = 0; i < size; ++i)
+    {
+      m_ring[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  delete [] m_ring;
+  m_ring = 0;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::PushRing (const T &item)
+{
+  uint64_t pos = m_enqueuePos.load (std::memory_order_relaxed);
+  Cell *cell;
+  for (;;)
+    {
+      cell = &m_ring[pos & m_mask];
+      uint64_t sequence = cell->sequence.load (std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t> (sequence - pos);
+      if (diff == 0)
+        {
+          if (m_enqueuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // the consumer has not read this cell yet: full
+          return false;
+        }
+      else
+        {
+          pos = m_enqueuePos.load (std::memory_order_relaxed);
+        }
+    }
+  cell->item = item;
+  cell->sequence.store (pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+void
+MpscQueue<T>::Push (const T &item)
+{
+  if (!m_overflow.load (std::memory_order_acquire) && PushRing (item))
+    {
+      return;
+    }
+  CriticalSection cs (m_overflowMutex);
+  m_overflowItems.push_back (item);
+  m_overflow.store (true, std::memory_order_release);
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop (T &item)
+{
+  if (m_drainHead < m_drain.size ())
+    {
+      item = m_drain[m_drainHead];
+      m_drainHead++;
+      return true;
+    }
+  Cell *cell = &m_ring[m_dequeuePos & m_mask];
+  uint64_t sequence = cell->sequence.load (std::memory_order_acquire);
+  if (sequence == m_dequeuePos + 1)
+    {
+      item = cell->item;
+      cell->sequence.store (m_dequeuePos + m_mask + 1, std::memory_order_release);
+      m_dequeuePos++;
+      return true;
+    }
+  if (!m_overflow.load (std::memory_order_acquire)
+      || m_enqueuePos.load (std::memory_order_acquire) != m_dequeuePos)
+    {
+      // A claimed cell is still being written; it, and the cells behind
+      // it, may hold older items of the producers using the overflow
+      return false;
+    }
+  // The ring is empty: the overflow items are the next ones
+  m_drain.clear ();
+  m_drainHead = 0;
+  {
+    CriticalSection cs (m_overflowMutex);
+    m_drain.swap (m_overflowItems);
+    m_overflow.store (false, std::memory_order_release);
+  }
+  return Pop (item);
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  return m_drainHead == m_drain.size ()
+         && m_enqueuePos.load (std::memory_order_acquire) == m_dequeuePos
+         && !m_overflow.load (std::memory_order_acquire);
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
@@ -34,6 +34,7 @@
 
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -107,6 +108,7 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -208,6 +210,18 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
       { 
         CriticalSection cs (m_mutex);
+        //
+        // This next line resets the synchronizer so that any future event will
+        // cause it to interrupt.  The other threads schedule their events
+        // without the critical section, and signal the synchronizer after
+        // queueing them: we reset it before we move the queued events to the
+        // event list, so that none may slip in between unnoticed.  The fence
+        // keeps the reset from being ordered after the reads of the queue.
+        //
+        m_synchronizer->SetCondition (false);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        ProcessEventsWithContext ();
+
         //
         // Since we are in realtime mode, the time to delay has got to be the 
         // difference between the current realtime and the timestamp of the next 
@@ -253,10 +267,9 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         // We've figured out how long we need to delay in order to pace the 
         // simulation time with the real time.  We're going to sleep, but need
         // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
+        // external happens (like a packet is received).  The synchronizer was
+        // reset above for this.
         //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -324,8 +337,10 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // We do know we're waiting for an event, so there had better be an event on the 
     // event queue.  Let's pull it off.  When we release the critical section, the
     // event we're working on won't be on the list and so subsequent operations won't
-    // mess with us.
+    // mess with us.  The events queued by the other threads in the meantime
+    // go to the event list first, in case one of them is due earlier.
     //
+    ProcessEventsWithContext ();
     NS_ASSERT_MSG (m_events->IsEmpty () == false, 
                    "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
     next = m_events->RemoveNext ();
@@ -399,12 +414,39 @@ RealtimeSimulatorImpl::IsFinished (void) const
   bool rc;
   {
     CriticalSection cs (m_mutex);
-    rc = m_events->IsEmpty () || m_stop;
+    rc = (m_events->IsEmpty () && m_eventsWithContext.IsEmpty ()) || m_stop;
   }
 
   return rc;
 }
 
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContext.IsEmpty ())
+    {
+      return;
+    }
+
+  EventWithContext event;
+  while (m_eventsWithContext.Pop (event))
+    {
+      Scheduler::Event ev;
+      ev.impl = event.event;
+      ev.key.m_ts = event.realtime ? event.timestamp : m_currentTs + event.timestamp;
+      //
+      // The event may have waited in the queue while we ran an event due
+      // later than its realtime timestamp: it runs as soon as possible.
+      //
+      ev.key.m_ts = std::max (ev.key.m_ts, m_currentTs);
+      ev.key.m_context = event.context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+}
+
 //
 // Peeks into event list.  Should be called with critical section locked.
 //
@@ -442,6 +484,7 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        ProcessEventsWithContext ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -543,23 +586,33 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      //
+      // From another thread, the event waits in a lock-free queue until the
+      // main thread moves it to the event list.  If the simulator is running,
+      // we're pacing and have a meaningful realtime clock.  If we're not,
+      // m_currentTs, where we stopped, is added then.
+      //
+      EventWithContext ev;
+      ev.context = context;
+      ev.realtime = m_running;
+      ev.timestamp = delay.GetTimeStep ();
+      if (ev.realtime)
+        {
+          ev.timestamp += m_synchronizer->GetCurrentRealtime ();
+        }
+      ev.event = impl;
+      m_eventsWithContext.Push (ev);
+      // Publish the event before the signal, see ProcessOneEvent
+      std::atomic_thread_fence (std::memory_order_seq_cst);
+      m_synchronizer->Signal ();
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
+    uint64_t ts = m_currentTs + delay.GetTimeStep ();
 
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
@@ -30,7 +30,9 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -172,9 +174,25 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Move the events scheduled by the other threads into the event list.
+   * Should be called with critical section locked.
+   */
+  void ProcessEventsWithContext (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
+  /** Wrap an event scheduled by another thread, with its execution context. */
+  struct EventWithContext
+  {
+    uint32_t context;   //!< The event context
+    uint64_t timestamp; //!< Event timestamp, absolute or relative to the current time
+    bool realtime;      //!< Whether the timestamp is absolute, from the realtime clock
+    EventImpl *event;   //!< The event implementation
+  };
+  /** The events scheduled by the other threads, not yet in the event list. */
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
+
   /** Container type for events to be run at destroy time. */
   typedef std::list<EventId> DestroyEvents;
   /** Container for events to be run at destroy time. */
@@ -182,7 +200,7 @@ private:
   /** Has the stopping condition been reached? */
   bool m_stop;
   /** Is the simulator currently running. */
-  bool m_running;
+  std::atomic<bool> m_running;
 
   /**
    * \name Mutex-protected variables.
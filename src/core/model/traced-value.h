@@ -197,6 +197,13 @@ public:
   void Disconnect (const CallbackBase &cb, std::string path) {
     m_cb.Disconnect (cb, path);
   }
+  /**
+   * Disconnect all the Callbacks, e.g. when the object holding the
+   * TracedValue is reused for something else.
+   */
+  void DisconnectAll (void) {
+    m_cb.DisconnectAll ();
+  }
   /**
    * Set the value of the underlying variable.
    *
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+
+#include <list>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Check that the items of every producer are popped once, in order
+ *
+ * Producer threads push numbered items, while the test pops them. With
+ * a ring smaller than the items, the producers go through the overflow.
+ */
+class MpscQueueTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param capacity capacity of the ring
+   */
+  MpscQueueTestCase (uint32_t capacity);
+
+private:
+  virtual void DoRun (void);
+
+  /** An item: its producer, and its number. */
+  struct Item
+  {
+    uint32_t producer; //!< The producer
+    uint32_t number;   //!< The number of the item
+  };
+  /**
+   * Push the items of a producer, from its thread
+   * \param context the test case, and the producer
+   */
+  static void Produce (std::pair<MpscQueueTestCase *, uint32_t> context);
+
+  uint32_t m_capacity;       //!< Capacity of the ring
+  MpscQueue<Item> *m_queue;  //!< The queue
+};
+
+/**
+ * \param capacity capacity of the ring
+ * \returns the capacity, as a string
+ */
+static std::string
+Name (uint32_t capacity)
+{
+  std::ostringstream oss;
+  oss << capacity;
+  return oss.str ();
+}
+
+static const uint32_t PRODUCERS = 4;
+static const uint32_t ITEMS = 100000;
+
+MpscQueueTestCase::MpscQueueTestCase (uint32_t capacity)
+  : TestCase ("Check the MpscQueue with a ring of capacity " + Name (capacity)),
+    m_capacity (capacity),
+    m_queue (0)
+{
+}
+
+void
+MpscQueueTestCase::Produce (std::pair<MpscQueueTestCase *, uint32_t> context)
+{
+  for (uint32_t i = 0; i < ITEMS; ++i)
+    {
+      Item item;
+      item.producer = context.second;
+      item.number = i;
+      context.first->m_queue->Push (item);
+    }
+}
+
+void
+MpscQueueTestCase::DoRun (void)
+{
+  m_queue = new MpscQueue<Item> (m_capacity);
+  NS_TEST_ASSERT_MSG_EQ (m_queue->IsEmpty (), true, "New queue not empty");
+
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < PRODUCERS; ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&MpscQueueTestCase::Produce,
+                                                                          std::make_pair (this, i)));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+
+  std::vector<uint32_t> next (PRODUCERS, 0);
+  uint32_t popped = 0;
+  while (popped < PRODUCERS * ITEMS)
+    {
+      Item item;
+      if (!m_queue->Pop (item))
+        {
+          continue;
+        }
+      popped++;
+      // expect rather than assert: the producers must be joined
+      NS_TEST_EXPECT_MSG_LT (item.producer, PRODUCERS, "Item of an unknown producer");
+      if (item.producer < PRODUCERS)
+        {
+          NS_TEST_EXPECT_MSG_EQ (item.number, next[item.producer], "Item out of order");
+          next[item.producer] = item.number + 1;
+        }
+    }
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+
+  Item item;
+  NS_TEST_ASSERT_MSG_EQ (m_queue->Pop (item), false, "Item popped twice");
+  NS_TEST_ASSERT_MSG_EQ (m_queue->IsEmpty (), true, "Queue not empty");
+  delete m_queue;
+  m_queue = 0;
+}
+
+/**
+ * \brief MpscQueue TestSuite
+ */
+class MpscQueueTestSuite : public TestSuite
+{
+public:
+  MpscQueueTestSuite ()
+    : TestSuite ("mpsc-queue", UNIT)
+  {
+    AddTestCase (new MpscQueueTestCase (1024), TestCase::QUICK);
+    AddTestCase (new MpscQueueTestCase (4), TestCase::QUICK);
+  }
+};
+
+static MpscQueueTestSuite g_mpscQueueTestSuite; //!< Static variable for test initialization
@@ -23,6 +23,18 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/make-event.h"
+#include "ns3/event-impl.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/uinteger.h"
+#include <chrono>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
 
 using namespace ns3;
 
@@ -168,6 +180,235 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that a large event population is ordered by " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  // A hold model: every event removed is replaced by a later one, with a
+  // mix of near and far, distinct and equal timestamps; some events are
+  // removed before their time.  The events are checked against a set.
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+  std::set<std::pair<uint64_t, uint32_t> > expected;
+  uint32_t uid = 0;
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < 20000; ++i)
+    {
+      uint64_t delay;
+      switch (i < 2000 ? 0 : rand->GetInteger (0, 3))
+        {
+        case 0:
+          delay = rand->GetInteger (0, 1000000);
+          break;
+        case 1:
+          delay = 0;
+          break;
+        default:
+          delay = rand->GetInteger (0, 100);
+          break;
+        }
+      Scheduler::Event ev;
+      ev.impl = 0;
+      ev.key.m_ts = now + delay;
+      ev.key.m_uid = uid++;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+      expected.insert (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+      if (i < 2000)
+        {
+          continue;
+        }
+      if (rand->GetInteger (0, 9) == 0)
+        {
+          ev = scheduler->PeekNext ();
+          scheduler->Remove (ev);
+          expected.erase (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+          ev.impl = 0;
+          ev.key.m_ts = now + 1000000 + rand->GetInteger (0, 1000);
+          ev.key.m_uid = uid++;
+          scheduler->Insert (ev);
+          scheduler->Remove (ev);
+          continue;
+        }
+      ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, expected.begin ()->first, "Wrong event timestamp");
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->second, "Wrong event order");
+      expected.erase (expected.begin ());
+      now = ev.key.m_ts;
+    }
+  while (!expected.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Events lost");
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->second, "Wrong event order");
+      expected.erase (expected.begin ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "Events left");
+}
+
+class EventImplPoolTestCase : public TestCase
+{
+public:
+  EventImplPoolTestCase ();
+  virtual void DoRun (void);
+  /** An argument too large for the event pool. */
+  struct Large
+  {
+    uint32_t values[100];  //!< Values to check
+  };
+  void Small (uint32_t a, uint64_t b);
+  void Big (Large large);
+  uint64_t m_sum;
+};
+
+EventImplPoolTestCase::EventImplPoolTestCase ()
+  : TestCase ("Check that the events are recycled, and keep their arguments")
+{
+}
+void
+EventImplPoolTestCase::Small (uint32_t a, uint64_t b)
+{
+  m_sum += a + b;
+}
+void
+EventImplPoolTestCase::Big (Large large)
+{
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      m_sum += large.values[i];
+    }
+}
+void
+EventImplPoolTestCase::DoRun (void)
+{
+  m_sum = 0;
+#ifdef EVENT_IMPL_POOL
+  EventImpl *first = MakeEvent (&EventImplPoolTestCase::Small, this, 1, 2);
+  first->Unref ();
+  EventImpl *second = MakeEvent (&EventImplPoolTestCase::Small, this, 3, 4);
+  NS_TEST_ASSERT_MSG_EQ (second, first, "Event not recycled");
+  second->Unref ();
+#endif /* EVENT_IMPL_POOL */
+
+  Large large;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      large.values[i] = i;
+    }
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      Simulator::Schedule (NanoSeconds (i), &EventImplPoolTestCase::Small, this, i, 1000000);
+      Simulator::Schedule (NanoSeconds (i), &EventImplPoolTestCase::Big, this, large);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_sum, 999 * 1000 / 2 + 1000 * (1000000 + 4950), "Wrong event arguments");
+}
+
+class SimulatorProfileTestCase : public TestCase
+{
+public:
+  SimulatorProfileTestCase ();
+  virtual void DoRun (void);
+  void Fast (void);
+  void Slow (uint32_t us);
+};
+
+SimulatorProfileTestCase::SimulatorProfileTestCase ()
+  : TestCase ("Check the profile of the events of the DefaultSimulatorImpl")
+{
+}
+void
+SimulatorProfileTestCase::Fast (void)
+{
+}
+void
+SimulatorProfileTestCase::Slow (uint32_t us)
+{
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now () + std::chrono::microseconds (us);
+  while (std::chrono::steady_clock::now () < end)
+    {
+    }
+}
+void
+SimulatorProfileTestCase::DoRun (void)
+{
+  Ptr<DefaultSimulatorImpl> impl = CreateObject<DefaultSimulatorImpl> ();
+  impl->SetAttribute ("ProfilePeriod", UintegerValue (1));
+  Simulator::SetImplementation (impl);
+  // a cancelled event is counted, not timed, and does not stop the sampling
+  EventId cancelled = Simulator::Schedule (MicroSeconds (0), &SimulatorProfileTestCase::Fast, this);
+  Simulator::Cancel (cancelled);
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorProfileTestCase::Fast, this);
+    }
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorProfileTestCase::Slow, this, 20);
+    }
+  Simulator::Run ();
+
+  std::ostringstream oss;
+  impl->PrintProfile (oss);
+  std::istringstream report (oss.str ());
+  std::string line;
+  std::getline (report, line);
+  NS_TEST_ASSERT_MSG_NE (line.find ("151 events, 150 of them"), std::string::npos,
+                         "Events not all sampled: " << line);
+  std::getline (report, line);
+  // the slow events come first, then the fast ones
+  double share;
+  uint64_t samples;
+  uint64_t mean;
+  std::getline (report, line);
+  std::istringstream (line) >> share >> samples >> mean;
+  NS_TEST_ASSERT_MSG_EQ (samples, 50, "Wrong samples: " << line);
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (mean, 20000, "Wrong time: " << line);
+  NS_TEST_ASSERT_MSG_NE (line.find ("MakeEvent<void (SimulatorProfileTestCase::*)(unsigned int)"),
+                         std::string::npos, "Wrong first type: " << line);
+  std::getline (report, line);
+  std::istringstream (line) >> share >> samples >> mean;
+  NS_TEST_ASSERT_MSG_EQ (samples, 100, "Wrong samples: " << line);
+  NS_TEST_ASSERT_MSG_NE (line.find ("MakeEvent<void (SimulatorProfileTestCase::*)()"),
+                         std::string::npos, "Wrong second type: " << line);
+  NS_TEST_ASSERT_MSG_EQ (std::getline (report, line).good (), false, "Types left: " << line);
+
+  // sampled, the events are not all timed
+  impl->SetAttribute ("ProfilePeriod", UintegerValue (10));
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorProfileTestCase::Fast, this);
+    }
+  Simulator::Run ();
+  oss.str ("");
+  impl->PrintProfile (oss);
+  report.clear ();
+  report.str (oss.str ());
+  std::getline (report, line);
+  NS_TEST_ASSERT_MSG_EQ (line.find ("1000 events, 1000 of them"), std::string::npos,
+                         "Events all sampled: " << line);
+  NS_TEST_ASSERT_MSG_NE (line.find ("1000 events, "), std::string::npos, "Events lost: " << line);
+
+  // no report at Destroy
+  impl->SetAttribute ("ProfilePeriod", UintegerValue (0));
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -469,11 +710,20 @@ public:
     factory.SetTypeId (ListScheduler::GetTypeId ());
 
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (MapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (HeapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventImplPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorProfileTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -29,6 +29,7 @@
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/tso-tag.h"
 #include "ns3/trace-source-accessor.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
@@ -373,7 +374,7 @@ CsmaNetDevice::AddHeader (Ptr<Packet> p,   Mac48Address source,  Mac48Address de
             p->AddAtEnd (padd);
           }
 
-        NS_ASSERT_MSG (p->GetSize () <= GetMtu (),
+        NS_ASSERT_MSG (p->GetSize () <= GetMtu () || TsoTag::GetFrames (p) > 1,
                        "CsmaNetDevice::AddHeader(): 802.3 Length/Type field with LLC/SNAP: "
                        "length interpretation must not exceed device frame size minus overhead");
       }
@@ -521,7 +522,9 @@ CsmaNetDevice::TransmitStart (void)
           m_txMachineState = BUSY;
           m_phyTxBeginTrace (m_currentPkt);
 
-          Time tEvent = m_bps.CalculateBytesTxTime (m_currentPkt->GetSize ());
+          // A super-segment takes the time of its wire frames, back to back
+          Time tEvent = m_bps.CalculateBytesTxTime (TsoTag::GetWireSize (m_currentPkt))
+            + m_tInterframeGap * (TsoTag::GetFrames (m_currentPkt) - 1);
           NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << tEvent.GetSeconds () << "sec");
           Simulator::Schedule (tEvent, &CsmaNetDevice::TransmitCompleteEvent, this);
         }
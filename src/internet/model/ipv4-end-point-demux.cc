@@ -35,33 +35,136 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints endPoints = GetAllEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
       delete endPoint;
     }
-  m_endPoints.clear ();
+  m_connected.clear ();
+  m_wildcards.clear ();
+  m_localPorts.clear ();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::FourTuple::operator == (const FourTuple &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator () (const FourTuple &x) const
+{
+  uint64_t h = (static_cast<uint64_t> (x.peerAddress.Get ()) << 32) | x.localAddress.Get ();
+  h ^= (static_cast<uint64_t> (x.peerPort) << 16 | x.localPort) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 29;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 32;
+  return static_cast<size_t> (h);
+}
+
+Ipv4EndPointDemux::FourTuple
+Ipv4EndPointDemux::GetFourTuple (Ipv4EndPoint *endPoint)
+{
+  FourTuple key;
+  key.localAddress = endPoint->GetLocalAddress ();
+  key.peerAddress = endPoint->GetPeerAddress ();
+  key.localPort = endPoint->GetLocalPort ();
+  key.peerPort = endPoint->GetPeerPort ();
+  return key;
+}
+
+bool
+Ipv4EndPointDemux::IsFullySpecified (Ipv4EndPoint *endPoint)
+{
+  return endPoint->GetLocalAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+void
+Ipv4EndPointDemux::Hash (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  if (IsFullySpecified (endPoint))
+    {
+      m_connected[GetFourTuple (endPoint)].push_back (endPoint);
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port) 
+      m_wildcards.push_back (endPoint);
+    }
+}
+
+bool
+Ipv4EndPointDemux::Unhash (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (endPoint->m_demux != this)
+    {
+      return false;
+    }
+  if (IsFullySpecified (endPoint))
+    {
+      ConnectedEndPoints::iterator it = m_connected.find (GetFourTuple (endPoint));
+      if (it == m_connected.end ())
         {
+          return false;
+        }
+      for (EndPointsI i = it->second.begin (); i != it->second.end (); i++)
+        {
+          if (*i == endPoint)
+            {
+              it->second.erase (i);
+              if (it->second.empty ())
+                {
+                  m_connected.erase (it);
+                }
+              return true;
+            }
+        }
+      return false;
+    }
+  for (EndPointsI i = m_wildcards.begin (); i != m_wildcards.end (); i++)
+    {
+      if (*i == endPoint)
+        {
+          m_wildcards.erase (i);
           return true;
         }
     }
   return false;
 }
 
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  Hash (endPoint);
+  m_localPorts[endPoint->GetLocalPort ()]++;
+  NS_LOG_DEBUG ("Now have >>" << m_connected.size () << "<< connected and >>"
+                << m_wildcards.size () << "<< other endpoints.");
+  return endPoint;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_localPorts.find (port) != m_localPorts.end ();
+}
+
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
+  EndPoints endPoints = GetAllEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
           (*i)->GetLocalAddress () == addr) 
@@ -82,10 +185,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -98,10 +198,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -121,10 +218,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -132,40 +226,53 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  bool duplicate = false;
+  if (IsFullySpecified (endPoint))
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
+      duplicate = m_connected.find (GetFourTuple (endPoint)) != m_connected.end ();
+    }
+  else
+    {
+      for (EndPointsI i = m_wildcards.begin (); i != m_wildcards.end (); i++) 
         {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
+          if ((*i)->GetLocalPort () == localPort &&
+              (*i)->GetLocalAddress () == localAddress &&
+              (*i)->GetPeerPort () == peerPort &&
+              (*i)->GetPeerAddress () == peerAddress) 
+            {
+              duplicate = true;
+              break;
+            }
         }
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  if (duplicate)
+    {
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      delete endPoint;
+      return 0;
+    }
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (!Unhash (endPoint))
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  std::map<uint16_t, uint32_t>::iterator it = m_localPorts.find (endPoint->GetLocalPort ());
+  NS_ASSERT (it != m_localPorts.end ());
+  if (--it->second == 0)
+    {
+      m_localPorts.erase (it);
     }
+  delete endPoint;
 }
 
 /*
@@ -175,12 +282,11 @@ Ipv4EndPointDemux::EndPoints
 Ipv4EndPointDemux::GetAllEndPoints (void)
 {
   NS_LOG_FUNCTION (this);
-  EndPoints ret;
+  EndPoints ret = m_wildcards;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (ConnectedEndPoints::iterator i = m_connected.begin (); i != m_connected.end (); i++)
     {
-      Ipv4EndPoint* endP = *i;
-      ret.push_back (endP);
+      ret.insert (ret.end (), i->second.begin (), i->second.end ());
     }
   return ret;
 }
@@ -203,8 +309,63 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval3; // Matches all but local address
   EndPoints retval4; // Exact match on all 4
 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  Ptr<NetDevice> incomingDevice = 0;
+  if (incomingInterface != 0)
+    {
+      incomingDevice = incomingInterface->GetDevice ();
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+            {
+              subnetDirected = true;
+              incomingInterfaceAddr = addr.GetLocal ();
+            }
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  // A fully specified endpoint can only be a full match, whose local
+  // address is the one of the interface when the packet is a broadcast
+  FourTuple key;
+  key.localAddress = incomingInterfaceAddr;
+  key.peerAddress = saddr;
+  key.localPort = dport;
+  key.peerPort = sport;
+  ConnectedEndPoints::iterator connected = m_connected.find (key);
+  if (connected != m_connected.end ())
+    {
+      for (EndPointsI i = connected->second.begin (); i != connected->second.end (); i++)
+        {
+          Ipv4EndPoint* endP = *i;
+          if (!endP->IsRxEnabled ())
+            {
+              NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                            << " because endpoint can not receive packets");
+              continue;
+            }
+          if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingDevice)
+            {
+              NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                            << " because endpoint is bound to specific device and"
+                            << endP->GetBoundNetDevice ()
+                            << " does not match packet device " << incomingDevice);
+              continue;
+            }
+          retval4.push_back (endP);
+        }
+      if (!retval4.empty ())
+        {
+          return retval4;
+        }
+    }
+
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointsI i = m_wildcards.begin (); i != m_wildcards.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -230,29 +391,15 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
         }
       if (endP->GetBoundNetDevice ())
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+          if (endP->GetBoundNetDevice () != incomingDevice)
             {
               NS_LOG_LOGIC ("Skipping endpoint " << &endP
                                                  << " because endpoint is bound to specific device and"
                                                  << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
+                                                 << " does not match packet device " << incomingDevice);
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
@@ -304,7 +451,7 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
       if (localAddressMatchesExact &&
           remotePeerMatchesExact &&
           remoteAddressMatchesExact)
-        { // All 4 match
+        { // All 4 match, with a packet from the any address or port
           retval4.push_back (endP);
         }
     }
@@ -324,11 +471,24 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  FourTuple key;
+  key.localAddress = daddr;
+  key.peerAddress = saddr;
+  key.localPort = dport;
+  key.peerPort = sport;
+  ConnectedEndPoints::iterator connected = m_connected.find (key);
+  if (connected != m_connected.end ())
+    {
+      /* this is an exact match. */
+      return connected->second.front ();
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints endPoints = GetAllEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () != dport) 
         {
@@ -358,6 +518,7 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
     }
   return generic;
 }
+
 uint16_t
 Ipv4EndPointDemux::AllocateEphemeralPort (void)
 {
@@ -23,7 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -34,10 +36,19 @@ class Ipv4EndPoint;
  * \brief Demultiplexes packets to various transport layer endpoints
  *
  * This class serves as a lookup table to match partial or full information
- * about a four-tuple to an ns3::Ipv4EndPoint.  It internally contains a list
- * of endpoints, and has APIs to add and find endpoints in this demux.  This
- * code is shared in common to TCP and UDP protocols in ns3.  This demux
- * sits between ns3's layer four and the socket layer
+ * about a four-tuple to an ns3::Ipv4EndPoint.  It has APIs to add and find
+ * endpoints in this demux.  This code is shared in common to TCP and UDP
+ * protocols in ns3.  This demux sits between ns3's layer four and the socket
+ * layer
+ *
+ * The endpoints are kept in two tiers.  The fully specified ones (local
+ * address, peer address and peer port all set, i.e. the connected sockets)
+ * are hashed on their four-tuple, so that finding the connection of a packet
+ * does not depend on how many connections there are.  All the others
+ * (listening and unconnected sockets) stay in a list, which is searched the
+ * way the whole demux used to be.  An endpoint moves between the tiers by
+ * itself when its addresses change (see Ipv4EndPoint::SetPeer and
+ * Ipv4EndPoint::SetLocalAddress).
  */
 
 class Ipv4EndPointDemux {
@@ -161,6 +172,80 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Key of the fully specified endpoints.
+   */
+  struct FourTuple
+  {
+    Ipv4Address localAddress; //!< Local address
+    Ipv4Address peerAddress;  //!< Peer address
+    uint16_t localPort;       //!< Local port
+    uint16_t peerPort;        //!< Peer port
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the four-tuple to compare with
+     * \return true if all the fields are equal
+     */
+    bool operator == (const FourTuple &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param x the four-tuple
+     * \return the hash
+     */
+    size_t operator () (const FourTuple &x) const;
+  };
+
+  /**
+   * \brief Fully specified endpoints, by four-tuple.
+   *
+   * Several endpoints may share a four-tuple when they are bound to
+   * different devices, hence a list.
+   */
+  typedef sgi::hash_map<FourTuple, EndPoints, FourTupleHash> ConnectedEndPoints;
+
+  /**
+   * \brief Build the four-tuple of an endpoint.
+   * \param endPoint the endpoint
+   * \return the four-tuple of the endpoint
+   */
+  static FourTuple GetFourTuple (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Whether an endpoint belongs to the hashed tier.
+   * \param endPoint the endpoint
+   * \return true if the local address, peer address and peer port are set
+   */
+  static bool IsFullySpecified (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Insert an endpoint in the tier matching its current addresses.
+   * \param endPoint the endpoint
+   */
+  void Hash (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the tier it was inserted in.
+   * \param endPoint the endpoint
+   * \return false if the endpoint is not in this demux
+   */
+  bool Unhash (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the demux.
+   * \param endPoint the endpoint
+   * \return the endpoint
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -184,9 +269,19 @@ private:
   uint16_t m_portFirst;
 
   /**
-   * \brief A list of IPv4 end points.
+   * \brief The fully specified IPv4 end points.
+   */
+  ConnectedEndPoints m_connected;
+
+  /**
+   * \brief The IPv4 end points with a wildcard address or port.
+   */
+  EndPoints m_wildcards;
+
+  /**
+   * \brief Number of end points using each local port.
    */
-  EndPoints m_endPoints;
+  std::map<uint16_t, uint32_t> m_localPorts;
 };
 
 } // namespace ns3
@@ -48,6 +48,11 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_randomEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if flows are routed among ECMP by a hash of their 5-tuple, so that all the packets of a flow follow the same path",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -59,7 +64,10 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_flowEcmpRouting (false),
+    m_respondToInterfaceEvents (false),
+    m_ecmpSalt (0),
+    m_ecmpSaltSet (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -136,10 +144,49 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
 }
 
 
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (Ptr<const Packet> p, const Ipv4Header &header)
+{
+  if (!m_ecmpSaltSet)
+    {
+      // Salt the hash with the node id, so that the choices made by the
+      // different stages of a fabric are not correlated
+      Ptr<Node> node = m_ipv4->GetObject<Node> ();
+      m_ecmpSalt = node ? node->GetId () : 0;
+      m_ecmpSaltSet = true;
+    }
+
+  uint32_t ports = 0;
+  uint8_t protocol = header.GetProtocol ();
+  if (p != 0 && (protocol == 6 || protocol == 17) && p->GetSize () >= 4)
+    { // TCP and UDP start with the source and destination ports
+      uint8_t buf[4];
+      p->CopyData (buf, 4);
+      ports = (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+    }
+
+  uint32_t words[4] = { header.GetSource ().Get (), header.GetDestination ().Get (),
+                        ports, protocol };
+  uint32_t h = m_ecmpSalt;
+  for (uint32_t i = 0; i < 4; ++i)
+    { // MurmurHash3 mixing of each word, then its finalizer
+      uint32_t k = words[i] * 0xcc9e2d51;
+      k = (k << 15) | (k >> 17);
+      h ^= k * 0x1b873593;
+      h = ((h << 13) | (h >> 19)) * 5 + 0xe6546b64;
+    }
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif, uint32_t flowHash)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_FUNCTION (this << dest << oif << flowHash);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
@@ -217,13 +264,18 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
       // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
+      // ECMP routing is enabled, by the flow hash if flow ECMP routing
+      // is enabled, or always select the first route consistently
+      // otherwise
       uint32_t selectIndex;
       if (m_randomEcmpRouting)
         {
           selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
         }
+      else if (m_flowEcmpRouting)
+        {
+          selectIndex = flowHash % allRoutes.size ();
+        }
       else 
         {
           selectIndex = 0;
@@ -468,7 +520,8 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  uint32_t flowHash = m_flowEcmpRouting ? GetFlowHash (p, header) : 0;
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif, flowHash);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +570,8 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  uint32_t flowHash = m_flowEcmpRouting ? GetFlowHash (p, header) : 0;
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), 0, flowHash);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -37,31 +37,127 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPoints endPoints = GetEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
       delete endPoint;
     }
-  m_endPoints.clear ();
+  m_connected.clear ();
+  m_wildcards.clear ();
+  m_localPorts.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+bool Ipv6EndPointDemux::FourTuple::operator == (const FourTuple &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::FourTupleHash::operator () (const FourTuple &x) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t h = addressHash (x.localAddress);
+  h = h * 0x9e3779b97f4a7c15ULL + addressHash (x.peerAddress);
+  h = h * 0x9e3779b97f4a7c15ULL + (static_cast<uint32_t> (x.peerPort) << 16 | x.localPort);
+  h ^= h >> 32;
+  return static_cast<size_t> (h);
+}
+
+Ipv6EndPointDemux::FourTuple Ipv6EndPointDemux::GetFourTuple (Ipv6EndPoint *endPoint)
+{
+  FourTuple key;
+  key.localAddress = endPoint->GetLocalAddress ();
+  key.peerAddress = endPoint->GetPeerAddress ();
+  key.localPort = endPoint->GetLocalPort ();
+  key.peerPort = endPoint->GetPeerPort ();
+  return key;
+}
+
+bool Ipv6EndPointDemux::IsFullySpecified (Ipv6EndPoint *endPoint)
+{
+  return endPoint->GetLocalAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+void Ipv6EndPointDemux::Hash (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  if (IsFullySpecified (endPoint))
+    {
+      m_connected[GetFourTuple (endPoint)].push_back (endPoint);
+    }
+  else
+    {
+      m_wildcards.push_back (endPoint);
+    }
+}
+
+bool Ipv6EndPointDemux::Unhash (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (endPoint->m_demux != this)
+    {
+      return false;
+    }
+  if (IsFullySpecified (endPoint))
     {
-      if ((*i)->GetLocalPort  () == port)
+      ConnectedEndPoints::iterator it = m_connected.find (GetFourTuple (endPoint));
+      if (it == m_connected.end ())
         {
+          return false;
+        }
+      for (EndPointsI i = it->second.begin (); i != it->second.end (); i++)
+        {
+          if (*i == endPoint)
+            {
+              it->second.erase (i);
+              if (it->second.empty ())
+                {
+                  m_connected.erase (it);
+                }
+              return true;
+            }
+        }
+      return false;
+    }
+  for (EndPointsI i = m_wildcards.begin (); i != m_wildcards.end (); i++)
+    {
+      if (*i == endPoint)
+        {
+          m_wildcards.erase (i);
           return true;
         }
     }
   return false;
 }
 
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  Hash (endPoint);
+  m_localPorts[endPoint->GetLocalPort ()]++;
+  NS_LOG_DEBUG ("Now have >>" << m_connected.size () << "<< connected and >>"
+                << m_wildcards.size () << "<< other endpoints.");
+  return endPoint;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_localPorts.find (port) != m_localPorts.end ();
+}
+
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
+  EndPoints endPoints = GetEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port
           && (*i)->GetLocalAddress () == addr)
@@ -81,10 +177,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -96,10 +189,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (uint16_t port)
@@ -117,49 +207,59 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t localPort,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  bool duplicate = false;
+  if (IsFullySpecified (endPoint))
+    {
+      duplicate = m_connected.find (GetFourTuple (endPoint)) != m_connected.end ();
+    }
+  else
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
+      for (EndPointsI i = m_wildcards.begin (); i != m_wildcards.end (); i++)
         {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
+          if ((*i)->GetLocalPort () == localPort
+              && (*i)->GetLocalAddress () == localAddress
+              && (*i)->GetPeerPort () == peerPort
+              && (*i)->GetPeerAddress () == peerAddress)
+            {
+              duplicate = true;
+              break;
+            }
         }
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  if (duplicate)
+    {
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      delete endPoint;
+      return 0;
+    }
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (!Unhash (endPoint))
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  std::map<uint16_t, uint32_t>::iterator it = m_localPorts.find (endPoint->GetLocalPort ());
+  NS_ASSERT (it != m_localPorts.end ());
+  if (--it->second == 0)
+    {
+      m_localPorts.erase (it);
     }
+  delete endPoint;
 }
 
 /*
@@ -178,8 +278,41 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval3; /* Matches all but local address */
   EndPoints retval4; /* Exact match on all 4 */
 
+  /* A fully specified endpoint can only be a full match */
+  FourTuple key;
+  key.localAddress = daddr;
+  key.peerAddress = saddr;
+  key.localPort = dport;
+  key.peerPort = sport;
+  ConnectedEndPoints::iterator connected = m_connected.find (key);
+  if (connected != m_connected.end ())
+    {
+      for (EndPointsI i = connected->second.begin (); i != connected->second.end (); i++)
+        {
+          Ipv6EndPoint* endP = *i;
+          if (!endP->IsRxEnabled ())
+            {
+              NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                            << " because endpoint can not receive packets");
+              continue;
+            }
+          if (endP->GetBoundNetDevice ()
+              && (!incomingInterface || endP->GetBoundNetDevice () != incomingInterface->GetDevice ()))
+            {
+              NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                            << " because endpoint is bound to specific device");
+              continue;
+            }
+          retval4.push_back (endP);
+        }
+      if (!retval4.empty ())
+        {
+          return retval4;
+        }
+    }
+
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointsI i = m_wildcards.begin (); i != m_wildcards.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -293,10 +426,23 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  FourTuple key;
+  key.localAddress = dst;
+  key.peerAddress = src;
+  key.localPort = dport;
+  key.peerPort = sport;
+  ConnectedEndPoints::iterator connected = m_connected.find (key);
+  if (connected != m_connected.end ())
+    {
+      /* this is an exact match. */
+      return connected->second.front ();
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPoints endPoints = GetEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
     {
       uint32_t tmp = 0;
 
@@ -355,7 +501,12 @@ uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
 {
-  return m_endPoints;
+  EndPoints ret = m_wildcards;
+  for (ConnectedEndPoints::const_iterator i = m_connected.begin (); i != m_connected.end (); i++)
+    {
+      ret.insert (ret.end (), i->second.begin (), i->second.end ());
+    }
+  return ret;
 }
 
 } /* namespace ns3 */
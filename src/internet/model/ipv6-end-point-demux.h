@@ -23,7 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv6-interface.h"
 
 namespace ns3 {
@@ -33,6 +35,10 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * As in Ipv4EndPointDemux, the fully specified endpoints are hashed on
+ * their four-tuple, and only the listening and unconnected ones are
+ * searched linearly.
  */
 class Ipv6EndPointDemux
 {
@@ -146,6 +152,78 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Key of the fully specified endpoints.
+   */
+  struct FourTuple
+  {
+    Ipv6Address localAddress; //!< Local address
+    Ipv6Address peerAddress;  //!< Peer address
+    uint16_t localPort;       //!< Local port
+    uint16_t peerPort;        //!< Peer port
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the four-tuple to compare with
+     * \return true if all the fields are equal
+     */
+    bool operator == (const FourTuple &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param x the four-tuple
+     * \return the hash
+     */
+    size_t operator () (const FourTuple &x) const;
+  };
+
+  /**
+   * \brief Fully specified endpoints, by four-tuple.
+   */
+  typedef sgi::hash_map<FourTuple, EndPoints, FourTupleHash> ConnectedEndPoints;
+
+  /**
+   * \brief Build the four-tuple of an endpoint.
+   * \param endPoint the endpoint
+   * \return the four-tuple of the endpoint
+   */
+  static FourTuple GetFourTuple (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Whether an endpoint belongs to the hashed tier.
+   * \param endPoint the endpoint
+   * \return true if the local address, peer address and peer port are set
+   */
+  static bool IsFullySpecified (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Insert an endpoint in the tier matching its current addresses.
+   * \param endPoint the endpoint
+   */
+  void Hash (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the tier it was inserted in.
+   * \param endPoint the endpoint
+   * \return false if the endpoint is not in this demux
+   */
+  bool Unhash (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the demux.
+   * \param endPoint the endpoint
+   * \return the endpoint
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -168,9 +246,19 @@ private:
   uint16_t m_portLast;
 
   /**
-   * \brief A list of IPv6 end points.
+   * \brief The fully specified IPv6 end points.
+   */
+  ConnectedEndPoints m_connected;
+
+  /**
+   * \brief The IPv6 end points with a wildcard address or port.
+   */
+  EndPoints m_wildcards;
+
+  /**
+   * \brief Number of end points using each local port.
    */
-  EndPoints m_endPoints;
+  std::map<uint16_t, uint32_t> m_localPorts;
 };
 
 } /* namespace ns3 */
@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 
 #include "ipv6-end-point.h"
+#include "ipv6-end-point-demux.h"
 
 namespace ns3
 {
@@ -34,7 +35,8 @@ Ipv6EndPoint::Ipv6EndPoint (Ipv6Address addr, uint16_t port)
     m_localPort (port),
     m_peerAddr (Ipv6Address::GetAny ()),
     m_peerPort (0),
-    m_rxEnabled (true)
+    m_rxEnabled (true),
+    m_demux (0)
 {
 }
 
@@ -56,7 +58,13 @@ Ipv6Address Ipv6EndPoint::GetLocalAddress ()
 
 void Ipv6EndPoint::SetLocalAddress (Ipv6Address addr)
 {
+  // The demux indexes fully specified endpoints by their addresses
+  bool hashed = m_demux != 0 && m_demux->Unhash (this);
   m_localAddr = addr;
+  if (hashed)
+    {
+      m_demux->Hash (this);
+    }
 }
 
 uint16_t Ipv6EndPoint::GetLocalPort ()
@@ -92,8 +100,13 @@ Ptr<NetDevice> Ipv6EndPoint::GetBoundNetDevice (void)
 
 void Ipv6EndPoint::SetPeer (Ipv6Address addr, uint16_t port)
 {
+  bool hashed = m_demux != 0 && m_demux->Unhash (this);
   m_peerAddr = addr;
   m_peerPort = port;
+  if (hashed)
+    {
+      m_demux->Hash (this);
+    }
 }
 
 void Ipv6EndPoint::SetRxCallback (Callback<void, Ptr<Packet>, Ipv6Header, uint16_t, Ptr<Ipv6Interface> > callback)
@@ -63,6 +63,12 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Set the CE codepoint if the packet is ECN capable
+   * \return true if the packet has been marked
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-ack-policy.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpAckPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpAckPolicy);
+
+TypeId
+TcpAckPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpAckPolicy")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("QuickAckOnCe",
+                   "Acknowledge CE-marked segments at once",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpAckPolicy::m_quickAckOnCe),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("AckedSegments",
+                     "Segments received in sequence covered by each ACK sent",
+                     MakeTraceSourceAccessor (&TcpAckPolicy::m_ackedSegments),
+                     "ns3::TcpAckPolicy::AckedSegmentsTracedCallback")
+  ;
+  return tid;
+}
+
+TcpAckPolicy::TcpAckPolicy ()
+  : Object (),
+    m_quickAckOnCe (false),
+    m_pending (0),
+    m_quickAck (false)
+{
+}
+
+TcpAckPolicy::TcpAckPolicy (const TcpAckPolicy &other)
+  : Object (other),
+    m_quickAckOnCe (other.m_quickAckOnCe),
+    m_pending (0),
+    m_quickAck (false),
+    m_ackedSegments (other.m_ackedSegments)
+{
+}
+
+TcpAckPolicy::~TcpAckPolicy ()
+{
+}
+
+Time
+TcpAckPolicy::DataReceived (uint32_t segments, bool ceMarked,
+                            uint32_t delAckCount, Time delAckTimeout)
+{
+  NS_LOG_FUNCTION (this << segments << ceMarked << delAckCount << delAckTimeout);
+
+  m_pending += segments;
+  if (m_quickAck)
+    {
+      NS_LOG_LOGIC ("Quick ACK");
+      m_quickAck = false;
+      return Time (0);
+    }
+  if (ceMarked && m_quickAckOnCe)
+    {
+      NS_LOG_LOGIC ("Quick ACK of a CE mark");
+      return Time (0);
+    }
+  return DoDataReceived (delAckCount, delAckTimeout);
+}
+
+void
+TcpAckPolicy::AckSent (void)
+{
+  if (m_pending > 0)
+    {
+      m_ackedSegments (m_pending);
+      m_pending = 0;
+    }
+}
+
+void
+TcpAckPolicy::QuickAck (void)
+{
+  m_quickAck = true;
+}
+
+uint32_t
+TcpAckPolicy::GetPendingSegments (void) const
+{
+  return m_pending;
+}
+
+// Delayed ACK
+
+NS_OBJECT_ENSURE_REGISTERED (TcpDelayedAckPolicy);
+
+TypeId
+TcpDelayedAckPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpDelayedAckPolicy")
+    .SetParent<TcpAckPolicy> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpDelayedAckPolicy> ()
+  ;
+  return tid;
+}
+
+TcpDelayedAckPolicy::TcpDelayedAckPolicy ()
+  : TcpAckPolicy ()
+{
+}
+
+TcpDelayedAckPolicy::TcpDelayedAckPolicy (const TcpDelayedAckPolicy &other)
+  : TcpAckPolicy (other)
+{
+}
+
+std::string
+TcpDelayedAckPolicy::GetName () const
+{
+  return "TcpDelayedAckPolicy";
+}
+
+Ptr<TcpAckPolicy>
+TcpDelayedAckPolicy::Fork (void)
+{
+  return CopyObject<TcpDelayedAckPolicy> (this);
+}
+
+Time
+TcpDelayedAckPolicy::DoDataReceived (uint32_t delAckCount, Time delAckTimeout)
+{
+  if (GetPendingSegments () >= delAckCount)
+    {
+      return Time (0);
+    }
+  return delAckTimeout;
+}
+
+// Per-segment ACK
+
+NS_OBJECT_ENSURE_REGISTERED (TcpPerSegmentAckPolicy);
+
+TypeId
+TcpPerSegmentAckPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpPerSegmentAckPolicy")
+    .SetParent<TcpAckPolicy> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpPerSegmentAckPolicy> ()
+  ;
+  return tid;
+}
+
+TcpPerSegmentAckPolicy::TcpPerSegmentAckPolicy ()
+  : TcpAckPolicy ()
+{
+}
+
+TcpPerSegmentAckPolicy::TcpPerSegmentAckPolicy (const TcpPerSegmentAckPolicy &other)
+  : TcpAckPolicy (other)
+{
+}
+
+std::string
+TcpPerSegmentAckPolicy::GetName () const
+{
+  return "TcpPerSegmentAckPolicy";
+}
+
+Ptr<TcpAckPolicy>
+TcpPerSegmentAckPolicy::Fork (void)
+{
+  return CopyObject<TcpPerSegmentAckPolicy> (this);
+}
+
+Time
+TcpPerSegmentAckPolicy::DoDataReceived (uint32_t delAckCount, Time delAckTimeout)
+{
+  return Time (0);
+}
+
+// Time-based coalescing
+
+NS_OBJECT_ENSURE_REGISTERED (TcpCoalescingAckPolicy);
+
+TypeId
+TcpCoalescingAckPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCoalescingAckPolicy")
+    .SetParent<TcpAckPolicy> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpCoalescingAckPolicy> ()
+    .AddAttribute ("Interval",
+                   "Longest delay of an ACK after the first segment it covers",
+                   TimeValue (MicroSeconds (8)),
+                   MakeTimeAccessor (&TcpCoalescingAckPolicy::m_interval),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("MaxSegments",
+                   "Segments acknowledged at once, zero for no limit",
+                   UintegerValue (32),
+                   MakeUintegerAccessor (&TcpCoalescingAckPolicy::m_maxSegments),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+TcpCoalescingAckPolicy::TcpCoalescingAckPolicy ()
+  : TcpAckPolicy (),
+    m_interval (MicroSeconds (8)),
+    m_maxSegments (32)
+{
+}
+
+TcpCoalescingAckPolicy::TcpCoalescingAckPolicy (const TcpCoalescingAckPolicy &other)
+  : TcpAckPolicy (other),
+    m_interval (other.m_interval),
+    m_maxSegments (other.m_maxSegments)
+{
+}
+
+std::string
+TcpCoalescingAckPolicy::GetName () const
+{
+  return "TcpCoalescingAckPolicy";
+}
+
+Ptr<TcpAckPolicy>
+TcpCoalescingAckPolicy::Fork (void)
+{
+  return CopyObject<TcpCoalescingAckPolicy> (this);
+}
+
+Time
+TcpCoalescingAckPolicy::DoDataReceived (uint32_t delAckCount, Time delAckTimeout)
+{
+  if ((m_maxSegments > 0 && GetPendingSegments () >= m_maxSegments) || m_interval.IsZero ())
+    {
+      return Time (0);
+    }
+  return m_interval;
+}
+
+} // namespace ns3
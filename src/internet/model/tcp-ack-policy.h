@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_ACK_POLICY_H
+#define TCP_ACK_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief When a TCP receiver acknowledges the data received in sequence
+ *
+ * The socket asks the policy, for every data segment received in sequence,
+ * whether to acknowledge it at once or how long the ACK may be delayed; the
+ * ACK is then sent when that delay, counted from the first segment not yet
+ * acknowledged, expires. Out-of-order segments, and segments filling a
+ * hole, are always acknowledged at once (RFC 5681), as is the first data
+ * segment of a connection (see QuickAck).
+ *
+ * The policy counts the segments received since the last ACK sent, whether
+ * the ACK was a pure one or was piggybacked on data, and reports how many
+ * segments each ACK covered with the "AckedSegments" trace source: with
+ * per-segment RTT samples, an ACK covering several segments stretches the
+ * samples of the older ones.
+ *
+ * With "QuickAckOnCe", a CE-marked segment is acknowledged at once, so that
+ * the congestion signal is echoed without delay.
+ */
+class TcpAckPolicy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpAckPolicy ();
+
+  /**
+   * \brief Copy constructor.
+   * \param other object to copy.
+   */
+  TcpAckPolicy (const TcpAckPolicy &other);
+
+  virtual ~TcpAckPolicy ();
+
+  /**
+   * \brief Callback signature of the "AckedSegments" trace source
+   * \param segments the segments covered by the ACK
+   */
+  typedef void (* AckedSegmentsTracedCallback)(uint32_t segments);
+
+  /**
+   * \brief Get the name of the policy
+   * \return A string identifying the name
+   */
+  virtual std::string GetName () const = 0;
+
+  /**
+   * \brief Decide when to acknowledge data received in sequence
+   *
+   * \param segments the segments received (a super-segment counts as the
+   *        segments it holds)
+   * \param ceMarked true if the segment carried a CE mark
+   * \param delAckCount the DelAckCount of the socket
+   * \param delAckTimeout the DelAckTimeout of the socket
+   * \return zero to acknowledge now, else the longest the ACK may be delayed
+   */
+  Time DataReceived (uint32_t segments, bool ceMarked,
+                     uint32_t delAckCount, Time delAckTimeout);
+
+  /**
+   * \brief An ACK has been sent, acknowledging all the data received
+   */
+  void AckSent (void);
+
+  /**
+   * \brief Acknowledge the next data segment at once
+   */
+  void QuickAck (void);
+
+  /**
+   * \return the segments received since the last ACK
+   */
+  uint32_t GetPendingSegments (void) const;
+
+  /**
+   * \brief Copy the policy, for a forked socket
+   * \return a copy of the policy, without its state
+   */
+  virtual Ptr<TcpAckPolicy> Fork (void) = 0;
+
+protected:
+  /**
+   * \brief Decide when to acknowledge, the segments pending included
+   *
+   * \param delAckCount the DelAckCount of the socket
+   * \param delAckTimeout the DelAckTimeout of the socket
+   * \return zero to acknowledge now, else the longest the ACK may be delayed
+   */
+  virtual Time DoDataReceived (uint32_t delAckCount, Time delAckTimeout) = 0;
+
+private:
+  bool m_quickAckOnCe;                       //!< Acknowledge CE-marked segments at once
+  uint32_t m_pending;                        //!< Segments received since the last ACK
+  bool m_quickAck;                           //!< Acknowledge the next segment at once
+  TracedCallback<uint32_t> m_ackedSegments;  //!< Segments covered by each ACK
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The delayed ACK of RFC 1122 and RFC 5681
+ *
+ * An ACK for every DelAckCount segments, or DelAckTimeout after the first
+ * segment not acknowledged; the parameters are the attributes of the
+ * socket. This is the default policy.
+ */
+class TcpDelayedAckPolicy : public TcpAckPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpDelayedAckPolicy ();
+
+  /**
+   * \brief Copy constructor.
+   * \param other object to copy.
+   */
+  TcpDelayedAckPolicy (const TcpDelayedAckPolicy &other);
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpAckPolicy> Fork (void);
+
+protected:
+  virtual Time DoDataReceived (uint32_t delAckCount, Time delAckTimeout);
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief An ACK for every segment
+ */
+class TcpPerSegmentAckPolicy : public TcpAckPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpPerSegmentAckPolicy ();
+
+  /**
+   * \brief Copy constructor.
+   * \param other object to copy.
+   */
+  TcpPerSegmentAckPolicy (const TcpPerSegmentAckPolicy &other);
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpAckPolicy> Fork (void);
+
+protected:
+  virtual Time DoDataReceived (uint32_t delAckCount, Time delAckTimeout);
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Time-based ACK coalescing, as NIC interrupt moderation does
+ *
+ * The segments received within Interval of the first one not acknowledged
+ * are acknowledged together, when Interval expires, or as soon as
+ * MaxSegments of them have arrived (if not zero). This is the rx-usecs and
+ * rx-frames pair of the interrupt coalescing of a NIC, seen from the
+ * transport: the ACK rate follows the data rate up to one ACK per
+ * MaxSegments, and never drops below one ACK per Interval while data flows.
+ * The socket DelAckCount and DelAckTimeout are not used.
+ */
+class TcpCoalescingAckPolicy : public TcpAckPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpCoalescingAckPolicy ();
+
+  /**
+   * \brief Copy constructor.
+   * \param other object to copy.
+   */
+  TcpCoalescingAckPolicy (const TcpCoalescingAckPolicy &other);
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpAckPolicy> Fork (void);
+
+protected:
+  virtual Time DoDataReceived (uint32_t delAckCount, Time delAckTimeout);
+
+private:
+  Time m_interval;         //!< Longest delay of an ACK
+  uint32_t m_maxSegments;  //!< Segments acknowledged at once, 0 for no limit
+};
+
+} // namespace ns3
+
+#endif // TCP_ACK_POLICY_H
@@ -36,22 +36,75 @@ TcpCongestionOps::GetTypeId (void)
                   CallbackValue(),
 		  MakeCallbackAccessor(&TcpCongestionOps::m_rttcallback),
                   MakeCallbackChecker())
+    .AddAttribute ("TraceFlowRTTCallback",
+                   "Callback to record RTTs, with the identifier of the flow",
+                   CallbackValue (),
+                   MakeCallbackAccessor (&TcpCongestionOps::m_flowRttCallback),
+                   MakeCallbackChecker ())
   ;
   return tid;
 }
 
-TcpCongestionOps::TcpCongestionOps () : Object ()
+uint32_t TcpCongestionOps::m_nextFlowId = 0;
+
+TcpCongestionOps::TcpCongestionOps ()
+  : Object (),
+    m_flowId (m_nextFlowId++)
 {
 }
 
-TcpCongestionOps::TcpCongestionOps (const TcpCongestionOps &other) : Object (other)
+TcpCongestionOps::TcpCongestionOps (const TcpCongestionOps &other)
+  : Object (other),
+    m_rttcallback (other.m_rttcallback),
+    m_flowRttCallback (other.m_flowRttCallback),
+    m_flowId (m_nextFlowId++)
 {
 }
 
+uint32_t
+TcpCongestionOps::GetFlowId (void) const
+{
+  return m_flowId;
+}
+
+void
+TcpCongestionOps::TraceRtt (const Time &rtt) const
+{
+  if (!m_rttcallback.IsNull ())
+    {
+      m_rttcallback (rtt.GetMicroSeconds ());
+    }
+  if (!m_flowRttCallback.IsNull ())
+    {
+      m_flowRttCallback (m_flowId, rtt.GetMicroSeconds ());
+    }
+}
+
 TcpCongestionOps::~TcpCongestionOps ()
 {
 }
 
+void
+TcpCongestionOps::PktsAckedBatch (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                                  const std::vector<TcpRttSample> &samples)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << samples.size ());
+
+  if (samples.empty ())
+    {
+      PktsAcked (tcb, segmentsAcked, Time (0));
+      return;
+    }
+
+  uint32_t remaining = segmentsAcked;
+  for (uint32_t i = 0; i < samples.size (); ++i)
+    {
+      uint32_t acked = (i + 1 == samples.size ()) ? remaining : std::min (remaining, 1U);
+      remaining -= acked;
+      PktsAcked (tcb, acked, samples[i].rtt);
+    }
+}
+
 
 // RENO
 
@@ -200,7 +253,10 @@ TcpNewReno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
 
 void TcpNewReno::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
                           const Time& rtt) {
-    if (!m_rttcallback.IsNull()) m_rttcallback(rtt.GetMicroSeconds());  
+  if (!rtt.IsZero ())
+    {
+      TraceRtt (rtt);
+    }
 }
 
 
@@ -59,6 +59,32 @@ public:
 
   virtual ~TcpCongestionOps ();
 
+  /**
+   * \brief Capabilities a congestion control can advertise to the socket
+   *
+   * The socket reads the capabilities once, when the algorithm is installed
+   * (or the socket is forked), and uses them to decide which of its own
+   * window manipulations should be skipped. In this way an algorithm can
+   * change the socket behaviour without being special-cased by name.
+   */
+  typedef enum
+  {
+    CAP_NONE = 0,                     /**< Plain window-based algorithm */
+    CAP_OWNS_CWND = 1 << 0,           /**< The algorithm alone sets cWnd; the socket
+                                        *  must not inflate/deflate/reset it during
+                                        *  fast recovery or after an RTO */
+    CAP_RAW_RTT = 1 << 1,             /**< PktsAcked wants the raw RTT sample
+                                        *  instead of the smoothed estimate */
+    CAP_SEGMENT_RTT = 1 << 2,         /**< PktsAcked wants one raw RTT sample per
+                                        *  segment completed, not one per ACK */
+    CAP_TELEMETRY = 1 << 3,           /**< The socket requests in-band telemetry on
+                                        *  its data segments, and exposes the echoed
+                                        *  path occupancy in TcpSocketState */
+    CAP_ECN = 1 << 4                  /**< The socket sends ECN capable data segments,
+                                        *  and calls EcnEchoReceived for every ACK
+                                        *  carrying the ECE flag */
+  } TcpCaCapability_t;
+
   /**
    * \brief Get the name of the congestion control algorithm
    *
@@ -66,6 +92,18 @@ public:
    */
   virtual std::string GetName () const = 0;
 
+  /**
+   * \brief Get the capabilities of the congestion control algorithm
+   *
+   * The default implementation returns CAP_NONE.
+   *
+   * \return A bitmask of TcpCaCapability_t values
+   */
+  virtual uint32_t GetCapabilities () const
+  {
+    return CAP_NONE;
+  }
+
   /**
    * \brief Get the slow start threshold after a loss event
    *
@@ -113,6 +151,26 @@ public:
   {
   }
 
+  /**
+   * \brief Timing information on received ACK, one sample per segment
+   *
+   * Called in place of PktsAcked, once per ACK, by sockets serving an
+   * algorithm that advertises CAP_SEGMENT_RTT. The samples are in sequence
+   * order, and the vector is empty if the ACK completed no segment with a
+   * valid sample (e.g. a duplicate ACK).
+   *
+   * The default implementation calls PktsAcked for each sample, spreading
+   * segmentsAcked over the calls, or once with a zero RTT if there is no
+   * sample. Algorithms which filter the samples should override it, to
+   * process the whole batch without a virtual call per segment.
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments acked
+   * \param samples per-segment RTT samples
+   */
+  virtual void PktsAckedBatch (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                               const std::vector<TcpRttSample> &samples);
+
   /**
    * \brief Trigger events/calculations specific to a congestion state
    *
@@ -127,6 +185,20 @@ public:
   {
   }
 
+  /**
+   * \brief Congestion notification from the receiver
+   *
+   * Called, for algorithms advertising CAP_ECN, when an ACK carries the
+   * ECE flag, i.e. the receiver got a segment marked with Congestion
+   * Experienced. The receiver echoes each mark on its next ACK only, so
+   * the call rate follows the marking rate.
+   *
+   * \param tcb internal congestion state
+   */
+  virtual void EcnEchoReceived (Ptr<TcpSocketState> tcb)
+  {
+  }
+
   // Present in Linux but not in ns-3 yet:
   /* call when cwnd event occurs (optional) */
   // void (*cwnd_event)(struct sock *sk, enum tcp_ca_event ev);
@@ -144,8 +216,30 @@ public:
    */
   virtual Ptr<TcpCongestionOps> Fork () = 0;
 
+  /**
+   * \brief Get the identifier of the flow served by this instance
+   *
+   * Every instance, including the ones obtained with Fork, gets a
+   * distinct identifier, which is passed to the TraceFlowRTTCallback.
+   *
+   * \return the flow identifier
+   */
+  uint32_t GetFlowId (void) const;
+
 protected:
-  Callback<void, int64_t> m_rttcallback;
+  /**
+   * \brief Report an RTT sample to the RTT callbacks, if any
+   *
+   * \param rtt the RTT sample
+   */
+  void TraceRtt (const Time &rtt) const;
+
+  Callback<void, int64_t> m_rttcallback;                //!< Aggregate RTT callback (us)
+  Callback<void, uint32_t, int64_t> m_flowRttCallback;  //!< Per-flow RTT callback (flow id, us)
+  uint32_t m_flowId;                                    //!< Flow identifier
+
+private:
+  static uint32_t m_nextFlowId;                         //!< Identifier of the next instance
 };
 
 /**
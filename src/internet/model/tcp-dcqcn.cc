@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-dcqcn.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpDcqcn");
+NS_OBJECT_ENSURE_REGISTERED (TcpDcqcn);
+
+/// Maximum number of increase events run at once after an idle period; the rate has converged long before
+static const uint32_t MAX_LAZY_EVENTS = 64;
+
+TypeId
+TcpDcqcn::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpDcqcn")
+    .SetParent<TcpRateCongestionOps> ()
+    .AddConstructor<TcpDcqcn> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("G", "Gain of the alpha update",
+                   DoubleValue (1.0 / 256),
+                   MakeDoubleAccessor (&TcpDcqcn::m_g),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("AlphaUpdatePeriod", "Period of the alpha decay without CNP",
+                   TimeValue (MicroSeconds (55)),
+                   MakeTimeAccessor (&TcpDcqcn::m_alphaUpdatePeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("RateIncreasePeriod", "Period of the timer rate increase events",
+                   TimeValue (MicroSeconds (55)),
+                   MakeTimeAccessor (&TcpDcqcn::m_rateIncreasePeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("ByteCounter", "Bytes ACKed between two byte counter rate increase events",
+                   UintegerValue (10 * 1024 * 1024),
+                   MakeUintegerAccessor (&TcpDcqcn::m_byteCounter),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("F", "Number of fast recovery events",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&TcpDcqcn::m_f),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RateAI", "Additive increase step of the target rate",
+                   DataRateValue (DataRate ("40Mbps")),
+                   MakeDataRateAccessor (&TcpDcqcn::m_rateAi),
+                   MakeDataRateChecker ())
+    .AddAttribute ("RateHAI", "Hyper increase step of the target rate",
+                   DataRateValue (DataRate ("200Mbps")),
+                   MakeDataRateAccessor (&TcpDcqcn::m_rateHai),
+                   MakeDataRateChecker ())
+    .AddAttribute ("CnpInterval", "Minimum interval between two CNPs taken into account",
+                   TimeValue (MicroSeconds (50)),
+                   MakeTimeAccessor (&TcpDcqcn::m_cnpInterval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("TargetRate",
+                     "Target rate (bps)",
+                     MakeTraceSourceAccessor (&TcpDcqcn::m_targetRate),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("Alpha",
+                     "Congestion estimate",
+                     MakeTraceSourceAccessor (&TcpDcqcn::m_alpha),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+TcpDcqcn::TcpDcqcn (void)
+  : TcpRateCongestionOps (),
+    m_g (1.0 / 256),
+    m_alphaUpdatePeriod (MicroSeconds (55)),
+    m_rateIncreasePeriod (MicroSeconds (55)),
+    m_byteCounter (10 * 1024 * 1024),
+    m_f (5),
+    m_rateAi (DataRate ("40Mbps")),
+    m_rateHai (DataRate ("200Mbps")),
+    m_cnpInterval (MicroSeconds (50)),
+    m_targetRate (0),
+    m_alpha (1),
+    m_lastCnp (Time::Min ()),
+    m_lastAlphaUpdate (Time (0)),
+    m_lastTimerEvent (Time (0)),
+    m_bytesAcked (0),
+    m_timerEvents (0),
+    m_byteEvents (0),
+    m_cnpInPeriod (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpDcqcn::TcpDcqcn (const TcpDcqcn& sock)
+  : TcpRateCongestionOps (sock),
+    m_g (sock.m_g),
+    m_alphaUpdatePeriod (sock.m_alphaUpdatePeriod),
+    m_rateIncreasePeriod (sock.m_rateIncreasePeriod),
+    m_byteCounter (sock.m_byteCounter),
+    m_f (sock.m_f),
+    m_rateAi (sock.m_rateAi),
+    m_rateHai (sock.m_rateHai),
+    m_cnpInterval (sock.m_cnpInterval),
+    m_targetRate (sock.m_targetRate),
+    m_alpha (sock.m_alpha),
+    m_lastCnp (sock.m_lastCnp),
+    m_lastAlphaUpdate (sock.m_lastAlphaUpdate),
+    m_lastTimerEvent (sock.m_lastTimerEvent),
+    m_bytesAcked (sock.m_bytesAcked),
+    m_timerEvents (sock.m_timerEvents),
+    m_byteEvents (sock.m_byteEvents),
+    m_cnpInPeriod (sock.m_cnpInPeriod)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpDcqcn::~TcpDcqcn (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpDcqcn::GetName () const
+{
+  return "TcpDcqcn";
+}
+
+Ptr<TcpCongestionOps>
+TcpDcqcn::Fork (void)
+{
+  return CopyObject<TcpDcqcn> (this);
+}
+
+uint32_t
+TcpDcqcn::GetCapabilities () const
+{
+  return TcpRateCongestionOps::GetCapabilities () | CAP_ECN;
+}
+
+void
+TcpDcqcn::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                              const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+
+  TcpRateCongestionOps::CongestionStateSet (tcb, newState);
+
+  // Only a new connection starts the counters; recovery keeps them
+  if (newState == TcpSocketState::CA_OPEN && m_targetRate == 0)
+    {
+      m_targetRate = m_rate;
+      m_lastAlphaUpdate = Simulator::Now ();
+      ResetCounters ();
+    }
+}
+
+void
+TcpDcqcn::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                     const Time& rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  TcpRateCongestionOps::PktsAcked (tcb, segmentsAcked, rtt);
+
+  if (m_targetRate == 0)
+    {
+      return;
+    }
+
+  UpdateAlpha ();
+
+  Time now = Simulator::Now ();
+  if (now - m_lastTimerEvent >= m_rateIncreasePeriod)
+    {
+      int64_t periods = (now - m_lastTimerEvent) / m_rateIncreasePeriod;
+      m_lastTimerEvent += m_rateIncreasePeriod * periods;
+      for (int64_t i = 0; i < std::min<int64_t> (periods, MAX_LAZY_EVENTS); ++i)
+        {
+          m_timerEvents++;
+          IncreaseRate ();
+        }
+    }
+
+  m_bytesAcked += static_cast<uint64_t> (segmentsAcked) * tcb->m_segmentSize;
+  while (m_bytesAcked >= m_byteCounter)
+    {
+      m_bytesAcked -= m_byteCounter;
+      m_byteEvents++;
+      IncreaseRate ();
+    }
+
+  UpdateRate (tcb);
+}
+
+void
+TcpDcqcn::EcnEchoReceived (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  Time now = Simulator::Now ();
+  if (m_lastCnp + m_cnpInterval > now)
+    {
+      NS_LOG_LOGIC ("ECE within the CNP interval, ignored");
+      return;
+    }
+  m_lastCnp = now;
+
+  UpdateAlpha ();
+
+  m_targetRate = m_rate;
+  m_rate = m_rate * (1 - m_alpha / 2);
+  m_alpha = (1 - m_g) * m_alpha + m_g;
+  m_cnpInPeriod = true;
+  ResetCounters ();
+
+  UpdateRate (tcb);
+  NS_LOG_INFO ("CNP: rate " << m_rate << " target " << m_targetRate << " alpha " << m_alpha);
+}
+
+void
+TcpDcqcn::UpdateAlpha (void)
+{
+  Time now = Simulator::Now ();
+  if (now - m_lastAlphaUpdate < m_alphaUpdatePeriod)
+    {
+      return;
+    }
+
+  int64_t periods = (now - m_lastAlphaUpdate) / m_alphaUpdatePeriod;
+  m_lastAlphaUpdate += m_alphaUpdatePeriod * periods;
+
+  // The period holding a CNP has already been accounted for by the cut
+  if (m_cnpInPeriod)
+    {
+      periods--;
+      m_cnpInPeriod = false;
+    }
+  m_alpha = m_alpha * std::pow (1 - m_g, static_cast<double> (periods));
+}
+
+void
+TcpDcqcn::IncreaseRate (void)
+{
+  uint32_t maxEvents = std::max (m_timerEvents, m_byteEvents);
+  uint32_t minEvents = std::min (m_timerEvents, m_byteEvents);
+
+  if (minEvents > m_f)
+    {
+      m_targetRate += (minEvents - m_f) * static_cast<double> (m_rateHai.GetBitRate ());
+    }
+  else if (maxEvents >= m_f)
+    {
+      m_targetRate += m_rateAi.GetBitRate ();
+    }
+  m_targetRate = std::min (m_targetRate.Get (), static_cast<double> (m_maxRate.GetBitRate ()));
+
+  m_rate = (m_targetRate + m_rate) / 2;
+}
+
+void
+TcpDcqcn::ResetCounters (void)
+{
+  m_lastTimerEvent = Simulator::Now ();
+  m_bytesAcked = 0;
+  m_timerEvents = 0;
+  m_byteEvents = 0;
+}
+
+} // namespace ns3
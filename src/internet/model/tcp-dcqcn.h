@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCPDCQCN_H
+#define TCPDCQCN_H
+
+#include "ns3/tcp-rate-congestion-ops.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief An implementation of the DCQCN reaction point over TCP
+ *
+ * DCQCN is the ECN-driven rate control of RoCEv2. Switches mark packets
+ * with RED-like probabilities (see the "UseEcn" attribute of RedQueueDisc);
+ * here the congestion notification packets (CNP) are the ACKs carrying the
+ * ECE flag, of which at most one per CnpInterval is taken into account, as
+ * the notification point of DCQCN would do.
+ *
+ * On a CNP the target rate Rt takes the current rate Rc, and
+ *
+ *              Rc = Rc * (1 - alpha / 2)
+ *              alpha = (1 - g) * alpha + g
+ *
+ * Without CNP, alpha decays by (1 - g) every AlphaUpdatePeriod. The rate
+ * increases on two counters: one event every RateIncreasePeriod (timer)
+ * and one every ByteCounter bytes acknowledged (byte counter). Each event
+ * runs one of
+ *
+ * - fast recovery, while both counters are below F: Rc = (Rt + Rc) / 2
+ * - additive increase, once one of them reaches F: Rt += RateAI, then
+ *   Rc = (Rt + Rc) / 2
+ * - hyper increase, once both exceed F: Rt += i * RateHAI, with i the
+ *   number of events past F, then Rc = (Rt + Rc) / 2
+ *
+ * There are no timers: the periods elapsed are accounted for lazily, when
+ * an ACK or a CNP arrives, which is when the rate can be used anyway.
+ *
+ * The rate is handled by TcpRateCongestionOps, like Timely's.
+ *
+ * More information: http://dx.doi.org/10.1145/2785956.2787484
+ */
+class TcpDcqcn : public TcpRateCongestionOps
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpDcqcn (void);
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpDcqcn (const TcpDcqcn& sock);
+  virtual ~TcpDcqcn (void);
+
+  virtual std::string GetName () const;
+
+  /**
+   * \return the capabilities of TcpRateCongestionOps, plus CAP_ECN
+   */
+  virtual uint32_t GetCapabilities () const;
+
+  /**
+   * \brief Run the rate increase events elapsed since the last ACK
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments ACKed
+   * \param rtt last RTT
+   */
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+
+  /**
+   * \brief Cut the rate, at most once per CnpInterval
+   *
+   * \param tcb internal congestion state
+   */
+  virtual void EcnEchoReceived (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Start the counters when a connection enters the open state
+   *
+   * \param tcb internal congestion state
+   * \param newState new congestion state to which the TCP is going to switch
+   */
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+private:
+  /**
+   * \brief Apply the alpha decay of the update periods without CNP
+   */
+  void UpdateAlpha (void);
+
+  /**
+   * \brief Run one rate increase event
+   */
+  void IncreaseRate (void);
+
+  /**
+   * \brief Restart the counters, after a cut or at the start of a connection
+   */
+  void ResetCounters (void);
+
+  double m_g;                        //!< Alpha update gain
+  Time m_alphaUpdatePeriod;          //!< Period of the alpha decay
+  Time m_rateIncreasePeriod;         //!< Period of the timer increase events
+  uint32_t m_byteCounter;            //!< Bytes between two byte counter increase events
+  uint32_t m_f;                      //!< Fast recovery events
+  DataRate m_rateAi;                 //!< Additive increase step
+  DataRate m_rateHai;                //!< Hyper increase step
+  Time m_cnpInterval;                //!< Minimum interval between two CNPs
+  TracedValue<double> m_targetRate;  //!< Target rate Rt (bps)
+  TracedValue<double> m_alpha;       //!< Congestion estimate
+  Time m_lastCnp;                    //!< Time of the last CNP taken into account
+  Time m_lastAlphaUpdate;            //!< End of the last alpha update period
+  Time m_lastTimerEvent;             //!< End of the last timer period
+  uint64_t m_bytesAcked;             //!< Bytes ACKed since the last byte counter event
+  uint32_t m_timerEvents;            //!< Timer events since the last cut
+  uint32_t m_byteEvents;             //!< Byte counter events since the last cut
+  bool m_cnpInPeriod;                //!< A CNP arrived in the current alpha period
+};
+
+} // namespace ns3
+
+#endif // TCPDCQCN_H
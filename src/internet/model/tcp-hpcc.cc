@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-hpcc.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpHpcc");
+NS_OBJECT_ENSURE_REGISTERED (TcpHpcc);
+
+TypeId
+TcpHpcc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpHpcc")
+    .SetParent<TcpRateCongestionOps> ()
+    .AddConstructor<TcpHpcc> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("Eta", "Target utilization of the bottleneck link",
+                   DoubleValue (0.95),
+                   MakeDoubleAccessor (&TcpHpcc::m_eta),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxStage", "Additive increase stages before a multiplicative update",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&TcpHpcc::m_maxStage),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RateAI", "Additive increase step",
+                   DataRateValue (DataRate ("50Mbps")),
+                   MakeDataRateAccessor (&TcpHpcc::m_rateAi),
+                   MakeDataRateChecker ())
+    .AddAttribute ("BaseRtt", "Base RTT of the network, normalizing the queueing delay",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&TcpHpcc::m_baseRtt),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Utilization",
+                     "Normalized inflight of the bottleneck link",
+                     MakeTraceSourceAccessor (&TcpHpcc::m_utilization),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+TcpHpcc::TcpHpcc (void)
+  : TcpRateCongestionOps (),
+    m_eta (0.95),
+    m_maxStage (5),
+    m_rateAi (DataRate ("50Mbps")),
+    m_baseRtt (MicroSeconds (10)),
+    m_refRate (0),
+    m_incStage (0),
+    m_lastUpdateSeq (0),
+    m_utilization (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpHpcc::TcpHpcc (const TcpHpcc& sock)
+  : TcpRateCongestionOps (sock),
+    m_eta (sock.m_eta),
+    m_maxStage (sock.m_maxStage),
+    m_rateAi (sock.m_rateAi),
+    m_baseRtt (sock.m_baseRtt),
+    m_refRate (sock.m_refRate),
+    m_incStage (sock.m_incStage),
+    m_lastUpdateSeq (sock.m_lastUpdateSeq),
+    m_utilization (sock.m_utilization)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpHpcc::~TcpHpcc (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpHpcc::GetName () const
+{
+  return "TcpHpcc";
+}
+
+Ptr<TcpCongestionOps>
+TcpHpcc::Fork (void)
+{
+  return CopyObject<TcpHpcc> (this);
+}
+
+uint32_t
+TcpHpcc::GetCapabilities () const
+{
+  return TcpRateCongestionOps::GetCapabilities () | CAP_TELEMETRY;
+}
+
+void
+TcpHpcc::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                             const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+
+  TcpRateCongestionOps::CongestionStateSet (tcb, newState);
+
+  if (newState == TcpSocketState::CA_OPEN && m_refRate == 0)
+    {
+      m_refRate = m_rate;
+      m_lastUpdateSeq = tcb->m_nextTxSequence;
+    }
+}
+
+void
+TcpHpcc::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                    const Time& rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  TcpRateCongestionOps::PktsAcked (tcb, segmentsAcked, rtt);
+
+  if (m_refRate == 0)
+    {
+      return;
+    }
+
+  double u = tcb->m_pathQueueDelay.GetSeconds () / m_baseRtt.GetSeconds ()
+    + tcb->m_pathUtilization;
+  m_utilization = u;
+
+  // The reference rate moves once per RTT, when the data sent at the last
+  // update is acknowledged; in between, each ACK recomputes from it
+  bool updateReference = tcb->m_lastAckedSeq > m_lastUpdateSeq;
+  if (updateReference)
+    {
+      m_lastUpdateSeq = tcb->m_nextTxSequence;
+    }
+
+  double rate;
+  if (u >= m_eta || m_incStage >= m_maxStage)
+    {
+      // Without any load echoed the multiplicative step is unbounded; MaxRate caps it
+      rate = (u > 0) ? m_refRate * m_eta / u : m_maxRate.GetBitRate ();
+      rate += m_rateAi.GetBitRate ();
+      if (updateReference)
+        {
+          m_incStage = 0;
+        }
+    }
+  else
+    {
+      rate = m_refRate + m_rateAi.GetBitRate ();
+      if (updateReference)
+        {
+          m_incStage++;
+        }
+    }
+
+  m_rate = rate;
+  UpdateRate (tcb);
+
+  if (updateReference)
+    {
+      m_refRate = m_rate;
+    }
+  NS_LOG_INFO ("U " << u << " rate " << m_rate << " reference " << m_refRate <<
+               " stage " << m_incStage);
+}
+
+} // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/object-vector.h"
 
 #include "ns3/packet.h"
@@ -42,11 +43,13 @@
 #include "tcp-socket-factory-impl.h"
 #include "tcp-socket-base.h"
 #include "tcp-congestion-ops.h"
+#include "tcp-ack-policy.h"
 #include "rtt-estimator.h"
 
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <typeinfo>
 
 namespace ns3 {
 
@@ -63,6 +66,9 @@ NS_OBJECT_ENSURE_REGISTERED (TcpL4Protocol);
 /* see http://www.iana.org/assignments/protocol-numbers */
 const uint8_t TcpL4Protocol::PROT_NUMBER = 6;
 
+/// Closed sockets looked at by a creation before building a new one
+static const uint32_t SOCKET_POOL_PROBES = 8;
+
 TypeId
 TcpL4Protocol::GetTypeId (void)
 {
@@ -80,16 +86,29 @@ TcpL4Protocol::GetTypeId (void)
                    TypeIdValue (TcpNewReno::GetTypeId ()),
                    MakeTypeIdAccessor (&TcpL4Protocol::m_congestionTypeId),
                    MakeTypeIdChecker ())
+    .AddAttribute ("AckPolicyType",
+                   "Type of the ACK policy of TCP objects.",
+                   TypeIdValue (TcpDelayedAckPolicy::GetTypeId ()),
+                   MakeTypeIdAccessor (&TcpL4Protocol::m_ackPolicyTypeId),
+                   MakeTypeIdChecker ())
     .AddAttribute ("SocketList", "The list of sockets associated to this protocol.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("SocketPoolSize",
+                   "Closed sockets kept to be recycled by the next creations; "
+                   "0 disables the pool and the prototypes",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpL4Protocol::m_socketPoolSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_socketPoolSize (0),
+    m_recycledSockets (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_LOGIC ("Made a TcpL4Protocol " << this);
@@ -155,6 +174,9 @@ TcpL4Protocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
+  m_socketPool.clear ();
+  m_socketPrototype = 0;
+  m_congestionPrototypes.clear ();
 
   if (m_endPoints != 0)
     {
@@ -178,10 +200,17 @@ Ptr<Socket>
 TcpL4Protocol::CreateSocket (TypeId congestionTypeId)
 {
   NS_LOG_FUNCTION (this << congestionTypeId.GetName ());
+  if (m_socketPoolSize > 0)
+    {
+      return CreatePooledSocket (congestionTypeId);
+    }
+
   ObjectFactory rttFactory;
   ObjectFactory congestionAlgorithmFactory;
+  ObjectFactory ackPolicyFactory;
   rttFactory.SetTypeId (m_rttTypeId);
   congestionAlgorithmFactory.SetTypeId (congestionTypeId);
+  ackPolicyFactory.SetTypeId (m_ackPolicyTypeId);
 
   Ptr<RttEstimator> rtt = rttFactory.Create<RttEstimator> ();
   Ptr<TcpSocketBase> socket = CreateObject<TcpSocketBase> ();
@@ -191,6 +220,7 @@ TcpL4Protocol::CreateSocket (TypeId congestionTypeId)
   socket->SetTcp (this);
   socket->SetRtt (rtt);
   socket->SetCongestionControlAlgorithm (algo);
+  socket->SetAckPolicy (ackPolicyFactory.Create<TcpAckPolicy> ());
 
   m_sockets.push_back (socket);
   return socket;
@@ -202,6 +232,74 @@ TcpL4Protocol::CreateSocket (void)
   return CreateSocket (m_congestionTypeId);
 }
 
+Ptr<TcpSocketBase>
+TcpL4Protocol::CreatePooledSocket (TypeId congestionTypeId)
+{
+  NS_LOG_FUNCTION (this << congestionTypeId.GetName ());
+
+  if (m_socketPrototype == 0)
+    {
+      ObjectFactory rttFactory;
+      ObjectFactory ackPolicyFactory;
+      rttFactory.SetTypeId (m_rttTypeId);
+      ackPolicyFactory.SetTypeId (m_ackPolicyTypeId);
+
+      m_socketPrototype = CreateObject<TcpSocketBase> ();
+      m_socketPrototype->SetNode (m_node);
+      m_socketPrototype->SetTcp (this);
+      m_socketPrototype->SetRtt (rttFactory.Create<RttEstimator> ());
+      m_socketPrototype->SetAckPolicy (ackPolicyFactory.Create<TcpAckPolicy> ());
+    }
+
+  Ptr<TcpCongestionOps> &congestion = m_congestionPrototypes[congestionTypeId];
+  if (congestion == 0)
+    {
+      ObjectFactory congestionAlgorithmFactory;
+      congestionAlgorithmFactory.SetTypeId (congestionTypeId);
+      congestion = congestionAlgorithmFactory.Create<TcpCongestionOps> ();
+    }
+
+  // The closed sockets still held by their application are moved to the
+  // back; the ones closed now may still have events about to run
+  Ptr<TcpSocketBase> socket;
+  for (uint32_t i = 0; i < SOCKET_POOL_PROBES && !m_socketPool.empty (); ++i)
+    {
+      std::list<PooledSocket>::iterator it = m_socketPool.begin ();
+      if (it->released == Simulator::Now ())
+        {
+          break;
+        }
+      if (it->socket->GetReferenceCount () == 1)
+        {
+          socket = it->socket;
+          m_socketPool.erase (it);
+          break;
+        }
+      m_socketPool.splice (m_socketPool.end (), m_socketPool, it);
+    }
+
+  if (socket != 0)
+    {
+      NS_LOG_LOGIC ("Recycling socket " << socket);
+      socket->Recycle (m_socketPrototype);
+      m_recycledSockets++;
+    }
+  else
+    {
+      socket = CopyObject<TcpSocketBase> (m_socketPrototype);
+    }
+  socket->SetCongestionControlAlgorithm (congestion->Fork ());
+
+  m_sockets.push_back (socket);
+  return socket;
+}
+
+uint64_t
+TcpL4Protocol::GetRecycledSockets (void) const
+{
+  return m_recycledSockets;
+}
+
 Ipv4EndPoint *
 TcpL4Protocol::Allocate (void)
 {
@@ -712,6 +810,19 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
       if (*it == socket)
         {
           m_sockets.erase (it);
+          // Sockets of derived classes are left alone: Recycle would not
+          // reset their own members
+          if (m_socketPoolSize > 0 && typeid (*socket) == typeid (TcpSocketBase))
+            {
+              if (m_socketPool.size () >= m_socketPoolSize)
+                {
+                  m_socketPool.pop_front ();
+                }
+              PooledSocket pooled;
+              pooled.socket = socket;
+              pooled.released = Simulator::Now ();
+              m_socketPool.push_back (pooled);
+            }
           return true;
         }
 
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-rate-congestion-ops.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpRateCongestionOps");
+NS_OBJECT_ENSURE_REGISTERED (TcpRateCongestionOps);
+
+TypeId
+TcpRateCongestionOps::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpRateCongestionOps")
+    .SetParent<TcpNewReno> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("MinRate", "Lower bound of the sending rate",
+                   DataRateValue (DataRate ("10Mbps")),
+                   MakeDataRateAccessor (&TcpRateCongestionOps::m_minRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("MaxRate", "Upper bound of the sending rate, also used as initial rate",
+                   DataRateValue (DataRate ("10Gbps")),
+                   MakeDataRateAccessor (&TcpRateCongestionOps::m_maxRate),
+                   MakeDataRateChecker ())
+    .AddTraceSource ("Rate",
+                     "Sending rate (bps)",
+                     MakeTraceSourceAccessor (&TcpRateCongestionOps::m_rate),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+TcpRateCongestionOps::TcpRateCongestionOps (void)
+  : TcpNewReno (),
+    m_rate (0),
+    m_minRate (DataRate ("10Mbps")),
+    m_maxRate (DataRate ("10Gbps")),
+    m_lastRtt (Time (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpRateCongestionOps::TcpRateCongestionOps (const TcpRateCongestionOps& sock)
+  : TcpNewReno (sock),
+    m_rate (sock.m_rate),
+    m_minRate (sock.m_minRate),
+    m_maxRate (sock.m_maxRate),
+    m_lastRtt (sock.m_lastRtt)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpRateCongestionOps::~TcpRateCongestionOps (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpRateCongestionOps::GetName () const
+{
+  return "TcpRateCongestionOps";
+}
+
+Ptr<TcpCongestionOps>
+TcpRateCongestionOps::Fork (void)
+{
+  return CopyObject<TcpRateCongestionOps> (this);
+}
+
+uint32_t
+TcpRateCongestionOps::GetCapabilities () const
+{
+  return CAP_OWNS_CWND | CAP_RAW_RTT;
+}
+
+void
+TcpRateCongestionOps::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                                 const Time& rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  if (!rtt.IsZero ())
+    {
+      TraceRtt (rtt);
+      m_lastRtt = rtt;
+    }
+}
+
+void
+TcpRateCongestionOps::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                          const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+  if (newState == TcpSocketState::CA_OPEN)
+    {
+      InitRate (tcb);
+    }
+}
+
+void
+TcpRateCongestionOps::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+  UpdateRate (tcb);
+}
+
+uint32_t
+TcpRateCongestionOps::GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                   uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+  return std::max (tcb->m_cWnd.Get (), 2 * tcb->m_segmentSize);
+}
+
+void
+TcpRateCongestionOps::InitRate (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  // The rate survives recovery; only a new connection starts at line rate
+  if (m_rate == 0)
+    {
+      m_rate = m_maxRate.GetBitRate ();
+    }
+  UpdateRate (tcb);
+}
+
+void
+TcpRateCongestionOps::UpdateRate (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  double rate = std::max (m_rate.Get (), static_cast<double> (m_minRate.GetBitRate ()));
+  m_rate = std::min (rate, static_cast<double> (m_maxRate.GetBitRate ()));
+  tcb->m_pacingRate = DataRate (static_cast<uint64_t> (m_rate));
+
+  if (!m_lastRtt.IsZero ())
+    {
+      double bdp = m_rate / 8 * m_lastRtt.GetSeconds ();
+      tcb->m_cWnd = static_cast<uint32_t> (std::max (2 * bdp, 2.0 * tcb->m_segmentSize));
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_RATE_CONGESTION_OPS_H
+#define TCP_RATE_CONGESTION_OPS_H
+
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/traced-value.h"
+#include "ns3/data-rate.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Base class of the rate-based datacenter congestion controls
+ *
+ * Rate-based algorithms (Timely, DCQCN, HPCC) compute a sending rate
+ * instead of a window. This class holds the machinery they share:
+ *
+ * - the rate, in bits per second, clamped between MinRate and MaxRate
+ *   and exported as the "Rate" trace source;
+ * - its publication to the socket as TcpSocketState::m_pacingRate;
+ * - the congestion window, only kept as a safety bound of twice the bytes
+ *   in flight that the rate produces over the last RTT;
+ * - the RTT callbacks of TcpCongestionOps, fed with every sample.
+ *
+ * A new connection starts at MaxRate; the rate survives loss recovery.
+ * The algorithms own the window (TcpCongestionOps::CAP_OWNS_CWND) and take
+ * raw RTT samples (TcpCongestionOps::CAP_RAW_RTT).
+ *
+ * Subclasses set m_rate and call UpdateRate.
+ */
+class TcpRateCongestionOps : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpRateCongestionOps (void);
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpRateCongestionOps (const TcpRateCongestionOps& sock);
+  virtual ~TcpRateCongestionOps (void);
+
+  virtual std::string GetName () const;
+
+  /**
+   * \return CAP_OWNS_CWND | CAP_RAW_RTT
+   */
+  virtual uint32_t GetCapabilities () const;
+
+  /**
+   * \brief Record the RTT sample, and report it to the RTT callbacks
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments ACKed
+   * \param rtt last RTT
+   */
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+
+  /**
+   * \brief Start at MaxRate when a connection enters the open state
+   *
+   * \param tcb internal congestion state
+   * \param newState new congestion state to which the TCP is going to switch
+   */
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+
+  /**
+   * \brief Keep cwnd as a bound on the rate
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments ACKed
+   */
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+  /**
+   * \brief The window is bound to the rate, and is not reduced on loss
+   *
+   * \param tcb internal congestion state
+   * \param bytesInFlight bytes in flight
+   *
+   * \return the current cWnd, at least two segments
+   */
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+protected:
+  /**
+   * \brief Start at MaxRate, unless a rate has already been computed
+   *
+   * \param tcb internal congestion state
+   */
+  void InitRate (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Clamp the rate and publish it to the socket
+   *
+   * The rate is set as the pacing rate, and cWnd is set to twice the amount
+   * of data the rate puts in flight during the last measured RTT.
+   *
+   * \param tcb internal congestion state
+   */
+  void UpdateRate (Ptr<TcpSocketState> tcb);
+
+  TracedValue<double> m_rate;        //!< Current sending rate (bps)
+  DataRate m_minRate;                //!< Lower bound of the sending rate
+  DataRate m_maxRate;                //!< Upper bound (and initial value) of the sending rate
+  Time m_lastRtt;                    //!< Last RTT sample, used to bound cWnd
+};
+
+} // namespace ns3
+
+#endif // TCP_RATE_CONGESTION_OPS_H
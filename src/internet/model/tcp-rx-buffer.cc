@@ -52,7 +52,8 @@ TcpRxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpRxBuffer::TcpRxBuffer (uint32_t n)
-  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0)
+  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0),
+    m_readSeq (n)
 {
 }
 
@@ -96,6 +97,45 @@ TcpRxBuffer::Available () const
   return m_availBytes;
 }
 
+uint32_t
+TcpRxBuffer::HoleCount (void) const
+{
+  return m_blocks.size ();
+}
+
+TcpOptionSack::SackList
+TcpRxBuffer::GetSackList (void) const
+{
+  TcpOptionSack::SackList list;
+  std::map<SequenceNumber32, Block>::const_iterator last = m_blocks.find (m_lastBlockSeq);
+  if (last != m_blocks.end ())
+    {
+      list.push_back (TcpOptionSack::SackBlock (last->first, last->second.tail));
+    }
+  for (std::map<SequenceNumber32, Block>::const_iterator i = m_blocks.begin (); i != m_blocks.end (); ++i)
+    {
+      if (i != last)
+        {
+          list.push_back (TcpOptionSack::SackBlock (i->first, i->second.tail));
+        }
+    }
+  return list;
+}
+
+SequenceNumber32
+TcpRxBuffer::HeadSequence (void) const
+{
+  if (m_availBytes)
+    {
+      return m_readSeq;
+    }
+  else if (m_blocks.size ())
+    {
+      return m_blocks.begin ()->first;
+    }
+  return m_nextRxSeq;
+}
+
 void
 TcpRxBuffer::IncNextRxSequence ()
 {
@@ -114,9 +154,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size ())
+  else if (m_size)
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return HeadSequence () + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -143,81 +183,103 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_LOG_FUNCTION (this << p << tcph);
 
   uint32_t pktSize = p->GetSize ();
-  SequenceNumber32 headSeq = tcph.GetSequenceNumber ();
+  SequenceNumber32 pktSeq = tcph.GetSequenceNumber ();
+  SequenceNumber32 headSeq = pktSeq;
   SequenceNumber32 tailSeq = headSeq + SequenceNumber32 (pktSize);
   NS_LOG_LOGIC ("Add pkt " << p << " len=" << pktSize << " seq=" << headSeq
                            << ", when NextRxSeq=" << m_nextRxSeq << ", buffsize=" << m_size);
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (m_size)
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = HeadSequence () + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
-      if (tailSeq < headSeq) headSeq = tailSeq;
-    }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
-    {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
-        {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
-            { // Incoming head is overlapped
-              headSeq = lastByteSeq;
-            }
-          if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-              tailSeq = i->first;
-            }
-        }
-      ++i;
     }
-  // We now know how much we are going to store, trim the packet
   if (headSeq >= tailSeq)
     {
       NS_LOG_LOGIC ("Nothing to buffer");
-      return false; // Nothing to buffer anyway
+      return false;
     }
-  else
+
+  // First block touching the packet: the one before it if it reaches headSeq,
+  // else the first one after it
+  BlockIterator i = m_blocks.upper_bound (headSeq);
+  if (i != m_blocks.begin ())
     {
-      uint32_t start = headSeq - tcph.GetSequenceNumber ();
-      uint32_t length = tailSeq - headSeq;
-      p = p->CreateFragment (start, length);
-      NS_ASSERT (length == p->GetSize ());
+      BlockIterator prev = i;
+      --prev;
+      if (prev->second.tail >= headSeq)
+        {
+          i = prev;
+        }
     }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+
+  // Coalesce the packet with the blocks it touches, filling the holes between
+  // them with the pieces of the packet
+  SequenceNumber32 blockSeq = headSeq;
+  SequenceNumber32 coveredSeq = headSeq;  // Every byte before is in data
+  PacketList data;
+  uint32_t added = 0;
+  while (i != m_blocks.end () && i->first <= tailSeq)
     {
-      if (i->first < m_nextRxSeq)
+      if (i->first > coveredSeq)
+        {
+          uint32_t length = i->first - coveredSeq;
+          data.push_back (p->CreateFragment (coveredSeq - pktSeq, length));
+          added += length;
+        }
+      else if (i->first < blockSeq)
+        {
+          blockSeq = i->first;
+        }
+      data.splice (data.end (), i->second.data);
+      if (i->second.tail > coveredSeq)
         {
-          continue;
+          coveredSeq = i->second.tail;
+        }
+      m_blocks.erase (i++);
+    }
+  if (coveredSeq < tailSeq)
+    {
+      uint32_t length = tailSeq - coveredSeq;
+      if (length == pktSize)
+        { // The whole packet is new, keep it as is
+          data.push_back (p);
         }
-      else if (i->first > m_nextRxSeq)
+      else
         {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+          data.push_back (p->CreateFragment (coveredSeq - pktSeq, length));
+        }
+      added += length;
+      coveredSeq = tailSeq;
     }
-  NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
+  m_size += added;
+
+  if (blockSeq == m_nextRxSeq)
+    { // The block closes the first hole, it becomes readable
+      if (m_availBytes == 0)
+        {
+          m_readSeq = blockSeq;
+        }
+      m_inOrder.splice (m_inOrder.end (), data);
+      m_availBytes += coveredSeq - blockSeq;
+      m_nextRxSeq = coveredSeq;
+    }
+  else
+    {
+      Block &block = m_blocks[blockSeq];
+      block.tail = coveredSeq;
+      block.data.swap (data);
+      m_lastBlockSeq = blockSeq;
+    }
+  NS_LOG_LOGIC ("Buffered " << added << " bytes, occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq
+                            << " holes=" << m_blocks.size ());
   if (m_gotFin && m_nextRxSeq == m_finSeq)
     { // Account for the FIN packet
       ++m_nextRxSeq;
     };
-  return true;
+  return added > 0;
 }
 
 Ptr<Packet>
@@ -228,40 +290,42 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
-  NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  NS_ASSERT (m_inOrder.size ()); // At least we have something to extract
+  Ptr<Packet> outPkt; // The packet that contains all the data to return
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
-      // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      Ptr<Packet> &head = m_inOrder.front ();
+      uint32_t pktSize = head->GetSize ();
+      Ptr<Packet> piece;
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
+          piece = head;
+          m_inOrder.pop_front ();
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          piece = head->CreateFragment (0, extractSize);
+          head = head->CreateFragment (extractSize, pktSize - extractSize);
+        }
+      uint32_t pieceSize = piece->GetSize ();
+      m_size -= pieceSize;
+      m_availBytes -= pieceSize;
+      m_readSeq += pieceSize;
+      extractSize -= pieceSize;
+
+      if (outPkt == 0)
+        { // Shares the data of the buffered packet; as with AddAtEnd, its
+          // packet tags are not delivered
+          outPkt = piece->Copy ();
+          outPkt->RemoveAllPacketTags ();
+        }
+      else
+        {
+          outPkt->AddAtEnd (piece);
         }
-    }
-  if (outPkt->GetSize () == 0)
-    {
-      NS_LOG_LOGIC ("Nothing extracted.");
-      return 0;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num pkts in buffer=" << m_inOrder.size ());
   return outPkt;
 }
 
@@ -21,12 +21,14 @@
 #ifndef TCP_RX_BUFFER_H
 #define TCP_RX_BUFFER_H
 
+#include <list>
 #include <map>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
 #include "ns3/tcp-header.h"
+#include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +38,20 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The data is kept as byte ranges. The in-sequence data, ready to be read
+ * by the application, is a list of packets starting at the first unread
+ * byte. The out-of-order data is a map of blocks, by first sequence number;
+ * each block is a contiguous range holding the list of its packets.
+ * Adjacent or overlapping blocks are coalesced on insertion, so the blocks
+ * are always separated by holes, one per block.
+ *
+ * Inserting a segment is logarithmic in the number of holes: the segment
+ * is cut only where it overlaps data already received, and the blocks it
+ * touches are spliced with it. When a block reaches RCV.NXT, its packets
+ * are moved to the in-sequence list without being copied. Extract starts
+ * from a copy-on-write copy of the first buffered packet, appends the
+ * following ones, and only fragments the last one if it does not fit.
  */
 class TcpRxBuffer : public Object
 {
@@ -97,6 +113,20 @@ public:
    * \returns size of available data (in bytes)
    */
   uint32_t Available () const;
+  /**
+   * \brief Get the number of holes in the received data
+   * \returns the number of out-of-order blocks, each one preceded by a hole
+   */
+  uint32_t HoleCount (void) const;
+  /**
+   * \brief Get the out-of-order blocks, to be reported by SACK
+   *
+   * As asked by \RFC{2018}, the block holding the last segment received
+   * comes first; the others follow in sequence order.
+   *
+   * \returns the out-of-order blocks
+   */
+  TcpOptionSack::SackList GetSackList (void) const;
   /**
    * \brief Check if the buffer did receive all the data (and the connection is closed)
    * \returns true if all data have been received
@@ -126,15 +156,35 @@ public:
   Ptr<Packet> Extract (uint32_t maxSize);
 
 private:
-  /// container for data stored in the buffer
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// List of contiguous packets
+  typedef std::list<Ptr<Packet> > PacketList;
+
+  /// Out-of-order block of contiguous data
+  struct Block
+  {
+    SequenceNumber32 tail;  //!< Sequence number following the last byte of the block
+    PacketList data;        //!< Packets of the block, in sequence
+  };
+
+  /// container for out-of-order data, by first sequence number
+  typedef std::map<SequenceNumber32, Block>::iterator BlockIterator;
+
+  /**
+   * \brief Get the sequence number of the first byte held, in sequence or not
+   * \returns the sequence number of the first byte in the buffer
+   */
+  SequenceNumber32 HeadSequence (void) const;
+
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  SequenceNumber32 m_readSeq;                //!< Seqnum of the first byte available to read
+  PacketList m_inOrder;                      //!< In-sequence data, m_availBytes from m_readSeq
+  std::map<SequenceNumber32, Block> m_blocks; //!< Out-of-order data, beyond RCV.NXT
+  SequenceNumber32 m_lastBlockSeq;           //!< First seqnum of the block of the last segment added
 };
 
 } //namepsace ns3
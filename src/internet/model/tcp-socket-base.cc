@@ -39,8 +39,12 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/tsq-tag.h"
+#include "ns3/tso-tag.h"
+#include "tcp-ack-policy.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -49,6 +53,8 @@
 #include "tcp-header.h"
 #include "tcp-option-winscale.h"
 #include "tcp-option-ts.h"
+#include "tcp-option-sack-permitted.h"
+#include "tcp-option-sack.h"
 #include "rtt-estimator.h"
 #include "tcp-congestion-ops.h"
 
@@ -98,6 +104,14 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("Sack", "Enable or disable SACK option and SACK-based loss recovery",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_sackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Rack", "Detect losses with RACK when SACK is in use",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpSocketBase::m_rackEnabled),
+                   MakeBooleanChecker ())
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (1.0)), // RFC 6298 says min RTO=1 sec, but Linux uses 200ms.
@@ -121,6 +135,16 @@ TcpSocketBase::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&TcpSocketBase::GetRxBuffer),
                    MakePointerChecker<TcpRxBuffer> ())
+    .AddAttribute ("AckPolicy",
+                   "When to acknowledge the data received",
+                   PointerValue (),
+                   MakePointerAccessor (&TcpSocketBase::GetAckPolicy),
+                   MakePointerChecker<TcpAckPolicy> ())
+    .AddAttribute ("CongestionOps",
+                   "Congestion control algorithm",
+                   PointerValue (),
+                   MakePointerAccessor (&TcpSocketBase::GetCongestionControlAlgorithm),
+                   MakePointerChecker<TcpCongestionOps> ())
     .AddAttribute ("ReTxThreshold", "Threshold for fast retransmit",
                    UintegerValue (3),
                    MakeUintegerAccessor (&TcpSocketBase::m_retxThresh),
@@ -129,6 +153,29 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsqLimit",
+                   "Maximum bytes of data queued in the host below the transport "
+                   "(TCP Small Queues). Zero disables the limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsqLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("TsoMaxSize",
+                   "Largest segment handed down at once, segmented into MSS-sized "
+                   "frames by the device (segmentation offload). Zero disables it. "
+                   "Switches and routers forward the super-segment whole: each hop "
+                   "adds its full serialization time, and queues limited in packets "
+                   "count it as one.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoMaxSize),
+                   // The IPv4 total length must still fit in 16 bits
+                   MakeUintegerChecker<uint32_t> (0, 65000))
+    .AddAttribute ("AckCoalescing",
+                   "With per-segment RTT samples, which segments covered by "
+                   "one ACK are sampled",
+                   EnumValue (TcpTxTimestampRing::SAMPLE_ALL),
+                   MakeEnumAccessor (&TcpSocketBase::m_ackCoalescing),
+                   MakeEnumChecker (TcpTxTimestampRing::SAMPLE_ALL, "All",
+                                    TcpTxTimestampRing::SAMPLE_NEWEST, "Newest"))
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto),
@@ -161,6 +208,10 @@ TcpSocketBase::GetTypeId (void)
                      "Socket estimation of bytes in flight",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_bytesInFlight),
                      "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("TsqBytes",
+                     "Bytes of data queued in the host below the transport",
+                     MakeTraceSourceAccessor (&TcpSocketBase::m_tsqBytes),
+                     "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("HighestRxSequence",
                      "Highest sequence number received from peer",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_highRxMark),
@@ -238,7 +289,12 @@ TcpSocketState::TcpSocketState (void)
     m_congState (CA_OPEN),
     m_highTxMark (0),
     // Change m_nextTxSequence for non-zero initial sequence number
-    m_nextTxSequence (0)
+    m_nextTxSequence (0),
+    m_pacingRate (0),
+    m_pathQueuePackets (0),
+    m_pathQueueBytes (0),
+    m_pathQueueDelay (Time (0)),
+    m_pathUtilization (0)
 {
 }
 
@@ -252,7 +308,12 @@ TcpSocketState::TcpSocketState (const TcpSocketState &other)
     m_lastAckedSeq (other.m_lastAckedSeq),
     m_congState (other.m_congState),
     m_highTxMark (other.m_highTxMark),
-    m_nextTxSequence (other.m_nextTxSequence)
+    m_nextTxSequence (other.m_nextTxSequence),
+    m_pacingRate (other.m_pacingRate),
+    m_pathQueuePackets (other.m_pathQueuePackets),
+    m_pathQueueBytes (other.m_pathQueueBytes),
+    m_pathQueueDelay (other.m_pathQueueDelay),
+    m_pathUtilization (other.m_pathUtilization)
 {
 }
 
@@ -270,7 +331,6 @@ TcpSocketBase::TcpSocketBase (void)
     m_persistEvent (),
     m_timewaitEvent (),
     m_dupAckCount (0),
-    m_delAckCount (0),
     m_delAckMaxCount (0),
     m_noDelay (false),
     m_synCount (0),
@@ -284,6 +344,7 @@ TcpSocketBase::TcpSocketBase (void)
     m_delAckTimeout (Seconds (0.0)),
     m_persistTimeout (Seconds (0.0)),
     m_cnTimeout (Seconds (0.0)),
+    m_ackCoalescing (TcpTxTimestampRing::SAMPLE_ALL),
     m_endPoint (0),
     m_endPoint6 (0),
     m_node (0),
@@ -311,19 +372,36 @@ TcpSocketBase::TcpSocketBase (void)
     m_sndWindShift (0),
     m_timestampEnabled (true),
     m_timestampToEcho (0),
+    m_sackEnabled (false),
+    m_rackEnabled (true),
+    m_rackXmitTs (Time (0)),
+    m_rackEndSeq (0),
+    m_rackRtt (Time (0)),
+    m_rackMinRtt (Time::Max ()),
+    m_recoveryRetx (false),
     m_sendPendingDataEvent (),
+    m_telemetryEchoPending (false),
+    m_ecnEchoPending (false),
+    m_ceReceived (false),
     // Set m_recover to the initial sequence number
     m_recover (0),
     m_retxThresh (3),
     m_limitedTx (false),
     m_retransOut (0),
+    m_tsqLimit (0),
+    m_tsqOwner (0),
+    m_tsqBytes (0),
+    m_tsqThrottled (false),
+    m_tsoMaxSize (0),
     m_congestionControl (0),
+    m_congCaps (TcpCongestionOps::CAP_NONE),
     m_isFirstPartialAck (true)
 {
   NS_LOG_FUNCTION (this);
   m_rxBuffer = CreateObject<TcpRxBuffer> ();
   m_txBuffer = CreateObject<TcpTxBuffer> ();
   m_tcb      = CreateObject<TcpSocketState> ();
+  m_ackPolicy = CreateObject<TcpDelayedAckPolicy> ();
 
   bool ok;
 
@@ -347,59 +425,15 @@ TcpSocketBase::TcpSocketBase (void)
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   : TcpSocket (sock),
     //copy object::m_tid and socket::callbacks
-    m_dupAckCount (sock.m_dupAckCount),
-    m_delAckCount (0),
-    m_delAckMaxCount (sock.m_delAckMaxCount),
-    m_noDelay (sock.m_noDelay),
-    m_synCount (sock.m_synCount),
-    m_synRetries (sock.m_synRetries),
-    m_dataRetrCount (sock.m_dataRetrCount),
-    m_dataRetries (sock.m_dataRetries),
-    m_rto (sock.m_rto),
-    m_minRto (sock.m_minRto),
-    m_clockGranularity (sock.m_clockGranularity),
-    m_lastRtt (sock.m_lastRtt),
-    m_delAckTimeout (sock.m_delAckTimeout),
-    m_persistTimeout (sock.m_persistTimeout),
-    m_cnTimeout (sock.m_cnTimeout),
     m_endPoint (0),
     m_endPoint6 (0),
-    m_node (sock.m_node),
-    m_tcp (sock.m_tcp),
-    m_state (sock.m_state),
-    m_errno (sock.m_errno),
-    m_closeNotified (sock.m_closeNotified),
-    m_closeOnEmpty (sock.m_closeOnEmpty),
-    m_shutdownSend (sock.m_shutdownSend),
-    m_shutdownRecv (sock.m_shutdownRecv),
-    m_connected (sock.m_connected),
-    m_msl (sock.m_msl),
-    m_maxWinSize (sock.m_maxWinSize),
-    m_rWnd (sock.m_rWnd),
-    m_highRxMark (sock.m_highRxMark),
-    m_highRxAckMark (sock.m_highRxAckMark),
-    m_bytesAckedNotProcessed (sock.m_bytesAckedNotProcessed),
-    m_bytesInFlight (sock.m_bytesInFlight),
-    m_winScalingEnabled (sock.m_winScalingEnabled),
-    m_rcvWindShift (sock.m_rcvWindShift),
-    m_sndWindShift (sock.m_sndWindShift),
-    m_timestampEnabled (sock.m_timestampEnabled),
-    m_timestampToEcho (sock.m_timestampToEcho),
-    m_recover (sock.m_recover),
-    m_retxThresh (sock.m_retxThresh),
-    m_limitedTx (sock.m_limitedTx),
-    m_retransOut (sock.m_retransOut),
-    m_isFirstPartialAck (sock.m_isFirstPartialAck),
+    m_rtt (0),
+    m_tsqOwner (0),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
-  // Copy the rtt estimator if it is set
-  if (sock.m_rtt)
-    {
-      m_rtt = sock.m_rtt->Copy ();
-    }
   // Reset all callbacks to null
   Callback<void, Ptr< Socket > > vPS = MakeNullCallback<void, Ptr<Socket> > ();
   Callback<void, Ptr<Socket>, const Address &> vPSA = MakeNullCallback<void, Ptr<Socket>, const Address &> ();
@@ -408,13 +442,99 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   SetDataSentCallback (vPSUI);
   SetSendCallback (vPSUI);
   SetRecvCallback (vPS);
+  CopyState (sock);
+}
+
+void
+TcpSocketBase::CopyState (const TcpSocketBase& sock)
+{
+  NS_LOG_FUNCTION (this);
+  m_dupAckCount = sock.m_dupAckCount;
+  m_delAckMaxCount = sock.m_delAckMaxCount;
+  m_noDelay = sock.m_noDelay;
+  m_synCount = sock.m_synCount;
+  m_synRetries = sock.m_synRetries;
+  m_dataRetrCount = sock.m_dataRetrCount;
+  m_dataRetries = sock.m_dataRetries;
+  m_rto = sock.m_rto;
+  m_minRto = sock.m_minRto;
+  m_clockGranularity = sock.m_clockGranularity;
+  m_lastRtt = sock.m_lastRtt;
+  m_delAckTimeout = sock.m_delAckTimeout;
+  m_persistTimeout = sock.m_persistTimeout;
+  m_cnTimeout = sock.m_cnTimeout;
+  m_history.clear ();
+  m_txTimestamps.Clear ();
+  m_rttSamples.clear ();
+  m_ackCoalescing = sock.m_ackCoalescing;
+  m_node = sock.m_node;
+  m_tcp = sock.m_tcp;
+  m_state = sock.m_state;
+  m_errno = sock.m_errno;
+  m_closeNotified = sock.m_closeNotified;
+  m_closeOnEmpty = sock.m_closeOnEmpty;
+  m_shutdownSend = sock.m_shutdownSend;
+  m_shutdownRecv = sock.m_shutdownRecv;
+  m_connected = sock.m_connected;
+  m_msl = sock.m_msl;
+  m_maxWinSize = sock.m_maxWinSize;
+  m_rWnd = sock.m_rWnd;
+  m_highRxMark = sock.m_highRxMark;
+  m_highTxAck = sock.m_highTxAck;
+  m_highRxAckMark = sock.m_highRxAckMark;
+  m_bytesAckedNotProcessed = sock.m_bytesAckedNotProcessed;
+  m_bytesInFlight = sock.m_bytesInFlight;
+  m_winScalingEnabled = sock.m_winScalingEnabled;
+  m_rcvWindShift = sock.m_rcvWindShift;
+  m_sndWindShift = sock.m_sndWindShift;
+  m_timestampEnabled = sock.m_timestampEnabled;
+  m_timestampToEcho = sock.m_timestampToEcho;
+  m_sackEnabled = sock.m_sackEnabled;
+  m_rackEnabled = sock.m_rackEnabled;
+  m_rackXmitTs = sock.m_rackXmitTs;
+  m_rackEndSeq = sock.m_rackEndSeq;
+  m_rackRtt = sock.m_rackRtt;
+  m_rackMinRtt = sock.m_rackMinRtt;
+  m_recoveryRetx = false;
+  m_telemetryToEcho = IntTelemetryTag ();
+  m_telemetryEchoPending = false;
+  m_ecnEchoPending = false;
+  m_ceReceived = false;
+  m_recover = sock.m_recover;
+  m_retxThresh = sock.m_retxThresh;
+  m_limitedTx = sock.m_limitedTx;
+  m_retransOut = sock.m_retransOut;
+  m_tsqLimit = sock.m_tsqLimit;
+  m_tsqBytes = 0;
+  m_tsqThrottled = false;
+  m_tsoMaxSize = sock.m_tsoMaxSize;
+  m_isFirstPartialAck = sock.m_isFirstPartialAck;
+
+  // Copy the rtt estimator if it is set; a recycled socket resets its own
+  if (sock.m_rtt == 0)
+    {
+      m_rtt = 0;
+    }
+  else if (m_rtt != 0 && m_rtt->GetInstanceTypeId () == sock.m_rtt->GetInstanceTypeId ())
+    {
+      m_rtt->Reset ();
+    }
+  else
+    {
+      m_rtt = sock.m_rtt->Copy ();
+    }
+
   m_txBuffer = CopyObject (sock.m_txBuffer);
   m_rxBuffer = CopyObject (sock.m_rxBuffer);
   m_tcb = CopyObject (sock.m_tcb);
+  m_congestionControl = 0;
+  m_congCaps = sock.m_congCaps;
   if (sock.m_congestionControl)
     {
       m_congestionControl = sock.m_congestionControl->Fork ();
+      m_congCaps = m_congestionControl->GetCapabilities ();
     }
+  m_ackPolicy = sock.m_ackPolicy->Fork ();
 
   bool ok;
 
@@ -432,6 +552,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
 
   ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
                                           MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
+  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -461,6 +582,10 @@ TcpSocketBase::~TcpSocketBase (void)
     }
   m_tcp = 0;
   CancelAllTimers ();
+  if (m_tsqOwner != 0)
+    {
+      TsqTag::Unregister (m_tsqOwner);
+    }
 }
 
 /* Associate a node with this TCP socket */
@@ -1147,6 +1272,12 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
   Address toAddress = InetSocketAddress (header.GetDestination (),
                                          m_endPoint->GetLocalPort ());
 
+  m_ceReceived = header.GetEcn () == Ipv4Header::ECN_CE;
+  if (m_ceReceived)
+    {
+      m_ecnEchoPending = true;
+    }
+
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
@@ -1164,6 +1295,12 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
   Address toAddress = Inet6SocketAddress (header.GetDestinationAddress (),
                                           m_endPoint6->GetLocalPort ());
 
+  m_ceReceived = (header.GetTrafficClass () & 0x3) == 0x3;
+  if (m_ceReceived)
+    {
+      m_ecnEchoPending = true;
+    }
+
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
@@ -1224,6 +1361,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
 
   m_rxTrace (packet, tcpHeader, this);
 
+  ProcessTelemetryTags (packet);
+
   if (tcpHeader.GetFlags () & TcpHeader::SYN)
     {
       /* The window field in a segment where the SYN bit is set (i.e., a <SYN>
@@ -1252,6 +1391,11 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
           m_timestampEnabled = false;
         }
 
+      if (!tcpHeader.HasOption (TcpOption::SACK_PERMITTED))
+        {
+          m_sackEnabled = false;
+        }
+
       // Initialize cWnd and ssThresh
       m_tcb->m_cWnd = GetInitialCwnd () * GetSegSize ();
       m_tcb->m_ssThresh = GetInitialSSThresh ();
@@ -1316,7 +1460,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       break;
     case CLOSED:
       // Send RST if the incoming packet is not a RST
-      if ((tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG)) != TcpHeader::RST)
+      if ((tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR)) != TcpHeader::RST)
         { // Since m_endPoint is not configured yet, we cannot use SendRST here
           TcpHeader h;
           Ptr<Packet> p = Create<Packet> ();
@@ -1376,7 +1520,7 @@ TcpSocketBase::ProcessEstablished (Ptr<Packet> packet, const TcpHeader& tcpHeade
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   // Different flags are different events
   if (tcpflags == TcpHeader::ACK)
@@ -1468,9 +1612,19 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 
   m_tcb->m_lastAckedSeq = ackNumber;
 
-  if (ackNumber == m_txBuffer->HeadSequence ()
-      && ackNumber < m_tcb->m_nextTxSequence
-      && packet->GetSize () == 0)
+  if ((tcpHeader.GetFlags () & TcpHeader::ECE)
+      && (m_congCaps & TcpCongestionOps::CAP_ECN))
+    {
+      m_congestionControl->EcnEchoReceived (m_tcb);
+    }
+
+  if (m_sackEnabled)
+    {
+      ProcessSackAck (packet, tcpHeader, bytesAcked, segsAcked);
+    }
+  else if (ackNumber == m_txBuffer->HeadSequence ()
+           && ackNumber < m_tcb->m_nextTxSequence
+           && packet->GetSize () == 0)
     {
       // There is a DupAck
       ++m_dupAckCount;
@@ -1507,8 +1661,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 
               m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
                                                                     BytesInFlight ());
-              if (m_congestionControl->GetName().compare("TIMELY") != 0)
-                m_tcb->m_cWnd = m_tcb->m_ssThresh + m_dupAckCount * m_tcb->m_segmentSize;
+              if (!(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
+                {
+                  m_tcb->m_cWnd = m_tcb->m_ssThresh + m_dupAckCount * m_tcb->m_segmentSize;
+                }
 
               NS_LOG_INFO (m_dupAckCount << " dupack. Enter fast recovery mode." <<
                            "Reset cwnd to " << m_tcb->m_cWnd << ", ssthresh to " <<
@@ -1525,15 +1681,17 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         }
       else if (m_tcb->m_congState == TcpSocketState::CA_RECOVERY)
         { // Increase cwnd for every additional dupack (RFC2582, sec.3 bullet #3)
-          if (m_congestionControl->GetName().compare("TIMELY") != 0)
-            m_tcb->m_cWnd += m_tcb->m_segmentSize;
+          if (!(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
+            {
+              m_tcb->m_cWnd += m_tcb->m_segmentSize;
+            }
           NS_LOG_INFO (m_dupAckCount << " Dupack received in fast recovery mode."
                        "Increase cwnd to " << m_tcb->m_cWnd);
           SendPendingData (m_connected);
         }
 
       // Artificially call PktsAcked. After all, one segment has been ACKed.
-      m_congestionControl->PktsAcked (m_tcb, 1, m_lastRtt);
+      CongestionPktsAcked (1);
     }
   else if (ackNumber == m_txBuffer->HeadSequence ()
            && ackNumber == m_tcb->m_nextTxSequence)
@@ -1568,7 +1726,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 
       if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
         {
-          m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+          CongestionPktsAcked (segsAcked);
         }
       else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
         {
@@ -1576,7 +1734,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
           // packet algorithm from FACK to NewReno. We simply go back in Open.
           m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
           m_tcb->m_congState = TcpSocketState::CA_OPEN;
-          m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+          CongestionPktsAcked (segsAcked);
           m_dupAckCount = 0;
           m_retransOut = 0;
 
@@ -1601,14 +1759,14 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
                * fast recovery procedure (i.e., if any duplicate ACKs subsequently
                * arrive, execute step 4 of Section 3.2 of [RFC5681]).
                 */
-              
-              if (m_congestionControl->GetName().compare("TIMELY") != 0)
-                m_tcb->m_cWnd = SafeSubtraction (m_tcb->m_cWnd, bytesAcked);
-
-              if (segsAcked >= 1)
+              if (!(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
                 {
-                  if (m_congestionControl->GetName().compare("TIMELY") != 0)
-                    m_tcb->m_cWnd += m_tcb->m_segmentSize;
+                  m_tcb->m_cWnd = SafeSubtraction (m_tcb->m_cWnd, bytesAcked);
+
+                  if (segsAcked >= 1)
+                    {
+                      m_tcb->m_cWnd += m_tcb->m_segmentSize;
+                    }
                 }
 
               callCongestionControl = false; // No congestion control on cWnd show be invoked
@@ -1631,7 +1789,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
                * previously lost and now successfully received. All others have
                * been processed when they come under the form of dupACKs
                */
-              m_congestionControl->PktsAcked (m_tcb, 1, m_lastRtt);
+              CongestionPktsAcked (1);
 
               NS_LOG_INFO ("Partial ACK for seq " << ackNumber <<
                            " in fast recovery: cwnd set to " << m_tcb->m_cWnd <<
@@ -1640,9 +1798,11 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
             }
           else if (ackNumber >= m_recover)
             { // Full ACK (RFC2582 sec.3 bullet #5 paragraph 2, option 1)
-              if (m_congestionControl->GetName().compare("TIMELY") != 0)
-                m_tcb->m_cWnd = std::min (m_tcb->m_ssThresh.Get (),
-                                        BytesInFlight () + m_tcb->m_segmentSize);
+              if (!(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
+                {
+                  m_tcb->m_cWnd = std::min (m_tcb->m_ssThresh.Get (),
+                                            BytesInFlight () + m_tcb->m_segmentSize);
+                }
               m_isFirstPartialAck = true;
               m_dupAckCount = 0;
               m_retransOut = 0;
@@ -1652,7 +1812,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
                * been processed when they come under the form of dupACKs,
                * except the (maybe) new ACKs which come from a new window
                */
-              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+              CongestionPktsAcked (segsAcked);
               newSegsAcked = (ackNumber - m_recover) / m_tcb->m_segmentSize;
               m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
               m_tcb->m_congState = TcpSocketState::CA_OPEN;
@@ -1666,7 +1826,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         {
           // Go back in OPEN state
           m_isFirstPartialAck = true;
-          m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+          CongestionPktsAcked (segsAcked);
           m_dupAckCount = 0;
           m_retransOut = 0;
           m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
@@ -1709,6 +1869,206 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
     }
 }
 
+void
+TcpSocketBase::ProcessSackAck (Ptr<Packet> packet, const TcpHeader& tcpHeader,
+                               uint32_t bytesAcked, uint32_t segsAcked)
+{
+  NS_LOG_FUNCTION (this << tcpHeader << bytesAcked << segsAcked);
+
+  SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
+
+  uint32_t sacked = 0;
+  if (tcpHeader.HasOption (TcpOption::SACK))
+    {
+      Ptr<const TcpOptionSack> sack = DynamicCast<const TcpOptionSack> (tcpHeader.GetOption (TcpOption::SACK));
+      sacked = m_txBuffer->UpdateScoreboard (sack->GetSackList ());
+    }
+
+  if (ackNumber == m_txBuffer->HeadSequence ())
+    {
+      if (sacked == 0
+          && (packet->GetSize () > 0 || ackNumber >= m_tcb->m_nextTxSequence))
+        {
+          // Window update or piggybacked data, not a duplicate ACK
+          return;
+        }
+
+      ++m_dupAckCount;
+      if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
+        {
+          m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_DISORDER);
+          m_tcb->m_congState = TcpSocketState::CA_DISORDER;
+          NS_LOG_DEBUG ("OPEN -> DISORDER");
+        }
+
+      // The segments SACKed have left the network
+      CongestionPktsAcked (std::max<uint32_t> (1, sacked / m_tcb->m_segmentSize));
+    }
+  else if (ackNumber > m_txBuffer->HeadSequence ())
+    {
+      uint32_t newSegsAcked = segsAcked;
+      bool inRecovery = false;
+
+      NewAck (ackNumber, true);
+      m_dupAckCount = 0;
+      m_dataRetrCount = m_dataRetries;
+      CongestionPktsAcked (segsAcked);
+
+      if (m_tcb->m_congState == TcpSocketState::CA_RECOVERY
+          || m_tcb->m_congState == TcpSocketState::CA_LOSS)
+        {
+          if (ackNumber < m_recover)
+            {
+              inRecovery = true;
+            }
+          else
+            {
+              if (m_tcb->m_congState == TcpSocketState::CA_RECOVERY
+                  && !(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
+                {
+                  m_tcb->m_cWnd = std::min (m_tcb->m_ssThresh.Get (),
+                                            BytesInFlight () + m_tcb->m_segmentSize);
+                }
+              newSegsAcked = (ackNumber - m_recover) / m_tcb->m_segmentSize;
+              NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
+                            " -> OPEN");
+              m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
+              m_tcb->m_congState = TcpSocketState::CA_OPEN;
+            }
+        }
+      else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER
+               && m_txBuffer->GetSackedBytes () == 0)
+        {
+          m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
+          m_tcb->m_congState = TcpSocketState::CA_OPEN;
+          NS_LOG_DEBUG ("DISORDER -> OPEN");
+        }
+
+      if (!inRecovery)
+        {
+          m_congestionControl->IncreaseWindow (m_tcb, newSegsAcked);
+          NS_LOG_LOGIC ("Congestion control called: " <<
+                        " cWnd: " << m_tcb->m_cWnd <<
+                        " ssTh: " << m_tcb->m_ssThresh);
+        }
+    }
+  else
+    {
+      // Old ACK: the SACK blocks are still worth processing
+      if (sacked == 0)
+        {
+          return;
+        }
+    }
+
+  DetectLosses ();
+
+  if (!m_sendPendingDataEvent.IsRunning ())
+    {
+      m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1),
+                                                    &TcpSocketBase::SendPendingData,
+                                                    this, m_connected);
+    }
+}
+
+void
+TcpSocketBase::DetectLosses (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t lost;
+  if (m_rackEnabled)
+    {
+      RackUpdate ();
+      if (m_rackMinRtt == Time::Max ())
+        {
+          return; // Nothing delivered yet
+        }
+
+      Time timeout;
+      lost = m_txBuffer->MarkLostByRack (m_rackXmitTs, m_rackEndSeq,
+                                         m_rackRtt + m_rackMinRtt / 4,
+                                         Simulator::Now (), timeout);
+      m_rackEvent.Cancel ();
+      if (timeout > Time (0))
+        {
+          m_rackEvent = Simulator::Schedule (timeout, &TcpSocketBase::RackTimeout, this);
+        }
+    }
+  else
+    {
+      lost = m_txBuffer->MarkLostByDupThresh (m_retxThresh, m_tcb->m_segmentSize);
+    }
+
+  if (lost == 0 || m_txBuffer->GetLostBytes () == 0)
+    {
+      return;
+    }
+
+  NS_LOG_DEBUG ("Marked " << lost << " bytes lost");
+  if (m_tcb->m_congState == TcpSocketState::CA_OPEN
+      || m_tcb->m_congState == TcpSocketState::CA_DISORDER)
+    {
+      NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
+                    " -> RECOVERY");
+      m_recover = m_tcb->m_highTxMark;
+      m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_RECOVERY);
+      m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
+
+      m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, UnAckDataCount ());
+      if (!(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
+        {
+          m_tcb->m_cWnd = m_tcb->m_ssThresh;
+        }
+      NS_LOG_INFO ("Enter SACK recovery. Reset cwnd to " << m_tcb->m_cWnd <<
+                   ", ssthresh to " << m_tcb->m_ssThresh <<
+                   " at recovery seqnum " << m_recover);
+
+      // The first retransmission does not wait for the window, but it is
+      // sent by SendPendingData, behind the pacing timer and the TSQ limit
+      m_recoveryRetx = true;
+    }
+}
+
+void
+TcpSocketBase::RackUpdate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time xmitTs;
+  SequenceNumber32 endSeq;
+  bool retrans;
+  if (!m_txBuffer->GetLastDelivered (xmitTs, endSeq, retrans))
+    {
+      return;
+    }
+
+  Time rtt = Simulator::Now () - xmitTs;
+  if (retrans && rtt < m_rackMinRtt)
+    {
+      // Possibly the ACK of the original transmission (RFC 8985, 6.2 step 2)
+      return;
+    }
+
+  m_rackMinRtt = std::min (m_rackMinRtt, rtt);
+  if (xmitTs > m_rackXmitTs
+      || (xmitTs == m_rackXmitTs && endSeq > m_rackEndSeq))
+    {
+      m_rackXmitTs = xmitTs;
+      m_rackEndSeq = endSeq;
+      m_rackRtt = rtt;
+    }
+}
+
+void
+TcpSocketBase::RackTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  DetectLosses ();
+  SendPendingData (m_connected);
+}
+
 /* Received a packet upon LISTEN state. */
 void
 TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
@@ -1717,7 +2077,7 @@ TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   // Fork a socket if received a SYN. Do nothing otherwise.
   // C.f.: the LISTEN part in tcp_v4_do_rcv() in tcp_ipv4.c in Linux kernel
@@ -1746,7 +2106,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == 0)
     { // Bare data, accept it and move to ESTABLISHED state. This is not a normal behaviour. Remove this?
@@ -1755,7 +2115,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_state = ESTABLISHED;
       m_connected = true;
       m_retxEvent.Cancel ();
-      m_delAckCount = m_delAckMaxCount;
+      m_ackPolicy->QuickAck ();
       ReceivedData (packet, tcpHeader);
       Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
     }
@@ -1786,7 +2146,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
       // Always respond to first data packet to speed up the connection.
       // Remove to get the behaviour of old NS-3 code.
-      m_delAckCount = m_delAckMaxCount;
+      m_ackPolicy->QuickAck ();
     }
   else
     { // Other in-sequence input
@@ -1808,7 +2168,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == 0
       || (tcpflags == TcpHeader::ACK
@@ -1835,7 +2195,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
         }
       // Always respond to first data packet to speed up the connection.
       // Remove to get the behaviour of old NS-3 code.
-      m_delAckCount = m_delAckMaxCount;
+      m_ackPolicy->QuickAck ();
       ReceivedAck (packet, tcpHeader);
       NotifyNewConnectionCreated (this, fromAddress);
       // As this connection is established, the socket is available to send data now
@@ -1899,7 +2259,7 @@ TcpSocketBase::ProcessWait (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   if (packet->GetSize () > 0 && tcpflags != TcpHeader::ACK)
     { // Bare data, accept it
@@ -1971,7 +2331,7 @@ TcpSocketBase::ProcessClosing (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == TcpHeader::ACK)
     {
@@ -2003,7 +2363,7 @@ TcpSocketBase::ProcessLastAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   NS_LOG_FUNCTION (this << tcpHeader);
 
   // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::ECE | TcpHeader::CWR);
 
   if (tcpflags == 0)
     {
@@ -2196,7 +2556,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       ++s;
     }
 
-  header.SetFlags (flags);
+  header.SetFlags (flags | EcnEchoFlag (flags));
   header.SetSequenceNumber (s);
   header.SetAckNumber (m_rxBuffer->NextRxSequence ());
   if (m_endPoint != 0)
@@ -2225,6 +2585,11 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
           AddOptionWScale (header);
         }
 
+      if (m_sackEnabled)
+        {
+          AddOptionSackPermitted (header);
+        }
+
       if (m_synCount == 0)
         { // No more connection retries, give up
           NS_LOG_LOGIC ("Connection failed.");
@@ -2252,6 +2617,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
   header.SetWindowSize (windowSize);
 
+  AddTelemetryTags (p, flags);
   m_txTrace (p, header, this);
 
   if (m_endPoint != 0)
@@ -2268,7 +2634,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
       m_delAckEvent.Cancel ();
-      m_delAckCount = 0;
+      m_ackPolicy->AckSent ();
       if (m_highTxAck < header.GetAckNumber ())
         {
           m_highTxAck = header.GetAckNumber ();
@@ -2449,7 +2815,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   if (withAck)
     {
       m_delAckEvent.Cancel ();
-      m_delAckCount = 0;
+      m_ackPolicy->AckSent ();
     }
 
   /*
@@ -2458,17 +2824,29 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
    * if both options are set. Once the packet got to layer three, only
    * the corresponding tags will be read.
    */
-  if (IsManualIpTos ())
+  bool ecnCapable = m_congCaps & TcpCongestionOps::CAP_ECN;
+  if (IsManualIpTos () || ecnCapable)
     {
+      // Data segments of ECN algorithms carry the ECT(0) codepoint
+      uint8_t tos = IsManualIpTos () ? GetIpTos () : 0;
+      if (ecnCapable)
+        {
+          tos = (tos & ~0x3) | Ipv4Header::ECN_ECT0;
+        }
       SocketIpTosTag ipTosTag;
-      ipTosTag.SetTos (GetIpTos ());
+      ipTosTag.SetTos (tos);
       p->AddPacketTag (ipTosTag);
     }
 
-  if (IsManualIpv6Tclass ())
+  if (IsManualIpv6Tclass () || ecnCapable)
     {
+      uint8_t tclass = IsManualIpv6Tclass () ? GetIpv6Tclass () : 0;
+      if (ecnCapable)
+        {
+          tclass = (tclass & ~0x3) | Ipv4Header::ECN_ECT0;
+        }
       SocketIpv6TclassTag ipTclassTag;
-      ipTclassTag.SetTclass (GetIpv6Tclass ());
+      ipTclassTag.SetTclass (tclass);
       p->AddPacketTag (ipTclassTag);
     }
 
@@ -2501,7 +2879,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
         }
     }
   TcpHeader header;
-  header.SetFlags (flags);
+  header.SetFlags (flags | EcnEchoFlag (flags));
   header.SetSequenceNumber (seq);
   header.SetAckNumber (m_rxBuffer->NextRxSequence ());
   if (m_endPoint)
@@ -2534,6 +2912,20 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
+  AddTelemetryTags (p, flags);
+  if (m_tsqLimit > 0 && sz > 0)
+    {
+      if (m_tsqOwner == 0)
+        {
+          TsqRegister ();
+        }
+      p->AddPacketTag (TsqTag (m_tsqOwner, sz));
+      m_tsqBytes += sz;
+    }
+  if (sz > m_tcb->m_segmentSize)
+    {
+      p->AddPacketTag (TsoTag (m_tcb->m_segmentSize, sz));
+    }
   m_txTrace (p, header, this);
 
   if (m_endPoint)
@@ -2555,6 +2947,11 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   UpdateRttHistory (seq, sz, isRetransmission);
 
+  if (m_sackEnabled && sz > 0)
+    {
+      m_txBuffer->SegmentSent (seq, sz, Simulator::Now ());
+    }
+
   // Notify the application of the data being sent unless this is a retransmit
   if (seq + sz > m_tcb->m_highTxMark)
     {
@@ -2572,6 +2969,19 @@ TcpSocketBase::UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_congCaps & TcpCongestionOps::CAP_SEGMENT_RTT)
+    {
+      if (isRetransmission == false)
+        {
+          m_txTimestamps.Push (seq, sz, Simulator::Now ());
+        }
+      else
+        {
+          m_txTimestamps.MarkRetransmitted (seq, sz);
+        }
+      return;
+    }
+
   // update the history of sequence numbers used to calculate the RTT
   if (isRetransmission == false)
     { // This is the next expected one, just log at end
@@ -2607,10 +3017,65 @@ TcpSocketBase::SendPendingData (bool withAck)
       NS_LOG_INFO ("TcpSocketBase::SendPendingData: No endpoint; m_shutdownSend=" << m_shutdownSend);
       return false; // Is this the right way to handle this condition?
     }
+  bool pacing = m_tcb->m_pacingRate.GetBitRate () > 0;
+  if (pacing && m_pacingEvent.IsRunning ())
+    {
+      NS_LOG_LOGIC ("Pacing timer is running. Wait to send.");
+      return false;
+    }
   uint32_t nPacketsSent = 0;
-  while (m_txBuffer->SizeFromSequence (m_tcb->m_nextTxSequence))
+  while (true)
     {
+      if (m_tsqLimit > 0 && m_tsqBytes >= m_tsqLimit)
+        {
+          NS_LOG_LOGIC ("TSQ: " << m_tsqBytes << " bytes queued in the host. Wait to send.");
+          m_tsqThrottled = true;
+          break;
+        }
+
       uint32_t w = AvailableWindow (); // Get available window size
+      uint32_t sz;
+
+      // With SACK, the segments marked lost go before any new data (RFC 6675)
+      SequenceNumber32 lostSeq;
+      uint32_t lostSize;
+      if (m_sackEnabled && m_txBuffer->NextLostSegment (lostSeq, lostSize))
+        {
+          // A lost super-segment is retransmitted in whole segments, as the
+          // window allows
+          uint32_t s = std::min (lostSize, std::min (w, GetSendQuantum ()));
+          if (s < lostSize)
+            {
+              s -= s % m_tcb->m_segmentSize;
+            }
+          if (s == 0 && m_recoveryRetx)
+            {
+              s = std::min (lostSize, m_tcb->m_segmentSize);
+            }
+          m_recoveryRetx = false;
+          if (s == 0)
+            {
+              NS_LOG_LOGIC ("No window to retransmit " << lostSeq << ". Wait to send.");
+              break;
+            }
+          lostSize = s;
+          NS_LOG_DEBUG ("Retransmit lost segment " << lostSeq << " size " << lostSize);
+          sz = SendDataPacket (lostSeq, lostSize, withAck);
+          nPacketsSent++;
+          if (pacing)
+            {
+              Time gap = m_tcb->m_pacingRate.CalculateBytesTxTime (sz);
+              m_pacingEvent = Simulator::Schedule (gap, &TcpSocketBase::SendPendingData,
+                                                   this, m_connected);
+              break;
+            }
+          continue;
+        }
+
+      if (m_txBuffer->SizeFromSequence (m_tcb->m_nextTxSequence) == 0)
+        {
+          break;
+        }
       // Stop sending if we need to wait for a larger Tx window (prevent silly window syndrome)
       if (w < m_tcb->m_segmentSize && m_txBuffer->SizeFromSequence (m_tcb->m_nextTxSequence) > w)
         {
@@ -2638,10 +3103,23 @@ TcpSocketBase::SendPendingData (bool withAck)
                     " cWnd: " << m_tcb->m_cWnd <<
                     " unAck: " << UnAckDataCount ());
 
-      uint32_t s = std::min (w, m_tcb->m_segmentSize);  // Send no more than window
-      uint32_t sz = SendDataPacket (m_tcb->m_nextTxSequence, s, withAck);
+      uint32_t s = std::min (w, GetSendQuantum ());  // Send no more than window
+      if (s > m_tcb->m_segmentSize)
+        { // Super-segments hold whole segments; only the end of the data is shorter
+          s -= s % m_tcb->m_segmentSize;
+        }
+      sz = SendDataPacket (m_tcb->m_nextTxSequence, s, withAck);
       nPacketsSent++;                             // Count sent this loop
       m_tcb->m_nextTxSequence += sz;                     // Advance next tx sequence
+
+      if (pacing)
+        { // Release the next segment after this one has left at the pacing rate
+          Time gap = m_tcb->m_pacingRate.CalculateBytesTxTime (sz);
+          NS_LOG_LOGIC ("Pacing at " << m_tcb->m_pacingRate << ", next send in " << gap);
+          m_pacingEvent = Simulator::Schedule (gap, &TcpSocketBase::SendPendingData,
+                                               this, m_connected);
+          break;
+        }
     }
   if (nPacketsSent > 0)
     {
@@ -2661,6 +3139,16 @@ uint32_t
 TcpSocketBase::BytesInFlight ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_sackEnabled)
+    { // RFC 6675 pipe, from the scoreboard
+      uint32_t pipe = m_txBuffer->BytesInFlight ();
+      if (m_bytesInFlight != pipe)
+        {
+          m_bytesInFlight = pipe;
+        }
+      return pipe;
+    }
+
   // Previous (see bug 1783):
   // uint32_t bytesInFlight = m_highTxMark.Get () - m_txBuffer->HeadSequence ();
   // RFC 4898 page 23
@@ -2703,7 +3191,8 @@ uint32_t
 TcpSocketBase::AvailableWindow () const
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint32_t unack = UnAckDataCount (); // Number of outstanding bytes
+  uint32_t unack = m_sackEnabled ? m_txBuffer->BytesInFlight ()
+    : UnAckDataCount ();              // Number of outstanding bytes
   uint32_t win = Window ();           // Number of bytes allowed to be outstanding
 
   NS_LOG_DEBUG ("UnAckCount=" << unack << ", Win=" << win);
@@ -2750,16 +3239,20 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       SendEmptyPacket (TcpHeader::ACK);
     }
   else
-    { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+    { // In-sequence packet: ACK when the ACK policy decides
+      // A super-segment counts as the segments it was received in
+      uint32_t segments = std::max<uint32_t> (1, (p->GetSize () + m_tcb->m_segmentSize - 1)
+                                              / m_tcb->m_segmentSize);
+      Time delay = m_ackPolicy->DataReceived (segments, m_ceReceived,
+                                              m_delAckMaxCount, m_delAckTimeout);
+      if (delay.IsZero ())
         {
           m_delAckEvent.Cancel ();
-          m_delAckCount = 0;
           SendEmptyPacket (TcpHeader::ACK);
         }
       else if (m_delAckEvent.IsExpired ())
         {
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
+          m_delAckEvent = Simulator::Schedule (delay,
                                                &TcpSocketBase::DelAckTimeout, this);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
                         (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
@@ -2799,6 +3292,23 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
   SequenceNumber32 ackSeq = tcpHeader.GetAckNumber ();
   Time m = Time (0.0);
 
+  if (m_congCaps & TcpCongestionOps::CAP_SEGMENT_RTT)
+    {
+      // Every segment completed by this ACK gives its own sample; the
+      // newest one feeds the RTO estimator, as it would do alone
+      m_rttSamples.clear ();
+      m_txTimestamps.Complete (ackSeq, Simulator::Now (), m_ackCoalescing, m_rttSamples);
+      if (!m_rttSamples.empty ())
+        {
+          m = m_rttSamples.back ().rtt;
+          m_rtt->Measurement (m);
+          m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
+          m_lastRtt = m;
+          NS_LOG_FUNCTION (this << m_lastRtt << m_rttSamples.size ());
+        }
+      return;
+    }
+
   // An ack has been received, calculate rtt and log this measurement
   // Note we use a linear search (O(n)) for this since for the common
   // case the ack'ed packet will be at the head of the list
@@ -2836,11 +3346,77 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
       m_rtt->Measurement (m);                // Log the measurement
       // RFC 6298, clause 2.4
       m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
-      m_lastRtt = m_congestionControl->GetName().compare("TIMELY") != 0 ? m_rtt->GetEstimate () : m; 
+      m_lastRtt = (m_congCaps & TcpCongestionOps::CAP_RAW_RTT) ? m : m_rtt->GetEstimate ();
       NS_LOG_FUNCTION (this << m_lastRtt);
     }
 }
 
+void
+TcpSocketBase::CongestionPktsAcked (uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << segmentsAcked);
+
+  if (!(m_congCaps & TcpCongestionOps::CAP_SEGMENT_RTT))
+    {
+      m_congestionControl->PktsAcked (m_tcb, segmentsAcked, m_lastRtt);
+      return;
+    }
+
+  m_congestionControl->PktsAckedBatch (m_tcb, segmentsAcked, m_rttSamples);
+
+  // Samples are delivered only once, even if the ACK is processed further
+  m_rttSamples.clear ();
+}
+
+void
+TcpSocketBase::AddTelemetryTags (Ptr<Packet> p, uint8_t flags)
+{
+  if ((m_congCaps & TcpCongestionOps::CAP_TELEMETRY) && p->GetSize () > 0)
+    {
+      p->AddPacketTag (IntTelemetryTag ());
+    }
+
+  if (m_telemetryEchoPending && (flags & TcpHeader::ACK))
+    {
+      p->AddPacketTag (IntTelemetryEchoTag (m_telemetryToEcho));
+      m_telemetryToEcho = IntTelemetryTag ();
+      m_telemetryEchoPending = false;
+    }
+}
+
+uint8_t
+TcpSocketBase::EcnEchoFlag (uint8_t flags)
+{
+  if (m_ecnEchoPending && (flags & TcpHeader::ACK))
+    {
+      m_ecnEchoPending = false;
+      return TcpHeader::ECE;
+    }
+  return 0;
+}
+
+void
+TcpSocketBase::ProcessTelemetryTags (Ptr<Packet> p)
+{
+  IntTelemetryTag telemetry;
+  if (p->RemovePacketTag (telemetry))
+    { // Echo the worst occupancy of all the segments covered by the next ACK
+      m_telemetryToEcho.Merge (telemetry);
+      m_telemetryEchoPending = true;
+    }
+
+  IntTelemetryEchoTag echo;
+  if (p->RemovePacketTag (echo))
+    {
+      m_tcb->m_pathQueuePackets = echo.GetMaxPackets ();
+      m_tcb->m_pathQueueBytes = echo.GetMaxBytes ();
+      m_tcb->m_pathQueueDelay = echo.GetMaxQueueDelay ();
+      m_tcb->m_pathUtilization = echo.GetMaxUtilization ();
+      NS_LOG_LOGIC (this << " path occupancy " << m_tcb->m_pathQueuePackets <<
+                    " packets, " << m_tcb->m_pathQueueBytes << " bytes");
+    }
+}
+
 // Called by the ReceivedAck() when new ACK received and by ProcessSynRcvd()
 // when the three-way handshake completed. This cancels retransmission timer
 // and advances Tx window
@@ -2908,7 +3484,6 @@ TcpSocketBase::ReTxTimeout ()
 void
 TcpSocketBase::DelAckTimeout (void)
 {
-  m_delAckCount = 0;
   SendEmptyPacket (TcpHeader::ACK);
 }
 
@@ -3022,14 +3597,31 @@ TcpSocketBase::Retransmit ()
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_LOSS);
       m_tcb->m_congState = TcpSocketState::CA_LOSS;
       m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, BytesInFlight ());
-      
-      if (m_congestionControl->GetName().compare("TIMELY") != 0)
-        m_tcb->m_cWnd = m_tcb->m_segmentSize;
+
+      if (!(m_congCaps & TcpCongestionOps::CAP_OWNS_CWND))
+        {
+          m_tcb->m_cWnd = m_tcb->m_segmentSize;
+        }
     }
 
-  m_tcb->m_nextTxSequence = m_txBuffer->HeadSequence (); // Restart from highest Ack
+  if (m_sackEnabled)
+    { // Keep the SACKed data; everything else is retransmitted as the window opens
+      m_txBuffer->MarkAllLost ();
+      m_recover = m_tcb->m_highTxMark;
+      m_rackEvent.Cancel ();
+      m_recoveryRetx = false;
+    }
+  else
+    {
+      m_tcb->m_nextTxSequence = m_txBuffer->HeadSequence (); // Restart from highest Ack
+    }
   m_dupAckCount = 0;
 
+  if (m_tsqOwner != 0)
+    { // Segments never given back by the host must not stall the socket
+      TsqRegister ();
+    }
+
   NS_LOG_DEBUG ("RTO. Reset cwnd to " <<  m_tcb->m_cWnd << ", ssthresh to " <<
                 m_tcb->m_ssThresh << ", restart from seqnum " << m_tcb->m_nextTxSequence);
   DoRetransmit ();                          // Retransmit the packet
@@ -3094,6 +3686,8 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
+  m_pacingEvent.Cancel ();
+  m_rackEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -3276,6 +3870,11 @@ TcpSocketBase::AddOptions (TcpHeader& header)
     {
       AddOptionTimestamp (header);
     }
+
+  if (m_sackEnabled && m_rxBuffer->HoleCount () > 0)
+    {
+      AddOptionSack (header);
+    }
 }
 
 void
@@ -3375,6 +3974,91 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
                option->GetTimestamp () << " echo=" << m_timestampToEcho);
 }
 
+void
+TcpSocketBase::TsqRegister (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_tsqOwner != 0)
+    {
+      TsqTag::Unregister (m_tsqOwner);
+    }
+  m_tsqOwner = TsqTag::Register (MakeCallback (&TcpSocketBase::TsqRelease, this));
+  m_tsqBytes = 0;
+  m_tsqThrottled = false;
+}
+
+void
+TcpSocketBase::TsqRelease (uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+
+  m_tsqBytes -= std::min (bytes, m_tsqBytes.Get ());
+  if (m_tsqThrottled && m_tsqBytes < m_tsqLimit)
+    {
+      m_tsqThrottled = false;
+      if (!m_sendPendingDataEvent.IsRunning ())
+        {
+          m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1),
+                                                        &TcpSocketBase::SendPendingData,
+                                                        this, m_connected);
+        }
+    }
+}
+
+uint32_t
+TcpSocketBase::GetSendQuantum (void) const
+{
+  uint32_t segmentSize = m_tcb->m_segmentSize;
+  if (m_tsoMaxSize <= segmentSize)
+    {
+      return segmentSize;
+    }
+  uint32_t quantum = m_tsoMaxSize;
+  if (m_tcb->m_pacingRate.GetBitRate () > 0)
+    { // As Linux' tcp_tso_autosize: about a millisecond of data at the pacing rate
+      uint64_t paced = std::max<uint64_t> (m_tcb->m_pacingRate.GetBitRate () / 8 / 1000,
+                                           2 * segmentSize);
+      quantum = static_cast<uint32_t> (std::min<uint64_t> (quantum, paced));
+    }
+  return std::max (quantum - quantum % segmentSize, segmentSize);
+}
+
+void
+TcpSocketBase::AddOptionSackPermitted (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  header.AppendOption (CreateObject<TcpOptionSackPermitted> ());
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK-PERMITTED");
+}
+
+void
+TcpSocketBase::AddOptionSack (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  // 2 bytes of kind and length, then 8 bytes per block
+  uint32_t room = header.GetMaxOptionLength () - header.GetOptionLength ();
+  if (room < 10)
+    {
+      return;
+    }
+  uint32_t maxBlocks = std::min<uint32_t> (TcpOptionSack::MAX_BLOCKS, (room - 2) / 8);
+
+  Ptr<TcpOptionSack> option = CreateObject<TcpOptionSack> ();
+  TcpOptionSack::SackList list = m_rxBuffer->GetSackList ();
+  for (TcpOptionSack::SackList::const_iterator it = list.begin ();
+       it != list.end () && option->GetNumSackBlocks () < maxBlocks; ++it)
+    {
+      option->AddSackBlock (*it);
+    }
+
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK, " <<
+               option->GetNumSackBlocks () << " blocks");
+}
+
 void TcpSocketBase::UpdateWindowSize (const TcpHeader &header)
 {
   NS_LOG_FUNCTION (this << header);
@@ -3457,6 +4141,12 @@ TcpSocketBase::GetRxBuffer (void) const
   return m_rxBuffer;
 }
 
+Ptr<TcpCongestionOps>
+TcpSocketBase::GetCongestionControlAlgorithm (void) const
+{
+  return m_congestionControl;
+}
+
 void
 TcpSocketBase::UpdateCwnd (uint32_t oldValue, uint32_t newValue)
 {
@@ -3495,6 +4185,56 @@ TcpSocketBase::SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo)
 {
   NS_LOG_FUNCTION (this << algo);
   m_congestionControl = algo;
+  m_congCaps = algo->GetCapabilities ();
+}
+
+void
+TcpSocketBase::SetAckPolicy (Ptr<TcpAckPolicy> policy)
+{
+  NS_LOG_FUNCTION (this << policy);
+  m_ackPolicy = policy;
+}
+
+Ptr<TcpAckPolicy>
+TcpSocketBase::GetAckPolicy (void) const
+{
+  return m_ackPolicy;
+}
+
+void
+TcpSocketBase::Recycle (Ptr<TcpSocketBase> proto)
+{
+  NS_LOG_FUNCTION (this << proto);
+  NS_ASSERT (m_endPoint == 0 && m_endPoint6 == 0);
+
+  CancelAllTimers ();
+  if (m_tsqOwner != 0)
+    {
+      TsqTag::Unregister (m_tsqOwner);
+      m_tsqOwner = 0;
+    }
+  ResetSocket ();
+  m_icmpCallback.Nullify ();
+  m_icmpCallback6.Nullify ();
+
+  // The sinks were connected for the previous connection
+  m_rto.DisconnectAll ();
+  m_lastRtt.DisconnectAll ();
+  m_nextTxSequenceTrace.DisconnectAll ();
+  m_highTxMarkTrace.DisconnectAll ();
+  m_state.DisconnectAll ();
+  m_congStateTrace.DisconnectAll ();
+  m_rWnd.DisconnectAll ();
+  m_bytesInFlight.DisconnectAll ();
+  m_tsqBytes.DisconnectAll ();
+  m_highRxMark.DisconnectAll ();
+  m_highRxAckMark.DisconnectAll ();
+  m_cWndTrace.DisconnectAll ();
+  m_ssThTrace.DisconnectAll ();
+  m_txTrace.DisconnectAll ();
+  m_rxTrace.DisconnectAll ();
+
+  CopyState (*proto);
 }
 
 Ptr<TcpSocketBase>
@@ -27,6 +27,8 @@
 #include "tcp-timely.h"
 #include "ns3/tcp-socket-base.h"
 #include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
 #include <sys/time.h>
 #include <float.h>
 
@@ -39,15 +41,15 @@ TypeId
 TcpTimely::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::TcpTimely")
-    .SetParent<TcpNewReno> ()
+    .SetParent<TcpRateCongestionOps> ()
     .AddConstructor<TcpTimely> ()
     .SetGroupName ("Internet")
     .AddAttribute("EMWA", "Exponential Moving Weight parameter",
                    DoubleValue(0.1),
                    MakeDoubleAccessor (&TcpTimely::m_emwa),
                    MakeDoubleChecker<double> ())
-    .AddAttribute ("Addstep", "Additive increase",
-                   DoubleValue(4.0),
+    .AddAttribute ("Addstep", "Additive increase step, in Mbps",
+                   DoubleValue(10.0),
                    MakeDoubleAccessor (&TcpTimely::m_addstep),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("Beta", "Multiplicative decrease",
@@ -62,20 +64,48 @@ TcpTimely::GetTypeId (void)
                    DoubleValue (250),
                    MakeDoubleAccessor (&TcpTimely::m_tlow),
                    MakeDoubleChecker<double> ())
-    .AddAttribute("QSizeCallback", "Callback to get size of queue",
-                  CallbackValue(MakeNullCallback<uint32_t>()),
-		  MakeCallbackAccessor(&TcpTimely::m_getQueueSize),
-                  MakeCallbackChecker())
-    .AddAttribute("UseOracle", "Use queue occupancy to determine cwnd",
+    .AddAttribute("UseOracle", "Use the max per-hop queue occupancy (packets) echoed "
+                  "by in-band telemetry instead of the RTT",
                  BooleanValue(false),
                  MakeBooleanAccessor(&TcpTimely::m_useOracle),
                  MakeBooleanChecker ())
+    .AddAttribute ("UpdateMode", "When the rate is updated: on every ACK, once per RTT, "
+                   "or once per CompletionBytes acknowledged",
+                   EnumValue (TcpTimely::UPDATE_PER_ACK),
+                   MakeEnumAccessor (&TcpTimely::m_updateMode),
+                   MakeEnumChecker (TcpTimely::UPDATE_PER_ACK, "PerAck",
+                                    TcpTimely::UPDATE_PER_RTT, "PerRtt",
+                                    TcpTimely::UPDATE_PER_BYTES, "PerBytes"))
+    .AddAttribute ("CompletionBytes", "Bytes acknowledged per completion event, with UpdateMode PerBytes",
+                   UintegerValue (16384),
+                   MakeUintegerAccessor (&TcpTimely::m_completionBytes),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxGradient", "Bound on the absolute value of the normalized gradient",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&TcpTimely::m_maxGradient),
+                   MakeDoubleChecker<double> (0))
+    .AddTraceSource ("RttDiff",
+                     "EWMA of the difference between consecutive RTTs (us)",
+                     MakeTraceSourceAccessor (&TcpTimely::m_rttDiffMs),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("NormalizedGradient",
+                     "RTT difference normalized by the minimum RTT",
+                     MakeTraceSourceAccessor (&TcpTimely::m_normalizedGradient),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("CompletionEvents",
+                     "Consecutive completion events with a non-positive gradient",
+                     MakeTraceSourceAccessor (&TcpTimely::m_completionEvents),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("HaiEntries",
+                     "Number of times the hyper-active increase mode was entered",
+                     MakeTraceSourceAccessor (&TcpTimely::m_haiEntries),
+                     "ns3::TracedValueCallback::Uint32")
  ;
   return tid;
 }
 
 TcpTimely::TcpTimely (void)
-  : TcpNewReno (),
+  : TcpRateCongestionOps (),
     m_emwa(0.1),
     m_addstep (1),
     m_beta (0.5),
@@ -83,20 +113,27 @@ TcpTimely::TcpTimely (void)
     m_tlow (2000),
     m_baseRtt (Time::Max ()),
     m_minRtt (DBL_MAX),
+    m_measurement (0),
     m_cntRtt (0),
     m_doingTimelyNow (true),
     m_begSndNxt (0),
     m_prevRtt(DBL_MAX),
     m_rttDiffMs(0),
+    m_normalizedGradient (0),
     m_completionEvents(0),
-    m_useOracle(false)
+    m_haiEntries (0),
+    m_useOracle(false),
+    m_updateMode (UPDATE_PER_ACK),
+    m_completionBytes (16384),
+    m_maxGradient (1.0),
+    m_bytesSinceUpdate (0)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO("TIMELY");
 }
 
 TcpTimely::TcpTimely (const TcpTimely& sock)
-  : TcpNewReno (sock),
+  : TcpRateCongestionOps (sock),
     m_emwa(sock.m_emwa),
     m_addstep (sock.m_addstep),
     m_beta (sock.m_beta),
@@ -104,13 +141,20 @@ TcpTimely::TcpTimely (const TcpTimely& sock)
     m_tlow (sock.m_tlow),
     m_baseRtt (sock.m_baseRtt),
     m_minRtt (sock.m_minRtt),
+    m_measurement (sock.m_measurement),
     m_cntRtt (sock.m_cntRtt),
     m_doingTimelyNow (true),
     m_begSndNxt (0),
     m_prevRtt(sock.m_prevRtt),
     m_rttDiffMs(0),
+    m_normalizedGradient (0),
     m_completionEvents(0),
-    m_useOracle(false)
+    m_haiEntries (0),
+    m_useOracle(sock.m_useOracle),
+    m_updateMode (sock.m_updateMode),
+    m_completionBytes (sock.m_completionBytes),
+    m_maxGradient (sock.m_maxGradient),
+    m_bytesSinceUpdate (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -131,76 +175,147 @@ TcpTimely::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
                      const Time& rtt)
 {
   NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
-  
+
+  m_bytesSinceUpdate += static_cast<uint64_t> (segmentsAcked) * tcb->m_segmentSize;
+
   if (rtt.IsZero ())
     {
       return;
     }
-  if (!m_rttcallback.IsNull()) 
-      this->m_rttcallback(rtt.GetMicroSeconds());
-  double EWMA = m_emwa;
+
+  FilterSample (tcb, rtt);
+  if (IsUpdateDue (tcb))
+    {
+      UpdateTimely (tcb);
+    }
+}
+
+void
+TcpTimely::PktsAckedBatch (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                           const std::vector<TcpRttSample> &samples)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << samples.size ());
+
+  m_bytesSinceUpdate += static_cast<uint64_t> (segmentsAcked) * tcb->m_segmentSize;
+
+  bool filtered = false;
+  for (std::vector<TcpRttSample>::const_iterator it = samples.begin ();
+       it != samples.end (); ++it)
+    {
+      if (!it->rtt.IsZero ())
+        {
+          FilterSample (tcb, it->rtt);
+          filtered = true;
+        }
+    }
+
+  // One rate decision for the whole ACK, on the gradient of all its segments
+  if (filtered && IsUpdateDue (tcb))
+    {
+      UpdateTimely (tcb);
+    }
+}
+
+void
+TcpTimely::FilterSample (Ptr<const TcpSocketState> tcb, const Time &rtt)
+{
+  TraceRtt (rtt);
+
+  m_measurement = m_useOracle ? tcb->m_pathQueuePackets : rtt.GetMicroSeconds ();
+  m_lastRtt = rtt;
+
+  m_minRtt = std::min (m_minRtt, m_measurement);
+
+  // The first sample has no previous one to be compared to
+  if (m_prevRtt != DBL_MAX)
+    {
+      double new_rtt_diff_us = m_measurement - m_prevRtt;
+      m_rttDiffMs = (1 - m_emwa) * m_rttDiffMs + m_emwa * new_rtt_diff_us;
+    }
+  m_prevRtt = m_measurement;
+
+  m_baseRtt = std::min (m_baseRtt, rtt);
+  m_cntRtt++;
+}
+
+bool
+TcpTimely::IsUpdateDue (Ptr<const TcpSocketState> tcb)
+{
+  // No rate decision during loss recovery
+  if (!m_doingTimelyNow)
+    {
+      return false;
+    }
+
+  switch (m_updateMode)
+    {
+    case UPDATE_PER_RTT:
+      // The RTT ends when the data sent at the last update is acknowledged
+      if (tcb->m_lastAckedSeq < m_begSndNxt)
+        {
+          return false;
+        }
+      m_begSndNxt = tcb->m_nextTxSequence;
+      m_cntRtt = 0;
+      return true;
+    case UPDATE_PER_BYTES:
+      if (m_bytesSinceUpdate < m_completionBytes)
+        {
+          return false;
+        }
+      m_bytesSinceUpdate = 0;
+      return true;
+    case UPDATE_PER_ACK:
+    default:
+      return true;
+    }
+}
+
+void
+TcpTimely::UpdateTimely (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
   double BETA = m_beta;
-  double ADDSTEP = m_addstep;
+  double ADDSTEP = m_addstep * 1e6;
   double TLOW = m_tlow;
   double THIGH = m_thigh;
-  
-  if (!m_getQueueSize.IsNull()) {
-    //uint32_t queue_occupancy = this->m_getQueueSize();
-    //std::cout << "Queue occupancy: " << queue_occupancy << std::endl;
-  }
-
-  double measurement = m_useOracle ? m_getQueueSize() : rtt.GetMicroSeconds();
 
-  m_minRtt = std::min (m_minRtt, measurement);
-
-  double new_rtt_diff_us = measurement - m_prevRtt;
-  m_prevRtt = measurement;
-  m_rttDiffMs = (1 - EWMA ) * m_rttDiffMs + EWMA * new_rtt_diff_us;
+  double measurement = m_measurement;
   double normalized_gradient = m_rttDiffMs / m_minRtt;
- 
-  NS_LOG_INFO(rtt.GetMicroSeconds() << " " << ns3::Simulator::Now().GetMicroSeconds());
+  // A single large RTT jump must not zero the rate nor boost it out of proportion
+  normalized_gradient = std::max (-m_maxGradient, std::min (normalized_gradient, m_maxGradient));
+  m_normalizedGradient = normalized_gradient;
+
+  NS_LOG_INFO (m_lastRtt.GetMicroSeconds () << " " << ns3::Simulator::Now ().GetMicroSeconds ());
 
   if (measurement < TLOW) {
     NS_LOG_INFO( "too low" );
     m_completionEvents = 0;
     m_rate = m_rate + ADDSTEP;
-    tcb->m_cWnd = m_rate * tcb->m_segmentSize;
-    NS_LOG_INFO("window size is now: " << tcb->m_cWnd);
-    return;
   } else if (measurement > THIGH) {
     NS_LOG_INFO( "too high" );
     m_completionEvents = 0;
     m_rate = m_rate * (1 - BETA * (1 - THIGH/measurement));
-    tcb->m_cWnd = m_rate * tcb->m_segmentSize;
-    NS_LOG_INFO("window size is now: " << tcb->m_cWnd);
-    return;
-  }
-  
-  if (normalized_gradient <= 0) {
+  } else if (normalized_gradient <= 0) {
     NS_LOG_INFO( "normalized gradient" );
     m_completionEvents += 1;
     int N = 1;
-    if (m_completionEvents >= 5) {
+    if (m_completionEvents >= 5u) {
       NS_LOG_INFO( "Entering HAI mode" );
       N = 5;
-      m_completionEvents = 0; // Not sure if need to reset to get out of HAI mode?
+      m_haiEntries++;
+      m_completionEvents = 0;
     }
     m_rate = m_rate + N * ADDSTEP;
   } else {
     m_rate = m_rate * (1 - BETA * normalized_gradient);
     m_completionEvents = 0;
   }
- 
-  tcb->m_cWnd = m_rate * tcb->m_segmentSize;
-  NS_LOG_INFO("window size is now: " << tcb->m_cWnd);
-
 
-  m_baseRtt = std::min (m_baseRtt, rtt);
-  NS_LOG_INFO ("Updated m_baseRtt = " << m_baseRtt);
-
-  // Update RTT counter
-  m_cntRtt++;
-  NS_LOG_INFO ("Updated m_cntRtt = " << m_cntRtt);
+  UpdateRate (tcb);
+  NS_LOG_INFO ("rate is now: " << tcb->m_pacingRate << " window size is now: " << tcb->m_cWnd);
+  NS_LOG_INFO ("m_baseRtt = " << m_baseRtt << " m_cntRtt = " << m_cntRtt);
 }
 
 void
@@ -211,8 +326,10 @@ TcpTimely::EnableTimely (Ptr<TcpSocketState> tcb)
   m_doingTimelyNow = true;
   m_begSndNxt = tcb->m_nextTxSequence;
   m_cntRtt = 0;
-  m_rate = 0.0;
   m_minRtt = DBL_MAX;
+  m_bytesSinceUpdate = 0;
+
+  InitRate (tcb);
 }
 
 void
@@ -238,13 +355,6 @@ TcpTimely::CongestionStateSet (Ptr<TcpSocketState> tcb,
     }
 }
 
-void
-TcpTimely::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
-{
-  tcb->m_cWnd = m_rate * tcb->m_segmentSize;
-  return;
-}
-
 std::string
 TcpTimely::GetName () const
 {
@@ -252,11 +362,14 @@ TcpTimely::GetName () const
 }
 
 uint32_t
-TcpTimely::GetSsThresh (Ptr<const TcpSocketState> tcb,
-                       uint32_t bytesInFlight)
+TcpTimely::GetCapabilities () const
 {
-  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
-  return std::max (tcb->m_cWnd.Get (), 2 * tcb->m_segmentSize);
+  uint32_t caps = CAP_OWNS_CWND | CAP_RAW_RTT | CAP_SEGMENT_RTT;
+  if (m_useOracle)
+    {
+      caps |= CAP_TELEMETRY;
+    }
+  return caps;
 }
 
 } // namespace ns3
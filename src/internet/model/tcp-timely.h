@@ -27,7 +27,7 @@
 #ifndef TCPTimely_H
 #define TCPTimely_H
 
-#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-rate-congestion-ops.h"
 
 namespace ns3 {
 
@@ -36,31 +36,54 @@ namespace ns3 {
  *
  * \brief An implementation of TCP Timely
  *
- * TCP Timely is a pure delay-based congestion control algorithm implementing a proactive
- * scheme that tries to prevent packet drops by maintaining a small backlog at the
- * bottleneck queue.
+ * Timely is a rate-based congestion control algorithm for datacenter
+ * networks which uses the RTT, and in particular its gradient, as the
+ * congestion signal.
  *
- * Timely continuously measures the actual throughput a connection achieves as shown in
- * Equation (1) and compares it with the expected throughput calculated in Equation (2).
- * The difference between these 2 sending rates in Equation (3) reflects the amount of
- * extra packets being queued at the bottleneck.
+ * Each RTT sample is compared against two thresholds. Below TLow the rate is
+ * additively increased; above THigh the rate is multiplicatively decreased
+ * in proportion to how much the RTT exceeds THigh:
  *
- *              actual = cwnd / RTT        (1)
- *              expected = cwnd / BaseRTT  (2)
- *              diff = expected - actual   (3)
+ *              rate = rate * (1 - Beta * (1 - THigh / rtt))
  *
- * To avoid congestion, Timely linearly increases/decreases its congestion window to ensure
- * the diff value fall between the 2 predefined thresholds, alpha and beta.
- * diff and another threshold, gamma, are used to determine when Timely should change from
- * its slow-start mode to linear increase/decrease mode.
+ * Between the two thresholds the EWMA-filtered RTT difference, normalized by
+ * the minimum RTT, drives the rate:
  *
- * Following the implementation of Timely in Linux, we use 2, 4, and 1 as the default values
- * of alpha, beta, and gamma, respectively.
+ *              gradient <= 0 : rate = rate + N * Addstep
+ *              gradient >  0 : rate = rate * (1 - Beta * gradient)
  *
- * More information: http://dx.doi.org/10.1109/49.464716
+ * where N is 5 (hyper-active increase, HAI) after five consecutive
+ * completion events with a non-positive gradient, and 1 otherwise.
+ *
+ * The rate is handled by TcpRateCongestionOps: it is clamped between
+ * MinRate and MaxRate and published to the socket as the pacing rate, so
+ * segments are paced instead of being sent in window-sized bursts.
+ *
+ * The normalized gradient is clipped to [-MaxGradient, MaxGradient], so
+ * that a single RTT jump cannot zero the rate (with Beta * gradient > 1)
+ * nor over-amplify it.
+ *
+ * Every sample is filtered, but by default the rate is updated on every
+ * ACK, so that successive decisions compound within one RTT. The
+ * "UpdateMode" attribute gates the update: once per RTT (when the data
+ * sent at the previous update is acknowledged) or once per completion
+ * event of CompletionBytes acknowledged, as in the paper. No update is
+ * made during loss recovery.
+ *
+ * The gradient filter is designed for a dense stream of completion times,
+ * so Timely asks the socket for one RTT sample per segment
+ * (TcpCongestionOps::CAP_SEGMENT_RTT) instead of one per ACK.
+ *
+ * The state of the algorithm (rate, filtered RTT difference, normalized
+ * gradient, completion events and HAI entries) is exported as trace
+ * sources. They can be reached from a socket through its "CongestionOps"
+ * attribute, e.g.
+ * "/NodeList/[i]/$ns3::TcpL4Protocol/SocketList/[j]/CongestionOps/$ns3::TcpTimely/Rate".
+ *
+ * More information: http://dx.doi.org/10.1145/2785956.2787510
  */
 
-class TcpTimely : public TcpNewReno
+class TcpTimely : public TcpRateCongestionOps
 {
 public:
   /**
@@ -69,6 +92,16 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief When the rate is updated
+   */
+  typedef enum
+  {
+    UPDATE_PER_ACK,          /**< On every ACK carrying RTT samples */
+    UPDATE_PER_RTT,          /**< Once per RTT */
+    UPDATE_PER_BYTES         /**< Once per CompletionBytes acknowledged */
+  } UpdateMode_t;
+
   /**
    * Create an unbound tcp socket.
    */
@@ -83,6 +116,14 @@ public:
 
   virtual std::string GetName () const;
 
+  /**
+   * \brief Timely drives cWnd from its rate and needs one raw RTT sample per segment
+   *
+   * \return CAP_OWNS_CWND | CAP_RAW_RTT | CAP_SEGMENT_RTT, plus
+   *         CAP_TELEMETRY when UseOracle is set
+   */
+  virtual uint32_t GetCapabilities () const;
+
   /**
    * \brief Compute RTTs needed to execute Timely algorithm
    *
@@ -102,34 +143,29 @@ public:
                           const Time& rtt);
 
   /**
-   * \brief Enable/disable Timely algorithm depending on the congestion state
-   *
-   * We only start a Timely cycle when we are in normal congestion state (CA_OPEN state).
+   * \brief Run Timely over all the per-segment samples of an ACK
    *
-   * \param tcb internal congestion state
-   * \param newState new congestion state to which the TCP is going to switch
-   */
-  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
-                                   const TcpSocketState::TcpCongState_t newState);
-
-  /**
-   * \brief Adjust cwnd following Timely linear increase/decrease algorithm
+   * Every sample goes through the EWMA filter of the RTT difference, in a
+   * single loop; the rate is then updated once, with the resulting gradient
+   * and the newest sample.
    *
    * \param tcb internal congestion state
    * \param segmentsAcked count of segments ACKed
+   * \param samples per-segment RTT samples
    */
-  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual void PktsAckedBatch (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                               const std::vector<TcpRttSample> &samples);
 
   /**
-   * \brief Get slow start threshold following Timely principle
+   * \brief Enable/disable Timely algorithm depending on the congestion state
    *
-   * \param tcb internal congestion state
-   * \param bytesInFlight bytes in flight
+   * We only start a Timely cycle when we are in normal congestion state (CA_OPEN state).
    *
-   * \return the slow start threshold value
+   * \param tcb internal congestion state
+   * \param newState new congestion state to which the TCP is going to switch
    */
-  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
-                                uint32_t bytesInFlight);
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
 
   virtual Ptr<TcpCongestionOps> Fork ();
 
@@ -153,23 +189,57 @@ private:
    */
   void DisableTimely ();
 
+  /**
+   * \brief Feed one RTT sample to the filters
+   *
+   * Updates the minimum and base RTT and the EWMA of the RTT difference.
+   * With UseOracle, the measurement filtered is the path occupancy echoed
+   * by in-band telemetry instead of the RTT.
+   *
+   * \param tcb internal congestion state
+   * \param rtt the RTT sample
+   */
+  void FilterSample (Ptr<const TcpSocketState> tcb, const Time &rtt);
+
+  /**
+   * \brief Check whether the rate has to be updated, according to UpdateMode
+   *
+   * When it does, the next update period starts.
+   *
+   * \param tcb internal congestion state
+   * \return true if UpdateTimely has to be called
+   */
+  bool IsUpdateDue (Ptr<const TcpSocketState> tcb);
+
+  /**
+   * \brief Compute the new rate from the filtered samples
+   *
+   * \param tcb internal congestion state
+   */
+  void UpdateTimely (Ptr<TcpSocketState> tcb);
+
 private:
   double m_emwa;
-  double m_addstep;                  //!< Alpha threshold, lower bound of packets in network
-  double m_beta;                   //!< Beta threshold, upper bound of packets in network
-  double m_thigh;
-  double m_tlow;                  //!< Gamma threshold, limit on increase
+  double m_addstep;                  //!< Additive increment step (Mbps)
+  double m_beta;                     //!< Multiplicative decrement factor
+  double m_thigh;                    //!< Upper RTT threshold (us, or packets with UseOracle)
+  double m_tlow;                     //!< Lower RTT threshold (us, or packets with UseOracle)
   Time m_baseRtt;                    //!< Minimum of all Timely RTT measurements seen during connection
   double m_minRtt;                     //!< Minimum of all RTT measurements within last RTT
-  double m_rate;
+  double m_measurement;              //!< Last filtered measurement (us, or packets with the oracle)
   uint32_t m_cntRtt;                 //!< # of RTT measurements during last RTT
   bool m_doingTimelyNow;              //!< If true, do Timely for this RTT
   SequenceNumber32 m_begSndNxt;      //!< Right edge during last RTT
   double m_prevRtt;
-  double m_rttDiffMs;
-  int m_completionEvents;
-  bool m_useOracle;
-  Callback<uint32_t> m_getQueueSize;
+  TracedValue<double> m_rttDiffMs;   //!< EWMA of the RTT difference (us)
+  TracedValue<double> m_normalizedGradient; //!< RTT difference over the minimum RTT
+  TracedValue<uint32_t> m_completionEvents; //!< Consecutive non-positive gradients
+  TracedValue<uint32_t> m_haiEntries; //!< Times the hyper-active increase was entered
+  bool m_useOracle;                  //!< Use the path occupancy from telemetry instead of the RTT
+  UpdateMode_t m_updateMode;         //!< When the rate is updated
+  uint32_t m_completionBytes;        //!< Bytes per completion event, with UPDATE_PER_BYTES
+  double m_maxGradient;              //!< Bound on the absolute normalized gradient
+  uint64_t m_bytesSinceUpdate;       //!< Bytes ACKed since the last update
 };
 
 } // namespace ns3
@@ -24,7 +24,9 @@
 
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 #include "tcp-tx-buffer.h"
 
@@ -41,6 +43,12 @@ TcpTxBuffer::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("Internet")
     .AddConstructor<TcpTxBuffer> ()
+    .AddAttribute ("VirtualPayload",
+                   "Keep only the byte range of the data and send zero-filled segments",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpTxBuffer::SetVirtualPayload,
+                                        &TcpTxBuffer::GetVirtualPayload),
+                   MakeBooleanChecker ())
     .AddTraceSource ("UnackSequence",
                      "First unacknowledged sequence number (SND.UNA)",
                      MakeTraceSourceAccessor (&TcpTxBuffer::m_firstByteSeq),
@@ -57,7 +65,12 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0),
+    m_virtualPayload (false),
+    m_sackedBytes (0),
+    m_lostBytes (0),
+    m_delivered (false),
+    m_deliveredRetrans (false)
 {
 }
 
@@ -109,7 +122,12 @@ TcpTxBuffer::Add (Ptr<Packet> p)
                                   << m_firstByteSeq << ", availSize="<< Available ());
   if (p->GetSize () <= Available ())
     {
-      if (p->GetSize () > 0)
+      if (p->GetSize () > 0 && m_virtualPayload)
+        {
+          m_size += p->GetSize ();
+          NS_LOG_LOGIC ("Counted " << p->GetSize () << " virtual bytes, size=" << m_size);
+        }
+      else if (p->GetSize () > 0)
         {
           m_data.push_back (p);
           m_size += p->GetSize ();
@@ -142,7 +160,7 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     {
       return Create<Packet> (); // Empty packet returned
     }
-  if (m_data.size () == 0)
+  if (m_virtualPayload || m_data.size () == 0)
     { // No actual data, just return dummy-data packet of correct size
       return Create<Packet> (s);
     }
@@ -217,6 +235,17 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
+  DiscardSentUpTo (seq);
+
+  if (m_virtualPayload)
+    {
+      uint32_t offset = std::min<uint32_t> (seq - m_firstByteSeq.Get (), m_size);
+      m_size -= offset;
+      m_firstByteSeq = seq;
+      NS_LOG_LOGIC ("Discarded " << offset << " virtual bytes, size=" << m_size);
+      return;
+    }
+
   // Scan the buffer and discard packets
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
@@ -253,4 +282,320 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   NS_ASSERT (m_firstByteSeq == seq);
 }
 
+void
+TcpTxBuffer::SetVirtualPayload (bool virtualPayload)
+{
+  NS_LOG_FUNCTION (this << virtualPayload);
+  NS_ABORT_MSG_IF (m_size > 0 && virtualPayload != m_virtualPayload,
+                   "Cannot change the payload mode of a non-empty buffer");
+  m_virtualPayload = virtualPayload;
+}
+
+bool
+TcpTxBuffer::GetVirtualPayload (void) const
+{
+  return m_virtualPayload;
+}
+
+void
+TcpTxBuffer::SegmentSent (const SequenceNumber32 &seq, uint32_t size, const Time &now)
+{
+  NS_LOG_FUNCTION (this << seq << size << now);
+
+  SequenceNumber32 tail = seq + SequenceNumber32 (size);
+  SequenceNumber32 sentTail = m_sent.empty () ? m_firstByteSeq.Get ()
+    : m_sent.back ().seq + SequenceNumber32 (m_sent.back ().size);
+
+  // Only the bytes sent again are retransmitted, not the whole records
+  SplitSegment (seq);
+  SplitSegment (tail);
+  for (uint32_t i = FindSegment (seq); i < m_sent.size () && m_sent[i].seq < tail; ++i)
+    { // Retransmission
+      SentSegment &segment = m_sent[i];
+      if (segment.lost)
+        {
+          segment.lost = false;
+          m_lostBytes -= segment.size;
+        }
+      segment.retrans = true;
+      segment.lastSent = now;
+    }
+
+  if (tail > sentTail)
+    {
+      SentSegment segment;
+      segment.seq = std::max (seq, sentTail);
+      segment.size = tail - segment.seq;
+      segment.lastSent = now;
+      segment.sacked = false;
+      segment.lost = false;
+      segment.retrans = false;
+      m_sent.push_back (segment);
+    }
+}
+
+uint32_t
+TcpTxBuffer::UpdateScoreboard (const TcpOptionSack::SackList &list)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t sacked = 0;
+  for (TcpOptionSack::SackList::const_iterator it = list.begin (); it != list.end (); ++it)
+    {
+      // Only the records fully covered are SACKed, once split at the block
+      SplitSegment (it->first);
+      SplitSegment (it->second);
+      for (uint32_t i = FindSegment (it->first); i < m_sent.size (); ++i)
+        {
+          SentSegment &segment = m_sent[i];
+          if (segment.seq + SequenceNumber32 (segment.size) > it->second)
+            {
+              break;
+            }
+          if (segment.seq < it->first || segment.sacked)
+            {
+              continue;
+            }
+          segment.sacked = true;
+          m_sackedBytes += segment.size;
+          sacked += segment.size;
+          if (segment.lost)
+            {
+              segment.lost = false;
+              m_lostBytes -= segment.size;
+            }
+          Delivered (segment);
+        }
+    }
+  NS_LOG_LOGIC ("SACKed " << sacked << " bytes, " << m_sackedBytes << " in total");
+  return sacked;
+}
+
+uint32_t
+TcpTxBuffer::MarkLostByDupThresh (uint32_t dupThresh, uint32_t segmentSize)
+{
+  NS_LOG_FUNCTION (this << dupThresh << segmentSize);
+
+  uint32_t lost = 0;
+  uint32_t sackedAbove = 0;
+  uint32_t threshold = (dupThresh - 1) * segmentSize;
+  for (std::deque<SentSegment>::reverse_iterator it = m_sent.rbegin (); it != m_sent.rend (); ++it)
+    {
+      if (it->sacked)
+        {
+          sackedAbove += it->size;
+        }
+      else if (sackedAbove > threshold && !it->lost && !it->retrans)
+        { // A retransmission is only declared lost again by RACK or RTO
+          it->lost = true;
+          m_lostBytes += it->size;
+          lost += it->size;
+        }
+    }
+  return lost;
+}
+
+uint32_t
+TcpTxBuffer::MarkLostByRack (const Time &xmitTs, const SequenceNumber32 &endSeq,
+                             const Time &window, const Time &now, Time &timeout)
+{
+  NS_LOG_FUNCTION (this << xmitTs << endSeq << window << now);
+
+  uint32_t lost = 0;
+  timeout = Time (0);
+  for (std::deque<SentSegment>::iterator it = m_sent.begin (); it != m_sent.end (); ++it)
+    {
+      if (it->sacked || it->lost)
+        {
+          continue;
+        }
+      bool sentBefore = it->lastSent < xmitTs
+        || (it->lastSent == xmitTs && it->seq + SequenceNumber32 (it->size) < endSeq);
+      if (!sentBefore)
+        {
+          continue;
+        }
+      Time remaining = it->lastSent + window - now;
+      if (remaining <= Time (0))
+        {
+          it->lost = true;
+          m_lostBytes += it->size;
+          lost += it->size;
+        }
+      else
+        {
+          timeout = Max (timeout, remaining);
+        }
+    }
+  return lost;
+}
+
+uint32_t
+TcpTxBuffer::MarkAllLost (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t lost = 0;
+  for (std::deque<SentSegment>::iterator it = m_sent.begin (); it != m_sent.end (); ++it)
+    {
+      if (!it->sacked && !it->lost)
+        {
+          it->lost = true;
+          m_lostBytes += it->size;
+          lost += it->size;
+        }
+    }
+  return lost;
+}
+
+bool
+TcpTxBuffer::NextLostSegment (SequenceNumber32 &seq, uint32_t &size) const
+{
+  if (m_lostBytes == 0)
+    {
+      return false;
+    }
+  for (std::deque<SentSegment>::const_iterator it = m_sent.begin (); it != m_sent.end (); ++it)
+    {
+      if (it->lost)
+        {
+          seq = it->seq;
+          size = it->size;
+          return true;
+        }
+    }
+  NS_ASSERT_MSG (false, "Lost bytes without lost segment");
+  return false;
+}
+
+bool
+TcpTxBuffer::GetLastDelivered (Time &xmitTs, SequenceNumber32 &endSeq, bool &retrans)
+{
+  if (!m_delivered)
+    {
+      return false;
+    }
+  xmitTs = m_deliveredXmitTs;
+  endSeq = m_deliveredEndSeq;
+  retrans = m_deliveredRetrans;
+  m_delivered = false;
+  return true;
+}
+
+uint32_t
+TcpTxBuffer::GetSackedBytes (void) const
+{
+  return m_sackedBytes;
+}
+
+uint32_t
+TcpTxBuffer::GetLostBytes (void) const
+{
+  return m_lostBytes;
+}
+
+uint32_t
+TcpTxBuffer::BytesInFlight (void) const
+{
+  if (m_sent.empty ())
+    {
+      return 0;
+    }
+  SequenceNumber32 sentTail = m_sent.back ().seq + SequenceNumber32 (m_sent.back ().size);
+  uint32_t outstanding = sentTail - m_firstByteSeq.Get ();
+  NS_ASSERT (outstanding >= m_sackedBytes + m_lostBytes);
+  return outstanding - m_sackedBytes - m_lostBytes;
+}
+
+uint32_t
+TcpTxBuffer::FindSegment (const SequenceNumber32 &seq) const
+{
+  // Binary search of the first record ending after seq
+  uint32_t low = 0;
+  uint32_t high = m_sent.size ();
+  while (low < high)
+    {
+      uint32_t mid = (low + high) / 2;
+      if (m_sent[mid].seq + SequenceNumber32 (m_sent[mid].size) <= seq)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+  return low;
+}
+
+void
+TcpTxBuffer::SplitSegment (const SequenceNumber32 &seq)
+{
+  uint32_t i = FindSegment (seq);
+  if (i == m_sent.size () || m_sent[i].seq >= seq)
+    {
+      return;
+    }
+  // the flags and the byte counts hold for both parts
+  SentSegment tail = m_sent[i];
+  tail.seq = seq;
+  tail.size = m_sent[i].seq + SequenceNumber32 (m_sent[i].size) - seq;
+  m_sent[i].size -= tail.size;
+  m_sent.insert (m_sent.begin () + i + 1, tail);
+}
+
+void
+TcpTxBuffer::Delivered (const SentSegment &segment)
+{
+  SequenceNumber32 endSeq = segment.seq + SequenceNumber32 (segment.size);
+  if (!m_delivered || segment.lastSent > m_deliveredXmitTs
+      || (segment.lastSent == m_deliveredXmitTs && endSeq > m_deliveredEndSeq))
+    {
+      m_delivered = true;
+      m_deliveredXmitTs = segment.lastSent;
+      m_deliveredEndSeq = endSeq;
+      m_deliveredRetrans = segment.retrans;
+    }
+}
+
+void
+TcpTxBuffer::DiscardSentUpTo (const SequenceNumber32& seq)
+{
+  while (!m_sent.empty ())
+    {
+      SentSegment &segment = m_sent.front ();
+      if (segment.seq >= seq)
+        {
+          break;
+        }
+      SequenceNumber32 endSeq = segment.seq + SequenceNumber32 (segment.size);
+      uint32_t acked = std::min (seq, endSeq) - segment.seq;
+      if (!segment.sacked)
+        {
+          // only the acknowledged part of the record is delivered
+          SentSegment delivered = segment;
+          delivered.size = acked;
+          Delivered (delivered);
+        }
+      if (segment.sacked)
+        {
+          m_sackedBytes -= acked;
+        }
+      if (segment.lost)
+        {
+          m_lostBytes -= acked;
+        }
+      if (endSeq <= seq)
+        {
+          m_sent.pop_front ();
+        }
+      else
+        { // Partially acknowledged
+          segment.seq = seq;
+          segment.size -= acked;
+          break;
+        }
+    }
+}
+
 } // namepsace ns3
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-tx-timestamp-ring.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpTxTimestampRing");
+
+TcpTxTimestampRing::TcpTxTimestampRing (uint32_t capacity)
+  : m_head (0),
+    m_count (0)
+{
+  uint32_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_ring.resize (size);
+  m_mask = size - 1;
+}
+
+void
+TcpTxTimestampRing::Push (const SequenceNumber32 &seq, uint32_t size,
+                          const Time &time)
+{
+  NS_LOG_FUNCTION (this << seq << size << time);
+
+  if (m_count == m_ring.size ())
+    {
+      Grow ();
+    }
+
+  Entry &e = m_ring[(m_head + m_count) & m_mask];
+  e.seq = seq;
+  e.size = size;
+  e.time = time;
+  e.retx = false;
+  ++m_count;
+}
+
+void
+TcpTxTimestampRing::MarkRetransmitted (const SequenceNumber32 &seq, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << seq << size);
+
+  // The retransmitted segment is almost always at the head
+  for (uint32_t i = 0; i < m_count; ++i)
+    {
+      Entry &e = m_ring[(m_head + i) & m_mask];
+      if (size == 0)
+        { // SYN retransmission
+          if (e.seq == seq)
+            {
+              e.retx = true;
+              break;
+            }
+          continue;
+        }
+      if (e.seq >= seq + size)
+        {
+          break;
+        }
+      if (seq < e.seq + e.size)
+        {
+          e.retx = true;
+        }
+    }
+}
+
+uint32_t
+TcpTxTimestampRing::Complete (const SequenceNumber32 &ack, const Time &now,
+                              SampleMode_t mode, std::vector<TcpRttSample> &samples)
+{
+  NS_LOG_FUNCTION (this << ack << now);
+
+  uint32_t completed = 0;
+  bool newestValid = false;
+  TcpRttSample sample;
+
+  while (m_count > 0)
+    {
+      Entry &e = m_ring[m_head];
+      if (e.seq + e.size > ack)
+        {
+          break;
+        }
+
+      sample.rtt = now - e.time;
+      sample.bytes = e.size;
+      if (mode == SAMPLE_ALL)
+        {
+          if (!e.retx)
+            {
+              samples.push_back (sample);
+            }
+        }
+      else
+        {
+          newestValid = !e.retx;
+        }
+
+      m_head = (m_head + 1) & m_mask;
+      --m_count;
+      ++completed;
+    }
+
+  if (newestValid)
+    {
+      samples.push_back (sample);
+    }
+
+  return completed;
+}
+
+void
+TcpTxTimestampRing::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_head = 0;
+  m_count = 0;
+}
+
+uint32_t
+TcpTxTimestampRing::GetSize (void) const
+{
+  return m_count;
+}
+
+void
+TcpTxTimestampRing::Grow (void)
+{
+  NS_LOG_FUNCTION (this << m_ring.size ());
+
+  std::vector<Entry> ring (m_ring.size () * 2);
+  for (uint32_t i = 0; i < m_count; ++i)
+    {
+      ring[i] = m_ring[(m_head + i) & m_mask];
+    }
+  m_ring.swap (ring);
+  m_head = 0;
+  m_mask = m_ring.size () - 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef TCP_TX_TIMESTAMP_RING_H
+#define TCP_TX_TIMESTAMP_RING_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/sequence-number.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief An RTT sample taken for one completed segment
+ */
+struct TcpRttSample
+{
+  Time rtt;          //!< Time between the send of the segment and its ACK
+  uint32_t bytes;    //!< Size of the segment
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Per-segment transmission timestamps, kept in a ring buffer
+ *
+ * This is the sampling path used by delay-based congestion controls which
+ * want one RTT sample per segment, as a NIC with hardware timestamps would
+ * provide them, instead of one sample per ACK.
+ *
+ * Each transmitted segment is appended with its send time. When an ACK
+ * arrives, every segment it completes is removed from the head of the ring
+ * and, if it was never retransmitted (Karn's algorithm), yields a sample
+ * equal to the ACK arrival time minus its send time.
+ *
+ * The storage is a power-of-two vector which is only grown (doubling) when
+ * full, so in steady state no allocation happens per segment.
+ */
+class TcpTxTimestampRing
+{
+public:
+  /**
+   * \brief How an ACK covering several segments is turned into samples
+   *
+   * When the receiver delays or coalesces ACKs, the older segments covered
+   * by one ACK carry the receiver hold time in their sample, while the
+   * newest one (the segment which triggered the ACK) does not.
+   */
+  typedef enum
+  {
+    SAMPLE_ALL,     /**< One sample for every segment completed by the ACK */
+    SAMPLE_NEWEST   /**< Only the newest completed segment gives a sample */
+  } SampleMode_t;
+
+  /**
+   * \brief Constructor
+   * \param capacity initial capacity, rounded up to a power of two
+   */
+  TcpTxTimestampRing (uint32_t capacity = 64);
+
+  /**
+   * \brief Record a segment sent for the first time
+   *
+   * \param seq first sequence number of the segment
+   * \param size size of the segment (0 for SYN/FIN)
+   * \param time time the segment has been sent
+   */
+  void Push (const SequenceNumber32 &seq, uint32_t size, const Time &time);
+
+  /**
+   * \brief Mark the segments overlapping a retransmission as not valid
+   *
+   * \param seq first sequence number retransmitted
+   * \param size number of bytes retransmitted
+   */
+  void MarkRetransmitted (const SequenceNumber32 &seq, uint32_t size);
+
+  /**
+   * \brief Remove the segments completed by a cumulative ACK
+   *
+   * The samples are appended to the vector, in sequence order.
+   *
+   * \param ack the cumulative ACK number
+   * \param now arrival time of the ACK
+   * \param mode how the completed segments are sampled
+   * \param samples vector where the valid samples are appended
+   * \return the number of segments completed
+   */
+  uint32_t Complete (const SequenceNumber32 &ack, const Time &now,
+                     SampleMode_t mode, std::vector<TcpRttSample> &samples);
+
+  /**
+   * \brief Forget all the recorded segments
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the number of segments recorded
+   * \return the number of segments waiting for an ACK
+   */
+  uint32_t GetSize (void) const;
+
+private:
+  /**
+   * \brief A segment waiting to be acknowledged
+   */
+  struct Entry
+  {
+    SequenceNumber32 seq;  //!< First sequence number in segment
+    uint32_t size;         //!< Number of bytes in segment
+    Time time;             //!< Send time
+    bool retx;             //!< True if (part of) it has been retransmitted
+  };
+
+  /**
+   * \brief Double the storage, keeping the entries in order
+   */
+  void Grow (void);
+
+  std::vector<Entry> m_ring;  //!< Storage
+  uint32_t m_head;            //!< Index of the oldest entry
+  uint32_t m_count;           //!< Number of entries
+  uint32_t m_mask;            //!< Storage size - 1
+};
+
+} // namespace ns3
+
+#endif /* TCP_TX_TIMESTAMP_RING_H */
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EndPointDemuxTestSuite");
+
+/**
+ * \brief Testing the lookup of Ipv4EndPointDemux across its two tiers
+ */
+class Ipv4EndPointDemuxTest : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTest::Ipv4EndPointDemuxTest ()
+  : TestCase ("IPv4 lookup of listening and connected endpoints")
+{
+}
+
+void
+Ipv4EndPointDemuxTest::DoRun ()
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+
+  Ipv4EndPoint *listener = demux.Allocate (80);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Port not in use");
+
+  // An accepted connection is hashed on its four-tuple
+  Ipv4EndPoint *accepted = demux.Allocate (local, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (accepted, 0, "Connection not allocated");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, peer, 1000), 0, "Duplicate four-tuple allocated");
+
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), accepted, "Connection not preferred to the listener");
+  found = demux.Lookup (local, 80, peer, 1001, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Unknown peer not given to the listener");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1000), accepted, "Wrong simple lookup");
+
+  // A connecting socket moves to the hashed tier once its addresses are set
+  Ipv4EndPoint *connecting = demux.Allocate ();
+  uint16_t port = connecting->GetLocalPort ();
+  connecting->SetPeer (peer, 2000);
+  connecting->SetLocalAddress (local);
+  found = demux.Lookup (local, port, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), connecting, "Endpoint not rehashed");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 3, "Wrong number of endpoints");
+
+  connecting->SetRxEnabled (false);
+  found = demux.Lookup (local, port, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 0, "Endpoint with disabled Rx found");
+
+  demux.DeAllocate (connecting);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), false, "Port still in use");
+  demux.DeAllocate (accepted);
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Removed connection found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Listener port released");
+}
+
+/**
+ * \brief Testing the lookup of Ipv6EndPointDemux across its two tiers
+ */
+class Ipv6EndPointDemuxTest : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTest::Ipv6EndPointDemuxTest ()
+  : TestCase ("IPv6 lookup of listening and connected endpoints")
+{
+}
+
+void
+Ipv6EndPointDemuxTest::DoRun ()
+{
+  Ipv6EndPointDemux demux;
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+
+  Ipv6EndPoint *listener = demux.Allocate (80);
+  Ipv6EndPoint *accepted = demux.Allocate (local, 80, peer, 1000);
+
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), accepted, "Connection not preferred to the listener");
+
+  accepted->SetPeer (peer, 1001);
+  found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Old four-tuple still hashed");
+  found = demux.Lookup (local, 80, peer, 1001, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), accepted, "Endpoint not rehashed");
+
+  demux.DeAllocate (accepted);
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 1, "Wrong number of endpoints");
+}
+
+// -------------------------------------------------------------------
+static class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTest (), TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTest (), TestCase::QUICK);
+  }
+} g_endPointDemuxTestSuite;
+
+} // namespace ns3
@@ -14,13 +14,17 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <map>
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
@@ -36,6 +40,7 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/udp-header.h"
 
 using namespace ns3;
 
@@ -419,6 +424,115 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class Ipv4GlobalRoutingFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowEcmpTestCase ();
+  virtual ~Ipv4GlobalRoutingFlowEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Route a UDP packet of a flow
+   * \param routing the routing protocol
+   * \param srcPort the source port of the flow
+   * \returns the gateway of the route
+   */
+  Ipv4Address RouteFlow (Ptr<Ipv4GlobalRouting> routing, uint16_t srcPort);
+};
+
+Ipv4GlobalRoutingFlowEcmpTestCase::Ipv4GlobalRoutingFlowEcmpTestCase ()
+  : TestCase ("Flow hash ECMP global routing")
+{
+}
+
+Ipv4GlobalRoutingFlowEcmpTestCase::~Ipv4GlobalRoutingFlowEcmpTestCase ()
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingFlowEcmpTestCase::RouteFlow (Ptr<Ipv4GlobalRouting> routing, uint16_t srcPort)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (srcPort);
+  udp.SetDestinationPort (1234);
+  p->AddHeader (udp);
+
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.0.1"));
+  header.SetDestination (Ipv4Address ("10.2.0.1"));
+  header.SetProtocol (17);
+
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = routing->RouteOutput (p, header, 0, err);
+  NS_TEST_EXPECT_MSG_NE (route, 0, "No route to the destination");
+  return route ? route->GetGateway () : Ipv4Address ();
+}
+
+// A node with four equal cost routes to 10.2.0.0/16, one per interface
+//
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::DoRun (void)
+{
+  const uint32_t nPaths = 4;
+
+  Ptr<Node> n = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (n);
+  Ptr<Ipv4> ipv4 = n->GetObject<Ipv4> ();
+
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+  routing->SetIpv4 (ipv4);
+
+  std::vector<Ipv4Address> gateways;
+  for (uint32_t i = 0; i < nPaths; ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      n->AddDevice (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+
+      std::ostringstream local;
+      std::ostringstream gateway;
+      local << "10.1." << i << ".1";
+      gateway << "10.1." << i << ".2";
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (local.str ().c_str ()),
+                                                       Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+
+      gateways.push_back (Ipv4Address (gateway.str ().c_str ()));
+      routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("/16"),
+                                  gateways.back (), ifIndex);
+    }
+
+  // All the packets of a flow take the same path
+  Ipv4Address first = RouteFlow (routing, 49152);
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, 49152), first,
+                             "The packets of a flow should follow the same path");
+    }
+
+  // Different flows are spread over all the paths
+  std::map<Ipv4Address, uint32_t> count;
+  const uint32_t nFlows = 256;
+  for (uint32_t i = 0; i < nFlows; ++i)
+    {
+      count[RouteFlow (routing, 49152 + i)]++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count.size (), nPaths, "The flows should use all the paths");
+  for (std::vector<Ipv4Address>::const_iterator it = gateways.begin (); it != gateways.end (); ++it)
+    {
+      NS_TEST_EXPECT_MSG_GT (count[*it], nFlows / nPaths / 2,
+                             "Path through " << *it << " carries too few flows");
+    }
+
+  routing->Dispose ();
+  Simulator::Destroy ();
+}
+
 
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
@@ -431,6 +545,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingFlowEcmpTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/tcp-ack-policy.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpAckPolicyTestSuite");
+
+/**
+ * \brief Testing the ACK delays returned by the TcpAckPolicy subclasses
+ */
+class TcpAckPolicyTest : public TestCase
+{
+public:
+  TcpAckPolicyTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count the segments covered by an ACK
+   * \param segments segments acknowledged
+   */
+  void AckedSegments (uint32_t segments);
+
+  uint32_t m_acked; //!< Segments reported by the last ACK
+};
+
+TcpAckPolicyTest::TcpAckPolicyTest ()
+  : TestCase ("ACK delays of the delayed, per-segment and coalescing policies"),
+    m_acked (0)
+{
+}
+
+void
+TcpAckPolicyTest::AckedSegments (uint32_t segments)
+{
+  m_acked = segments;
+}
+
+void
+TcpAckPolicyTest::DoRun ()
+{
+  Time timeout = MilliSeconds (200);
+
+  // Delayed ACK: every second segment, or at the timeout
+  Ptr<TcpAckPolicy> delayed = CreateObject<TcpDelayedAckPolicy> ();
+  delayed->TraceConnectWithoutContext ("AckedSegments",
+                                       MakeCallback (&TcpAckPolicyTest::AckedSegments, this));
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (1, false, 2, timeout), timeout,
+                         "First segment not delayed");
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (1, false, 2, timeout), Time (0),
+                         "Second segment not acknowledged");
+  delayed->AckSent ();
+  NS_TEST_ASSERT_MSG_EQ (m_acked, 2, "Wrong segments covered by the ACK");
+  NS_TEST_ASSERT_MSG_EQ (delayed->GetPendingSegments (), 0, "Pending segments not reset");
+
+  // A super-segment holding two segments is acknowledged at once
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (2, false, 2, timeout), Time (0),
+                         "Super-segment not acknowledged");
+  delayed->AckSent ();
+
+  // Quick ACK, once
+  delayed->QuickAck ();
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (1, false, 2, timeout), Time (0),
+                         "Quick ACK not honoured");
+  delayed->AckSent ();
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (1, false, 2, timeout), timeout,
+                         "Quick ACK not cleared by the ACK");
+  delayed->AckSent ();
+
+  // CE-marked data is delayed unless QuickAckOnCe is set
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (1, true, 2, timeout), timeout,
+                         "CE-marked segment acknowledged at once");
+  delayed->AckSent ();
+  delayed->SetAttribute ("QuickAckOnCe", BooleanValue (true));
+  NS_TEST_ASSERT_MSG_EQ (delayed->DataReceived (1, true, 2, timeout), Time (0),
+                         "CE-marked segment delayed");
+  delayed->AckSent ();
+
+  // Per segment
+  Ptr<TcpAckPolicy> perSegment = CreateObject<TcpPerSegmentAckPolicy> ();
+  NS_TEST_ASSERT_MSG_EQ (perSegment->DataReceived (1, false, 2, timeout), Time (0),
+                         "Segment delayed");
+
+  // Coalescing: held for the interval, up to MaxSegments
+  Ptr<TcpAckPolicy> coalescing = CreateObject<TcpCoalescingAckPolicy> ();
+  coalescing->SetAttribute ("Interval", TimeValue (MicroSeconds (8)));
+  coalescing->SetAttribute ("MaxSegments", UintegerValue (3));
+  coalescing->TraceConnectWithoutContext ("AckedSegments",
+                                          MakeCallback (&TcpAckPolicyTest::AckedSegments, this));
+  NS_TEST_ASSERT_MSG_EQ (coalescing->DataReceived (1, false, 2, timeout), MicroSeconds (8),
+                         "First segment not held for the interval");
+  NS_TEST_ASSERT_MSG_EQ (coalescing->DataReceived (1, false, 2, timeout), MicroSeconds (8),
+                         "Second segment not held, DelAckCount should not apply");
+  NS_TEST_ASSERT_MSG_EQ (coalescing->DataReceived (1, false, 2, timeout), Time (0),
+                         "MaxSegments not enforced");
+  coalescing->AckSent ();
+  NS_TEST_ASSERT_MSG_EQ (m_acked, 3, "Wrong segments covered by the coalesced ACK");
+
+  // A forked policy starts without pending segments
+  coalescing->DataReceived (1, false, 2, timeout);
+  Ptr<TcpAckPolicy> fork = coalescing->Fork ();
+  NS_TEST_ASSERT_MSG_EQ (fork->GetName (), coalescing->GetName (), "Wrong forked policy");
+  NS_TEST_ASSERT_MSG_EQ (fork->DataReceived (1, false, 2, timeout), MicroSeconds (8),
+                         "Forked policy lost its attributes");
+}
+
+// -------------------------------------------------------------------
+static class TcpAckPolicyTestSuite : public TestSuite
+{
+public:
+  TcpAckPolicyTestSuite () : TestSuite ("tcp-ack-policy", UNIT)
+  {
+    AddTestCase (new TcpAckPolicyTest (), TestCase::QUICK);
+  }
+} g_tcpAckPolicyTest;
+
+} // namespace ns3
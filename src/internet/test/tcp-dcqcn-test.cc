@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-dcqcn.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpDcqcnTestSuite");
+
+/**
+ * \brief Testing the rate cut on congestion notifications and the recovery after it
+ */
+class TcpDcqcnCnpTest : public TestCase
+{
+public:
+  TcpDcqcnCnpTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpDcqcnCnpTest::TcpDcqcnCnpTest ()
+  : TestCase ("DCQCN cuts the rate on a CNP and recovers towards the target")
+{
+}
+
+void
+TcpDcqcnCnpTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 1000;
+
+  Ptr<TcpDcqcn> cong = CreateObject <TcpDcqcn> ();
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("ByteCounter", UintegerValue (1000));
+
+  NS_TEST_ASSERT_MSG_EQ ((cong->GetCapabilities () & TcpCongestionOps::CAP_ECN), TcpCongestionOps::CAP_ECN,
+                         "DCQCN must ask for ECN");
+
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+  NS_TEST_ASSERT_MSG_EQ (state->m_pacingRate.GetBitRate (), 10000000000ULL,
+                         "Pacing rate does not start at MaxRate");
+
+  // alpha starts at 1: the first cut halves the rate
+  cong->EcnEchoReceived (state);
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 5000000000ULL, 1000,
+                             "Rate not halved by the first CNP");
+
+  // A second ECE within the CNP interval is not a new CNP
+  cong->EcnEchoReceived (state);
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 5000000000ULL, 1000,
+                             "Rate cut twice within the CNP interval");
+
+  // One byte counter event: fast recovery halfway to the target rate
+  cong->PktsAcked (state, 1, MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 7500000000ULL, 1000,
+                             "Fast recovery does not move halfway to the target");
+
+  // Fast recovery converges to the target, without exceeding it
+  cong->PktsAcked (state, 3, MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 9687500000ULL, 1000,
+                             "Fast recovery does not converge to the target");
+}
+
+// -------------------------------------------------------------------
+static class TcpDcqcnTestSuite : public TestSuite
+{
+public:
+  TcpDcqcnTestSuite () : TestSuite ("tcp-dcqcn-test", UNIT)
+  {
+    AddTestCase (new TcpDcqcnCnpTest (), TestCase::QUICK);
+  }
+} g_tcpDcqcnTest;
+
+} // namespace ns3
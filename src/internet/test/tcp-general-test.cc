@@ -25,6 +25,7 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/log.h"
 #include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-ack-policy.h"
 #include "../model/ipv4-end-point.h"
 #include "../model/ipv6-end-point.h"
 #include "tcp-general-test.h"
@@ -1153,7 +1154,7 @@ TcpSocketSmallAcks::SendEmptyPacket (uint8_t flags)
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
       m_delAckEvent.Cancel ();
-      m_delAckCount = 0;
+      m_ackPolicy->AckSent ();
     }
   if (m_retxEvent.IsExpired () && (hasSyn || hasFin) && !isAck )
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-hpcc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpHpccTestSuite");
+
+/**
+ * \brief Testing the rate computed by TcpHpcc from the echoed telemetry
+ */
+class TcpHpccRateTest : public TestCase
+{
+public:
+  TcpHpccRateTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpHpccRateTest::TcpHpccRateTest ()
+  : TestCase ("HPCC scales the rate by the utilization of the bottleneck")
+{
+}
+
+void
+TcpHpccRateTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 1000;
+
+  Ptr<TcpHpcc> cong = CreateObject <TcpHpcc> ();
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("RateAI", DataRateValue (DataRate ("50Mbps")));
+  cong->SetAttribute ("BaseRtt", TimeValue (MicroSeconds (10)));
+  cong->SetAttribute ("Eta", DoubleValue (0.95));
+
+  NS_TEST_ASSERT_MSG_EQ ((cong->GetCapabilities () & TcpCongestionOps::CAP_TELEMETRY), TcpCongestionOps::CAP_TELEMETRY,
+                         "HPCC must ask for telemetry");
+
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+  state->m_nextTxSequence = SequenceNumber32 (10000);
+
+  // U = 10us / 10us + 0.9 = 1.9: rate = 10G * 0.95 / 1.9 + 50M, new reference
+  state->m_pathQueueDelay = MicroSeconds (10);
+  state->m_pathUtilization = 0.9;
+  state->m_lastAckedSeq = SequenceNumber32 (1000);
+  cong->PktsAcked (state, 1, MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 5050000000ULL, 1000,
+                             "Multiplicative update not scaled by the utilization");
+
+  // Below the target, within the same RTT: additive step from the reference
+  state->m_pathQueueDelay = Time (0);
+  state->m_pathUtilization = 0.5;
+  state->m_lastAckedSeq = SequenceNumber32 (2000);
+  cong->PktsAcked (state, 1, MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 5100000000ULL, 1000,
+                             "Additive update not computed from the reference rate");
+
+  // Still the same RTT: the reference has not moved
+  cong->PktsAcked (state, 1, MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 5100000000ULL, 1000,
+                             "Reference rate updated more than once per RTT");
+}
+
+// -------------------------------------------------------------------
+static class TcpHpccTestSuite : public TestSuite
+{
+public:
+  TcpHpccTestSuite () : TestSuite ("tcp-hpcc-test", UNIT)
+  {
+    AddTestCase (new TcpHpccRateTest (), TestCase::QUICK);
+  }
+} g_tcpHpccTest;
+
+} // namespace ns3
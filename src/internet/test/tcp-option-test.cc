@@ -22,6 +22,8 @@
 #include "ns3/tcp-option.h"
 #include "ns3/private/tcp-option-winscale.h"
 #include "ns3/private/tcp-option-ts.h"
+#include "ns3/tcp-option-sack-permitted.h"
+#include "ns3/tcp-option-sack.h"
 
 #include <string.h>
 
@@ -164,6 +166,62 @@ TcpOptionTSTestCase::DoTeardown ()
 {
 }
 
+class TcpOptionSackTestCase : public TestCase
+{
+public:
+  TcpOptionSackTestCase (uint32_t blocks, std::string name);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_blocks;
+};
+
+TcpOptionSackTestCase::TcpOptionSackTestCase (uint32_t blocks, std::string name)
+  : TestCase (name),
+    m_blocks (blocks)
+{
+}
+
+void
+TcpOptionSackTestCase::DoRun ()
+{
+  TcpOptionSack opt;
+  for (uint32_t i = 0; i < m_blocks; ++i)
+    {
+      SequenceNumber32 first (1000 + 3000 * i);
+      opt.AddSackBlock (TcpOptionSack::SackBlock (first, first + 1448));
+    }
+  NS_TEST_EXPECT_MSG_EQ (opt.GetSerializedSize (), 2 + 8 * m_blocks, "Wrong size");
+
+  Buffer buffer;
+  buffer.AddAtStart (opt.GetSerializedSize ());
+  opt.Serialize (buffer.Begin ());
+
+  NS_TEST_EXPECT_MSG_EQ (buffer.Begin ().PeekU8 (), TcpOption::SACK, "Different kind found");
+
+  TcpOptionSack read;
+  NS_TEST_EXPECT_MSG_EQ (read.Deserialize (buffer.Begin ()), 2 + 8 * m_blocks,
+                         "Wrong size read");
+  NS_TEST_ASSERT_MSG_EQ (read.GetNumSackBlocks (), m_blocks, "Different number of blocks");
+  TcpOptionSack::SackList::const_iterator it = opt.GetSackList ().begin ();
+  TcpOptionSack::SackList::const_iterator jt = read.GetSackList ().begin ();
+  for (; it != opt.GetSackList ().end (); ++it, ++jt)
+    {
+      NS_TEST_EXPECT_MSG_EQ (it->first, jt->first, "Different block start");
+      NS_TEST_EXPECT_MSG_EQ (it->second, jt->second, "Different block end");
+    }
+
+  TcpOptionSackPermitted permitted;
+  Buffer permittedBuffer;
+  permittedBuffer.AddAtStart (permitted.GetSerializedSize ());
+  permitted.Serialize (permittedBuffer.Begin ());
+  NS_TEST_EXPECT_MSG_EQ (permittedBuffer.Begin ().PeekU8 (), TcpOption::SACK_PERMITTED,
+                         "Different kind found");
+  NS_TEST_EXPECT_MSG_EQ (permitted.Deserialize (permittedBuffer.Begin ()), 2,
+                         "Wrong size read");
+}
+
 static class TcpOptionTestSuite : public TestSuite
 {
 public:
@@ -176,6 +234,10 @@ public:
                                               "scale value", i), TestCase::QUICK);
       }
     AddTestCase (new TcpOptionTSTestCase ("Testing serialization of random values for timestamp"), TestCase::QUICK);
+    for (uint32_t i = 1; i <= TcpOptionSack::MAX_BLOCKS; ++i)
+      {
+        AddTestCase (new TcpOptionSackTestCase (i, "Testing serialization of SACK blocks"), TestCase::QUICK);
+      }
   }
 
 } g_TcpOptionTestSuite;
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-rx-buffer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpRxBufferTestSuite");
+
+/**
+ * \brief Testing the reordering, the coalescing and the delivery of TcpRxBuffer
+ */
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Add a segment to the buffer
+   * \param rxBuf the buffer
+   * \param seq sequence number of the segment
+   * \param size size of the segment
+   * \return the value returned by TcpRxBuffer::Add
+   */
+  bool AddSegment (Ptr<TcpRxBuffer> rxBuf, uint32_t seq, uint32_t size);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("TcpRxBuffer reordering and delivery")
+{
+}
+
+bool
+TcpRxBufferTestCase::AddSegment (Ptr<TcpRxBuffer> rxBuf, uint32_t seq, uint32_t size)
+{
+  TcpHeader h;
+  h.SetSequenceNumber (SequenceNumber32 (seq));
+  return rxBuf->Add (Create<Packet> (size), h);
+}
+
+void
+TcpRxBufferTestCase::DoRun ()
+{
+  Ptr<TcpRxBuffer> rxBuf = CreateObject<TcpRxBuffer> (1);
+  rxBuf->SetMaxBufferSize (10000);
+
+  // In sequence
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 1, 500), true, "In-sequence segment refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->NextRxSequence (), SequenceNumber32 (501), "Wrong RCV.NXT");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Extract (1000)->GetSize (), 500, "Wrong extraction");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), 0, "Buffer not empty");
+
+  // Two holes: [501, 1001) and [1501, 2001)
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 1001, 500), true, "Out-of-order segment refused");
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 2001, 500), true, "Out-of-order segment refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->HoleCount (), 2, "Wrong number of holes");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Available (), 0, "Out-of-order data available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), 1000, "Wrong size");
+
+  // Duplicate and adjacent data
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 1101, 200), false, "Duplicate segment accepted");
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 2501, 500), true, "Adjacent segment refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->HoleCount (), 2, "Adjacent segment not coalesced");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), 1500, "Wrong size");
+
+  // SACK blocks: the last one received first
+  TcpOptionSack::SackList list = rxBuf->GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (list.size (), 2, "Wrong number of SACK blocks");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().first, SequenceNumber32 (2001), "Wrong first SACK block");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().second, SequenceNumber32 (3001), "Wrong first SACK block");
+  NS_TEST_ASSERT_MSG_EQ (list.back ().first, SequenceNumber32 (1001), "Wrong second SACK block");
+  NS_TEST_ASSERT_MSG_EQ (list.back ().second, SequenceNumber32 (1501), "Wrong second SACK block");
+
+  // A retransmission spanning both holes closes them
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 1, 2500), true, "Retransmission refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->HoleCount (), 0, "Holes left");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->NextRxSequence (), SequenceNumber32 (3001), "Wrong RCV.NXT");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Available (), 2500, "Wrong available bytes");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), 2500, "Overlap counted twice");
+
+  // Partial then whole delivery
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Extract (700)->GetSize (), 700, "Wrong partial extraction");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Available (), 1800, "Wrong available bytes");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Extract (5000)->GetSize (), 1800, "Wrong extraction");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), 0, "Buffer not empty");
+
+  // The window is counted from the first byte held
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 4001, 1000), true, "Out-of-order segment refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->MaxRxSequence (), SequenceNumber32 (14001), "Wrong window");
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 13001, 2000), true, "Segment at the window edge refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), 2000, "Segment not trimmed to the window");
+
+  // FIN right after the data
+  rxBuf->SetFinSequence (SequenceNumber32 (14001));
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (rxBuf, 3001, 11000), true, "Retransmission refused");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->NextRxSequence (), SequenceNumber32 (14002), "FIN not accounted");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf->Finished (), true, "Buffer not finished");
+}
+
+// -------------------------------------------------------------------
+static class TcpRxBufferTestSuite : public TestSuite
+{
+public:
+  TcpRxBufferTestSuite () : TestSuite ("tcp-rx-buffer", UNIT)
+  {
+    AddTestCase (new TcpRxBufferTestCase (), TestCase::QUICK);
+  }
+} g_tcpRxBufferTest;
+
+} // namespace ns3
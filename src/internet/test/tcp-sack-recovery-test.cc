@@ -0,0 +1,219 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "tcp-error-model.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpSackRecoveryTestSuite");
+
+/**
+ * \brief Recovery of a burst of losses with SACK
+ *
+ * Consecutive segments are dropped in the middle of the transfer. The
+ * losses are detected by RACK, or by the duplicate threshold, from the
+ * SACK blocks of the following segments: the sender goes into recovery
+ * once, retransmits every dropped segment, and never times out.
+ */
+class TcpSackRecoveryTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc description
+   * \param rack detect the losses with RACK
+   * \param toDrop sequence numbers of the segments to drop
+   */
+  TcpSackRecoveryTest (const std::string &desc, bool rack,
+                       const std::vector<uint32_t> &toDrop);
+
+protected:
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void CongStateTrace (const TcpSocketState::TcpCongState_t oldValue,
+                               const TcpSocketState::TcpCongState_t newValue);
+  virtual void RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void NormalClose (SocketWho who);
+  virtual void FinalChecks ();
+
+  /**
+   * \brief Drop callback of the error model
+   * \param ipH IPv4 header
+   * \param tcpH TCP header
+   * \param p packet
+   */
+  void PktDropped (const Ipv4Header &ipH, const TcpHeader& tcpH, Ptr<const Packet> p);
+
+private:
+  bool m_rack;                     //!< RACK enabled
+  std::vector<uint32_t> m_toDrop;  //!< Sequence numbers to drop
+  uint32_t m_dropped;              //!< Segments dropped
+  uint32_t m_retransmitted;        //!< Dropped segments sent again
+  uint32_t m_recoveries;           //!< Times the sender went into recovery
+  uint32_t m_rtos;                 //!< RTO expirations
+  bool m_senderClosed;             //!< The sender closed normally
+  SequenceNumber32 m_highTx;       //!< Highest sequence number sent
+};
+
+TcpSackRecoveryTest::TcpSackRecoveryTest (const std::string &desc, bool rack,
+                                          const std::vector<uint32_t> &toDrop)
+  : TcpGeneralTest (desc),
+    m_rack (rack),
+    m_toDrop (toDrop),
+    m_dropped (0),
+    m_retransmitted (0),
+    m_recoveries (0),
+    m_rtos (0),
+    m_senderClosed (false),
+    m_highTx (0)
+{
+}
+
+void
+TcpSackRecoveryTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+  SetAppPktInterval (MicroSeconds (100));
+  SetPropagationDelay (MilliSeconds (50));
+  SetTransmitStart (Seconds (2.0));
+}
+
+void
+TcpSackRecoveryTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("Sack", BooleanValue (true));
+  GetSenderSocket ()->SetAttribute ("Rack", BooleanValue (m_rack));
+  GetReceiverSocket ()->SetAttribute ("Sack", BooleanValue (true));
+}
+
+Ptr<ErrorModel>
+TcpSackRecoveryTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  for (std::vector<uint32_t>::iterator it = m_toDrop.begin (); it != m_toDrop.end (); ++it)
+    {
+      errorModel->AddSeqToKill (SequenceNumber32 (*it));
+    }
+
+  errorModel->SetDropCallback (MakeCallback (&TcpSackRecoveryTest::PktDropped, this));
+
+  return errorModel;
+}
+
+void
+TcpSackRecoveryTest::PktDropped (const Ipv4Header &ipH, const TcpHeader &tcpH,
+                                 Ptr<const Packet> p)
+{
+  NS_LOG_DEBUG ("Drop seq= " << tcpH.GetSequenceNumber () << " size " << p->GetSize ());
+  m_dropped++;
+}
+
+void
+TcpSackRecoveryTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  SequenceNumber32 seq = h.GetSequenceNumber ();
+  if (seq < m_highTx
+      && std::find (m_toDrop.begin (), m_toDrop.end (), seq.GetValue ()) != m_toDrop.end ())
+    {
+      NS_LOG_DEBUG ("Retransmit seq= " << seq);
+      m_retransmitted++;
+    }
+  m_highTx = std::max (m_highTx, seq);
+}
+
+void
+TcpSackRecoveryTest::CongStateTrace (const TcpSocketState::TcpCongState_t oldValue,
+                                     const TcpSocketState::TcpCongState_t newValue)
+{
+  if (newValue == TcpSocketState::CA_RECOVERY && oldValue != TcpSocketState::CA_RECOVERY)
+    {
+      m_recoveries++;
+    }
+}
+
+void
+TcpSackRecoveryTest::RTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_rtos++;
+    }
+}
+
+void
+TcpSackRecoveryTest::NormalClose (SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_senderClosed = true;
+    }
+}
+
+void
+TcpSackRecoveryTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_dropped, m_toDrop.size (), "Not all the segments were dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_rtos, 0, "The losses were recovered by an RTO");
+  NS_TEST_ASSERT_MSG_EQ (m_recoveries, 1, "The burst of losses took more than one recovery");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmitted, m_toDrop.size (),
+                         "Each dropped segment should be retransmitted once");
+  NS_TEST_ASSERT_MSG_EQ (m_senderClosed, true, "The transfer did not complete");
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP SACK and RACK loss recovery TestSuite
+ */
+static class TcpSackRecoveryTestSuite : public TestSuite
+{
+public:
+  TcpSackRecoveryTestSuite () : TestSuite ("tcp-sack-recovery-test", UNIT)
+  {
+    std::vector<uint32_t> toDrop;
+    toDrop.push_back (5001);
+    toDrop.push_back (5501);
+    toDrop.push_back (6001);
+    AddTestCase (new TcpSackRecoveryTest ("SACK recovery of three consecutive losses, RACK",
+                                          true, toDrop),
+                 TestCase::QUICK);
+    AddTestCase (new TcpSackRecoveryTest ("SACK recovery of three consecutive losses, dupthresh",
+                                          false, toDrop),
+                 TestCase::QUICK);
+  }
+} g_tcpSackRecoveryTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpSocketPoolTestSuite");
+
+/**
+ * \brief Testing the flows of recycled sockets
+ *
+ * Short flows are sent one after the other on the loopback of a node whose
+ * TcpL4Protocol keeps a few closed sockets. The server side sockets close
+ * at once and are recycled by the next flows, which must deliver all their
+ * bytes; the trace sinks connected to a server socket must not see the
+ * connection of the flow that recycles it. When the application holds its
+ * sockets, none is recycled.
+ */
+class TcpSocketPoolTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc description
+   * \param hold keep a reference to every socket
+   */
+  TcpSocketPoolTest (std::string desc, bool hold);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Start a flow
+   * \param left flows to start after this one
+   */
+  void StartFlow (uint32_t left);
+
+  /**
+   * \brief Send the bytes of the flow and close
+   * \param socket the client socket
+   */
+  void Connected (Ptr<Socket> socket);
+
+  /**
+   * \brief Accept a flow
+   * \param socket the server socket
+   * \param from the client
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Count the bytes received
+   * \param socket the server socket
+   */
+  void Recv (Ptr<Socket> socket);
+
+  /**
+   * \brief Close the server socket
+   * \param socket the server socket
+   */
+  void PeerClose (Ptr<Socket> socket);
+
+  /**
+   * \brief Trace the state of a server socket
+   * \param oldValue the old state
+   * \param newValue the new state
+   */
+  void ServerState (TcpSocket::TcpStates_t oldValue, TcpSocket::TcpStates_t newValue);
+
+  bool m_hold;                 //!< Keep a reference to every socket
+  Ptr<Node> m_node;            //!< The node
+  uint64_t m_received;         //!< Bytes received by the server
+  uint32_t m_closed;           //!< Flows closed by the server
+  uint32_t m_strayConnects;    //!< Connections seen by the server sinks
+  std::vector<Ptr<Socket> > m_held; //!< Sockets kept by the application
+};
+
+static const uint32_t FLOWS = 20;
+static const uint32_t FLOW_SIZE = 1000;
+
+TcpSocketPoolTest::TcpSocketPoolTest (std::string desc, bool hold)
+  : TestCase (desc),
+    m_hold (hold),
+    m_received (0),
+    m_closed (0),
+    m_strayConnects (0)
+{
+}
+
+void
+TcpSocketPoolTest::StartFlow (uint32_t left)
+{
+  Ptr<Socket> socket = Socket::CreateSocket (m_node, TcpSocketFactory::GetTypeId ());
+  socket->Bind ();
+  socket->SetConnectCallback (MakeCallback (&TcpSocketPoolTest::Connected, this),
+                              MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Connect (InetSocketAddress (Ipv4Address::GetLoopback (), 9));
+  if (m_hold)
+    {
+      m_held.push_back (socket);
+    }
+  if (left > 0)
+    {
+      Simulator::Schedule (MilliSeconds (1), &TcpSocketPoolTest::StartFlow, this, left - 1);
+    }
+}
+
+void
+TcpSocketPoolTest::Connected (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (FLOW_SIZE));
+  socket->Close ();
+}
+
+void
+TcpSocketPoolTest::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpSocketPoolTest::Recv, this));
+  socket->SetCloseCallbacks (MakeCallback (&TcpSocketPoolTest::PeerClose, this),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+  socket->TraceConnectWithoutContext ("State", MakeCallback (&TcpSocketPoolTest::ServerState, this));
+  if (m_hold)
+    {
+      m_held.push_back (socket);
+    }
+}
+
+void
+TcpSocketPoolTest::Recv (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_received += p->GetSize ();
+    }
+}
+
+void
+TcpSocketPoolTest::PeerClose (Ptr<Socket> socket)
+{
+  socket->Close ();
+  m_closed++;
+}
+
+void
+TcpSocketPoolTest::ServerState (TcpSocket::TcpStates_t oldValue, TcpSocket::TcpStates_t newValue)
+{
+  if (newValue == TcpSocket::SYN_SENT)
+    {
+      m_strayConnects++;
+    }
+}
+
+void
+TcpSocketPoolTest::DoRun (void)
+{
+  m_node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (m_node);
+  Ptr<TcpL4Protocol> tcp = m_node->GetObject<TcpL4Protocol> ();
+  tcp->SetAttribute ("SocketPoolSize", UintegerValue (4));
+
+  Ptr<Socket> sink = Socket::CreateSocket (m_node, TcpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->Listen ();
+  sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                           MakeCallback (&TcpSocketPoolTest::Accept, this));
+
+  Simulator::Schedule (MilliSeconds (1), &TcpSocketPoolTest::StartFlow, this, FLOWS - 1);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_closed, FLOWS, "Not all the flows were closed");
+  NS_TEST_ASSERT_MSG_EQ (m_received, FLOWS * FLOW_SIZE, "Not all the bytes were received");
+  NS_TEST_ASSERT_MSG_EQ (m_strayConnects, 0, "A sink saw the flow of a recycled socket");
+  if (m_hold)
+    {
+      NS_TEST_ASSERT_MSG_EQ (tcp->GetRecycledSockets (), 0, "A held socket was recycled");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (tcp->GetRecycledSockets (), 0, "No socket recycled");
+    }
+
+  m_held.clear ();
+  sink = 0;
+  m_node = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief TcpL4Protocol socket pool TestSuite
+ */
+class TcpSocketPoolTestSuite : public TestSuite
+{
+public:
+  TcpSocketPoolTestSuite ()
+    : TestSuite ("tcp-socket-pool", UNIT)
+  {
+    AddTestCase (new TcpSocketPoolTest ("Flows of recycled sockets", false), TestCase::QUICK);
+    AddTestCase (new TcpSocketPoolTest ("Sockets held by the application", true), TestCase::QUICK);
+  }
+};
+
+static TcpSocketPoolTestSuite g_tcpSocketPoolTestSuite; //!< Static variable for test initialization
+
+} // namespace ns3
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-timely.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpTimelyTestSuite");
+
+/**
+ * \brief Testing the rate computed by TcpTimely and its publication to the socket
+ */
+class TcpTimelyRateTest : public TestCase
+{
+public:
+  TcpTimelyRateTest (Time rtt, uint64_t expectedRate, const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  Time m_rtt;
+  uint64_t m_expectedRate;
+};
+
+TcpTimelyRateTest::TcpTimelyRateTest (Time rtt, uint64_t expectedRate,
+                                      const std::string &name)
+  : TestCase (name),
+    m_rtt (rtt),
+    m_expectedRate (expectedRate)
+{
+}
+
+void
+TcpTimelyRateTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 1000;
+
+  Ptr<TcpTimely> cong = CreateObject <TcpTimely> ();
+  cong->SetAttribute ("MinRate", DataRateValue (DataRate ("100Mbps")));
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("TLow", DoubleValue (50));
+  cong->SetAttribute ("THigh", DoubleValue (500));
+  cong->SetAttribute ("Beta", DoubleValue (0.8));
+
+  NS_TEST_ASSERT_MSG_EQ ((cong->GetCapabilities () & TcpCongestionOps::CAP_OWNS_CWND), TcpCongestionOps::CAP_OWNS_CWND,
+                         "Timely must own cWnd");
+
+  // A new connection starts at MaxRate
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+  NS_TEST_ASSERT_MSG_EQ (state->m_pacingRate.GetBitRate (), 10000000000ULL,
+                         "Pacing rate does not start at MaxRate");
+
+  cong->PktsAcked (state, 1, m_rtt);
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), m_expectedRate, 1000,
+                             "Pacing rate has not updated correctly");
+
+  double bdp = m_expectedRate / 8.0 * m_rtt.GetSeconds ();
+  uint32_t expectedCwnd = static_cast<uint32_t> (std::max (2 * bdp, 2000.0));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_cWnd.Get (), expectedCwnd, 1,
+                             "CWnd is not bound to the rate");
+}
+
+/**
+ * \brief Testing that a batch of samples gives one rate update on the whole gradient
+ */
+class TcpTimelyBatchTest : public TestCase
+{
+public:
+  TcpTimelyBatchTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTimelyBatchTest::TcpTimelyBatchTest ()
+  : TestCase ("Timely updates the rate once per batch of samples")
+{
+}
+
+void
+TcpTimelyBatchTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 1000;
+
+  Ptr<TcpTimely> cong = CreateObject <TcpTimely> ();
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("TLow", DoubleValue (50));
+  cong->SetAttribute ("THigh", DoubleValue (500));
+  cong->SetAttribute ("Beta", DoubleValue (0.8));
+  cong->SetAttribute ("EMWA", DoubleValue (0.5));
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+
+  // Three segments of a stretch ACK, with a growing RTT
+  std::vector<TcpRttSample> samples;
+  for (uint32_t i = 1; i <= 3; ++i)
+    {
+      TcpRttSample sample;
+      sample.rtt = MicroSeconds (100 * i);
+      sample.bytes = 1000;
+      samples.push_back (sample);
+    }
+
+  cong->PktsAckedBatch (state, 3, samples);
+
+  // gradient = (0.5 * 100 + 0.25 * 100) / 100 = 0.75; rate = 10G * (1 - 0.8 * 0.75)
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 4000000000ULL, 1000,
+                             "Rate not updated once on the gradient of the batch");
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_cWnd.Get (), 300000, 1, "CWnd is not bound to the newest sample");
+
+  // An ACK without samples does not touch the rate
+  cong->PktsAckedBatch (state, 1, std::vector<TcpRttSample> ());
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 4000000000ULL, 1000,
+                             "Rate changed without samples");
+}
+
+/**
+ * \brief Testing the gating of the rate updates
+ */
+class TcpTimelyUpdateModeTest : public TestCase
+{
+public:
+  TcpTimelyUpdateModeTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTimelyUpdateModeTest::TcpTimelyUpdateModeTest ()
+  : TestCase ("Timely updates the rate once per RTT or per completion event")
+{
+}
+
+void
+TcpTimelyUpdateModeTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 1000;
+  state->m_nextTxSequence = SequenceNumber32 (10000);
+
+  // Per RTT: RTT > THigh, rate = 10G * (1 - 0.8 * (1 - 500 / 1000)) once
+  Ptr<TcpTimely> cong = CreateObject <TcpTimely> ();
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("TLow", DoubleValue (50));
+  cong->SetAttribute ("THigh", DoubleValue (500));
+  cong->SetAttribute ("Beta", DoubleValue (0.8));
+  cong->SetAttribute ("UpdateMode", EnumValue (TcpTimely::UPDATE_PER_RTT));
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+
+  state->m_lastAckedSeq = SequenceNumber32 (1000);
+  cong->PktsAcked (state, 1, MicroSeconds (1000));
+  NS_TEST_ASSERT_MSG_EQ (state->m_pacingRate.GetBitRate (), 10000000000ULL,
+                         "Rate updated before the end of the RTT");
+
+  state->m_lastAckedSeq = SequenceNumber32 (10000);
+  state->m_nextTxSequence = SequenceNumber32 (20000);
+  cong->PktsAcked (state, 1, MicroSeconds (1000));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 6000000000ULL, 1000,
+                             "Rate not updated at the end of the RTT");
+
+  state->m_lastAckedSeq = SequenceNumber32 (11000);
+  cong->PktsAcked (state, 1, MicroSeconds (1000));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 6000000000ULL, 1000,
+                             "Rate updated twice in the same RTT");
+
+  // Per completion event of 3 segments
+  cong = CreateObject <TcpTimely> ();
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("TLow", DoubleValue (50));
+  cong->SetAttribute ("THigh", DoubleValue (500));
+  cong->SetAttribute ("Beta", DoubleValue (0.8));
+  cong->SetAttribute ("UpdateMode", EnumValue (TcpTimely::UPDATE_PER_BYTES));
+  cong->SetAttribute ("CompletionBytes", UintegerValue (3000));
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+
+  cong->PktsAcked (state, 2, MicroSeconds (1000));
+  NS_TEST_ASSERT_MSG_EQ (state->m_pacingRate.GetBitRate (), 10000000000ULL,
+                         "Rate updated before the completion event");
+  cong->PktsAcked (state, 1, MicroSeconds (1000));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 6000000000ULL, 1000,
+                             "Rate not updated at the completion event");
+
+  // No update during recovery
+  cong->CongestionStateSet (state, TcpSocketState::CA_RECOVERY);
+  cong->PktsAcked (state, 3, MicroSeconds (1000));
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 6000000000ULL, 1000,
+                             "Rate updated during recovery");
+}
+
+/**
+ * \brief Testing the clipping of the normalized gradient
+ */
+class TcpTimelyGradientClipTest : public TestCase
+{
+public:
+  TcpTimelyGradientClipTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTimelyGradientClipTest::TcpTimelyGradientClipTest ()
+  : TestCase ("Timely clips the normalized gradient")
+{
+}
+
+void
+TcpTimelyGradientClipTest::DoRun ()
+{
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 1000;
+
+  Ptr<TcpTimely> cong = CreateObject <TcpTimely> ();
+  cong->SetAttribute ("MinRate", DataRateValue (DataRate ("100Mbps")));
+  cong->SetAttribute ("MaxRate", DataRateValue (DataRate ("10Gbps")));
+  cong->SetAttribute ("TLow", DoubleValue (50));
+  cong->SetAttribute ("THigh", DoubleValue (500));
+  cong->SetAttribute ("Beta", DoubleValue (0.8));
+  cong->SetAttribute ("EMWA", DoubleValue (1));
+  cong->SetAttribute ("MaxGradient", DoubleValue (0.5));
+  cong->CongestionStateSet (state, TcpSocketState::CA_OPEN);
+
+  // Gradient (300 - 100) / 100 = 2 is clipped to 0.5: rate = 10G * (1 - 0.8 * 0.5)
+  std::vector<TcpRttSample> samples;
+  TcpRttSample sample;
+  sample.bytes = 1000;
+  sample.rtt = MicroSeconds (100);
+  samples.push_back (sample);
+  sample.rtt = MicroSeconds (300);
+  samples.push_back (sample);
+
+  cong->PktsAckedBatch (state, 2, samples);
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->m_pacingRate.GetBitRate (), 6000000000ULL, 1000,
+                             "Gradient not clipped");
+}
+
+// -------------------------------------------------------------------
+static class TcpTimelyTestSuite : public TestSuite
+{
+public:
+  TcpTimelyTestSuite () : TestSuite ("tcp-timely-test", UNIT)
+  {
+    AddTestCase (new TcpTimelyRateTest (MicroSeconds (20), 10000000000ULL,
+                                        "Timely stays at MaxRate when RTT < TLow"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpTimelyRateTest (MicroSeconds (1000), 6000000000ULL,
+                                        "Timely decreases the rate when RTT > THigh"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpTimelyRateTest (Seconds (1), 2004000000ULL,
+                                        "Timely decrease is bounded by Beta"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpTimelyBatchTest (), TestCase::QUICK);
+    AddTestCase (new TcpTimelyUpdateModeTest (), TestCase::QUICK);
+    AddTestCase (new TcpTimelyGradientClipTest (), TestCase::QUICK);
+  }
+} g_tcpTimelyTest;
+
+} // namespace ns3
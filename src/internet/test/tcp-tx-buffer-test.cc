@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-tx-buffer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpTxBufferTestSuite");
+
+/**
+ * \brief Testing that both payload modes of TcpTxBuffer account the same bytes
+ */
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase (bool virtualPayload, const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_virtualPayload;
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase (bool virtualPayload,
+                                          const std::string &name)
+  : TestCase (name),
+    m_virtualPayload (virtualPayload)
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun ()
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetVirtualPayload (m_virtualPayload);
+  txBuf->SetHeadSequence (SequenceNumber32 (1));
+  txBuf->SetMaxBufferSize (10000);
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (3000)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (3000)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (5000)), false,
+                         "Add beyond the maximum size accepted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 6000, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Available (), 4000, "Wrong available space");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->TailSequence (), SequenceNumber32 (6001), "Wrong tail");
+
+  // A segment spanning the two packets
+  Ptr<Packet> p = txBuf->CopyFromSequence (1448, SequenceNumber32 (2001));
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1448, "Wrong segment size");
+
+  // The last segment is cut at the tail
+  p = txBuf->CopyFromSequence (1448, SequenceNumber32 (5001));
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1000, "Segment beyond the tail");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->SizeFromSequence (SequenceNumber32 (5001)), 1000,
+                         "Wrong size from sequence");
+
+  // Discard in the middle of the first packet, then the rest
+  txBuf->DiscardUpTo (SequenceNumber32 (1449));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->HeadSequence (), SequenceNumber32 (1449), "Wrong head");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 4552, "Wrong size after discard");
+  p = txBuf->CopyFromSequence (1448, SequenceNumber32 (1449));
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1448, "Wrong segment size after discard");
+
+  txBuf->DiscardUpTo (SequenceNumber32 (6001));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Buffer not empty");
+
+  // The ACK of a FIN moves the head beyond the data
+  txBuf->DiscardUpTo (SequenceNumber32 (6002));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->HeadSequence (), SequenceNumber32 (6002), "Wrong head after FIN");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Buffer not empty after FIN");
+}
+
+/**
+ * \brief Testing the SACK scoreboard of TcpTxBuffer
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  TcpTxBufferScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer SACK scoreboard")
+{
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun ()
+{
+  const uint32_t mss = 1000;
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetHeadSequence (SequenceNumber32 (1));
+  txBuf->SetMaxBufferSize (100000);
+  txBuf->Add (Create<Packet> (10 * mss));
+
+  // Ten segments, sent 1 ms apart
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      txBuf->SegmentSent (SequenceNumber32 (1 + i * mss), mss, MilliSeconds (i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 10 * mss, "Wrong pipe");
+
+  // Segments 1 and 2 are lost, 3 to 5 are SACKed
+  TcpOptionSack::SackList list;
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (1 + 3 * mss),
+                                            SequenceNumber32 (1 + 6 * mss)));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->UpdateScoreboard (list), 3 * mss, "Wrong bytes SACKed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->UpdateScoreboard (list), 0, "Bytes SACKed twice");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSackedBytes (), 3 * mss, "Wrong SACKed bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 7 * mss, "Wrong pipe after SACK");
+
+  Time xmitTs;
+  SequenceNumber32 endSeq;
+  bool retrans;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLastDelivered (xmitTs, endSeq, retrans), true,
+                         "Nothing delivered");
+  NS_TEST_ASSERT_MSG_EQ (xmitTs, MilliSeconds (5), "Wrong most recent delivery");
+  NS_TEST_ASSERT_MSG_EQ (endSeq, SequenceNumber32 (1 + 6 * mss), "Wrong end of delivery");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLastDelivered (xmitTs, endSeq, retrans), false,
+                         "Delivery reported twice");
+
+  // Three segments SACKed above: with a threshold of 3, 0 to 2 are lost
+  NS_TEST_ASSERT_MSG_EQ (txBuf->MarkLostByDupThresh (3, mss), 3 * mss, "Wrong bytes lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 4 * mss, "Wrong pipe after loss");
+
+  SequenceNumber32 seq;
+  uint32_t size;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextLostSegment (seq, size), true, "No lost segment");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (1), "Wrong lost segment");
+  NS_TEST_ASSERT_MSG_EQ (size, mss, "Wrong lost size");
+
+  // The retransmission is back in flight
+  txBuf->SegmentSent (seq, size, MilliSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLostBytes (), 2 * mss, "Retransmission still lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 5 * mss, "Wrong pipe after retransmission");
+  txBuf->NextLostSegment (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (1 + mss), "Wrong next lost segment");
+
+  // The cumulative ACK of the retransmission
+  txBuf->DiscardUpTo (SequenceNumber32 (1 + mss));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLastDelivered (xmitTs, endSeq, retrans), true,
+                         "Nothing delivered");
+  NS_TEST_ASSERT_MSG_EQ (retrans, true, "Retransmission not reported");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 4 * mss, "Wrong pipe after ACK");
+
+  // RACK: segments 6 to 9 were sent before the one delivered, sent at
+  // 20 ms. With a window of 18 ms, at 25 ms 6 and 7 are lost, 8 and 9 will
+  // be in 2 ms
+  Time timeout;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->MarkLostByRack (MilliSeconds (20), SequenceNumber32 (1 + mss),
+                                                MilliSeconds (18), MilliSeconds (25), timeout),
+                         2 * mss, "Wrong bytes lost by RACK");
+  NS_TEST_ASSERT_MSG_EQ (timeout, MilliSeconds (2), "Wrong RACK timeout");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->MarkLostByRack (MilliSeconds (20), SequenceNumber32 (1 + mss),
+                                                MilliSeconds (18), MilliSeconds (27), timeout),
+                         2 * mss, "Wrong bytes lost by RACK timeout");
+  NS_TEST_ASSERT_MSG_EQ (timeout, Time (0), "RACK timeout left");
+
+  // The RTO marks everything else lost; the SACKed data is kept
+  txBuf->SegmentSent (SequenceNumber32 (1 + mss), mss, MilliSeconds (30));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->MarkAllLost (), mss, "Wrong bytes lost by RTO");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 0, "Wrong pipe after RTO");
+
+  txBuf->DiscardUpTo (SequenceNumber32 (1 + 10 * mss));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSackedBytes (), 0, "SACKed bytes left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLostBytes (), 0, "Lost bytes left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 0, "Pipe not empty");
+
+  // A partial ACK delivers only the acknowledged part of a record
+  txBuf->Add (Create<Packet> (2 * mss));
+  txBuf->SegmentSent (SequenceNumber32 (1 + 10 * mss), 2 * mss, MilliSeconds (40));
+  txBuf->GetLastDelivered (xmitTs, endSeq, retrans);
+  txBuf->DiscardUpTo (SequenceNumber32 (1 + 11 * mss));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLastDelivered (xmitTs, endSeq, retrans), true,
+                         "Nothing delivered");
+  NS_TEST_ASSERT_MSG_EQ (endSeq, SequenceNumber32 (1 + 11 * mss), "Unacknowledged bytes delivered");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), mss, "Wrong pipe after partial ACK");
+}
+
+/**
+ * \brief Testing the SACK scoreboard of TcpTxBuffer with super-segments
+ */
+class TcpTxBufferTsoScoreboardTestCase : public TestCase
+{
+public:
+  TcpTxBufferTsoScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTsoScoreboardTestCase::TcpTxBufferTsoScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer SACK scoreboard with super-segments")
+{
+}
+
+void
+TcpTxBufferTsoScoreboardTestCase::DoRun ()
+{
+  const uint32_t mss = 1000;
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetHeadSequence (SequenceNumber32 (1));
+  txBuf->SetMaxBufferSize (100000);
+  txBuf->Add (Create<Packet> (8 * mss));
+
+  // Two super-segments of four segments each
+  txBuf->SegmentSent (SequenceNumber32 (1), 4 * mss, MilliSeconds (0));
+  txBuf->SegmentSent (SequenceNumber32 (1 + 4 * mss), 4 * mss, MilliSeconds (1));
+
+  // The RTO marks both lost; only the first segment is retransmitted
+  NS_TEST_ASSERT_MSG_EQ (txBuf->MarkAllLost (), 8 * mss, "Wrong bytes lost by RTO");
+  txBuf->SegmentSent (SequenceNumber32 (1), mss, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLostBytes (), 7 * mss, "Whole record retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), mss, "Wrong pipe after retransmission");
+  SequenceNumber32 seq;
+  uint32_t size;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextLostSegment (seq, size), true, "Rest of the record not lost");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (1 + mss), "Wrong lost segment");
+  NS_TEST_ASSERT_MSG_EQ (size, 3 * mss, "Wrong lost size");
+
+  // Two more segments retransmitted, then SACKed with the first: the
+  // last one of the record is still lost
+  txBuf->SegmentSent (SequenceNumber32 (1 + mss), 2 * mss, MilliSeconds (11));
+  TcpOptionSack::SackList list;
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (1 + 2 * mss),
+                                            SequenceNumber32 (1 + 3 * mss)));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->UpdateScoreboard (list), mss, "Wrong bytes SACKed");
+  Time xmitTs;
+  SequenceNumber32 endSeq;
+  bool retrans;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLastDelivered (xmitTs, endSeq, retrans), true,
+                         "Nothing delivered");
+  NS_TEST_ASSERT_MSG_EQ (endSeq, SequenceNumber32 (1 + 3 * mss), "Unsent bytes delivered");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextLostSegment (seq, size), true, "Lost segment forgotten");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (1 + 3 * mss), "Wrong lost segment");
+  NS_TEST_ASSERT_MSG_EQ (size, mss, "Wrong lost size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLostBytes (), 5 * mss, "Wrong lost bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 2 * mss, "Wrong pipe after SACK");
+
+  txBuf->DiscardUpTo (SequenceNumber32 (1 + 8 * mss));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSackedBytes (), 0, "SACKed bytes left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLostBytes (), 0, "Lost bytes left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 0, "Pipe not empty");
+}
+
+// -------------------------------------------------------------------
+static class TcpTxBufferTestSuite : public TestSuite
+{
+public:
+  TcpTxBufferTestSuite () : TestSuite ("tcp-tx-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTestCase (false, "TcpTxBuffer with packet list"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpTxBufferTestCase (true, "TcpTxBuffer with virtual payload"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase (), TestCase::QUICK);
+    AddTestCase (new TcpTxBufferTsoScoreboardTestCase (), TestCase::QUICK);
+  }
+} g_tcpTxBufferTest;
+
+} // namespace ns3
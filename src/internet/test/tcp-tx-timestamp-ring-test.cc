@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/tcp-tx-timestamp-ring.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpTxTimestampRingTestSuite");
+
+/**
+ * \brief Testing the per-segment samples produced by TcpTxTimestampRing
+ */
+class TcpTxTimestampRingTest : public TestCase
+{
+public:
+  TcpTxTimestampRingTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxTimestampRingTest::TcpTxTimestampRingTest ()
+  : TestCase ("Per-segment RTT samples from the timestamp ring")
+{
+}
+
+void
+TcpTxTimestampRingTest::DoRun ()
+{
+  // Start small, so the ring has to grow
+  TcpTxTimestampRing ring (2);
+  std::vector<TcpRttSample> samples;
+
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      ring.Push (SequenceNumber32 (1 + i * 1000), 1000, MicroSeconds (i * 10));
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.GetSize (), 10, "Ring did not grow");
+
+  // A stretch ACK covering three segments gives three samples
+  uint32_t completed = ring.Complete (SequenceNumber32 (3001), MicroSeconds (100),
+                                      TcpTxTimestampRing::SAMPLE_ALL, samples);
+  NS_TEST_ASSERT_MSG_EQ (completed, 3, "Wrong number of completed segments");
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 3, "Not every segment was sampled");
+  NS_TEST_ASSERT_MSG_EQ (samples[0].rtt, MicroSeconds (100), "Wrong first sample");
+  NS_TEST_ASSERT_MSG_EQ (samples[2].rtt, MicroSeconds (80), "Wrong last sample");
+
+  // A partial ACK completes nothing
+  samples.clear ();
+  completed = ring.Complete (SequenceNumber32 (3500), MicroSeconds (110),
+                             TcpTxTimestampRing::SAMPLE_ALL, samples);
+  NS_TEST_ASSERT_MSG_EQ (completed, 0, "Partially acked segment completed");
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 0, "Sample from a partial ACK");
+
+  // Retransmitted segments are not sampled (Karn)
+  ring.MarkRetransmitted (SequenceNumber32 (4001), 1000);
+  completed = ring.Complete (SequenceNumber32 (6001), MicroSeconds (120),
+                             TcpTxTimestampRing::SAMPLE_ALL, samples);
+  NS_TEST_ASSERT_MSG_EQ (completed, 3, "Wrong number of completed segments");
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 2, "Retransmitted segment was sampled");
+  NS_TEST_ASSERT_MSG_EQ (samples[0].rtt, MicroSeconds (90), "Wrong sample before retransmission");
+  NS_TEST_ASSERT_MSG_EQ (samples[1].rtt, MicroSeconds (70), "Wrong sample after retransmission");
+
+  // Only the newest segment of a coalesced ACK is sampled
+  samples.clear ();
+  completed = ring.Complete (SequenceNumber32 (9001), MicroSeconds (130),
+                             TcpTxTimestampRing::SAMPLE_NEWEST, samples);
+  NS_TEST_ASSERT_MSG_EQ (completed, 3, "Wrong number of completed segments");
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 1, "More than one sample per ACK");
+  NS_TEST_ASSERT_MSG_EQ (samples[0].rtt, MicroSeconds (50), "Newest segment not sampled");
+
+  NS_TEST_ASSERT_MSG_EQ (ring.GetSize (), 1, "Wrong number of segments left");
+  ring.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (ring.GetSize (), 0, "Ring not cleared");
+}
+
+// -------------------------------------------------------------------
+static class TcpTxTimestampRingTestSuite : public TestSuite
+{
+public:
+  TcpTxTimestampRingTestSuite () : TestSuite ("tcp-tx-timestamp-ring", UNIT)
+  {
+    AddTestCase (new TcpTxTimestampRingTest (), TestCase::QUICK);
+  }
+} g_tcpTxTimestampRingTest;
+
+} // namespace ns3
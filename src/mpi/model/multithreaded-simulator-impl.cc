@@ -0,0 +1,786 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/uinteger.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions, and because the
+// log output is not serialized between the threads
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/// Timestamp of an empty event list
+static const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+/// Context of the events which belong to no node
+static const uint32_t NO_CONTEXT = 0xffffffff;
+/// Polls of the barrier before yielding the processor
+static const uint32_t BARRIER_SPINS = 1000;
+
+/// The simulator in Run, for IsLocal
+static MultithreadedSimulatorImpl *g_running = 0;
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "Maximum number of threads, each running a partition "
+                   "of the nodes; 0 for one per processor",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LookAhead",
+                   "Length of the time windows run without synchronization; "
+                   "0 for the smallest delay of the links between partitions",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookAheadAttribute),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_stop (false),
+    m_serial (false),
+    m_systemIdBase (0),
+    m_maxThreads (0),
+    m_lookAhead (0),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+  // The context-less events go to the first partition, which is the one
+  // of the main thread until the first Run
+  Partition *global = new Partition;
+  global->index = 0;
+  global->impl = this;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  global->uid = 4;
+  // before ::Run is entered, the m_currentUid will be zero
+  global->currentUid = 0;
+  global->currentTs = 0;
+  global->currentContext = NO_CONTEXT;
+  global->unscheduledEvents = 0;
+  global->next = NO_EVENT;
+  global->windowEnd = 0;
+  global->outbox.resize (1);
+  m_partitions.push_back (global);
+  m_current = global;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Merge (*i);
+    }
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete p;
+    }
+  m_partitions.clear ();
+  m_current = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (p->events != 0)
+        {
+          while (!p->events->IsEmpty ())
+            {
+              Scheduler::Event next = p->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      p->events = scheduler;
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  // The packet uids are made of the system id and of a counter of the
+  // thread: every partition gets a system id of its own at every Run,
+  // since its thread starts counting from zero
+  Partition *p = m_current;
+  if (p == 0 || p->index == 0)
+    {
+      return 0;
+    }
+  return m_systemIdBase + p->index;
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t threads = m_maxThreads;
+  if (threads == 0)
+    {
+      threads = std::max (std::thread::hardware_concurrency (), 1u);
+    }
+  uint32_t partitions = std::max (std::min (threads, NodeList::GetNNodes ()), 1u);
+
+  for (uint32_t i = 1; i <= partitions; ++i)
+    {
+      Partition *p = new Partition;
+      p->index = i;
+      p->impl = this;
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      p->uid = 4;
+      p->currentUid = 0;
+      p->currentTs = m_partitions[0]->currentTs;
+      p->currentContext = NO_CONTEXT;
+      p->unscheduledEvents = 0;
+      p->next = NO_EVENT;
+      p->windowEnd = 0;
+      m_partitions.push_back (p);
+    }
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      (*i)->outbox.resize (m_partitions.size ());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::MapNodes (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t partitions = m_partitions.size () - 1;
+  uint32_t nodes = NodeList::GetNNodes ();
+  bool bySystemId = false;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      if ((*i)->GetSystemId () != 0)
+        {
+          bySystemId = true;
+          break;
+        }
+    }
+  uint32_t block = (nodes + partitions - 1) / partitions;
+  for (uint32_t id = m_nodePartition.size (); id < nodes; ++id)
+    {
+      uint32_t index;
+      if (bySystemId)
+        {
+          index = NodeList::GetNode (id)->GetSystemId () % partitions;
+        }
+      else
+        {
+          index = std::min (id / block, partitions - 1);
+        }
+      m_nodePartition.push_back (index + 1);
+    }
+
+  // The events scheduled for the nodes while they had no partition wait
+  // with the context-less ones: move them, with their uids
+  Partition *global = m_partitions[0];
+  std::vector<Scheduler::Event> events;
+  while (!global->events->IsEmpty ())
+    {
+      events.push_back (global->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Partition *p = GetPartition (i->key.m_context);
+      if (p != global)
+        {
+          global->unscheduledEvents--;
+          p->unscheduledEvents++;
+        }
+      p->events->Insert (*i);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t lookAhead = NO_EVENT;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      Partition *local = GetPartition (node->GetId ());
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              Ptr<Node> remote = channel->GetDevice (k)->GetNode ();
+              if (GetPartition (remote->GetId ()) == local)
+                {
+                  continue;
+                }
+              TimeValue delay;
+              NS_ABORT_MSG_UNLESS (device->IsPointToPoint ()
+                                   && channel->GetAttributeFailSafe ("Delay", delay),
+                                   "Node " << node->GetId () << " and node " << remote->GetId ()
+                                   << " are in different partitions, but not on a "
+                                   "point-to-point link; set their system ids");
+              lookAhead = std::min (lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+            }
+        }
+    }
+
+  if (m_lookAheadAttribute.IsStrictlyPositive ())
+    {
+      lookAhead = m_lookAheadAttribute.GetTimeStep ();
+    }
+  NS_ABORT_MSG_IF (lookAhead == 0, "A link between two partitions has no delay");
+  m_lookAhead = lookAhead;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context < m_nodePartition.size ())
+    {
+      return m_partitions[m_nodePartition[context]];
+    }
+  return m_partitions[0];
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = p->uid;
+  p->uid++;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::Merge (Partition *p)
+{
+  // The handed over events get their uids in the order of the partitions
+  // which sent them, so that the runs are repeatable
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      std::vector<EventWithContext> &outbox = (*i)->outbox[p->index];
+      for (std::vector<EventWithContext>::iterator j = outbox.begin (); j != outbox.end (); ++j)
+        {
+          Insert (p, j->timestamp, j->context, j->event);
+        }
+      outbox.clear ();
+    }
+
+  if (!p->foreign.IsEmpty ())
+    {
+      // The context-less events must not run before the time reached by
+      // the partitions
+      uint64_t now = p->currentTs;
+      for (uint32_t i = 1; p->index == 0 && i < m_partitions.size (); ++i)
+        {
+          now = std::max (now, m_partitions[i]->currentTs);
+        }
+      EventWithContext ev;
+      while (p->foreign.Pop (ev))
+        {
+          // Current time added here, as for the DefaultSimulatorImpl
+          Insert (p, now + ev.timestamp, ev.context, ev.event);
+        }
+    }
+
+  p->next = p->events->IsEmpty () ? NO_EVENT : p->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessEvents (Partition *p, uint64_t end)
+{
+  while (!p->events->IsEmpty () && !m_stop.load (std::memory_order_relaxed))
+    {
+      if (p->events->PeekNext ().key.m_ts >= end)
+        {
+          break;
+        }
+      Scheduler::Event next = p->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= p->currentTs);
+      p->unscheduledEvents--;
+
+      p->currentTs = next.key.m_ts;
+      p->currentContext = next.key.m_context;
+      p->currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t threads = m_partitions.size () - 1;
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierCount.fetch_add (1, std::memory_order_acq_rel) + 1 == threads)
+    {
+      // Last one in: release the others
+      m_barrierCount.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.fetch_add (1, std::memory_order_release);
+      return;
+    }
+  uint32_t spins = 0;
+  while (m_barrierGeneration.load (std::memory_order_acquire) == generation)
+    {
+      if (++spins > BARRIER_SPINS)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Work (Partition *p)
+{
+  m_current = p;
+  Partition *global = m_partitions[0];
+  // The main thread runs the first partition, and the context-less events
+  bool main = p->index == 1;
+
+  while (true)
+    {
+      // Nothing runs between the two barriers: collect the events of the
+      // last window and publish the time of the next one
+      Merge (p);
+      if (main)
+        {
+          Merge (global);
+        }
+      bool stop = m_stop;
+      Barrier ();
+
+      uint64_t next = NO_EVENT;
+      for (uint32_t i = 1; i < m_partitions.size (); ++i)
+        {
+          next = std::min (next, m_partitions[i]->next);
+        }
+      if (stop || (next == NO_EVENT && global->next == NO_EVENT))
+        {
+          break;
+        }
+
+      if (global->next <= next)
+        {
+          // A context-less event comes first: it runs alone
+          if (main)
+            {
+              m_serial = true;
+              m_current = global;
+              ProcessEvents (global, global->next + 1);
+              m_current = p;
+              m_serial = false;
+            }
+        }
+      else
+        {
+          // No partition may receive an event before the end of the window
+          p->windowEnd = next + std::min (m_lookAhead, NO_EVENT - next);
+          p->windowEnd = std::min (p->windowEnd, global->next);
+          ProcessEvents (p, p->windowEnd);
+        }
+      Barrier ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::WorkThread (Partition *p)
+{
+  p->impl->Work (p);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *global = m_partitions[0];
+  if (m_partitions.size () == 1)
+    {
+      CreatePartitions ();
+    }
+  MapNodes ();
+  CalculateLookAhead ();
+  NS_LOG_INFO ("Run " << m_partitions.size () - 1 << " partitions of "
+                      << m_nodePartition.size () << " nodes, lookahead " << GetLookAhead ());
+
+  // Every partition allocates the uids after the ones already in use
+  uint32_t uid = 0;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      uid = std::max (uid, (*i)->uid);
+    }
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      (*i)->uid = uid;
+    }
+
+  m_stop = false;
+  g_running = this;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 2; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&WorkThread, m_partitions[i]));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  Work (m_partitions[1]);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  g_running = 0;
+  m_systemIdBase += m_partitions.size () - 1;
+
+  // Back to the main program, at the time of the last event
+  m_current = global;
+  global->currentContext = NO_CONTEXT;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      global->currentTs = std::max (global->currentTs, (*i)->currentTs);
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      NS_ASSERT (m_stop || (*i)->unscheduledEvents == 0);
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  Partition *p = m_current;
+  NS_ASSERT_MSG (p != 0, "Simulator::Schedule Thread-unsafe invocation!");
+
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (p->currentTs));
+  uint64_t ts = tAbsolute.GetTimeStep ();
+  uint32_t uid = Insert (p, ts, p->currentContext, event);
+  return EventId (event, ts, p->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  Partition *p = m_current;
+  Partition *target = GetPartition (context);
+
+  if (p == 0)
+    {
+      // From a foreign thread: the current time is added in Merge
+      EventWithContext ev;
+      ev.context = context;
+      ev.timestamp = delay.GetTimeStep ();
+      ev.event = event;
+      target->foreign.Push (ev);
+      return;
+    }
+
+  uint64_t ts = (delay + TimeStep (p->currentTs)).GetTimeStep ();
+  if (target == p || m_serial || g_running == 0)
+    {
+      Insert (target, ts, context, event);
+      return;
+    }
+
+  NS_ABORT_MSG_IF (ts < p->windowEnd,
+                   "Event for node " << context << " in another partition within the "
+                   "lookahead (" << TimeStep (ts - p->currentTs) << " < "
+                   << TimeStep (p->windowEnd - p->currentTs) << ")");
+  EventWithContext ev;
+  ev.context = context;
+  ev.timestamp = ts;
+  ev.event = event;
+  p->outbox[target->index].push_back (ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *p = m_current;
+  NS_ASSERT_MSG (p != 0, "Simulator::ScheduleNow Thread-unsafe invocation!");
+
+  uint32_t uid = Insert (p, p->currentTs, p->currentContext, event);
+  return EventId (event, p->currentTs, p->currentContext, uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (m_current != 0, "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_current->currentTs, NO_CONTEXT, 2);
+  CriticalSection cs (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *p = m_current;
+  return TimeStep (p != 0 ? p->currentTs : m_partitions[0]->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  NS_ABORT_MSG_IF (g_running != 0 && !m_serial && p != m_current,
+                   "Removing an event of another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  // The events of a node are compared with the progress of its partition
+  Partition *p = GetPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p->currentTs
+      || (id.GetTs () == p->currentTs
+          && id.GetUid () <= p->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  Partition *p = m_current;
+  return p != 0 ? p->currentContext : NO_CONTEXT;
+}
+
+bool
+MultithreadedSimulatorImpl::IsLocal (uint32_t context)
+{
+  MultithreadedSimulatorImpl *impl = g_running;
+  if (impl == 0)
+    {
+      return true;
+    }
+  // The context-less events run alone, but may hand objects over to
+  // the partitions, which run later in other threads
+  return m_current != 0 && m_current != impl->m_partitions[0]
+         && impl->GetPartition (context) == m_current;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitions (void) const
+{
+  return m_partitions.size () - 1;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+} // namespace ns3
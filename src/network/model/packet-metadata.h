@@ -656,7 +656,9 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage, of the thread
+  /// The free list of the thread has been destroyed, at its exit
+  static thread_local bool m_freeListDestroyed;
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -667,8 +669,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size, of the thread
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid, of the thread
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -22,13 +22,14 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <string>
+#include <vector>
 #include <cstdarg>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+thread_local uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -127,6 +128,55 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> copy = Create<Packet> ();
+
+  // The serialized buffer keeps the zero area of the virtual payloads
+  std::vector<uint8_t> raw (m_buffer.GetSerializedSize ());
+  m_buffer.Serialize (&raw[0], raw.size ());
+  Buffer buffer (0, false);
+  // Deserialize expects the size of the length word of Packet::Serialize too
+  buffer.Deserialize (&raw[0], raw.size () + 4);
+  copy->m_buffer = buffer;
+  copy->m_metadata = PacketMetadata (GetUid (), GetSize ());
+
+  ByteTagList::Iterator i = m_byteTagList.Begin (0, GetSize ());
+  while (i.HasNext ())
+    {
+      ByteTagList::Iterator::Item item = i.Next ();
+      TagBuffer tag = copy->m_byteTagList.Add (item.tid, item.size, item.start, item.end);
+      tag.CopyFrom (item.buf);
+    }
+
+  // The packet tags are listed from the last one added
+  std::vector<Tag *> tags;
+  PacketTagIterator j = GetPacketTagIterator ();
+  while (j.HasNext ())
+    {
+      PacketTagIterator::Item item = j.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      NS_ASSERT (!constructor.IsNull ());
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      tags.push_back (tag);
+    }
+  for (std::vector<Tag *>::reverse_iterator k = tags.rbegin (); k != tags.rend (); ++k)
+    {
+      copy->AddPacketTag (**k);
+      delete *k;
+    }
+
+  if (m_nixVector)
+    {
+      copy->m_nixVector = m_nixVector->Copy ();
+    }
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -424,6 +424,18 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a full copy of the packet.
+   *
+   * \returns a copy of the packet which shares no data with the
+   * original one.
+   *
+   * The copy keeps the uid, the bytes, the byte and packet tags and the
+   * nix-vector of the packet, but not its metadata. It can be handed
+   * over to another thread, while the original packet is still in use.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -727,7 +739,7 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static thread_local uint32_t m_globalUid; //!< Counter of packets Uid of the thread
 };
 
 /**
@@ -326,6 +326,30 @@ Socket::DoDispose (void)
   m_receivedData = MakeNullCallback<void,Ptr<Socket> > ();
 }
 
+void
+Socket::ResetSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+  Socket::DoDispose ();
+  m_boundnetdevice = 0;
+  m_recvPktInfo = false;
+  m_ipv6MulticastGroupAddress = Ipv6Address::GetAny ();
+
+  m_manualIpTos = false;
+  m_manualIpTtl = false;
+  m_ipRecvTos = false;
+  m_ipRecvTtl = false;
+  m_ipTos = 0;
+  m_ipTtl = 0;
+
+  m_manualIpv6Tclass = false;
+  m_manualIpv6HopLimit = false;
+  m_ipv6RecvTclass = false;
+  m_ipv6RecvHopLimit = false;
+  m_ipv6Tclass = 0;
+  m_ipv6HopLimit = 0;
+}
+
 void
 Socket::BindToNetDevice (Ptr<NetDevice> netdevice)
 {
@@ -18,7 +18,10 @@
 
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/int-telemetry-tag.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
 
 using namespace ns3;
 
@@ -77,6 +80,69 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((item == 0), true, "There are really no packets in there");
 }
 
+class DropTailQueueTelemetryTestCase : public TestCase
+{
+public:
+  DropTailQueueTelemetryTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueTelemetryTestCase::DropTailQueueTelemetryTestCase ()
+  : TestCase ("Check the in-band telemetry stamped by the queue")
+{
+}
+void
+DropTailQueueTelemetryTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("StampTelemetry", BooleanValue (true));
+
+  Ptr<Packet> p1, p2, p3;
+  p1 = Create<Packet> (100);
+  p2 = Create<Packet> (100);
+  p3 = Create<Packet> (100);
+
+  IntTelemetryTag tag;
+  p2->AddPacketTag (tag);
+  p3->AddPacketTag (IntTelemetryEchoTag ());
+
+  queue->Enqueue (Create<QueueItem> (p1));
+  queue->Enqueue (Create<QueueItem> (p2));
+  queue->Enqueue (Create<QueueItem> (p3));
+
+  NS_TEST_EXPECT_MSG_EQ (p1->PeekPacketTag (tag), false, "Packets without a tag must not be stamped");
+
+  NS_TEST_EXPECT_MSG_EQ (p2->PeekPacketTag (tag), true, "The tag has been lost");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetMaxPackets (), 2, "Wrong occupancy in packets");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetMaxBytes (), 200, "Wrong occupancy in bytes");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) tag.GetHops (), 1, "Wrong number of hops");
+
+  // A second, emptier hop does not lower the maximum
+  Ptr<DropTailQueue> hop = CreateObject<DropTailQueue> ();
+  hop->SetAttribute ("StampTelemetry", BooleanValue (true));
+  hop->Enqueue (Create<QueueItem> (p2));
+  p2->PeekPacketTag (tag);
+  NS_TEST_EXPECT_MSG_EQ (tag.GetMaxPackets (), 2, "Maximum lowered by the second hop");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) tag.GetHops (), 2, "Wrong number of hops");
+
+  IntTelemetryEchoTag echo;
+  NS_TEST_EXPECT_MSG_EQ (p3->PeekPacketTag (echo), true, "The echo has been lost");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) echo.GetHops (), 0, "Echoes must not be stamped");
+
+  // A queue which knows its link rate stamps the queueing delay
+  Ptr<DropTailQueue> timed = CreateObject<DropTailQueue> ();
+  timed->SetAttribute ("StampTelemetry", BooleanValue (true));
+  timed->SetAttribute ("LinkRate", DataRateValue (DataRate ("8Mbps")));
+  Ptr<Packet> p4 = Create<Packet> (100);
+  Ptr<Packet> p5 = Create<Packet> (100);
+  p5->AddPacketTag (IntTelemetryTag ());
+  timed->Enqueue (Create<QueueItem> (p4));
+  timed->Enqueue (Create<QueueItem> (p5));
+  p5->PeekPacketTag (tag);
+  NS_TEST_EXPECT_MSG_EQ (tag.GetMaxQueueDelay (), MicroSeconds (200), "Wrong queueing delay");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetMaxUtilization (), 0, "Nothing has been transmitted yet");
+}
+
 static class DropTailQueueTestSuite : public TestSuite
 {
 public:
@@ -84,5 +150,6 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueTelemetryTestCase (), TestCase::QUICK);
   }
 } g_dropTailQueueTestSuite;
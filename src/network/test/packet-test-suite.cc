@@ -24,6 +24,7 @@
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <ctime>
@@ -582,6 +583,27 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test DeepCopy, which shares nothing with the original packet. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<20> ());
+    tmp->AddPacketTag (ATestTag<10> ());
+    Ptr<Packet> copy = tmp->DeepCopy ();
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 110, "DeepCopy changed the size");
+    NS_TEST_EXPECT_MSG_EQ (copy->GetUid (), tmp->GetUid (), "DeepCopy changed the uid");
+    CHECK (copy, 1, E (20, 0, 110));
+    ATestTag<10> tag;
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (tag), true, "DeepCopy lost the packet tag");
+    uint8_t a[110];
+    uint8_t b[110];
+    tmp->CopyData (a, 110);
+    copy->CopyData (b, 110);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (a, b, 110), 0, "DeepCopy changed the bytes");
+    copy->RemoveAtStart (10);
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 110, "DeepCopy shares the buffer");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tso-tag.h"
+
+using namespace ns3;
+
+/**
+ * \brief Testing the wire frames of a super-segment
+ */
+class TsoTagTestCase : public TestCase
+{
+public:
+  TsoTagTestCase ();
+  virtual void DoRun (void);
+};
+
+TsoTagTestCase::TsoTagTestCase ()
+  : TestCase ("Wire frames of a TsoTag super-segment")
+{
+}
+
+void
+TsoTagTestCase::DoRun (void)
+{
+  Ptr<Packet> untagged = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_EQ (TsoTag::GetFrames (untagged), 1, "Untagged packet split");
+  NS_TEST_EXPECT_MSG_EQ (TsoTag::GetWireSize (untagged), 1000, "Untagged packet resized");
+
+  // 10 full segments and a shorter one, behind 62 bytes of headers
+  Ptr<Packet> p = Create<Packet> (10 * 1448 + 500 + 62);
+  p->AddPacketTag (TsoTag (1448, 10 * 1448 + 500));
+  NS_TEST_EXPECT_MSG_EQ (TsoTag::GetFrames (p), 11, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (TsoTag::GetWireSize (p), 10 * 1448 + 500 + 11 * 62,
+                         "Headers not repeated in every frame");
+
+  // A whole number of segments
+  Ptr<Packet> q = Create<Packet> (4 * 1448 + 62);
+  q->AddPacketTag (TsoTag (1448, 4 * 1448));
+  NS_TEST_EXPECT_MSG_EQ (TsoTag::GetFrames (q), 4, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (TsoTag::GetWireSize (q), 4 * (1448 + 62), "Wrong wire size");
+}
+
+static class TsoTagTestSuite : public TestSuite
+{
+public:
+  TsoTagTestSuite ()
+    : TestSuite ("tso-tag", UNIT)
+  {
+    AddTestCase (new TsoTagTestCase (), TestCase::QUICK);
+  }
+} g_tsoTagTestSuite;
@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tsq-tag.h"
+
+using namespace ns3;
+
+/**
+ * \brief Testing that the bytes of a TsqTag go back to their owner, once
+ */
+class TsqTagTestCase : public TestCase
+{
+public:
+  TsqTagTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Release callback
+   * \param bytes the bytes released
+   */
+  void Released (uint32_t bytes);
+
+  uint32_t m_released; //!< Bytes released so far
+};
+
+TsqTagTestCase::TsqTagTestCase ()
+  : TestCase ("Release the bytes of a TsqTag to its owner"),
+    m_released (0)
+{
+}
+
+void
+TsqTagTestCase::Released (uint32_t bytes)
+{
+  m_released += bytes;
+}
+
+void
+TsqTagTestCase::DoRun (void)
+{
+  uint32_t owner = TsqTag::Register (MakeCallback (&TsqTagTestCase::Released, this));
+  NS_TEST_ASSERT_MSG_NE (owner, 0, "Owner 0 is reserved");
+
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddPacketTag (TsqTag (owner, 1000));
+  Ptr<Packet> untagged = Create<Packet> (500);
+
+  TsqTag::Release (untagged);
+  NS_TEST_EXPECT_MSG_EQ (m_released, 0, "Untagged packet released");
+
+  TsqTag::Release (p);
+  NS_TEST_EXPECT_MSG_EQ (m_released, 1000, "Bytes not released");
+  TsqTag tag;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (tag), false, "The tag is still there");
+
+  // The next hop does not release the packet again
+  TsqTag::Release (p);
+  NS_TEST_EXPECT_MSG_EQ (m_released, 1000, "Bytes released twice");
+
+  // Packets of an owner gone are ignored
+  Ptr<Packet> late = Create<Packet> (1000);
+  late->AddPacketTag (TsqTag (owner, 1000));
+  TsqTag::Unregister (owner);
+  TsqTag::Release (late);
+  NS_TEST_EXPECT_MSG_EQ (m_released, 1000, "Bytes released to an owner gone");
+}
+
+static class TsqTagTestSuite : public TestSuite
+{
+public:
+  TsqTagTestSuite ()
+    : TestSuite ("tsq-tag", UNIT)
+  {
+    AddTestCase (new TsqTagTestCase (), TestCase::QUICK);
+  }
+} g_tsqTagTestSuite;
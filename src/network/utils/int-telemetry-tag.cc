@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "int-telemetry-tag.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("IntTelemetryTag");
+
+NS_OBJECT_ENSURE_REGISTERED (IntTelemetryTag);
+NS_OBJECT_ENSURE_REGISTERED (IntTelemetryEchoTag);
+
+TypeId
+IntTelemetryTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IntTelemetryTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<IntTelemetryTag> ()
+  ;
+  return tid;
+}
+TypeId
+IntTelemetryTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+IntTelemetryTag::GetSerializedSize (void) const
+{
+  return 4 + 4 + 4 + 4 + 1;
+}
+void
+IntTelemetryTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_maxPackets);
+  buf.WriteU32 (m_maxBytes);
+  buf.WriteU32 (m_maxDelay);
+  buf.WriteU32 (m_maxUtil);
+  buf.WriteU8 (m_hops);
+}
+void
+IntTelemetryTag::Deserialize (TagBuffer buf)
+{
+  m_maxPackets = buf.ReadU32 ();
+  m_maxBytes = buf.ReadU32 ();
+  m_maxDelay = buf.ReadU32 ();
+  m_maxUtil = buf.ReadU32 ();
+  m_hops = buf.ReadU8 ();
+}
+void
+IntTelemetryTag::Print (std::ostream &os) const
+{
+  os << "MaxPackets=" << m_maxPackets << " MaxBytes=" << m_maxBytes
+     << " MaxDelay=" << m_maxDelay << "ns MaxUtil=" << m_maxUtil / 1e6
+     << " Hops=" << (uint32_t) m_hops;
+}
+IntTelemetryTag::IntTelemetryTag ()
+  : Tag (),
+    m_maxPackets (0),
+    m_maxBytes (0),
+    m_maxDelay (0),
+    m_maxUtil (0),
+    m_hops (0)
+{
+}
+
+void
+IntTelemetryTag::Stamp (uint32_t packets, uint32_t bytes, Time queueDelay, double utilization)
+{
+  NS_LOG_FUNCTION (this << packets << bytes << queueDelay << utilization);
+  m_maxPackets = std::max (m_maxPackets, packets);
+  m_maxBytes = std::max (m_maxBytes, bytes);
+  // Saturate, rather than wrap, values too large for the 32 bit fields
+  uint64_t delay = std::min<int64_t> (queueDelay.GetNanoSeconds (), UINT32_MAX);
+  m_maxDelay = std::max (m_maxDelay, static_cast<uint32_t> (delay));
+  uint64_t util = std::min (utilization * 1e6, static_cast<double> (UINT32_MAX));
+  m_maxUtil = std::max (m_maxUtil, static_cast<uint32_t> (util));
+  if (m_hops < 255)
+    {
+      m_hops++;
+    }
+}
+
+void
+IntTelemetryTag::Merge (const IntTelemetryTag &other)
+{
+  m_maxPackets = std::max (m_maxPackets, other.m_maxPackets);
+  m_maxBytes = std::max (m_maxBytes, other.m_maxBytes);
+  m_maxDelay = std::max (m_maxDelay, other.m_maxDelay);
+  m_maxUtil = std::max (m_maxUtil, other.m_maxUtil);
+  m_hops = std::max (m_hops, other.m_hops);
+}
+
+uint32_t
+IntTelemetryTag::GetMaxPackets (void) const
+{
+  return m_maxPackets;
+}
+
+uint32_t
+IntTelemetryTag::GetMaxBytes (void) const
+{
+  return m_maxBytes;
+}
+
+Time
+IntTelemetryTag::GetMaxQueueDelay (void) const
+{
+  return NanoSeconds (m_maxDelay);
+}
+
+double
+IntTelemetryTag::GetMaxUtilization (void) const
+{
+  return m_maxUtil / 1e6;
+}
+
+uint8_t
+IntTelemetryTag::GetHops (void) const
+{
+  return m_hops;
+}
+
+TypeId
+IntTelemetryEchoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IntTelemetryEchoTag")
+    .SetParent<IntTelemetryTag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<IntTelemetryEchoTag> ()
+  ;
+  return tid;
+}
+TypeId
+IntTelemetryEchoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+IntTelemetryEchoTag::Print (std::ostream &os) const
+{
+  os << "Echo ";
+  IntTelemetryTag::Print (os);
+}
+IntTelemetryEchoTag::IntTelemetryEchoTag ()
+  : IntTelemetryTag ()
+{
+}
+IntTelemetryEchoTag::IntTelemetryEchoTag (const IntTelemetryTag &tag)
+  : IntTelemetryTag (tag)
+{
+}
+
+} // namespace ns3
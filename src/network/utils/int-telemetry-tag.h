@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef INT_TELEMETRY_TAG_H
+#define INT_TELEMETRY_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief In-band network telemetry carried by a packet
+ *
+ * A sender which wants to know the occupancy of the queues along the path
+ * adds an empty tag to its packets. Every Queue with the "StampTelemetry"
+ * attribute set records its occupancy in the tag when the packet is
+ * enqueued, keeping the maximum over the hops traversed. Queues which know
+ * the rate of their link (attribute "LinkRate") also record the queueing
+ * delay and the utilization of the link, again keeping the maximum of each.
+ *
+ * The receiver sends the values back in an IntTelemetryEchoTag, attached to
+ * its ACKs; queues do not stamp echo tags, so the sender gets the occupancy
+ * of the forward path only.
+ */
+class IntTelemetryTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  IntTelemetryTag ();
+
+  /**
+   * \brief Record the occupancy of one more hop
+   *
+   * \param packets number of packets in the queue, including this one
+   * \param bytes number of bytes in the queue, including this one
+   * \param queueDelay time needed to drain the queue at the link rate
+   * \param utilization transmit rate of the link over its capacity
+   */
+  void Stamp (uint32_t packets, uint32_t bytes,
+              Time queueDelay = Time (0), double utilization = 0);
+
+  /**
+   * \brief Merge the values of another tag, keeping the maximum
+   * \param other the tag to merge
+   */
+  void Merge (const IntTelemetryTag &other);
+
+  /**
+   * \return the maximum queue occupancy over the path, in packets
+   */
+  uint32_t GetMaxPackets (void) const;
+
+  /**
+   * \return the maximum queue occupancy over the path, in bytes
+   */
+  uint32_t GetMaxBytes (void) const;
+
+  /**
+   * \return the maximum queueing delay over the path
+   */
+  Time GetMaxQueueDelay (void) const;
+
+  /**
+   * \return the maximum link utilization over the path
+   */
+  double GetMaxUtilization (void) const;
+
+  /**
+   * \return the number of queues which stamped the tag
+   */
+  uint8_t GetHops (void) const;
+
+private:
+  uint32_t m_maxPackets; //!< Maximum queue occupancy (packets)
+  uint32_t m_maxBytes;   //!< Maximum queue occupancy (bytes)
+  uint32_t m_maxDelay;   //!< Maximum queueing delay (ns)
+  uint32_t m_maxUtil;    //!< Maximum link utilization (millionths)
+  uint8_t m_hops;        //!< Number of queues traversed
+};
+
+/**
+ * \ingroup packet
+ *
+ * \brief In-band network telemetry echoed back to the sender
+ *
+ * A distinct tag type, so that a data segment can carry both its own
+ * IntTelemetryTag and the echo of the peer's one in a piggybacked ACK.
+ */
+class IntTelemetryEchoTag : public IntTelemetryTag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  IntTelemetryEchoTag ();
+
+  /**
+   * \brief Build the echo of a received tag
+   * \param tag the tag to echo
+   */
+  IntTelemetryEchoTag (const IntTelemetryTag &tag);
+};
+
+} // namespace ns3
+
+#endif /* INT_TELEMETRY_TAG_H */
@@ -20,7 +20,10 @@
 #include "ns3/abort.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
+#include "int-telemetry-tag.h"
 #include "queue.h"
 
 namespace ns3 {
@@ -54,6 +57,22 @@ Queue::GetTypeId (void)
                    MakeUintegerAccessor (&Queue::SetMaxBytes,
                                          &Queue::GetMaxBytes),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StampTelemetry",
+                   "Record the queue occupancy in the IntTelemetryTag of the packets enqueued.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Queue::m_stampTelemetry),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LinkRate",
+                   "Rate of the link served by the queue, used to stamp the queueing delay "
+                   "and the link utilization in telemetry tags. Zero if unknown.",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&Queue::m_linkRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("TelemetryRateWindow",
+                   "Window over which the transmit rate of the link is measured.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&Queue::m_txRateWindow),
+                   MakeTimeChecker ())
     .AddTraceSource ("Enqueue", "Enqueue a packet in the queue.",
                      MakeTraceSourceAccessor (&Queue::m_traceEnqueue),
                      "ns3::Packet::TracedCallback")
@@ -82,7 +101,12 @@ Queue::Queue() :
   m_nTotalReceivedPackets (0),
   m_nTotalDroppedBytes (0),
   m_nTotalDroppedPackets (0),
-  m_mode (QUEUE_MODE_PACKETS)
+  m_mode (QUEUE_MODE_PACKETS),
+  m_stampTelemetry (false),
+  m_linkRate (0),
+  m_txWindowStart (Seconds (0)),
+  m_txWindowBytes (0),
+  m_txRate (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -127,10 +151,49 @@ Queue::Enqueue (Ptr<QueueItem> item)
 
       m_nPackets++;
       m_nTotalReceivedPackets++;
+
+      if (m_stampTelemetry)
+        {
+          StampTelemetry (item->GetPacket ());
+        }
     }
   return retval;
 }
 
+void
+Queue::StampTelemetry (Ptr<Packet> p)
+{
+  IntTelemetryTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      p->RemovePacketTag (tag);
+      if (m_linkRate.GetBitRate () > 0)
+        {
+          UpdateTxRate ();
+          tag.Stamp (m_nPackets.Get (), m_nBytes.Get (),
+                     m_linkRate.CalculateBytesTxTime (m_nBytes.Get ()),
+                     m_txRate / m_linkRate.GetBitRate ());
+        }
+      else
+        {
+          tag.Stamp (m_nPackets.Get (), m_nBytes.Get ());
+        }
+      p->AddPacketTag (tag);
+    }
+}
+
+void
+Queue::UpdateTxRate (void)
+{
+  Time elapsed = Simulator::Now () - m_txWindowStart;
+  if (elapsed >= m_txRateWindow && elapsed.IsStrictlyPositive ())
+    {
+      m_txRate = m_txWindowBytes * 8 / elapsed.GetSeconds ();
+      m_txWindowBytes = 0;
+      m_txWindowStart = Simulator::Now ();
+    }
+}
+
 Ptr<QueueItem>
 Queue::Dequeue (void)
 {
@@ -152,6 +215,12 @@ Queue::Dequeue (void)
       m_nBytes -= item->GetPacketSize ();
       m_nPackets--;
 
+      if (m_stampTelemetry && m_linkRate.GetBitRate () > 0)
+        {
+          m_txWindowBytes += item->GetPacketSize ();
+          UpdateTxRate ();
+        }
+
       NS_LOG_LOGIC ("m_traceDequeue (packet)");
       m_traceDequeue (item->GetPacket ());
     }
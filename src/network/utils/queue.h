@@ -28,6 +28,8 @@
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
 #include "ns3/traced-value.h"
+#include "ns3/nstime.h"
+#include "data-rate.h"
 
 namespace ns3 {
 
@@ -237,6 +239,21 @@ private:
    */
   void NotifyDrop (Ptr<QueueItem> item);
 
+  /**
+   * \brief Record the current occupancy in the telemetry tag of a packet
+   *
+   * Packets without an IntTelemetryTag are untouched. If the link rate is
+   * known, the queueing delay and the link utilization are recorded too.
+   *
+   * \param p the packet just enqueued
+   */
+  void StampTelemetry (Ptr<Packet> p);
+
+  /**
+   * \brief Close the transmit rate measurement window, if it has elapsed
+   */
+  void UpdateTxRate (void);
+
   /// Traced callback: fired when a packet is enqueued
   TracedCallback<Ptr<const Packet> > m_traceEnqueue;
   /// Traced callback: fired when a packet is dequeued
@@ -254,6 +271,12 @@ private:
   uint32_t m_maxPackets;              //!< max packets in the queue
   uint32_t m_maxBytes;                //!< max bytes in the queue
   QueueMode m_mode;                   //!< queue mode (packets or bytes limited)
+  bool m_stampTelemetry;              //!< stamp the occupancy in telemetry tags
+  DataRate m_linkRate;                //!< rate of the link served, 0 if unknown
+  Time m_txRateWindow;                //!< transmit rate measurement window
+  Time m_txWindowStart;               //!< start of the current measurement window
+  uint64_t m_txWindowBytes;           //!< bytes dequeued in the current window
+  double m_txRate;                    //!< transmit rate over the last window (bps)
   DropCallback m_dropCallback;        //!< drop callback
 };
 
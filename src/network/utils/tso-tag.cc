@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tso-tag.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TsoTag");
+
+NS_OBJECT_ENSURE_REGISTERED (TsoTag);
+
+TypeId
+TsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<TsoTag> ()
+  ;
+  return tid;
+}
+TypeId
+TsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+TsoTag::GetSerializedSize (void) const
+{
+  return 4 + 4;
+}
+void
+TsoTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_segmentSize);
+  buf.WriteU32 (m_payloadSize);
+}
+void
+TsoTag::Deserialize (TagBuffer buf)
+{
+  m_segmentSize = buf.ReadU32 ();
+  m_payloadSize = buf.ReadU32 ();
+}
+void
+TsoTag::Print (std::ostream &os) const
+{
+  os << "SegmentSize=" << m_segmentSize << " PayloadSize=" << m_payloadSize;
+}
+TsoTag::TsoTag ()
+  : Tag (),
+    m_segmentSize (0),
+    m_payloadSize (0)
+{
+}
+TsoTag::TsoTag (uint32_t segmentSize, uint32_t payloadSize)
+  : Tag (),
+    m_segmentSize (segmentSize),
+    m_payloadSize (payloadSize)
+{
+}
+
+uint32_t
+TsoTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+uint32_t
+TsoTag::GetPayloadSize (void) const
+{
+  return m_payloadSize;
+}
+
+uint32_t
+TsoTag::GetFrames (Ptr<const Packet> p)
+{
+  TsoTag tag;
+  if (!p->PeekPacketTag (tag) || tag.m_segmentSize == 0)
+    {
+      return 1;
+    }
+  return std::max<uint32_t> (1, (tag.m_payloadSize + tag.m_segmentSize - 1) / tag.m_segmentSize);
+}
+
+uint32_t
+TsoTag::GetWireSize (Ptr<const Packet> p)
+{
+  TsoTag tag;
+  uint32_t size = p->GetSize ();
+  if (!p->PeekPacketTag (tag) || tag.m_segmentSize == 0 || tag.m_payloadSize > size)
+    {
+      return size;
+    }
+  uint32_t frames = GetFrames (p);
+  uint32_t headers = size - tag.m_payloadSize;
+  NS_LOG_LOGIC ("Super-segment of " << size << " bytes in " << frames << " frames");
+  return size + (frames - 1) * headers;
+}
+
+} // namespace ns3
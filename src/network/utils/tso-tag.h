@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TSO_TAG_H
+#define TSO_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Segmentation offload of a transport super-segment
+ *
+ * A transport protocol using segmentation offload (see the "TsoMaxSize"
+ * attribute of TcpSocketBase) hands down segments carrying several MSS of
+ * payload at once, tagged with the MSS and the payload size. The IP layer
+ * does not fragment them, and the queues handle them as one packet.
+ *
+ * The packet is never split: a device honouring the tag transmits it for
+ * the time the wire frames of the individual segments would take, each of
+ * them repeating the headers of the super-segment, with an interframe gap
+ * between them. The peer receives the whole super-segment when its last
+ * frame arrives, as generic receive offload would deliver it.
+ *
+ * PointToPointNetDevice and CsmaNetDevice honour the tag; other devices
+ * would transmit the super-segment as a single, oversized frame.
+ *
+ * The tag stays on the packet when it is forwarded: every hop of the path
+ * stores and forwards the whole super-segment, which is not how a switch
+ * forwards the individual frames. The per-hop latency is that of the
+ * super-segment, and queues limited in packets count it as one.
+ */
+class TsoTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  TsoTag ();
+
+  /**
+   * \brief Constructor
+   * \param segmentSize the payload of each wire frame (MSS)
+   * \param payloadSize the payload of the super-segment
+   */
+  TsoTag (uint32_t segmentSize, uint32_t payloadSize);
+
+  /**
+   * \return the payload of each wire frame (MSS)
+   */
+  uint32_t GetSegmentSize (void) const;
+
+  /**
+   * \return the payload of the super-segment
+   */
+  uint32_t GetPayloadSize (void) const;
+
+  /**
+   * \brief Get the number of wire frames of a packet
+   * \param p the packet
+   * \return the frames of a super-segment, or 1 for an untagged packet
+   */
+  static uint32_t GetFrames (Ptr<const Packet> p);
+
+  /**
+   * \brief Get the bytes of the wire frames of a packet
+   *
+   * The headers of the packet, i.e. its bytes beyond the payload of the
+   * super-segment, are repeated in every frame.
+   *
+   * \param p the packet, with the headers of the device
+   * \return the bytes of all the frames, or the size of an untagged packet
+   */
+  static uint32_t GetWireSize (Ptr<const Packet> p);
+
+private:
+  uint32_t m_segmentSize; //!< Payload of each wire frame
+  uint32_t m_payloadSize; //!< Payload of the super-segment
+};
+
+} // namespace ns3
+
+#endif /* TSO_TAG_H */
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tsq-tag.h"
+#include "ns3/log.h"
+#include "ns3/system-mutex.h"
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TsqTag");
+
+NS_OBJECT_ENSURE_REGISTERED (TsqTag);
+
+/**
+ * \brief The registered owners
+ * \return the release callbacks, by owner identifier
+ */
+static std::map<uint32_t, TsqTag::ReleaseCallback> &
+GetOwners (void)
+{
+  static std::map<uint32_t, TsqTag::ReleaseCallback> owners;
+  return owners;
+}
+
+/**
+ * \brief The lock of the owners, registered from the threads of a
+ * MultithreadedSimulatorImpl
+ * \return the mutex
+ */
+static SystemMutex &
+GetOwnersMutex (void)
+{
+  static SystemMutex mutex;
+  return mutex;
+}
+
+TypeId
+TsqTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TsqTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<TsqTag> ()
+  ;
+  return tid;
+}
+TypeId
+TsqTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+TsqTag::GetSerializedSize (void) const
+{
+  return 4 + 4;
+}
+void
+TsqTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_owner);
+  buf.WriteU32 (m_bytes);
+}
+void
+TsqTag::Deserialize (TagBuffer buf)
+{
+  m_owner = buf.ReadU32 ();
+  m_bytes = buf.ReadU32 ();
+}
+void
+TsqTag::Print (std::ostream &os) const
+{
+  os << "Owner=" << m_owner << " Bytes=" << m_bytes;
+}
+TsqTag::TsqTag ()
+  : Tag (),
+    m_owner (0),
+    m_bytes (0)
+{
+}
+TsqTag::TsqTag (uint32_t owner, uint32_t bytes)
+  : Tag (),
+    m_owner (owner),
+    m_bytes (bytes)
+{
+}
+
+uint32_t
+TsqTag::GetOwner (void) const
+{
+  return m_owner;
+}
+
+uint32_t
+TsqTag::GetBytes (void) const
+{
+  return m_bytes;
+}
+
+uint32_t
+TsqTag::Register (ReleaseCallback cb)
+{
+  CriticalSection cs (GetOwnersMutex ());
+  static uint32_t nextOwner = 1;
+  uint32_t owner = nextOwner++;
+  GetOwners ()[owner] = cb;
+  NS_LOG_LOGIC ("Registered owner " << owner);
+  return owner;
+}
+
+void
+TsqTag::Unregister (uint32_t owner)
+{
+  NS_LOG_LOGIC ("Unregistered owner " << owner);
+  CriticalSection cs (GetOwnersMutex ());
+  GetOwners ().erase (owner);
+}
+
+void
+TsqTag::Release (Ptr<Packet> p)
+{
+  TsqTag tag;
+  if (!p->RemovePacketTag (tag))
+    {
+      return;
+    }
+  ReleaseCallback cb;
+  {
+    CriticalSection cs (GetOwnersMutex ());
+    std::map<uint32_t, ReleaseCallback>::iterator it = GetOwners ().find (tag.m_owner);
+    if (it == GetOwners ().end ())
+      {
+        return;
+      }
+    cb = it->second;
+  }
+  // The owner is a socket of the node, run by the current thread
+  NS_LOG_LOGIC ("Release " << tag.m_bytes << " bytes of owner " << tag.m_owner);
+  cb (tag.m_bytes);
+}
+
+} // namespace ns3
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+// ns3 includes
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/point-to-point-fat-tree.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointFatTreeHelper");
+
+PointToPointFatTreeHelper::PointToPointFatTreeHelper (uint32_t k,
+                                                      PointToPointHelper hostLink,
+                                                      PointToPointHelper fabricLink,
+                                                      double oversubscription)
+  : m_k (k)
+{
+  NS_ABORT_MSG_IF (k < 2 || k % 2 != 0, "The fat-tree radix must be even");
+  NS_ABORT_MSG_IF (oversubscription <= 0, "Oversubscription must be positive");
+
+  uint32_t half = k / 2;
+  m_hostsPerEdge = std::max (1U, static_cast<uint32_t> (std::floor (half * oversubscription + 0.5)));
+
+  m_cores.Create (half * half);
+  m_aggs.Create (k * half);
+  m_edges.Create (k * half);
+  m_hosts.Create (k * half * m_hostsPerEdge);
+
+  NS_LOG_INFO ("Fat-tree k=" << k << ": " << m_hosts.GetN () << " hosts, " <<
+               m_edges.GetN () + m_aggs.GetN () + m_cores.GetN () << " switches");
+
+  for (uint32_t pod = 0; pod < k; ++pod)
+    {
+      for (uint32_t e = 0; e < half; ++e)
+        {
+          uint32_t edge = pod * half + e;
+
+          // Hosts under this edge switch
+          for (uint32_t h = 0; h < m_hostsPerEdge; ++h)
+            {
+              NetDeviceContainer nd = hostLink.Install (m_hosts.Get (edge * m_hostsPerEdge + h),
+                                                        m_edges.Get (edge));
+              m_hostDevices.Add (nd.Get (0));
+              m_hostSwitchDevices.Add (nd.Get (1));
+            }
+
+          // Edge to every aggregation switch of the pod
+          for (uint32_t a = 0; a < half; ++a)
+            {
+              m_fabricLinks.push_back (fabricLink.Install (m_edges.Get (edge),
+                                                           m_aggs.Get (pod * half + a)));
+            }
+        }
+
+      // The j-th aggregation switch goes to the j-th group of cores
+      for (uint32_t a = 0; a < half; ++a)
+        {
+          for (uint32_t c = 0; c < half; ++c)
+            {
+              m_fabricLinks.push_back (fabricLink.Install (m_aggs.Get (pod * half + a),
+                                                           m_cores.Get (a * half + c)));
+            }
+        }
+    }
+}
+
+PointToPointFatTreeHelper::~PointToPointFatTreeHelper ()
+{
+}
+
+Ptr<Node>
+PointToPointFatTreeHelper::GetHost (uint32_t i) const
+{
+  return m_hosts.Get (i);
+}
+
+Ipv4Address
+PointToPointFatTreeHelper::GetHostIpv4Address (uint32_t i) const
+{
+  return m_hostInterfaces.GetAddress (i);
+}
+
+NodeContainer
+PointToPointFatTreeHelper::GetHosts () const
+{
+  return m_hosts;
+}
+
+NodeContainer
+PointToPointFatTreeHelper::GetSwitches () const
+{
+  return NodeContainer (m_edges, m_aggs, m_cores);
+}
+
+uint32_t
+PointToPointFatTreeHelper::HostCount () const
+{
+  return m_hosts.GetN ();
+}
+
+uint32_t
+PointToPointFatTreeHelper::HostsPerEdge () const
+{
+  return m_hostsPerEdge;
+}
+
+void
+PointToPointFatTreeHelper::InstallStack (InternetStackHelper stack)
+{
+  stack.Install (m_hosts);
+  stack.Install (m_edges);
+  stack.Install (m_aggs);
+  stack.Install (m_cores);
+}
+
+void
+PointToPointFatTreeHelper::AssignIpv4Addresses (Ipv4AddressHelper address)
+{
+  for (uint32_t i = 0; i < m_hostDevices.GetN (); ++i)
+    {
+      m_hostInterfaces.Add (address.Assign (m_hostDevices.Get (i)));
+      address.Assign (m_hostSwitchDevices.Get (i));
+      address.NewNetwork ();
+    }
+
+  for (std::vector<NetDeviceContainer>::const_iterator it = m_fabricLinks.begin ();
+       it != m_fabricLinks.end (); ++it)
+    {
+      address.Assign (*it);
+      address.NewNetwork ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_FAT_TREE_HELPER_H
+#define POINT_TO_POINT_FAT_TREE_HELPER_H
+
+#include <vector>
+
+#include "point-to-point-helper.h"
+#include "ipv4-address-helper.h"
+#include "internet-stack-helper.h"
+#include "ipv4-interface-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to make it easier to create a k-ary fat-tree
+ * datacenter fabric with PointToPoint links
+ *
+ * The fabric has k pods, each made of k/2 edge and k/2 aggregation
+ * switches, and (k/2)^2 core switches. Every edge switch is connected to
+ * all the aggregation switches of its pod, and the j-th aggregation switch
+ * of every pod is connected to the j-th group of k/2 core switches.
+ *
+ * Without oversubscription each edge switch serves k/2 hosts, for a total
+ * of k^3/4 hosts; an oversubscription factor of n puts n * k/2 hosts under
+ * each edge switch, with the same uplinks.
+ *
+ * Hosts are numbered by pod, then by edge switch. To spread the flows over
+ * the equal cost paths, set the attribute
+ * "ns3::Ipv4GlobalRouting::FlowEcmpRouting" before installing the stack,
+ * and populate the routing tables with
+ * Ipv4GlobalRoutingHelper::PopulateRoutingTables once addresses are
+ * assigned.
+ */
+class PointToPointFatTreeHelper
+{
+public:
+  /**
+   * Create a PointToPointFatTreeHelper in order to easily create
+   * fat-tree topologies using p2p links
+   *
+   * \param k the number of ports of every switch (must be even)
+   * \param hostLink the link helper for the links between hosts and
+   *        edge switches
+   * \param fabricLink the link helper for the links between switches
+   * \param oversubscription ratio between the host-facing and the
+   *        uplink capacity of edge switches (1 means no oversubscription)
+   */
+  PointToPointFatTreeHelper (uint32_t k,
+                             PointToPointHelper hostLink,
+                             PointToPointHelper fabricLink,
+                             double oversubscription = 1.0);
+
+  ~PointToPointFatTreeHelper ();
+
+public:
+  /**
+   * \param i an index into the hosts
+   *
+   * \returns a node pointer to the indexed host
+   */
+  Ptr<Node> GetHost (uint32_t i) const;
+
+  /**
+   * \param i an index into the hosts
+   *
+   * \returns the Ipv4Address of the indexed host
+   */
+  Ipv4Address GetHostIpv4Address (uint32_t i) const;
+
+  /**
+   * \returns a container with all the hosts
+   */
+  NodeContainer GetHosts () const;
+
+  /**
+   * \returns a container with all the switches (edge, aggregation, core)
+   */
+  NodeContainer GetSwitches () const;
+
+  /**
+   * \returns the total number of hosts
+   */
+  uint32_t HostCount () const;
+
+  /**
+   * \returns the number of hosts under each edge switch
+   */
+  uint32_t HostsPerEdge () const;
+
+  /**
+   * \param stack an InternetStackHelper which is used to install
+   *              on every node of the fabric
+   */
+  void InstallStack (InternetStackHelper stack);
+
+  /**
+   * \param address an Ipv4AddressHelper which is used to install
+   *                Ipv4 addresses on all the node interfaces of the
+   *                fabric. A new network is used for every link, so a
+   *                /30 mask is enough.
+   */
+  void AssignIpv4Addresses (Ipv4AddressHelper address);
+
+private:
+  uint32_t m_k;                               //!< Switch radix
+  uint32_t m_hostsPerEdge;                    //!< Hosts under each edge switch
+  NodeContainer m_hosts;                      //!< Hosts
+  NodeContainer m_edges;                      //!< Edge switches
+  NodeContainer m_aggs;                       //!< Aggregation switches
+  NodeContainer m_cores;                      //!< Core switches
+  NetDeviceContainer m_hostDevices;           //!< Host NetDevices
+  NetDeviceContainer m_hostSwitchDevices;     //!< Edge NetDevices facing the hosts
+  std::vector<NetDeviceContainer> m_fabricLinks; //!< NetDevices of the switch-to-switch links
+  Ipv4InterfaceContainer m_hostInterfaces;    //!< IPv4 host interfaces
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_FAT_TREE_HELPER_H */
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ns3 includes
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/point-to-point-leaf-spine.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointLeafSpineHelper");
+
+PointToPointLeafSpineHelper::PointToPointLeafSpineHelper (uint32_t nLeaves,
+                                                          uint32_t nSpines,
+                                                          uint32_t hostsPerLeaf,
+                                                          PointToPointHelper hostLink,
+                                                          PointToPointHelper fabricLink)
+{
+  NS_ABORT_MSG_IF (nLeaves == 0 || nSpines == 0 || hostsPerLeaf == 0,
+                   "A leaf-spine fabric needs leaves, spines and hosts");
+
+  m_spines.Create (nSpines);
+  m_leaves.Create (nLeaves);
+  m_hosts.Create (nLeaves * hostsPerLeaf);
+
+  for (uint32_t l = 0; l < nLeaves; ++l)
+    {
+      for (uint32_t h = 0; h < hostsPerLeaf; ++h)
+        {
+          NetDeviceContainer nd = hostLink.Install (m_hosts.Get (l * hostsPerLeaf + h),
+                                                    m_leaves.Get (l));
+          m_hostDevices.Add (nd.Get (0));
+          m_hostSwitchDevices.Add (nd.Get (1));
+        }
+
+      for (uint32_t s = 0; s < nSpines; ++s)
+        {
+          m_fabricLinks.push_back (fabricLink.Install (m_leaves.Get (l), m_spines.Get (s)));
+        }
+    }
+}
+
+PointToPointLeafSpineHelper::~PointToPointLeafSpineHelper ()
+{
+}
+
+Ptr<Node>
+PointToPointLeafSpineHelper::GetHost (uint32_t i) const
+{
+  return m_hosts.Get (i);
+}
+
+Ipv4Address
+PointToPointLeafSpineHelper::GetHostIpv4Address (uint32_t i) const
+{
+  return m_hostInterfaces.GetAddress (i);
+}
+
+NodeContainer
+PointToPointLeafSpineHelper::GetHosts () const
+{
+  return m_hosts;
+}
+
+NodeContainer
+PointToPointLeafSpineHelper::GetSwitches () const
+{
+  return NodeContainer (m_leaves, m_spines);
+}
+
+uint32_t
+PointToPointLeafSpineHelper::HostCount () const
+{
+  return m_hosts.GetN ();
+}
+
+void
+PointToPointLeafSpineHelper::InstallStack (InternetStackHelper stack)
+{
+  stack.Install (m_hosts);
+  stack.Install (m_leaves);
+  stack.Install (m_spines);
+}
+
+void
+PointToPointLeafSpineHelper::AssignIpv4Addresses (Ipv4AddressHelper address)
+{
+  for (uint32_t i = 0; i < m_hostDevices.GetN (); ++i)
+    {
+      m_hostInterfaces.Add (address.Assign (m_hostDevices.Get (i)));
+      address.Assign (m_hostSwitchDevices.Get (i));
+      address.NewNetwork ();
+    }
+
+  for (std::vector<NetDeviceContainer>::const_iterator it = m_fabricLinks.begin ();
+       it != m_fabricLinks.end (); ++it)
+    {
+      address.Assign (*it);
+      address.NewNetwork ();
+    }
+}
+
+} // namespace ns3
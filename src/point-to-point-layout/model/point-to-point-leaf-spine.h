@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_LEAF_SPINE_HELPER_H
+#define POINT_TO_POINT_LEAF_SPINE_HELPER_H
+
+#include <vector>
+
+#include "point-to-point-helper.h"
+#include "ipv4-address-helper.h"
+#include "internet-stack-helper.h"
+#include "ipv4-interface-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to make it easier to create a two-tier leaf-spine
+ * datacenter fabric with PointToPoint links
+ *
+ * Every leaf switch serves the same number of hosts and is connected to
+ * every spine switch. The oversubscription of the leaves is given by the
+ * ratio between the host capacity (hosts per leaf times the host link
+ * rate) and the uplink capacity (spines times the fabric link rate).
+ *
+ * Hosts are numbered by leaf. To spread the flows over the spines, set the
+ * attribute "ns3::Ipv4GlobalRouting::FlowEcmpRouting" before installing
+ * the stack, and populate the routing tables with
+ * Ipv4GlobalRoutingHelper::PopulateRoutingTables once addresses are
+ * assigned.
+ */
+class PointToPointLeafSpineHelper
+{
+public:
+  /**
+   * Create a PointToPointLeafSpineHelper in order to easily create
+   * leaf-spine topologies using p2p links
+   *
+   * \param nLeaves the number of leaf switches
+   * \param nSpines the number of spine switches
+   * \param hostsPerLeaf the number of hosts under each leaf switch
+   * \param hostLink the link helper for the links between hosts and leaves
+   * \param fabricLink the link helper for the links between leaves and spines
+   */
+  PointToPointLeafSpineHelper (uint32_t nLeaves,
+                               uint32_t nSpines,
+                               uint32_t hostsPerLeaf,
+                               PointToPointHelper hostLink,
+                               PointToPointHelper fabricLink);
+
+  ~PointToPointLeafSpineHelper ();
+
+public:
+  /**
+   * \param i an index into the hosts
+   *
+   * \returns a node pointer to the indexed host
+   */
+  Ptr<Node> GetHost (uint32_t i) const;
+
+  /**
+   * \param i an index into the hosts
+   *
+   * \returns the Ipv4Address of the indexed host
+   */
+  Ipv4Address GetHostIpv4Address (uint32_t i) const;
+
+  /**
+   * \returns a container with all the hosts
+   */
+  NodeContainer GetHosts () const;
+
+  /**
+   * \returns a container with all the switches (leaves, then spines)
+   */
+  NodeContainer GetSwitches () const;
+
+  /**
+   * \returns the total number of hosts
+   */
+  uint32_t HostCount () const;
+
+  /**
+   * \param stack an InternetStackHelper which is used to install
+   *              on every node of the fabric
+   */
+  void InstallStack (InternetStackHelper stack);
+
+  /**
+   * \param address an Ipv4AddressHelper which is used to install
+   *                Ipv4 addresses on all the node interfaces of the
+   *                fabric. A new network is used for every link, so a
+   *                /30 mask is enough.
+   */
+  void AssignIpv4Addresses (Ipv4AddressHelper address);
+
+private:
+  NodeContainer m_hosts;                      //!< Hosts
+  NodeContainer m_leaves;                     //!< Leaf switches
+  NodeContainer m_spines;                     //!< Spine switches
+  NetDeviceContainer m_hostDevices;           //!< Host NetDevices
+  NetDeviceContainer m_hostSwitchDevices;     //!< Leaf NetDevices facing the hosts
+  std::vector<NetDeviceContainer> m_fabricLinks; //!< NetDevices of the leaf-to-spine links
+  Ipv4InterfaceContainer m_hostInterfaces;    //!< IPv4 host interfaces
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_LEAF_SPINE_HELPER_H */
@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-fat-tree.h"
+#include "ns3/point-to-point-leaf-spine.h"
+
+using namespace ns3;
+
+/**
+ * \brief Base class of the fabric tests
+ */
+class PointToPointLayoutTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the test case name
+   */
+  PointToPointLayoutTestCase (std::string name);
+
+protected:
+  /**
+   * \brief Check the host link and the address of every host of a fabric
+   *
+   * Hosts are numbered by switch, and every link is a /30 network taken in
+   * order from 10.0.0.0, the host side first.
+   *
+   * \param hosts the hosts of the fabric
+   * \param switches the switches of the fabric, the ones facing the hosts first
+   * \param hostsPerSwitch the hosts under each switch
+   * \param addresses the addresses of the hosts, as given by the helper
+   */
+  void CheckHosts (NodeContainer hosts, NodeContainer switches,
+                   uint32_t hostsPerSwitch, std::vector<Ipv4Address> addresses);
+};
+
+PointToPointLayoutTestCase::PointToPointLayoutTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+PointToPointLayoutTestCase::CheckHosts (NodeContainer hosts, NodeContainer switches,
+                                        uint32_t hostsPerSwitch, std::vector<Ipv4Address> addresses)
+{
+  for (uint32_t i = 0; i < hosts.GetN (); ++i)
+    {
+      Ptr<Node> host = hosts.Get (i);
+      Ptr<PointToPointChannel> channel =
+        DynamicCast<PointToPointChannel> (host->GetDevice (0)->GetChannel ());
+      NS_TEST_EXPECT_MSG_NE (channel, 0, "Host " << i << " has no link");
+      if (channel == 0)
+        {
+          continue;
+        }
+      NS_TEST_EXPECT_MSG_EQ (channel->GetDevice (1)->GetNode (),
+                             switches.Get (i / hostsPerSwitch),
+                             "Host " << i << " is under the wrong switch");
+
+      Ipv4Address expected (Ipv4Address ("10.0.0.1").Get () + 4 * i);
+      NS_TEST_EXPECT_MSG_EQ (addresses[i], expected,
+                             "Host " << i << " has the wrong address");
+
+      Ptr<Ipv4> ipv4 = host->GetObject<Ipv4> ();
+      NS_TEST_EXPECT_MSG_EQ (ipv4->GetNInterfaces (), 2,
+                             "Host " << i << " should have a loopback and a link");
+      NS_TEST_EXPECT_MSG_EQ (ipv4->GetAddress (1, 0).GetLocal (), expected,
+                             "Host " << i << " interface has the wrong address");
+
+      // The switch side of the host link
+      Ptr<Ipv4> switchIpv4 = channel->GetDevice (1)->GetNode ()->GetObject<Ipv4> ();
+      int32_t interface = switchIpv4->GetInterfaceForDevice (channel->GetDevice (1));
+      NS_TEST_EXPECT_MSG_EQ (switchIpv4->GetAddress (interface, 0).GetLocal (),
+                             Ipv4Address (expected.Get () + 1),
+                             "Switch side of host " << i << " has the wrong address");
+    }
+}
+
+/**
+ * \brief Test the nodes, links and addresses of PointToPointFatTreeHelper
+ */
+class PointToPointFatTreeTestCase : public PointToPointLayoutTestCase
+{
+public:
+  /**
+   * \param k the radix of the switches
+   * \param oversubscription the oversubscription of the edge switches
+   */
+  PointToPointFatTreeTestCase (uint32_t k, double oversubscription);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_k;              //!< Switch radix
+  double m_oversubscription; //!< Oversubscription of the edge switches
+};
+
+PointToPointFatTreeTestCase::PointToPointFatTreeTestCase (uint32_t k, double oversubscription)
+  : PointToPointLayoutTestCase ("Fat-tree nodes, links and addresses"),
+    m_k (k),
+    m_oversubscription (oversubscription)
+{
+}
+
+void
+PointToPointFatTreeTestCase::DoRun (void)
+{
+  PointToPointHelper link;
+  PointToPointFatTreeHelper fatTree (m_k, link, link, m_oversubscription);
+
+  uint32_t half = m_k / 2;
+  uint32_t hostsPerEdge = static_cast<uint32_t> (half * m_oversubscription);
+  NS_TEST_ASSERT_MSG_EQ (fatTree.HostsPerEdge (), hostsPerEdge, "Wrong number of hosts per edge switch");
+  NS_TEST_ASSERT_MSG_EQ (fatTree.HostCount (), m_k * half * hostsPerEdge, "Wrong number of hosts");
+  NS_TEST_ASSERT_MSG_EQ (fatTree.GetHosts ().GetN (), fatTree.HostCount (), "Wrong host container");
+
+  // Edge, then aggregation, then core switches
+  NodeContainer switches = fatTree.GetSwitches ();
+  NS_TEST_ASSERT_MSG_EQ (switches.GetN (), m_k * half * 2 + half * half, "Wrong number of switches");
+  for (uint32_t i = 0; i < switches.GetN (); ++i)
+    {
+      uint32_t ports;
+      if (i < m_k * half)
+        {
+          ports = hostsPerEdge + half;
+        }
+      else
+        {
+          // Aggregation switches have half the ports up, core switches one
+          // port to each pod
+          ports = m_k;
+        }
+      NS_TEST_EXPECT_MSG_EQ (switches.Get (i)->GetNDevices (), ports,
+                             "Switch " << i << " has the wrong number of links");
+    }
+  for (uint32_t i = 0; i < fatTree.HostCount (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (fatTree.GetHost (i)->GetNDevices (), 1,
+                             "Host " << i << " should have a single link");
+    }
+
+  InternetStackHelper stack;
+  fatTree.InstallStack (stack);
+  fatTree.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.252"));
+
+  // Every switch port is an interface, with its address
+  for (uint32_t i = 0; i < switches.GetN (); ++i)
+    {
+      Ptr<Ipv4> ipv4 = switches.Get (i)->GetObject<Ipv4> ();
+      NS_TEST_EXPECT_MSG_EQ (ipv4->GetNInterfaces (), switches.Get (i)->GetNDevices (),
+                             "Switch " << i << " should have an interface per device");
+      for (uint32_t j = 1; j < ipv4->GetNInterfaces (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (ipv4->GetNAddresses (j), 1,
+                                 "Switch " << i << " interface " << j << " has no address");
+        }
+    }
+
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t i = 0; i < fatTree.HostCount (); ++i)
+    {
+      addresses.push_back (fatTree.GetHostIpv4Address (i));
+    }
+  CheckHosts (fatTree.GetHosts (), switches, hostsPerEdge, addresses);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test the nodes, links and addresses of PointToPointLeafSpineHelper
+ */
+class PointToPointLeafSpineTestCase : public PointToPointLayoutTestCase
+{
+public:
+  PointToPointLeafSpineTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PointToPointLeafSpineTestCase::PointToPointLeafSpineTestCase ()
+  : PointToPointLayoutTestCase ("Leaf-spine nodes, links and addresses")
+{
+}
+
+void
+PointToPointLeafSpineTestCase::DoRun (void)
+{
+  const uint32_t nLeaves = 4;
+  const uint32_t nSpines = 2;
+  const uint32_t hostsPerLeaf = 3;
+
+  PointToPointHelper link;
+  PointToPointLeafSpineHelper leafSpine (nLeaves, nSpines, hostsPerLeaf, link, link);
+
+  NS_TEST_ASSERT_MSG_EQ (leafSpine.HostCount (), nLeaves * hostsPerLeaf, "Wrong number of hosts");
+  NS_TEST_ASSERT_MSG_EQ (leafSpine.GetHosts ().GetN (), leafSpine.HostCount (), "Wrong host container");
+
+  // Leaves, then spines
+  NodeContainer switches = leafSpine.GetSwitches ();
+  NS_TEST_ASSERT_MSG_EQ (switches.GetN (), nLeaves + nSpines, "Wrong number of switches");
+  for (uint32_t i = 0; i < nLeaves; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (switches.Get (i)->GetNDevices (), hostsPerLeaf + nSpines,
+                             "Leaf " << i << " has the wrong number of links");
+    }
+  for (uint32_t i = nLeaves; i < nLeaves + nSpines; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (switches.Get (i)->GetNDevices (), nLeaves,
+                             "Spine " << i - nLeaves << " has the wrong number of links");
+    }
+
+  InternetStackHelper stack;
+  leafSpine.InstallStack (stack);
+  leafSpine.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.252"));
+
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t i = 0; i < leafSpine.HostCount (); ++i)
+    {
+      addresses.push_back (leafSpine.GetHostIpv4Address (i));
+    }
+  CheckHosts (leafSpine.GetHosts (), switches, hostsPerLeaf, addresses);
+
+  // The leaf-to-spine links follow the host links
+  Ipv4Address firstFabric (Ipv4Address ("10.0.0.1").Get () + 4 * leafSpine.HostCount ());
+  Ptr<Ipv4> leaf = switches.Get (0)->GetObject<Ipv4> ();
+  NS_TEST_EXPECT_MSG_EQ (leaf->GetAddress (hostsPerLeaf + 1, 0).GetLocal (), firstFabric,
+                         "Wrong address of the first leaf-to-spine link");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief TestSuite for the point-to-point fabric helpers
+ */
+class PointToPointLayoutTestSuite : public TestSuite
+{
+public:
+  PointToPointLayoutTestSuite ();
+};
+
+PointToPointLayoutTestSuite::PointToPointLayoutTestSuite ()
+  : TestSuite ("point-to-point-layout", UNIT)
+{
+  AddTestCase (new PointToPointFatTreeTestCase (4, 1.0), TestCase::QUICK);
+  AddTestCase (new PointToPointFatTreeTestCase (4, 2.0), TestCase::QUICK);
+  AddTestCase (new PointToPointLeafSpineTestCase, TestCase::QUICK);
+}
+
+static PointToPointLayoutTestSuite g_pointToPointLayoutTestSuite; //!< The testsuite
@@ -22,6 +22,8 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/multithreaded-simulator-impl.h"
 
 namespace ns3 {
 
@@ -80,9 +82,21 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      GetDestinationNode (0);
+      GetDestinationNode (1);
     }
 }
 
+uint32_t
+PointToPointChannel::GetDestinationNode (uint32_t wire)
+{
+  if (m_link[wire].m_dstNode == NO_NODE && m_link[wire].m_dst->GetNode () != 0)
+    {
+      m_link[wire].m_dstNode = m_link[wire].m_dst->GetNode ()->GetId ();
+    }
+  return m_link[wire].m_dstNode;
+}
+
 bool
 PointToPointChannel::TransmitStart (
   Ptr<Packet> p,
@@ -96,8 +110,23 @@ PointToPointChannel::TransmitStart (
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  uint32_t node = GetDestinationNode (wire);
+
+  if (!MultithreadedSimulatorImpl::IsLocal (node))
+    {
+      // The destination is run by another thread: hand it over a packet
+      // and a device whose reference counts are not touched by this one,
+      // unless the tx anim callback is connected
+      if (!m_txrxPointToPoint.IsEmpty ())
+        {
+          m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+        }
+      Simulator::ScheduleWithContext (node, txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), p->DeepCopy ());
+      return true;
+    }
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+  Simulator::ScheduleWithContext (node,
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p);
 
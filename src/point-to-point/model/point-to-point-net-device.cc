@@ -25,6 +25,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/tsq-tag.h"
+#include "ns3/tso-tag.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -234,6 +236,10 @@ PointToPointNetDevice::SetDataRate (DataRate bps)
 {
   NS_LOG_FUNCTION (this);
   m_bps = bps;
+  if (m_queue)
+    {
+      m_queue->SetAttribute ("LinkRate", DataRateValue (m_bps));
+    }
 }
 
 void
@@ -257,9 +263,13 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
   m_currentPkt = p;
+  // The packet leaves the host queues: give the bytes back to their socket
+  TsqTag::Release (p);
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  // A super-segment takes the time of its wire frames, back to back
+  Time txTime = m_bps.CalculateBytesTxTime (TsoTag::GetWireSize (p))
+    + m_tInterframeGap * (TsoTag::GetFrames (p) - 1);
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -348,6 +358,8 @@ PointToPointNetDevice::SetQueue (Ptr<Queue> q)
 {
   NS_LOG_FUNCTION (this << q);
   m_queue = q;
+  // Let the queue compute queueing delay and utilization for telemetry
+  m_queue->SetAttribute ("LinkRate", DataRateValue (m_bps));
 }
 
 void
@@ -557,6 +569,7 @@ PointToPointNetDevice::Send (
   if (IsLinkUp () == false)
     {
       m_macTxDropTrace (packet);
+      TsqTag::Release (packet);
       return false;
     }
 
@@ -589,6 +602,7 @@ PointToPointNetDevice::Send (
   // Enqueue may fail (overflow). Stop the tx queue, so that the upper layers
   // do not send packets until there is room in the queue again.
   m_macTxDropTrace (packet);
+  TsqTag::Release (packet);
   if (txq)
   {
     txq->Stop ();
@@ -23,6 +23,9 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -98,6 +101,162 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test of the PointToPoint model with the MultithreadedSimulatorImpl
+ *
+ * Two nodes, each in its own partition, exchange packets and their
+ * echoes, which must arrive with their tags, at the time they do with
+ * the DefaultSimulatorImpl.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   * \param multithreaded use the MultithreadedSimulatorImpl
+   */
+  PointToPointMultithreadedTest (bool multithreaded);
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send one tagged packet to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendOnePacket (Ptr<PointToPointNetDevice> device);
+  /**
+   * \brief Receive a packet on the second node, and echo it
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  /**
+   * \brief Receive an echo on the first node
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \returns true
+   */
+  bool ReceiveEcho (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  bool m_multithreaded;  //!< Use the MultithreadedSimulatorImpl
+  uint32_t m_received;   //!< Packets received by the second node, with their tag
+  uint32_t m_echoed;     //!< Echoes received by the first node
+  Time m_lastEcho;       //!< Arrival of the last echo
+};
+
+static const uint32_t PACKETS = 10;
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest (bool multithreaded)
+  : TestCase (multithreaded ? "PointToPoint with the multithreaded simulator"
+              : "PointToPoint with the default simulator"),
+    m_multithreaded (multithreaded),
+    m_received (0),
+    m_echoed (0)
+{
+}
+
+void
+PointToPointMultithreadedTest::SendOnePacket (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  SocketIpTtlTag tag;
+  tag.SetTtl (42);
+  p->AddPacketTag (tag);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  SocketIpTtlTag tag;
+  if (packet->PeekPacketTag (tag) && tag.GetTtl () == 42 && packet->GetSize () == 100)
+    {
+      m_received++;
+    }
+  device->Send (packet->Copy (), device->GetBroadcast (), protocol);
+  return true;
+}
+
+bool
+PointToPointMultithreadedTest::ReceiveEcho (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                            uint16_t protocol, const Address &from)
+{
+  m_echoed++;
+  m_lastEcho = Simulator::Now ();
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl;
+  if (m_multithreaded)
+    {
+      impl = CreateObject<MultithreadedSimulatorImpl> ();
+      impl->SetAttribute ("MaxThreads", UintegerValue (2));
+      Simulator::SetImplementation (impl);
+    }
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devA->SetDataRate (DataRate ("1Mbps"));
+  devA->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::ReceiveEcho, this));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+  devB->SetDataRate (DataRate ("1Mbps"));
+  devB->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+
+  Ptr<NetDeviceQueueInterface> ifaceA = CreateObject<NetDeviceQueueInterface> ();
+  devA->AggregateObject (ifaceA);
+  Ptr<NetDeviceQueueInterface> ifaceB = CreateObject<NetDeviceQueueInterface> ();
+  devB->AggregateObject (ifaceB);
+
+  for (uint32_t i = 1; i <= PACKETS; ++i)
+    {
+      Simulator::ScheduleWithContext (a->GetId (), MilliSeconds (10 * i),
+                                      &PointToPointMultithreadedTest::SendOnePacket, this, devA);
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, PACKETS, "Packets lost or without their tag");
+  NS_TEST_ASSERT_MSG_EQ (m_echoed, PACKETS, "Echoes lost");
+  // 102 bytes at 1 Mbit/s and 1 ms of propagation, each way
+  Time hop = DataRate ("1Mbps").CalculateBytesTxTime (102) + MilliSeconds (1);
+  NS_TEST_ASSERT_MSG_EQ (m_lastEcho, MilliSeconds (10 * PACKETS) + hop + hop,
+                         "Wrong arrival time of the last echo");
+  if (m_multithreaded)
+    {
+      NS_TEST_ASSERT_MSG_EQ (impl->GetPartitions (), 2, "Nodes not split between the threads");
+      NS_TEST_ASSERT_MSG_EQ (impl->GetLookAhead (), MilliSeconds (1), "Wrong lookahead");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +273,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest (false), TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest (true), TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
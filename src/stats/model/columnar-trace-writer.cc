@@ -0,0 +1,514 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/callback.h"
+#include "columnar-trace-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceWriter");
+
+NS_OBJECT_ENSURE_REGISTERED (ColumnarTraceWriter);
+
+namespace {
+
+const char g_magic[8] = { 'N', 'S', '3', 'C', 'O', 'L', 'T', 'R' };
+const uint32_t g_version = 1;
+
+enum
+{
+  RECORD_FLOW = 1,
+  RECORD_SERIES = 2,
+  RECORD_BLOCK = 3
+};
+
+void
+PutU16 (std::ostream &os, uint16_t v)
+{
+  os.put (v & 0xff);
+  os.put (v >> 8);
+}
+
+void
+PutU32 (std::ostream &os, uint32_t v)
+{
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      os.put ((v >> (8 * i)) & 0xff);
+    }
+}
+
+bool
+GetU16 (std::istream &is, uint16_t &v)
+{
+  uint8_t b[2];
+  if (!is.read (reinterpret_cast<char *> (b), 2))
+    {
+      return false;
+    }
+  v = b[0] | (b[1] << 8);
+  return true;
+}
+
+bool
+GetU32 (std::istream &is, uint32_t &v)
+{
+  uint8_t b[4];
+  if (!is.read (reinterpret_cast<char *> (b), 4))
+    {
+      return false;
+    }
+  v = b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t> (b[3]) << 24);
+  return true;
+}
+
+void
+PutVarint (std::vector<uint8_t> &col, uint64_t v)
+{
+  while (v >= 0x80)
+    {
+      col.push_back ((v & 0x7f) | 0x80);
+      v >>= 7;
+    }
+  col.push_back (v);
+}
+
+bool
+GetVarint (const std::vector<uint8_t> &col, uint32_t &pos, uint64_t &v)
+{
+  v = 0;
+  for (uint32_t shift = 0; shift < 64 && pos < col.size (); shift += 7)
+    {
+      uint8_t b = col[pos++];
+      v |= static_cast<uint64_t> (b & 0x7f) << shift;
+      if (!(b & 0x80))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint64_t
+ZigZag (int64_t v)
+{
+  return (static_cast<uint64_t> (v) << 1) ^ static_cast<uint64_t> (v >> 63);
+}
+
+int64_t
+UnZigZag (uint64_t v)
+{
+  return static_cast<int64_t> (v >> 1) ^ -static_cast<int64_t> (v & 1);
+}
+
+uint64_t
+DoubleBits (double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  return bits;
+}
+
+double
+BitsDouble (uint64_t bits)
+{
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+uint64_t
+SeriesKey (uint32_t flow, uint16_t series)
+{
+  return (static_cast<uint64_t> (flow) << 16) | series;
+}
+
+} // anonymous namespace
+
+TypeId
+ColumnarTraceWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ColumnarTraceWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("Stats")
+    .AddConstructor<ColumnarTraceWriter> ()
+    .AddAttribute ("BlockSize",
+                   "Number of records buffered before they are written",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&ColumnarTraceWriter::m_blockSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+ColumnarTraceWriter::ColumnarTraceWriter ()
+  : m_blockSize (65536),
+    m_records (0),
+    m_lastTime (0),
+    m_lastFlow (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ColumnarTraceWriter::~ColumnarTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ColumnarTraceWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+ColumnarTraceWriter::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_out.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_out.is_open (), "Cannot open " << filename);
+  m_out.write (g_magic, sizeof (g_magic));
+  PutU32 (m_out, g_version);
+
+  // Names declared before opening the file
+  for (std::map<std::string, uint32_t>::const_iterator it = m_flows.begin ();
+       it != m_flows.end (); ++it)
+    {
+      m_out.put (RECORD_FLOW);
+      PutU32 (m_out, it->second);
+      PutU16 (m_out, it->first.size ());
+      m_out.write (it->first.data (), it->first.size ());
+    }
+  for (std::map<std::string, uint16_t>::const_iterator it = m_series.begin ();
+       it != m_series.end (); ++it)
+    {
+      m_out.put (RECORD_SERIES);
+      PutU16 (m_out, it->second);
+      PutU16 (m_out, it->first.size ());
+      m_out.write (it->first.data (), it->first.size ());
+    }
+}
+
+void
+ColumnarTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_out.is_open ())
+    {
+      Flush ();
+      m_out.close ();
+    }
+}
+
+uint32_t
+ColumnarTraceWriter::AddFlow (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  std::map<std::string, uint32_t>::const_iterator it = m_flows.find (name);
+  if (it != m_flows.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t id = m_flows.size ();
+  m_flows[name] = id;
+  if (m_out.is_open ())
+    {
+      m_out.put (RECORD_FLOW);
+      PutU32 (m_out, id);
+      PutU16 (m_out, name.size ());
+      m_out.write (name.data (), name.size ());
+    }
+  return id;
+}
+
+uint16_t
+ColumnarTraceWriter::AddSeries (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  std::map<std::string, uint16_t>::const_iterator it = m_series.find (name);
+  if (it != m_series.end ())
+    {
+      return it->second;
+    }
+
+  NS_ABORT_MSG_IF (m_series.size () > 0xffff, "Too many series");
+  uint16_t id = m_series.size ();
+  m_series[name] = id;
+  if (m_out.is_open ())
+    {
+      m_out.put (RECORD_SERIES);
+      PutU16 (m_out, id);
+      PutU16 (m_out, name.size ());
+      m_out.write (name.data (), name.size ());
+    }
+  return id;
+}
+
+void
+ColumnarTraceWriter::Write (uint32_t flow, uint16_t series, double value)
+{
+  Write (Simulator::Now (), flow, series, value);
+}
+
+void
+ColumnarTraceWriter::Write (Time time, uint32_t flow, uint16_t series, double value)
+{
+  int64_t ns = time.GetNanoSeconds ();
+  PutVarint (m_columns[0], ZigZag (ns - m_lastTime));
+  PutVarint (m_columns[1], ZigZag (static_cast<int64_t> (flow) - m_lastFlow));
+  PutVarint (m_columns[2], series);
+  m_lastTime = ns;
+  m_lastFlow = flow;
+
+  uint64_t bits = DoubleBits (value);
+  uint64_t &last = m_lastValue[SeriesKey (flow, series)];
+  uint64_t x = bits ^ last;
+  last = bits;
+
+  std::vector<uint8_t> &col = m_columns[3];
+  if (x == 0)
+    {
+      col.push_back (0);
+    }
+  else
+    {
+      uint32_t lead = 0;
+      while (!(x >> (56 - 8 * lead)))
+        {
+          lead++;
+        }
+      uint32_t trail = 0;
+      while (!((x >> (8 * trail)) & 0xff))
+        {
+          trail++;
+        }
+      col.push_back (0x80 | (lead << 3) | trail);
+      for (uint32_t i = trail; i < 8 - lead; ++i)
+        {
+          col.push_back ((x >> (8 * i)) & 0xff);
+        }
+    }
+
+  if (++m_records >= m_blockSize)
+    {
+      Flush ();
+    }
+}
+
+void
+ColumnarTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this << m_records);
+  if (m_records == 0)
+    {
+      return;
+    }
+
+  if (m_out.is_open ())
+    {
+      m_out.put (RECORD_BLOCK);
+      PutU32 (m_out, m_records);
+      for (uint32_t i = 0; i < 4; ++i)
+        {
+          PutU32 (m_out, m_columns[i].size ());
+        }
+      for (uint32_t i = 0; i < 4; ++i)
+        {
+          m_out.write (reinterpret_cast<const char *> (&m_columns[i][0]), m_columns[i].size ());
+        }
+    }
+
+  // Every block decodes on its own
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_columns[i].clear ();
+    }
+  m_lastValue.clear ();
+  m_records = 0;
+  m_lastTime = 0;
+  m_lastFlow = 0;
+}
+
+uint32_t
+ColumnarTraceWriter::GetFlowFromContext (std::string context)
+{
+  // The context ends with the name of the trace source
+  std::string::size_type slash = context.rfind ('/');
+  if (slash != std::string::npos)
+    {
+      context = context.substr (0, slash);
+    }
+  return AddFlow (context);
+}
+
+void
+ColumnarTraceWriter::DoubleSink (Ptr<ColumnarTraceWriter> writer, uint16_t series,
+                                 std::string context, double oldValue, double newValue)
+{
+  writer->Write (writer->GetFlowFromContext (context), series, newValue);
+}
+
+void
+ColumnarTraceWriter::UintegerSink (Ptr<ColumnarTraceWriter> writer, uint16_t series,
+                                   std::string context, uint32_t oldValue, uint32_t newValue)
+{
+  writer->Write (writer->GetFlowFromContext (context), series, newValue);
+}
+
+void
+ColumnarTraceWriter::ConnectDouble (std::string path, std::string series)
+{
+  NS_LOG_FUNCTION (this << path << series);
+  Config::Connect (path, MakeBoundCallback (&ColumnarTraceWriter::DoubleSink,
+                                            Ptr<ColumnarTraceWriter> (this),
+                                            AddSeries (series)));
+}
+
+void
+ColumnarTraceWriter::ConnectUinteger (std::string path, std::string series)
+{
+  NS_LOG_FUNCTION (this << path << series);
+  Config::Connect (path, MakeBoundCallback (&ColumnarTraceWriter::UintegerSink,
+                                            Ptr<ColumnarTraceWriter> (this),
+                                            AddSeries (series)));
+}
+
+bool
+ColumnarTraceReader::Read (std::string filename, std::vector<Record> &records,
+                           std::map<uint32_t, std::string> &flows,
+                           std::map<uint16_t, std::string> &series)
+{
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (g_magic)];
+  uint32_t version;
+  if (!in.read (magic, sizeof (magic)) || std::memcmp (magic, g_magic, sizeof (magic)) != 0
+      || !GetU32 (in, version) || version != g_version)
+    {
+      return false;
+    }
+
+  int type;
+  while ((type = in.get ()) != EOF)
+    {
+      if (type == RECORD_FLOW || type == RECORD_SERIES)
+        {
+          uint32_t id32 = 0;
+          uint16_t id16 = 0;
+          uint16_t len;
+          if ((type == RECORD_FLOW ? !GetU32 (in, id32) : !GetU16 (in, id16))
+              || !GetU16 (in, len))
+            {
+              return false;
+            }
+          std::string name (len, '\0');
+          if (len > 0 && !in.read (&name[0], len))
+            {
+              return false;
+            }
+          if (type == RECORD_FLOW)
+            {
+              flows[id32] = name;
+            }
+          else
+            {
+              series[id16] = name;
+            }
+        }
+      else if (type == RECORD_BLOCK)
+        {
+          uint32_t n;
+          uint32_t sizes[4];
+          if (!GetU32 (in, n))
+            {
+              return false;
+            }
+          for (uint32_t i = 0; i < 4; ++i)
+            {
+              if (!GetU32 (in, sizes[i]))
+                {
+                  return false;
+                }
+            }
+          std::vector<uint8_t> cols[4];
+          for (uint32_t i = 0; i < 4; ++i)
+            {
+              cols[i].resize (sizes[i]);
+              if (sizes[i] > 0 && !in.read (reinterpret_cast<char *> (&cols[i][0]), sizes[i]))
+                {
+                  return false;
+                }
+            }
+
+          uint32_t pos[4] = { 0, 0, 0, 0 };
+          int64_t time = 0;
+          int64_t flow = 0;
+          std::map<uint64_t, uint64_t> last;
+          for (uint32_t r = 0; r < n; ++r)
+            {
+              uint64_t dt, df, s;
+              if (!GetVarint (cols[0], pos[0], dt) || !GetVarint (cols[1], pos[1], df)
+                  || !GetVarint (cols[2], pos[2], s) || pos[3] >= cols[3].size ())
+                {
+                  return false;
+                }
+              time += UnZigZag (dt);
+              flow += UnZigZag (df);
+
+              uint64_t x = 0;
+              uint8_t header = cols[3][pos[3]++];
+              if (header != 0)
+                {
+                  uint32_t lead = (header >> 3) & 0x7;
+                  uint32_t trail = header & 0x7;
+                  for (uint32_t i = trail; i < 8 - lead; ++i)
+                    {
+                      if (pos[3] >= cols[3].size ())
+                        {
+                          return false;
+                        }
+                      x |= static_cast<uint64_t> (cols[3][pos[3]++]) << (8 * i);
+                    }
+                }
+              uint64_t &bits = last[SeriesKey (flow, s)];
+              bits ^= x;
+
+              Record rec;
+              rec.time = time;
+              rec.flow = flow;
+              rec.series = s;
+              rec.value = BitsDouble (bits);
+              records.push_back (rec);
+            }
+        }
+      else
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "quantile-sketch.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuantileSketch");
+
+QuantileSketch::QuantileSketch (uint32_t precision)
+  : m_precision (precision),
+    m_subBuckets (1ULL << precision)
+{
+  NS_ASSERT_MSG (precision >= 1 && precision <= 16, "Unsupported precision " << precision);
+  Reset ();
+}
+
+void
+QuantileSketch::Reset (void)
+{
+  m_counts.clear ();
+  m_count = 0;
+  m_min = std::numeric_limits<int64_t>::max ();
+  m_max = 0;
+  m_sum = 0;
+}
+
+uint32_t
+QuantileSketch::Index (uint64_t v) const
+{
+  if (v < m_subBuckets)
+    {
+      return v;
+    }
+
+  // Position of the most significant bit
+  uint32_t msb = 0;
+  for (uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+      if (v >> (msb + shift))
+        {
+          msb += shift;
+        }
+    }
+
+  // Keep m_precision significant bits: the bucket width is 2^exp
+  uint32_t exp = msb - (m_precision - 1);
+  uint64_t half = m_subBuckets >> 1;
+  uint64_t mantissa = v >> exp;
+  return m_subBuckets + (exp - 1) * half + (mantissa - half);
+}
+
+uint64_t
+QuantileSketch::LowerBound (uint32_t index) const
+{
+  if (index < m_subBuckets)
+    {
+      return index;
+    }
+  uint64_t half = m_subBuckets >> 1;
+  uint64_t r = index - m_subBuckets;
+  return (r % half + half) << (r / half + 1);
+}
+
+uint64_t
+QuantileSketch::Width (uint32_t index) const
+{
+  if (index < m_subBuckets)
+    {
+      return 1;
+    }
+  return 1ULL << ((index - m_subBuckets) / (m_subBuckets >> 1) + 1);
+}
+
+void
+QuantileSketch::Update (int64_t value)
+{
+  if (value < 0)
+    {
+      value = 0;
+    }
+
+  uint32_t index = Index (value);
+  if (index >= m_counts.size ())
+    {
+      m_counts.resize (index + 1, 0);
+    }
+  m_counts[index]++;
+
+  m_count++;
+  m_min = std::min (m_min, value);
+  m_max = std::max (m_max, value);
+  m_sum += value;
+}
+
+void
+QuantileSketch::Merge (const QuantileSketch &other)
+{
+  NS_ASSERT_MSG (other.m_precision == m_precision, "Merging sketches of different precision");
+  if (other.m_count == 0)
+    {
+      return;
+    }
+
+  if (other.m_counts.size () > m_counts.size ())
+    {
+      m_counts.resize (other.m_counts.size (), 0);
+    }
+  for (uint32_t i = 0; i < other.m_counts.size (); ++i)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+
+  m_count += other.m_count;
+  m_min = std::min (m_min, other.m_min);
+  m_max = std::max (m_max, other.m_max);
+  m_sum += other.m_sum;
+}
+
+int64_t
+QuantileSketch::Quantile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+
+  q = std::min (std::max (q, 0.0), 1.0);
+  uint64_t rank = std::max<uint64_t> (1, static_cast<uint64_t> (std::ceil (q * m_count)));
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); ++i)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          // The middle of the bucket halves the worst case error; the
+          // exact extremes are better estimates than the bucket bounds
+          int64_t value = LowerBound (i) + (Width (i) - 1) / 2;
+          return std::min (std::max (value, m_min), m_max);
+        }
+    }
+  return m_max;
+}
+
+uint64_t
+QuantileSketch::Count (void) const
+{
+  return m_count;
+}
+
+int64_t
+QuantileSketch::Min (void) const
+{
+  return m_count ? m_min : 0;
+}
+
+int64_t
+QuantileSketch::Max (void) const
+{
+  return m_max;
+}
+
+double
+QuantileSketch::Mean (void) const
+{
+  return m_count ? m_sum / m_count : 0;
+}
+
+} // namespace ns3
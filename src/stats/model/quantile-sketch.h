@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Streaming quantile estimator of non-negative integer samples
+ *
+ * A log-linear histogram in the style of HDR histograms: values below
+ * 2^precision are counted exactly, larger values fall in buckets whose
+ * width is a fixed fraction of their magnitude. Any quantile is then
+ * reported with a relative error below 2^-precision, using memory
+ * proportional to the logarithm of the largest sample instead of the
+ * number of samples (a few KB for microsecond RTTs up to seconds, with
+ * the default precision).
+ *
+ * Sketches with the same precision can be merged, so that per-flow
+ * sketches can be combined into an aggregate one.
+ */
+class QuantileSketch
+{
+public:
+  /**
+   * \param precision number of significant bits kept for each sample
+   *        (between 1 and 16)
+   */
+  QuantileSketch (uint32_t precision = 7);
+
+  /**
+   * \brief Add a sample
+   * \param value the sample; negative values are counted as zero
+   */
+  void Update (int64_t value);
+
+  /**
+   * \brief Add all the samples of another sketch
+   * \param other a sketch with the same precision
+   */
+  void Merge (const QuantileSketch &other);
+
+  /// Forget all the samples
+  void Reset (void);
+
+  /**
+   * \param q the quantile, between 0 and 1 (e.g. 0.99)
+   * \returns the estimated q-quantile, or 0 if there is no sample
+   */
+  int64_t Quantile (double q) const;
+
+  /// \returns the number of samples
+  uint64_t Count (void) const;
+  /// \returns the smallest sample (exact)
+  int64_t Min (void) const;
+  /// \returns the largest sample (exact)
+  int64_t Max (void) const;
+  /// \returns the average of the samples (exact)
+  double Mean (void) const;
+
+private:
+  /**
+   * \param v a sample
+   * \returns the bucket counting v
+   */
+  uint32_t Index (uint64_t v) const;
+  /**
+   * \param index a bucket
+   * \returns the smallest value counted in the bucket
+   */
+  uint64_t LowerBound (uint32_t index) const;
+  /**
+   * \param index a bucket
+   * \returns the number of values counted in the bucket
+   */
+  uint64_t Width (uint32_t index) const;
+
+  uint32_t m_precision;           //!< Significant bits kept
+  uint64_t m_subBuckets;          //!< Values counted exactly (2^precision)
+  std::vector<uint64_t> m_counts; //!< Bucket counters, grown on demand
+  uint64_t m_count;               //!< Number of samples
+  int64_t m_min;                  //!< Smallest sample
+  int64_t m_max;                  //!< Largest sample
+  double m_sum;                   //!< Sum of the samples
+};
+
+} // namespace ns3
+
+#endif /* QUANTILE_SKETCH_H */
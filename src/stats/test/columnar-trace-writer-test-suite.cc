@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/columnar-trace-writer.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for a round trip through a file, across several blocks.
+// ===========================================================================
+
+class RoundTripColumnarTraceTestCase : public TestCase
+{
+public:
+  RoundTripColumnarTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RoundTripColumnarTraceTestCase::RoundTripColumnarTraceTestCase ()
+  : TestCase ("ColumnarTraceWriter round trip")
+{
+}
+
+void
+RoundTripColumnarTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("columnar-trace.bin");
+  const uint32_t n = 10000;
+
+  Ptr<ColumnarTraceWriter> writer = CreateObject<ColumnarTraceWriter> ();
+  writer->SetAttribute ("BlockSize", UintegerValue (1000));
+  uint16_t rate = writer->AddSeries ("Rate");
+  writer->Open (filename);
+  uint32_t flowA = writer->AddFlow ("a");
+  uint32_t flowB = writer->AddFlow ("b");
+  uint16_t events = writer->AddSeries ("CompletionEvents");
+
+  std::vector<ColumnarTraceReader::Record> expected;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ColumnarTraceReader::Record rec;
+      rec.time = 1000 * i;
+      rec.flow = (i % 3) ? flowA : flowB;
+      rec.series = (i % 2) ? rate : events;
+      rec.value = (i % 2) ? 1e9 - 1e7 * (i / 1000) : (i / 100) % 5;
+      if (i == 42)
+        {
+          rec.value = -0.1234;
+        }
+      expected.push_back (rec);
+      writer->Write (NanoSeconds (rec.time), rec.flow, rec.series, rec.value);
+    }
+  writer->Close ();
+
+  std::ifstream in (filename.c_str (), std::ios::binary | std::ios::ate);
+  // A raw record takes 22 bytes; here time takes 2 bytes, flow, series
+  // and unchanged values one byte each
+  NS_TEST_ASSERT_MSG_LT (static_cast<uint64_t> (in.tellg ()), n * 6,
+                         "Slowly changing series should take less than 6 bytes per record");
+
+  std::vector<ColumnarTraceReader::Record> records;
+  std::map<uint32_t, std::string> flows;
+  std::map<uint16_t, std::string> series;
+  bool ok = ColumnarTraceReader::Read (filename, records, flows, series);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "File could not be decoded");
+  NS_TEST_ASSERT_MSG_EQ (records.size (), n, "Wrong number of records");
+  NS_TEST_ASSERT_MSG_EQ (flows[flowA], "a", "Wrong flow name");
+  NS_TEST_ASSERT_MSG_EQ (flows[flowB], "b", "Wrong flow name");
+  NS_TEST_ASSERT_MSG_EQ (series[rate], "Rate", "Wrong series name");
+  NS_TEST_ASSERT_MSG_EQ (series[events], "CompletionEvents", "Wrong series name");
+
+  for (uint32_t i = 0; i < records.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (records[i].time, expected[i].time, "Wrong time of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].flow, expected[i].flow, "Wrong flow of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].series, expected[i].series, "Wrong series of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].value, expected[i].value, "Wrong value of record " << i);
+    }
+}
+
+class ColumnarTraceWriterTestSuite : public TestSuite
+{
+public:
+  ColumnarTraceWriterTestSuite ();
+};
+
+ColumnarTraceWriterTestSuite::ColumnarTraceWriterTestSuite ()
+  : TestSuite ("columnar-trace-writer", UNIT)
+{
+  AddTestCase (new RoundTripColumnarTraceTestCase, TestCase::QUICK);
+}
+
+static ColumnarTraceWriterTestSuite columnarTraceWriterTestSuite;
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/quantile-sketch.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for small values, which are counted exactly.
+// ===========================================================================
+
+class ExactQuantileSketchTestCase : public TestCase
+{
+public:
+  ExactQuantileSketchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ExactQuantileSketchTestCase::ExactQuantileSketchTestCase ()
+  : TestCase ("QuantileSketch is exact below 2^precision")
+{
+}
+
+void
+ExactQuantileSketchTestCase::DoRun (void)
+{
+  QuantileSketch sketch;
+
+  NS_TEST_ASSERT_MSG_EQ (sketch.Quantile (0.5), 0, "Empty sketch must report 0");
+
+  for (int64_t i = 1; i <= 100; i++)
+    {
+      sketch.Update (i);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (sketch.Count (), 100, "Count value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Min (), 1, "Min value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Max (), 100, "Max value wrong");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.Mean (), 50.5, 1e-9, "Mean value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Quantile (0.5), 50, "p50 value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Quantile (0.95), 95, "p95 value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Quantile (0.99), 99, "p99 value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Quantile (1.0), 100, "p100 value wrong");
+  NS_TEST_ASSERT_MSG_EQ (sketch.Quantile (0.0), 1, "p0 value wrong");
+}
+
+// ===========================================================================
+// Test case for a wide range of values, which are bucketed.
+// ===========================================================================
+
+class RelativeErrorQuantileSketchTestCase : public TestCase
+{
+public:
+  RelativeErrorQuantileSketchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RelativeErrorQuantileSketchTestCase::RelativeErrorQuantileSketchTestCase ()
+  : TestCase ("QuantileSketch relative error and merging")
+{
+}
+
+void
+RelativeErrorQuantileSketchTestCase::DoRun (void)
+{
+  QuantileSketch odd;
+  QuantileSketch even;
+  QuantileSketch all;
+
+  for (int64_t i = 1; i <= 1000000; i++)
+    {
+      all.Update (i);
+      if (i % 2)
+        {
+          odd.Update (i);
+        }
+      else
+        {
+          even.Update (i);
+        }
+    }
+
+  double q[] = { 0.5, 0.95, 0.99, 0.999 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      double exact = q[i] * 1000000;
+      NS_TEST_ASSERT_MSG_EQ_TOL (all.Quantile (q[i]), exact, exact / 128,
+                                 "Quantile " << q[i] << " out of the error bound");
+    }
+
+  odd.Merge (even);
+  NS_TEST_ASSERT_MSG_EQ (odd.Count (), all.Count (), "Merged count wrong");
+  NS_TEST_ASSERT_MSG_EQ (odd.Min (), 1, "Merged min wrong");
+  NS_TEST_ASSERT_MSG_EQ (odd.Max (), 1000000, "Merged max wrong");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (odd.Quantile (q[i]), all.Quantile (q[i]),
+                             "Merged quantile " << q[i] << " differs");
+    }
+
+  all.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (all.Count (), 0, "Reset sketch not empty");
+  NS_TEST_ASSERT_MSG_EQ (all.Quantile (0.99), 0, "Reset sketch must report 0");
+}
+
+class QuantileSketchTestSuite : public TestSuite
+{
+public:
+  QuantileSketchTestSuite ();
+};
+
+QuantileSketchTestSuite::QuantileSketchTestSuite ()
+  : TestSuite ("quantile-sketch", UNIT)
+{
+  AddTestCase (new ExactQuantileSketchTestCase, TestCase::QUICK);
+  AddTestCase (new RelativeErrorQuantileSketchTestCase, TestCase::QUICK);
+}
+
+static QuantileSketchTestSuite quantileSketchTestSuite;
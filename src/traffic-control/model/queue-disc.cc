@@ -24,6 +24,7 @@
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/unused.h"
+#include "ns3/tsq-tag.h"
 #include "queue-disc.h"
 
 namespace ns3 {
@@ -67,6 +68,13 @@ QueueDiscItem::SetTxQueueIndex (uint8_t txq)
   m_txq = txq;
 }
 
+bool
+QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
 void
 QueueDiscItem::Print (std::ostream& os) const
 {
@@ -411,6 +419,8 @@ QueueDisc::Drop (Ptr<QueueItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
+  TsqTag::Release (item->GetPacket ());
+
   // if the wake mode of this queue disc is WAKE_CHILD, packets are directly
   // enqueued/dequeued from the child queue discs, thus this queue disc does not
   // keep valid packets/bytes counters and no actions need to be performed.
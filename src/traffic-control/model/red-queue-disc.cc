@@ -113,6 +113,11 @@ TypeId RedQueueDisc::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&RedQueueDisc::m_isAdaptMaxP),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseEcn",
+                   "True to mark ECN capable packets with CE instead of dropping them early",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RedQueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
     .AddAttribute ("MinTh",
                    "Minimum average length threshold in packets/bytes",
                    DoubleValue (5),
@@ -390,7 +395,12 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       m_stats.qLimDrop++;
     }
 
-  if (dropType == DTYPE_UNFORCED)
+  if (dropType == DTYPE_UNFORCED && m_useEcn && item->Mark ())
+    {
+      NS_LOG_DEBUG ("\t Marking due to Prob Mark " << m_qAvg);
+      m_stats.unforcedMark++;
+    }
+  else if (dropType == DTYPE_UNFORCED)
     {
       NS_LOG_DEBUG ("\t Dropping due to Prob Mark " << m_qAvg);
       m_stats.unforcedDrop++;
@@ -470,6 +480,7 @@ RedQueueDisc::InitializeParams (void)
   NS_ASSERT (m_minTh <= m_maxTh);
   m_stats.forcedDrop = 0;
   m_stats.unforcedDrop = 0;
+  m_stats.unforcedMark = 0;
   m_stats.qLimDrop = 0;
 
   m_qAvg = 0.0;
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the per-packet lookup of Ipv4EndPointDemux.
+ *
+ * A server listens on one port and holds n connections, from distinct
+ * peers, as a fan-in incast would leave it. Every packet belongs to one of
+ * the connections, drawn at random, and is demultiplexed once.
+ *
+ * Ipv4EndPointDemux is compared with a copy of the previous implementation,
+ * which kept all the endpoints in a single list and matched each of them
+ * against every packet.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include <iostream>
+#include <limits>
+#include <list>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/**
+ * The list-based demux Ipv4EndPointDemux used to be, reduced to the
+ * allocation and the lookup of unicast packets which the benchmark needs.
+ */
+class LegacyEndPointDemux
+{
+public:
+  typedef std::list<Ipv4EndPoint *> EndPoints;
+
+  ~LegacyEndPointDemux ()
+  {
+    for (EndPoints::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+      {
+        delete *i;
+      }
+  }
+
+  void Allocate (Ipv4Address localAddress, uint16_t localPort,
+                 Ipv4Address peerAddress, uint16_t peerPort)
+  {
+    for (EndPoints::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+      {
+        if ((*i)->GetLocalPort () == localPort &&
+            (*i)->GetLocalAddress () == localAddress &&
+            (*i)->GetPeerPort () == peerPort &&
+            (*i)->GetPeerAddress () == peerAddress)
+          {
+            return;
+          }
+      }
+    Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
+    endPoint->SetPeer (peerAddress, peerPort);
+    m_endPoints.push_back (endPoint);
+  }
+
+  EndPoints Lookup (Ipv4Address daddr, uint16_t dport,
+                    Ipv4Address saddr, uint16_t sport)
+  {
+    EndPoints retval1, retval2, retval3, retval4;
+    for (EndPoints::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+      {
+        Ipv4EndPoint* endP = *i;
+        if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+          {
+            continue;
+          }
+        bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+        bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+        if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+          continue;
+        bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+        bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+        bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+        bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+        if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
+          continue;
+        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+          continue;
+        if (localAddressMatchesWildCard && remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+          {
+            retval1.push_back (endP);
+          }
+        if (localAddressMatchesExact && remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+          {
+            retval2.push_back (endP);
+          }
+        if (localAddressMatchesWildCard && remotePeerMatchesExact && remoteAddressMatchesExact)
+          {
+            retval3.push_back (endP);
+          }
+        if (localAddressMatchesExact && remotePeerMatchesExact && remoteAddressMatchesExact)
+          {
+            retval4.push_back (endP);
+          }
+      }
+    if (!retval4.empty ()) return retval4;
+    if (!retval3.empty ()) return retval3;
+    if (!retval2.empty ()) return retval2;
+    return retval1;
+  }
+
+private:
+  EndPoints m_endPoints;
+};
+
+static Ipv4Address g_server ("10.0.0.1");
+static uint16_t g_serverPort = 5000;
+
+/// A packet to demultiplex
+struct Flow
+{
+  Ipv4Address peer;  //!< Source address
+  uint16_t port;     //!< Source port
+};
+
+/**
+ * \brief Build the peers of n connections
+ * \param n number of connections
+ * \returns the peer address and port of each connection
+ */
+static std::vector<Flow>
+Peers (uint32_t n)
+{
+  std::vector<Flow> peers;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Flow f;
+      // One host per 16 connections, each host using consecutive ephemeral ports
+      f.peer = Ipv4Address (Ipv4Address ("10.1.0.0").Get () + i / 16 + 1);
+      f.port = 49152 + i % 16;
+      peers.push_back (f);
+    }
+  return peers;
+}
+
+/**
+ * \brief Draw the connection of each packet
+ * \param n number of connections
+ * \param packets number of packets
+ * \returns the connection index of each packet
+ */
+static std::vector<uint32_t>
+Arrivals (uint32_t n, uint32_t packets)
+{
+  std::vector<uint32_t> order;
+  uint32_t x = 12345;
+  for (uint32_t i = 0; i < packets; ++i)
+    {
+      x = x * 1103515245 + 12345;
+      order.push_back ((x >> 8) % n);
+    }
+  return order;
+}
+
+template <class T>
+static uint64_t
+RunLookups (T &lookup, const std::vector<Flow> &peers, const std::vector<uint32_t> &order)
+{
+  uint64_t found = 0;
+  for (std::vector<uint32_t>::const_iterator it = order.begin (); it != order.end (); ++it)
+    {
+      const Flow &f = peers[*it];
+      found += lookup (f.peer, f.port).size ();
+    }
+  return found;
+}
+
+/// Lookup functor of the legacy demux
+struct LegacyLookup
+{
+  LegacyEndPointDemux *demux;  //!< The demux
+  LegacyEndPointDemux::EndPoints operator () (Ipv4Address peer, uint16_t port)
+  {
+    return demux->Lookup (g_server, g_serverPort, peer, port);
+  }
+};
+
+/// Lookup functor of Ipv4EndPointDemux
+struct CurrentLookup
+{
+  Ipv4EndPointDemux *demux;         //!< The demux
+  Ptr<Ipv4Interface> interface;     //!< The interface the packets arrive on
+  Ipv4EndPointDemux::EndPoints operator () (Ipv4Address peer, uint16_t port)
+  {
+    return demux->Lookup (g_server, g_serverPort, peer, port, interface);
+  }
+};
+
+static uint64_t
+BenchLegacy (const std::vector<Flow> &peers, const std::vector<uint32_t> &order,
+             uint64_t &elapsed)
+{
+  LegacyEndPointDemux demux;
+  demux.Allocate (Ipv4Address::GetAny (), g_serverPort, Ipv4Address::GetAny (), 0);
+  for (std::vector<Flow>::const_iterator it = peers.begin (); it != peers.end (); ++it)
+    {
+      demux.Allocate (g_server, g_serverPort, it->peer, it->port);
+    }
+  LegacyLookup lookup;
+  lookup.demux = &demux;
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t found = RunLookups (lookup, peers, order);
+  elapsed = time.End ();
+  return found;
+}
+
+static uint64_t
+BenchCurrent (const std::vector<Flow> &peers, const std::vector<uint32_t> &order,
+              uint64_t &elapsed)
+{
+  Ipv4EndPointDemux demux;
+  demux.Allocate (g_serverPort);
+  for (std::vector<Flow>::const_iterator it = peers.begin (); it != peers.end (); ++it)
+    {
+      demux.Allocate (g_server, g_serverPort, it->peer, it->port);
+    }
+  CurrentLookup lookup;
+  lookup.demux = &demux;
+  lookup.interface = CreateObject<Ipv4Interface> ();
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t found = RunLookups (lookup, peers, order);
+  elapsed = time.End ();
+  return found;
+}
+
+static void
+RunBench (uint64_t (*bench) (const std::vector<Flow> &, const std::vector<uint32_t> &, uint64_t &),
+          const std::vector<Flow> &peers, const std::vector<uint32_t> &order,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t found = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t elapsed;
+      found = (*bench) (peers, order, elapsed);
+      minDelay = std::min (minDelay, elapsed);
+    }
+  double ns = minDelay;
+  ns *= 1e6;
+  ns /= order.size ();
+  std::cout << peers.size () << " endpoints\t" << ns << " ns/lookup"
+            << " (" << minDelay << " ms elapsed, " << found << " found)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t maxEndPoints = 100000;
+  uint32_t packets = 100000;
+  uint32_t minIterations = 1;
+  bool legacy = true;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the lookup of Ipv4EndPointDemux against the number of endpoints");
+  cmd.AddValue ("max-endpoints", "largest number of connections, from 10 by factors of 10", maxEndPoints);
+  cmd.AddValue ("packets", "number of packets demultiplexed per run", packets);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("legacy", "also run the list-based demux", legacy);
+  cmd.Parse (argc, argv);
+
+  if (maxEndPoints < 10 || packets == 0)
+    {
+      std::cerr << "Error-- at least 10 endpoints and one packet must be specified " <<
+        "by command-line arguments --max-endpoints and --packets" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-endpoint-demux with " << packets << " packets per run" << std::endl;
+
+  for (uint32_t n = 10; n <= maxEndPoints; n *= 10)
+    {
+      std::vector<Flow> peers = Peers (n);
+      std::vector<uint32_t> order = Arrivals (n, packets);
+      if (legacy)
+        {
+          RunBench (&BenchLegacy, peers, order, minIterations, "Single list (previous Ipv4EndPointDemux)");
+        }
+      RunBench (&BenchCurrent, peers, order, minIterations, "Hashed connections (Ipv4EndPointDemux)");
+    }
+
+  return 0;
+}
@@ -63,7 +63,7 @@ public:
     m_total = total;
   }
     
-  void RunBench (void);
+  double RunBench (void);
 private:
   void Cb (void);
   
@@ -73,7 +73,7 @@ private:
   uint32_t m_count;
 };
 
-void
+double
 Bench::RunBench (void) 
 {
   SystemWallClockMs time;
@@ -107,6 +107,7 @@ Bench::RunBench (void)
        std::setw (g_fwidth) << (m_count / simu) <<
        std::setw (g_fwidth) << (simu / m_count));
 
+  return simu / m_count;
 }
 
 void
@@ -179,58 +180,24 @@ GetRandomStream (std::string filename)
 
 
 
-int main (int argc, char *argv[])
+/**
+ * Benchmark one scheduler, and print a table of the runs.
+ *
+ * \param factory the scheduler factory
+ * \param bench the benchmark
+ * \param pop event population size
+ * \param total total number of events to run
+ * \param runs number of runs
+ * \returns the best simulation time per event of the runs, in s
+ */
+double
+BenchScheduler (ObjectFactory factory, Bench *bench,
+                uint32_t pop, uint32_t total, uint32_t runs)
 {
-
-  bool schedCal  = false;
-  bool schedHeap = false;
-  bool schedList = false;
-  bool schedMap  = true;
-
-  uint32_t pop   =  100000;
-  uint32_t total = 1000000;
-  uint32_t runs  =       1;
-  std::string filename = "";
-  
-  CommandLine cmd;
-  cmd.Usage ("Benchmark the simulator scheduler.\n"
-             "\n"
-             "Event intervals are taken from one of:\n"
-             "  an exponential distribution, with mean 100 ns,\n"
-             "  an ascii file, given by the --file=\"<filename>\" argument,\n"
-             "  or standard input, by the argument --file=\"-\"\n"
-             "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
-  cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
-  cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
-  cmd.AddValue ("list",  "use ListSheduler",              schedList);
-  cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
-  cmd.AddValue ("debug", "enable debugging output",       g_debug);
-  cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
-  cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
-  cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
-  cmd.AddValue ("file",  "file of relative event times",  filename);
-  cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
-  cmd.Parse (argc, argv);
-  g_me = cmd.GetName () + ": ";
-  g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
-
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
   Simulator::SetScheduler (factory);
 
-  LOGME (std::setprecision (g_fwidth - 6));
-  DEB ("debugging is ON");
-
+  LOG ("");
   LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
-  LOGME ("population: " << pop);
-  LOGME ("total events: " << total);
-  LOGME ("runs: " << runs);
-  
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
 
   // table header
   LOG ("");
@@ -262,16 +229,117 @@ int main (int argc, char *argv[])
 
   bench->SetPopulation (pop);
   bench->SetTotal (total);
+  double best = 0;
   for (uint32_t i = 0; i < runs; i++)
     {
       std::cout << std::setw (g_fwidth) << i;
       
-      bench->RunBench ();
+      double per = bench->RunBench ();
+      if (i == 0 || per < best)
+        {
+          best = per;
+        }
     }
 
-  LOG ("");
-  return 0;
-
   Simulator::Destroy ();
+  return best;
+}
 
+int main (int argc, char *argv[])
+{
+
+  bool schedCal    = false;
+  bool schedHeap   = false;
+  bool schedLadder = false;
+  bool schedList   = false;
+  bool schedMap    = true;
+  bool schedAll    = false;
+
+  uint32_t pop   =  100000;
+  uint32_t total = 1000000;
+  uint32_t runs  =       1;
+  std::string filename = "";
+  
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the simulator scheduler.\n"
+             "\n"
+             "Event intervals are taken from one of:\n"
+             "  an exponential distribution, with mean 100 ns,\n"
+             "  an ascii file, given by the --file=\"<filename>\" argument,\n"
+             "  or standard input, by the argument --file=\"-\"\n"
+             "In the case of either --file form, the input is expected\n"
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "With --all, every scheduler is run in turn, and their\n"
+             "best simulation times per event are compared at the end.");
+  cmd.AddValue ("cal",    "use CalendarSheduler",          schedCal);
+  cmd.AddValue ("heap",   "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderScheduler",           schedLadder);
+  cmd.AddValue ("list",   "use ListSheduler",              schedList);
+  cmd.AddValue ("map",    "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("all",    "compare all the schedulers",    schedAll);
+  cmd.AddValue ("debug",  "enable debugging output",       g_debug);
+  cmd.AddValue ("pop",    "event population size (default 1E5)",         pop);
+  cmd.AddValue ("total",  "total number of events to run (default 1E6)", total);
+  cmd.AddValue ("runs",   "number of runs (default 1)",    runs);
+  cmd.AddValue ("file",   "file of relative event times",  filename);
+  cmd.AddValue ("prec",   "printed output precision",      g_fwidth);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+  g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
+
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      std::string type = "ns3::MapScheduler";
+      if (schedCal)    { type = "ns3::CalendarScheduler"; }
+      if (schedHeap)   { type = "ns3::HeapScheduler";     }
+      if (schedLadder) { type = "ns3::LadderScheduler";   }
+      if (schedList)   { type = "ns3::ListScheduler";     }
+      schedulers.push_back (type);
+    }
+
+  LOGME (std::setprecision (g_fwidth - 6));
+  DEB ("debugging is ON");
+
+  LOGME ("population: " << pop);
+  LOGME ("total events: " << total);
+  LOGME ("runs: " << runs);
+  
+  Bench *bench = new Bench (pop, total);
+  bench->SetRandomStream (GetRandomStream (filename));
+
+  std::vector<double> best;
+  for (uint32_t i = 0; i < schedulers.size (); ++i)
+    {
+      best.push_back (BenchScheduler (ObjectFactory (schedulers[i]), bench,
+                                      pop, total, runs));
+    }
+
+  if (schedulers.size () > 1)
+    {
+      // comparison, relative to the first scheduler
+      LOG ("");
+      LOG (std::left << std::setw (3 * g_fwidth) << "Scheduler" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Speedup");
+      for (uint32_t i = 0; i < schedulers.size (); ++i)
+        {
+          LOG (std::left << std::setw (3 * g_fwidth) << schedulers[i] <<
+               std::left << std::setw (g_fwidth) << best[i] <<
+               std::left << std::setw (g_fwidth) << (best[0] / best[i]));
+        }
+    }
+
+  LOG ("");
+  delete bench;
+  return 0;
 }
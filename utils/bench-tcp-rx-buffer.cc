@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the TCP receive buffer under reordering.
+ *
+ * Segments are received in sequence, except that one every lossInterval is
+ * lost and retransmitted reorder segments later, as after a fast
+ * retransmit. The out-of-order data held by the buffer grows with
+ * reorder/lossInterval holes. All the available data is read after every
+ * segment, as an application would.
+ *
+ * TcpRxBuffer is compared with a copy of the previous implementation, which
+ * kept every segment in a map and trimmed and fragmented on every insert.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-rx-buffer.h"
+#include <iostream>
+#include <limits>
+#include <map>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/**
+ * The map-based receive buffer TcpRxBuffer used to be, without the FIN and
+ * window handling which the benchmark does not need.
+ */
+class LegacyRxBuffer
+{
+public:
+  LegacyRxBuffer (uint32_t n)
+    : m_nextRxSeq (n), m_size (0), m_availBytes (0)
+  {
+  }
+
+  bool Add (Ptr<Packet> p, TcpHeader const& tcph)
+  {
+    uint32_t pktSize = p->GetSize ();
+    SequenceNumber32 headSeq = tcph.GetSequenceNumber ();
+    SequenceNumber32 tailSeq = headSeq + SequenceNumber32 (pktSize);
+
+    if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
+    BufIterator i = m_data.begin ();
+    while (i != m_data.end () && i->first <= tailSeq)
+      {
+        SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+        if (lastByteSeq > headSeq)
+          {
+            if (i->first > headSeq && lastByteSeq < tailSeq)
+              {
+                m_size -= i->second->GetSize ();
+                m_data.erase (i++);
+                continue;
+              }
+            if (i->first <= headSeq)
+              {
+                headSeq = lastByteSeq;
+              }
+            if (lastByteSeq >= tailSeq)
+              {
+                tailSeq = i->first;
+              }
+          }
+        ++i;
+      }
+    if (headSeq >= tailSeq)
+      {
+        return false;
+      }
+    p = p->CreateFragment (headSeq - tcph.GetSequenceNumber (), tailSeq - headSeq);
+    m_data [headSeq] = p;
+    m_size += p->GetSize ();
+    for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+      {
+        if (i->first < m_nextRxSeq)
+          {
+            continue;
+          }
+        else if (i->first > m_nextRxSeq)
+          {
+            break;
+          }
+        m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+        m_availBytes += i->second->GetSize ();
+      }
+    return true;
+  }
+
+  Ptr<Packet> Extract (uint32_t maxSize)
+  {
+    uint32_t extractSize = std::min (maxSize, m_availBytes);
+    if (extractSize == 0) return 0;
+    Ptr<Packet> outPkt = Create<Packet> ();
+    while (extractSize)
+      {
+        BufIterator i = m_data.begin ();
+        uint32_t pktSize = i->second->GetSize ();
+        if (pktSize <= extractSize)
+          {
+            outPkt->AddAtEnd (i->second);
+            m_data.erase (i);
+            m_size -= pktSize;
+            m_availBytes -= pktSize;
+            extractSize -= pktSize;
+          }
+        else
+          {
+            outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+            m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
+            m_data.erase (i);
+            m_size -= extractSize;
+            m_availBytes -= extractSize;
+            extractSize = 0;
+          }
+      }
+    return outPkt;
+  }
+
+  uint32_t Available () const
+  {
+    return m_availBytes;
+  }
+
+private:
+  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  SequenceNumber32 m_nextRxSeq;
+  uint32_t m_size;
+  uint32_t m_availBytes;
+  std::map<SequenceNumber32, Ptr<Packet> > m_data;
+};
+
+static uint32_t g_segmentSize = 1448;
+static uint32_t g_lossInterval = 20;
+static uint32_t g_reorder = 200;
+static uint32_t g_readSize = 65536;
+
+/**
+ * \brief Build the arrival order of n segments
+ * \param n number of segments
+ * \returns the segment indices, in arrival order
+ */
+static std::vector<uint32_t>
+ArrivalOrder (uint32_t n)
+{
+  std::vector<uint32_t> order;
+  std::multimap<uint32_t, uint32_t> retransmissions; // by arrival slot
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      if (i % g_lossInterval == g_lossInterval - 1)
+        {
+          retransmissions.insert (std::make_pair (i + g_reorder, i));
+        }
+      else
+        {
+          order.push_back (i);
+        }
+      while (retransmissions.size () && retransmissions.begin ()->first <= i)
+        {
+          order.push_back (retransmissions.begin ()->second);
+          retransmissions.erase (retransmissions.begin ());
+        }
+    }
+  for (std::multimap<uint32_t, uint32_t>::iterator it = retransmissions.begin ();
+       it != retransmissions.end (); ++it)
+    {
+      order.push_back (it->second);
+    }
+  return order;
+}
+
+template <class T>
+static uint64_t
+RunOnce (T &buffer, const std::vector<uint32_t> &order)
+{
+  uint64_t delivered = 0;
+  TcpHeader h;
+  for (std::vector<uint32_t>::const_iterator it = order.begin (); it != order.end (); ++it)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + *it * g_segmentSize));
+      buffer.Add (Create<Packet> (g_segmentSize), h);
+      while (buffer.Available ())
+        {
+          delivered += buffer.Extract (g_readSize)->GetSize ();
+        }
+    }
+  return delivered;
+}
+
+static uint64_t
+BenchLegacy (const std::vector<uint32_t> &order)
+{
+  LegacyRxBuffer buffer (1);
+  return RunOnce (buffer, order);
+}
+
+static uint64_t
+BenchCurrent (const std::vector<uint32_t> &order)
+{
+  Ptr<TcpRxBuffer> buffer = CreateObject<TcpRxBuffer> (1);
+  buffer->SetMaxBufferSize (std::numeric_limits<uint32_t>::max () / 2);
+  return RunOnce (*buffer, order);
+}
+
+static void
+RunBench (uint64_t (*bench) (const std::vector<uint32_t> &), const std::vector<uint32_t> &order,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t delivered = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      delivered = (*bench) (order);
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  double ps = order.size ();
+  ps *= 1000;
+  ps /= std::max<uint64_t> (minDelay, 1);
+  std::cout << ps << " segments/s"
+            << " (" << minDelay << " ms elapsed, " << delivered << " bytes delivered)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark TcpRxBuffer under reordering");
+  cmd.AddValue ("n", "number of segments", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("segment-size", "size of the segments", g_segmentSize);
+  cmd.AddValue ("loss-interval", "one segment out of loss-interval is reordered", g_lossInterval);
+  cmd.AddValue ("reorder", "segments received before a lost one is retransmitted", g_reorder);
+  cmd.AddValue ("read-size", "maximum bytes read at once by the application", g_readSize);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || g_lossInterval == 0)
+    {
+      std::cerr << "Error-- number of segments must be specified " <<
+        "by command-line argument --n=(number of segments)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-tcp-rx-buffer with n=" << n << ", " << g_reorder / g_lossInterval
+            << " holes on average" << std::endl;
+
+  std::vector<uint32_t> order = ArrivalOrder (n);
+  RunBench (&BenchLegacy, order, minIterations, "Map of segments (previous TcpRxBuffer)");
+  RunBench (&BenchCurrent, order, minIterations, "Coalesced blocks (TcpRxBuffer)");
+
+  return 0;
+}
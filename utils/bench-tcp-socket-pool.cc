@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the creation of TCP sockets, with and without the socket
+ * pool of TcpL4Protocol.
+ *
+ * "create" only creates sockets and drops them, which measures the setup of
+ * a socket: attribute initialization of all its objects without the pool,
+ * copies of the prototypes with it.
+ *
+ * "flows" runs short flows between two hosts: each opens a connection,
+ * sends one segment and closes, and the server closes on the FIN. The
+ * applications keep no reference to their sockets, so with the pool the
+ * closed sockets are recycled by the next flows.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-l4-protocol.h"
+#include <iostream>
+#include <limits>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static uint16_t g_port = 5000;
+static uint32_t g_completed = 0;  //!< Flows closed by the server
+
+static void
+ServerRecv (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+    }
+}
+
+static void
+ServerPeerClose (Ptr<Socket> socket)
+{
+  socket->Close ();
+  g_completed++;
+}
+
+static bool
+ServerRequest (Ptr<Socket> socket, const Address &from)
+{
+  return true;
+}
+
+static void
+ServerAccept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&ServerRecv));
+  socket->SetCloseCallbacks (MakeCallback (&ServerPeerClose), MakeNullCallback<void, Ptr<Socket> > ());
+}
+
+static void
+ClientConnected (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+  socket->Close ();
+}
+
+static void
+ClientFailed (Ptr<Socket> socket)
+{
+  socket->Close ();
+}
+
+static void
+StartFlow (Ptr<Node> client, Address server, Time interval, uint32_t left)
+{
+  Ptr<Socket> socket = Socket::CreateSocket (client, TcpSocketFactory::GetTypeId ());
+  socket->Bind ();
+  socket->SetConnectCallback (MakeCallback (&ClientConnected), MakeCallback (&ClientFailed));
+  socket->Connect (server);
+  if (left > 1)
+    {
+      Simulator::Schedule (interval, &StartFlow, client, server, interval, left - 1);
+    }
+}
+
+/**
+ * \brief Create and drop sockets
+ * \param n number of sockets
+ * \param poolSize the "SocketPoolSize" of TcpL4Protocol
+ * \param elapsed wall-clock time, in ms
+ * \returns the number of sockets recycled
+ */
+static uint64_t
+BenchCreate (uint32_t n, uint32_t poolSize, uint64_t &elapsed)
+{
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketPoolSize", UintegerValue (poolSize));
+  NodeContainer nodes;
+  nodes.Create (1);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+    }
+  elapsed = time.End ();
+
+  uint64_t recycled = nodes.Get (0)->GetObject<TcpL4Protocol> ()->GetRecycledSockets ();
+  Simulator::Destroy ();
+  return recycled;
+}
+
+/**
+ * \brief Run short flows
+ * \param n number of flows
+ * \param poolSize the "SocketPoolSize" of TcpL4Protocol
+ * \param elapsed wall-clock time, in ms
+ * \returns the number of sockets recycled by the client
+ */
+static uint64_t
+BenchFlows (uint32_t n, uint32_t poolSize, uint64_t &elapsed)
+{
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketPoolSize", UintegerValue (poolSize));
+  // Leave TIME_WAIT quickly, so that the ephemeral ports are not exhausted
+  Config::SetDefault ("ns3::TcpSocketBase::MaxSegLifetime", DoubleValue (1e-6));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper link;
+  NetDeviceContainer devices = link.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  Ptr<Socket> listener = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  listener->Bind (InetSocketAddress (Ipv4Address::GetAny (), g_port));
+  listener->Listen ();
+  listener->SetAcceptCallback (MakeCallback (&ServerRequest), MakeCallback (&ServerAccept));
+
+  g_completed = 0;
+  Address server = InetSocketAddress (interfaces.GetAddress (1), g_port);
+  Simulator::Schedule (Seconds (0), &StartFlow, nodes.Get (0), server, MicroSeconds (10), n);
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  elapsed = time.End ();
+
+  if (g_completed != n)
+    {
+      std::cerr << "Error-- " << g_completed << " flows out of " << n << " completed" << std::endl;
+    }
+  uint64_t recycled = nodes.Get (0)->GetObject<TcpL4Protocol> ()->GetRecycledSockets ();
+  listener = 0;
+  Simulator::Destroy ();
+  return recycled;
+}
+
+static void
+RunBench (uint64_t (*bench) (uint32_t, uint32_t, uint64_t &),
+          uint32_t n, uint32_t poolSize, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t recycled = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t elapsed;
+      recycled = (*bench) (n, poolSize, elapsed);
+      minDelay = std::min (minDelay, elapsed);
+    }
+  double rate = n;
+  rate /= std::max<uint64_t> (minDelay, 1);
+  rate *= 1000;
+  std::cout << name << "\tpool " << poolSize << "\t" << rate << " sockets/s"
+            << " (" << minDelay << " ms elapsed, " << recycled << " recycled)"
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t flows = 100000;
+  uint32_t poolSize = 1024;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the creation of TCP sockets with and without the socket pool");
+  cmd.AddValue ("flows", "number of sockets created per run", flows);
+  cmd.AddValue ("pool-size", "SocketPoolSize of the pooled runs", poolSize);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (flows == 0 || poolSize == 0)
+    {
+      std::cerr << "Error-- a number of flows and a pool size must be specified " <<
+        "by command-line arguments --flows and --pool-size" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-tcp-socket-pool with " << flows << " sockets per run" << std::endl;
+
+  RunBench (&BenchCreate, flows, 0, minIterations, "create");
+  RunBench (&BenchCreate, flows, poolSize, minIterations, "create");
+  RunBench (&BenchFlows, flows, 0, minIterations, "flows");
+  RunBench (&BenchFlows, flows, poolSize, minIterations, "flows");
+
+  return 0;
+}
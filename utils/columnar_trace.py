@@ -0,0 +1,108 @@
+"""Load the files written by ns3::ColumnarTraceWriter into numpy arrays.
+
+    import columnar_trace
+    trace = columnar_trace.load("timely-state.bin")
+    t, rate = trace[("/NodeList/1/$ns3::TcpL4Protocol/SocketList/0/CongestionOps", "Rate")]
+
+Times are in nanoseconds. See columnar-trace-writer.h for the format.
+"""
+
+import struct
+import numpy as np
+
+MAGIC = b"NS3COLTR"
+VERSION = 1
+RECORD_FLOW, RECORD_SERIES, RECORD_BLOCK = 1, 2, 3
+
+
+def _varints(buf):
+    """Decode a column of LEB128 varints, vectorized."""
+    b = np.frombuffer(buf, dtype=np.uint8)
+    if len(b) == 0:
+        return np.zeros(0, dtype=np.uint64)
+    ends = np.flatnonzero(b < 0x80)
+    starts = np.concatenate(([0], ends[:-1] + 1))
+    group = np.repeat(np.arange(len(ends)), ends - starts + 1)
+    shift = (7 * (np.arange(len(b)) - starts[group])).astype(np.uint64)
+    parts = (b & 0x7f).astype(np.uint64) << shift
+    return np.add.reduceat(parts, starts)
+
+
+def _unzigzag(v):
+    return (v >> np.uint64(1)).astype(np.int64) ^ -(v & np.uint64(1)).astype(np.int64)
+
+
+def _values(buf, n):
+    """Decode the XOR-with-leading/trailing-zeros value column."""
+    x = np.zeros(n, dtype=np.uint64)
+    data = bytearray(buf)
+    pos = 0
+    for i in range(n):
+        header = data[pos]
+        pos += 1
+        if header:
+            lead = (header >> 3) & 7
+            trail = header & 7
+            width = 8 - lead - trail
+            chunk = bytes(data[pos:pos + width]) + b"\0" * (8 - width)
+            x[i] = struct.unpack("<Q", chunk)[0] << (8 * trail)
+            pos += width
+    return x
+
+
+def read(filename):
+    """Return (flows, series, records), records being a dict of numpy
+    arrays 'time', 'flow', 'series' and 'value' in file order."""
+    flows, series = {}, {}
+    columns = {"time": [], "flow": [], "series": [], "value": []}
+    with open(filename, "rb") as f:
+        if f.read(8) != MAGIC or struct.unpack("<I", f.read(4))[0] != VERSION:
+            raise ValueError("not a columnar trace: " + filename)
+        while True:
+            kind = f.read(1)
+            if not kind:
+                break
+            kind = ord(kind)
+            if kind == RECORD_FLOW:
+                ident, length = struct.unpack("<IH", f.read(6))
+                flows[ident] = f.read(length).decode()
+            elif kind == RECORD_SERIES:
+                ident, length = struct.unpack("<HH", f.read(4))
+                series[ident] = f.read(length).decode()
+            elif kind == RECORD_BLOCK:
+                n, lt, lf, ls, lv = struct.unpack("<IIIII", f.read(20))
+                time = np.cumsum(_unzigzag(_varints(f.read(lt))))
+                flow = np.cumsum(_unzigzag(_varints(f.read(lf))))
+                ser = _varints(f.read(ls)).astype(np.int64)
+                x = _values(f.read(lv), n)
+                # Undo the XOR with the previous value of the same flow and
+                # series: a cumulative XOR inside each (flow, series) group
+                key = (flow << 16) | ser
+                order = np.argsort(key, kind="mergesort")
+                acc = np.bitwise_xor.accumulate(x[order])
+                sk = key[order]
+                first = np.concatenate(([True], sk[1:] != sk[:-1]))
+                group_start = np.maximum.accumulate(np.where(first, np.arange(n), 0))
+                before = np.where(group_start > 0, acc[group_start - 1], np.uint64(0))
+                bits = np.empty(n, dtype=np.uint64)
+                bits[order] = acc ^ before
+                columns["time"].append(time)
+                columns["flow"].append(flow)
+                columns["series"].append(ser)
+                columns["value"].append(bits.view(np.float64))
+            else:
+                raise ValueError("corrupted columnar trace: " + filename)
+    records = dict((k, np.concatenate(v) if v else np.zeros(0)) for k, v in columns.items())
+    return flows, series, records
+
+
+def load(filename):
+    """Return a dict mapping (flow name, series name) to (times, values)."""
+    flows, series, rec = read(filename)
+    out = {}
+    key = (rec["flow"] << 16) | rec["series"]
+    for k in np.unique(key):
+        mask = key == k
+        name = (flows[int(k >> 16)], series[int(k & 0xffff)])
+        out[name] = (rec["time"][mask], rec["value"][mask])
+    return out